@@ -0,0 +1,161 @@
+/**
+\author Anthony Matarazzo
+\file batchRender.cpp
+\date 5/12/20
+\version 1.0
+\brief renders markup documents to image files without a window. Several
+documents are rendered at once, one for each thread of the pool. The
+documents of a thread are held within its own element containers while
+the font files read from the disk are shared.
+
+usage: guidomBatch.out [-w width] [-h height] [-j threads] [-l listFile]
+                       [input output]...
+
+The list file holds one input and output pair for each line. The images are
+written as binary portable pixmaps.
+*/
+#include "viewManager.hpp"
+
+using namespace std;
+using namespace viewManager;
+
+/**
+\brief a document to render and the result of rendering it.
+*/
+struct batchItem {
+  batchItem(const std::string &_sInput, const std::string &_sOutput)
+      : sInput(_sInput), sOutput(_sOutput) {}
+
+  std::string sInput;
+  std::string sOutput;
+  double dMilliseconds = 0;
+  std::string sError;
+};
+
+/**
+\brief renders one document upon the calling thread. The elements of the
+document are released afterwards so the thread can render the next.
+*/
+void renderDocument(batchItem &item, const int width, const int height) {
+  auto start = std::chrono::steady_clock::now();
+
+  try {
+    auto &vm = createElement<Viewer>(
+        viewerMode::headless,
+        objectWidth{static_cast<double>(width), numericFormat::px},
+        objectHeight{static_cast<double>(height), numericFormat::px},
+        textFace{"arial"}, textSize{16_pt}, textWeight{400}, lineHeight::normal,
+        textAlignment::left, position::relative, paddingTop{5_pt},
+        paddingLeft{5_pt}, paddingBottom{5_pt}, paddingRight{5_pt},
+        background{"white"}, textColor{"black"});
+    vm.load(item.sInput);
+    vm.saveImage(item.sOutput);
+  } catch (const std::exception &e) {
+    item.sError = e.what();
+  }
+
+  releaseElements();
+
+  item.dMilliseconds = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+}
+
+/**
+\brief reads the input and output pairs of a list file.
+*/
+void readListFile(const std::string &sFilename, std::vector<batchItem> &items) {
+  std::ifstream in(sFilename);
+  if (!in)
+    throw std::runtime_error("The list file could not be opened: " +
+                             sFilename);
+
+  std::string sInput, sOutput;
+  while (in >> sInput >> sOutput)
+    items.push_back(batchItem{sInput, sOutput});
+}
+
+int main(int argc, char **argv) {
+  int width = 800;
+  int height = 600;
+  unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<batchItem> items;
+
+  try {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+      std::string sArg = argv[i];
+      bool bOption = sArg == "-w" || sArg == "-h" || sArg == "-j" ||
+                     sArg == "-l";
+      if (bOption && i + 1 >= argc)
+        throw std::invalid_argument("A value is required for " + sArg);
+
+      if (sArg == "-w")
+        width = std::stoi(argv[++i]);
+      else if (sArg == "-h")
+        height = std::stoi(argv[++i]);
+      else if (sArg == "-j")
+        threads = static_cast<unsigned int>(std::stoi(argv[++i]));
+      else if (sArg == "-l")
+        readListFile(argv[++i], items);
+      else
+        positional.push_back(sArg);
+    }
+
+    if (positional.size() % 2)
+      throw std::invalid_argument("Each input requires an output file.");
+    for (std::size_t i = 0; i < positional.size(); i += 2)
+      items.push_back(batchItem{positional[i], positional[i + 1]});
+
+    if (width <= 0 || height <= 0 || threads == 0)
+      throw std::invalid_argument("The size and threads must be positive.");
+
+  } catch (const std::exception &e) {
+    cerr << e.what() << endl
+         << "usage: " << argv[0]
+         << " [-w width] [-h height] [-j threads] [-l listFile]"
+            " [input output]..."
+         << endl;
+    return 1;
+  }
+
+  if (items.empty())
+    return 0;
+
+  threads = std::min<std::size_t>(threads, items.size());
+
+  // each worker takes the next document until none remain.
+  std::atomic<std::size_t> next = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threads; i++)
+    workers.emplace_back([&]() {
+      for (std::size_t n = next++; n < items.size(); n = next++)
+        renderDocument(items[n], width, height);
+    });
+
+  for (auto &t : workers)
+    t.join();
+
+  double dSeconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  std::size_t failed = 0;
+  for (auto &item : items) {
+    cout << item.sInput << " -> " << item.sOutput << " " << item.dMilliseconds
+         << " ms";
+    if (!item.sError.empty()) {
+      cout << " failed: " << item.sError;
+      failed++;
+    }
+    cout << endl;
+  }
+
+  cout << items.size() << " documents, " << threads << " threads, "
+       << dSeconds << " s, " << (dSeconds > 0 ? items.size() / dSeconds : 0)
+       << " documents/s" << endl;
+
+  return failed ? 1 : 0;
+}
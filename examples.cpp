@@ -1184,3 +1184,217 @@ void randomAttributeSettings(Element &e) {
     // std::cout << " Exception: " << e.what() << "\n";
   }
 }
+
+//! [CHART]
+void chartExample(Viewer &vm) {
+  auto &c = createElement<CHART>(objectHeight{200_px});
+  vm.appendChild(c);
+
+  // appending updates the min/max summary, so drawing stays fast for
+  // any number of points.
+  for (int i = 0; i < 100000; i++)
+    c.series.append(std::sin(i / 1000.0));
+
+  // zoom to a range of points
+  c.viewFirst = 40000;
+  c.viewCount = 20000;
+}
+//! [CHART]
+
+//! [observable]
+void observableExample(Viewer &vm) {
+  static observable<int> count(0);
+  static computed<std::string> label(
+      []() { return "clicked " + std::to_string(count.get()) + " times"; },
+      {count});
+
+  auto &p = createElement<PARAGRAPH>();
+  vm.appendChild(p);
+
+  // the text is applied once per frame however often the count changes.
+  label.bindData(p, 0);
+  p.addListener(eventType::click,
+                [](const event &evt) { count = count.get() + 1; });
+}
+//! [observable]
+
+//! [frameExport]
+// within the viewer process
+void frameExportExample(Viewer &vm) { vm.exportFrames("guidom"); }
+
+// within a recorder process
+void frameRecorderExample(void) {
+  Visualizer::frameExportReader reader("guidom");
+  Visualizer::frameExportReader::frame f;
+  std::vector<u_int8_t> copy;
+
+  while (reader.wait(std::chrono::milliseconds(500))) {
+    if (!reader.acquire(f))
+      continue;
+
+    // the damage rectangles give the parts of f.pixels that changed since
+    // the frame before. Frames were skipped when the whole frame is set.
+    const std::size_t stride = f.header->stride;
+    copy.resize(stride * f.header->height);
+    if (f.bWhole) {
+      std::copy(f.pixels, f.pixels + copy.size(), copy.begin());
+    } else {
+      for (uint32_t i = 0; i < f.header->damageCount; i++) {
+        const auto &d = f.header->damage[i];
+        for (uint32_t y = d.y; y < d.y + d.h; y++)
+          std::copy(&f.pixels[y * stride + d.x * 4],
+                    &f.pixels[y * stride + (d.x + d.w) * 4],
+                    &copy[y * stride + d.x * 4]);
+      }
+    }
+
+    // the producer wrote over the slot meanwhile, a newer frame follows
+    // with the whole frame set.
+    if (!reader.intact(f))
+      continue;
+  }
+}
+//! [frameExport]
+
+//! [memoryBudget]
+void memoryBudgetExample(Viewer &vm) {
+  // the caches are trimmed after a frame that leaves them above 32 MB.
+  // When the word metrics alone are larger, the handler is told once.
+  vm.setMemoryBudget(32 << 20, [](const memoryUsage &use) {
+    std::cout << use.metrics << " bytes of metrics exceed the budget"
+              << std::endl;
+  });
+
+  // moderate pressure reported by the kernel drops the glyphs and below.
+  vm.watchMemoryPressure(trimLevel::glyphs);
+
+  // before the application is suspended, everything is released.
+  memoryUsage freed = vm.trim(trimLevel::metrics);
+  std::cout << freed.total() << " bytes freed" << std::endl;
+}
+//! [memoryBudget]
+
+//! [clone]
+void cloneExample(Viewer &vm) {
+  auto &card = createElement<DIV>(indexBy{"card"});
+  card.appendChild<H3>(indexBy{"title"}, "Name");
+  card.appendChild<PARAGRAPH>("Description");
+
+  // each copy is its own tree, its ids become "card-1", "title-1" ...
+  for (int i = 1; i <= 3; i++)
+    vm.appendChild(card.clone(true, "-" + std::to_string(i)));
+}
+//! [clone]
+
+//! [sortData]
+void sortDataExample(Viewer &vm) {
+  auto &prices = vm.appendChild<PARAGRAPH>(indexBy{"prices"});
+  prices.data<double>() = {12.5, 3.25, 40, 7.75};
+
+  // displayed from the highest, the rows are not measured again.
+  prices.sortData<double>(std::greater<>());
+
+  // then only the prices above 5.
+  prices.filterData<double>([](double d) { return d > 5; });
+}
+//! [sortData]
+
+//! [executor]
+void executorExample(Viewer &vm) {
+  // four workers upon the first four processors.
+  vm.configureExecutor(4, {0, 1, 2, 3});
+
+  auto &list = vm.appendChild<PARAGRAPH>(indexBy{"records"});
+  cancellationToken token = list.taskToken();
+
+  // the rows are read by a worker, and given to the document upon the
+  // ui thread. Both are dropped if the element is removed meanwhile.
+  vm.tasks().post(
+      [&vm, &list, token]() {
+        std::vector<std::string> rows = {"first", "second", "third"};
+        vm.runOnUiThread(
+            [&list, rows]() mutable { list.data() = std::move(rows); },
+            token);
+      },
+      taskPriority::visible, token);
+
+  // a result can also be waited upon.
+  std::future<int> sum = vm.tasks().submit([]() { return 6 * 7; });
+  std::cout << sum.get() << std::endl;
+}
+//! [executor]
+
+//! [loadZstd]
+#if defined(USE_ZSTD)
+void loadZstdExample(Viewer &vm) {
+  std::string sMarkup;
+  for (int i = 0; i < 10000; i++)
+    sMarkup += "<p>row " + std::to_string(i) + "</p>";
+
+  // written as a zstd file, as from "zstd page.html".
+  std::string sCompressed(ZSTD_compressBound(sMarkup.size()), '\0');
+  sCompressed.resize(ZSTD_compress(sCompressed.data(), sCompressed.size(),
+                                   sMarkup.data(), sMarkup.size(), 3));
+  std::ofstream("page.html.zst", std::ios::binary) << sCompressed;
+
+  // the format is recognized from its leading bytes.
+  auto &page = createElement<DIV>();
+  page.load("page.html.zst");
+  vm.appendChild(page);
+  std::cout << page.childCount() << " rows" << std::endl;
+}
+#endif
+//! [loadZstd]
+
+//! [halve]
+// compares the mip reduction, vectorized where SSE2 is available, with
+// the scalar rounding it must match.
+bool halveExample(void) {
+  Visualizer::imageSurface src(64, 32), dst(32, 16);
+  for (unsigned int y = 0; y < src.height(); y++)
+    for (unsigned int x = 0; x < src.width(); x++)
+      src.putPixel(x, y, (static_cast<uint32_t>(std::rand()) << 16) ^
+                             static_cast<uint32_t>(std::rand()));
+
+  Visualizer::imageSurface::halve(src, dst);
+
+  for (unsigned int y = 0; y < dst.height(); y++)
+    for (unsigned int x = 0; x < dst.width(); x++) {
+      const uint32_t *r0 = src.row(y * 2);
+      const uint32_t *r1 = src.row(y * 2 + 1);
+      if (dst.row(y)[x] !=
+          Visualizer::imageSurface::boxAverage(r0[x * 2], r0[x * 2 + 1],
+                                               r1[x * 2], r1[x * 2 + 1]))
+        return false;
+    }
+  return true;
+}
+//! [halve]
+
+//! [lazyMarkup]
+#if defined(USE_LAZY_MARKUP)
+// built with make LAZY_MARKUP=1
+void lazyMarkupExample(Viewer &vm) {
+  std::string sMarkup;
+  for (int i = 0; i < 100000; i++)
+    sMarkup += "<p id=row" + std::to_string(i) + ">row " +
+               std::to_string(i) + "</p>";
+  std::ofstream("rows.html") << sMarkup;
+
+  // the paragraphs are recorded upon tapes. Those near the viewport are
+  // created by the first layout, the rest as they are scrolled to.
+  auto &page = createElement<DIV>();
+  vm.appendChild(page);
+  page.load("rows.html");
+
+  // seeking an element creates the group holding it.
+  getElement("row90000") << " found";
+
+  // traversal creates the children before visiting them, so only the
+  // paragraphs are seen.
+  std::cout << page.childCount() << " rows" << std::endl;
+  for (auto &n : page.children())
+    n.setAttribute(textColor{64, 64, 64});
+}
+#endif
+//! [lazyMarkup]
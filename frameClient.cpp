@@ -0,0 +1,70 @@
+/**
+\author Anthony Matarazzo
+\file frameClient.cpp
+\date 5/14/20
+\version 1.0
+\brief a reference client of the frame server started with
+Viewer::serveFrames. The frames are received and applied to a copy of the
+screen, and the size of each is reported. The last frame is written to an
+image file.
+
+usage: guidomFrameClient.out [-n frames] [-o image.ppm] address
+
+The address is "unix:path", "tcp:port" or "tcp:host:port". Without -n the
+client runs until the server closes the connection.
+*/
+#include "viewManager.hpp"
+
+using namespace std;
+using namespace viewManager;
+
+int main(int argc, char **argv) {
+  std::size_t frames = 0;
+  std::string sOutput = "frame.ppm";
+  std::string sAddress;
+
+  for (int i = 1; i < argc; i++) {
+    std::string sArg = argv[i];
+    if (sArg == "-n" && i + 1 < argc)
+      frames = static_cast<std::size_t>(std::stoul(argv[++i]));
+    else if (sArg == "-o" && i + 1 < argc)
+      sOutput = argv[++i];
+    else
+      sAddress = sArg;
+  }
+
+  if (sAddress.empty()) {
+    cerr << "usage: " << argv[0] << " [-n frames] [-o image.ppm] address"
+         << endl;
+    return 1;
+  }
+
+  try {
+    int fd = Visualizer::frameSocket(sAddress, false);
+    Visualizer::frameDecoder decoder;
+    std::size_t received = 0;
+    std::size_t totalBytes = 0;
+
+    while ((!frames || received < frames) && decoder.receive(fd)) {
+      received++;
+      totalBytes += decoder.frameBytes();
+      cout << "frame " << received << " " << decoder.width() << "x"
+           << decoder.height() << " " << decoder.tiles() << " tiles "
+           << decoder.frameBytes() << " bytes" << endl;
+    }
+    close(fd);
+
+    if (received) {
+      Visualizer::writePixmap(sOutput, decoder.pixels().data(),
+                              decoder.width(), decoder.height());
+      cout << received << " frames, " << totalBytes / received
+           << " bytes per frame" << endl;
+    }
+
+  } catch (const std::exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -97,6 +97,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE /* hPrevInstance */,
   test10(vm);
 #endif
 
+#if defined(__linux__)
+  // -serve address shares the window with frame clients.
+  if (argc > 2 && string(argv[1]) == "-serve")
+    vm.serveFrames(argv[2]);
+#endif
+
   vm.processEvents();
 }
 
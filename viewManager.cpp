@@ -40,10 +40,47 @@ are not normally accessed by the developer. They are accessed using the
 API. The create, append, and getElement functions provide the searching and
 creation of the objects.
 */
-std::unordered_map<std::size_t, std::unique_ptr<Element>> viewManager::elements;
-std::unordered_map<std::string, std::reference_wrapper<Element>>
+thread_local std::unordered_map<std::size_t, std::unique_ptr<Element>>
+    viewManager::elements;
+thread_local std::unordered_map<std::string, std::reference_wrapper<Element>>
     viewManager::indexedElements;
-std::vector<std::unique_ptr<StyleClass>> viewManager::styles;
+#if defined(USE_LAZY_MARKUP)
+thread_local std::unordered_map<std::string, std::size_t>
+    viewManager::deferredIndex;
+#endif
+thread_local std::vector<std::unique_ptr<StyleClass>> viewManager::styles;
+thread_local std::shared_ptr<viewManager::bindingQueue>
+    viewManager::pendingBindings = std::make_shared<bindingQueue>();
+std::recursive_mutex viewManager::observableLock;
+thread_local std::vector<Element *> viewManager::pendingOutput;
+thread_local viewManager::documentCacheBytes viewManager::cacheBytes{0, 0};
+thread_local std::size_t viewManager::treeGeneration = 0;
+thread_local std::size_t viewManager::layoutGeneration = 0;
+
+/**
+\internal
+\brief the computed styles of the thread by hash. The records are owned by
+the elements, so the entries of records no longer used expire.
+*/
+static thread_local std::unordered_multimap<
+    std::size_t, std::weak_ptr<viewManager::computedStyle>>
+    internedStyles;
+
+/**
+\brief releases the document of the calling thread. All elements created
+upon the thread, including the Viewer, are destroyed. A thread rendering
+many documents calls this between them.
+*/
+void viewManager::releaseElements(void) {
+  pendingOutput.clear();
+  indexedElements.clear();
+#if defined(USE_LAZY_MARKUP)
+  deferredIndex.clear();
+#endif
+  elements.clear();
+  styles.clear();
+  internedStyles.clear();
+}
 
 /**
 \internal
@@ -55,8 +92,10 @@ function which calls the createElement document API. The function
 returns the newly created element. The table is used by the
 parser to instantiate document elements.
 
+The entries are sorted by name when compiled so the table needs no work
+when the program loads.
 */
-const factoryMap viewManager::objectFactoryMap = {
+static constexpr auto objectFactoryEntries = sortTable<factoryLambda>({
 
 #ifdef INCLUDE_UX
     CREATE_OBJECT(text, UX::text),
@@ -104,9 +143,11 @@ const factoryMap viewManager::objectFactoryMap = {
     CREATE_OBJECT(ul, UL),
     CREATE_OBJECT(ol, OL),
     CREATE_OBJECT(li, LI),
-    CREATE_OBJECT(image, IMAGE)
+    CREATE_OBJECT(image, IMAGE),
+    CREATE_OBJECT(chart, CHART)
 
-};
+});
+const factoryMap viewManager::objectFactoryMap(objectFactoryEntries);
 
 // clang-format off
 
@@ -126,113 +167,114 @@ Items that are single words are shorthand for attributes that have enumeration v
 for example block instead of using display:block.
 This informs the context of the parser to advance and except a secondary value or not.
 
+The name left sets objectLeft. The alignment is given with textalignment left.
 */
-const attributeStringMap
-    viewManager::attributeFactory = {
+static constexpr auto attributeFactoryEntries =
+    sortTable<std::pair<bool, attributeLambda>>({
     {"id",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(indexBy{s});
         }}
     },
 
     {"indexby",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(indexBy{s});
         }}
     },
 
     {"block",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(display::block);
         }}
     },
 
     {"inline",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(display::in_line);
         }}
     },
 
     {"hidden",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(display::none);
         }}
     },
 
     {"display",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(display{s});
         }}
     },
 
     {"absolute",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(position::absolute);
         }}
     },
 
     {"relative",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(position::relative);
         }}
     },
 
     {"position",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(position{s});
         }}
     },
 
     {"objecttop",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectTop{doubleNF(s)});
         }}
     },
 
     {"top",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectTop{doubleNF(s)});
         }}
     },
 
     {"objectleft",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectLeft{doubleNF(s)});
         }}
     },
 
     {"left",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectLeft{doubleNF(s)});
         }}
     },
 
     {"objectheight",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectHeight{doubleNF(s)});
         }}
     },
 
     {"height",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectHeight{doubleNF(s)});
         }}
     },
 
     {"objectwidth",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectWidth{doubleNF(s)});
         }}
     },
 
     {"width",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(objectWidth{doubleNF(s)});
         }}
     },
 
     {"coordinates",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             auto coords=parseQuadCoordinates(s);
 
             e.setAttribute(objectTop{std::get<0>(coords)});
@@ -243,159 +285,154 @@ const attributeStringMap
     },
 
     {"scrolltop",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(scrollTop{doubleNF(s)});
         }}
     },
 
     {"scrollleft",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(scrollLeft{doubleNF(s)});
         }}
     },
 
     {"background",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(background{colorNF(s)});
         }}
     },
 
     {"opacity",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(opacity{s});
         }}
     },
 
     {"textface",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textFace{s});
         }}
     },
 
     {"textsize",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textSize{doubleNF(s)});
         }}
     },
 
     {"textweight",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textWeight{s});
         }}
     },
 
     {"weight",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textWeight{s});
         }}
     },
     {"textcolor",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textColor{colorNF(s)});
         }}
     },
 
     {"color",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textColor{colorNF(s)});
         }}
     },
     {"textalignment",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textAlignment{s});
         }}
     },
 
-    {"left",{false,
-        [](Element &e, string s) {
-            e.setAttribute(textAlignment::left);
-        }}
-    },
     {"center",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textAlignment::center);
         }}
     },
     {"right",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textAlignment::right);
         }}
     },
     {"justified",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textAlignment::justified);
         }}
     },
 
     {"textindent",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textIndent{doubleNF(s)});
         }}
     },
 
     {"indent",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(textIndent{doubleNF(s)});
         }}
     },
 
     {"tabsize",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(tabSize{doubleNF(s)});
         }}
     },
 
     {"tab",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(tabSize{doubleNF(s)});
         }}
     },
 
     {"lineheight",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(lineHeight{s});
         }}
     },
 
     {"normal",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(lineHeight::normal);
         }}
     },
 
     {"numeric",{false,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(lineHeight::numeric);
         }}
     },
 
 
     {"margintop",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(marginTop{doubleNF(s)});
         }}
     },
 
     {"marginleft",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(marginLeft{doubleNF(s)});
         }}
     },
 
     {"marginbottom",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(marginBottom{doubleNF(s)});
         }}
     },
 
     {"marginright",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(marginRight{doubleNF(s)});
         }}
     },
 
     {"margin",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             auto coords=parseQuadCoordinates(s);
 
             e.setAttribute(marginTop{std::get<0>(coords)});
@@ -406,31 +443,31 @@ const attributeStringMap
     },
 
     {"paddingtop",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(paddingTop{doubleNF(s)});
         }}
     },
 
     {"paddingleft",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(paddingLeft{doubleNF(s)});
         }}
     },
 
     {"paddingbottom",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(paddingBottom{doubleNF(s)});
         }}
     },
 
     {"paddingright",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(paddingRight{doubleNF(s)});
         }}
     },
 
     {"padding",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             auto coords=parseQuadCoordinates(s);
 
             e.setAttribute(paddingTop{std::get<0>(coords)});
@@ -441,50 +478,52 @@ const attributeStringMap
     },
 
     {"borderstyle",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(borderStyle{s});
         }}
     },
 
     {"borderwidth",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(borderWidth{doubleNF(s)});
         }}
     },
 
     {"bordercolor",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(borderColor{colorNF(s)});
         }}
     },
 
     {"borderradius",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(borderRadius{s});
         }}
     },
 
     {"focusindex",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(focusIndex{s});
         }}
     },
     {"focus",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(focusIndex{s});
         }}
     },
     {"zindex",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(zIndex{s});
         }}
     },
 
     {"liststyletype",{true,
-        [](Element &e, string s) {
+        [](Element &e, const string &s) {
             e.setAttribute(listStyleType{s});
         }}
-    }};
+    }});
+const attributeStringMap
+    viewManager::attributeFactory(attributeFactoryEntries);
 
 /**
 \internal
@@ -492,12 +531,12 @@ const attributeStringMap
 textual color name to the 24bit rgb value.
 color names from https://www.w3schools.com/colors/colors_names.asp
 */
-const colorMap colorNF::colorFactory = {
+static constexpr auto colorFactoryEntries = sortTable<unsigned long>({
     { "aliceblue", 0xF0F8FF },      { "antiquewhite", 0xFAEBD7 },   { "aqua", 0x00FFFF },
     { "aquamarine", 0x7FFFD4 },     { "azure", 0xF0FFFF },          { "beige", 0xF5F5DC },
     { "bisque", 0xFFE4C4 },         { "black", 0x000000 },          { "blanchedalmond", 0xFFEBCD },
     { "blue", 0x0000FF },           { "blueviolet", 0x8A2BE2 },     { "brown", 0xA52A2A },
-    { "burlyWood", 0xDEB887 },      { "cadetblue", 0x5F9EA0 },      { "chartreuse", 0x7FFF00 },
+    { "burlywood", 0xDEB887 },      { "cadetblue", 0x5F9EA0 },      { "chartreuse", 0x7FFF00 },
     { "chocolate", 0xD2691E },      { "coral", 0xFF7F50 },          { "cornflowerblue", 0x6495ED },
     { "cornsilk", 0xFFF8DC },       { "crimson", 0xDC143C },        { "cyan", 0x00FFFF },
     { "darkblue", 0x00008B },       { "darkcyan", 0x008B8B },       { "darkgoldenrod", 0xB8860B },
@@ -518,7 +557,7 @@ const colorMap colorNF::colorFactory = {
     { "lemonchiffon", 0xFFFACD },   { "lightblue", 0xADD8E6 },      { "lightcoral", 0xF08080 },
     { "lightcyan", 0xE0FFFF },      { "lightgoldenrodyellow", 0xFAFAD2 },
     { "lightgray", 0xD3D3D3 },      { "lightgrey", 0xD3D3D3 },      { "lightgreen", 0x90EE90 },
-    { "lightpink", 0xFFB6C1 },      { "lightdalmon", 0xFFA07A },    { "lightseagreen", 0x20B2AA },
+    { "lightpink", 0xFFB6C1 },      { "lightsalmon", 0xFFA07A },    { "lightseagreen", 0x20B2AA },
     { "lightskyblue", 0x87CEFA },   { "lightslategray", 0x778899 }, { "lightslategrey", 0x778899 },
     { "lightsteelblue", 0xB0C4DE }, { "lightyellow", 0xFFFFE0 },    { "lime", 0x00FF00 },
     { "limegreen", 0x32CD32 },      { "linen", 0xFAF0E6 },          { "magenta", 0xFF00FF },
@@ -542,7 +581,8 @@ const colorMap colorNF::colorFactory = {
     { "steelblue", 0x4682B4 },      { "tan", 0xD2B48C },            { "teal", 0x008080 },
     { "thistle", 0xD8BFD8 },        { "tomato", 0xFF6347 },         { "turquoise", 0x40E0D0 },
     { "violet", 0xEE82EE },         { "wheat", 0xF5DEB3 },          { "white", 0xFFFFFF },
-    { "whitesmoke", 0xF5F5F5 },    { "yellow", 0xFFFF00 },          { "yellowgreen", 0x9ACD32 } };
+    { "whitesmoke", 0xF5F5F5 },    { "yellow", 0xFFFF00 },          { "yellowgreen", 0x9ACD32 } });
+const colorMap colorNF::colorFactory(colorFactoryEntries);
 
 // clang-format on
 
@@ -550,15 +590,15 @@ const colorMap colorNF::colorFactory = {
 \brief a constructor that takes a string and sets the options.
 */
 viewManager::doubleNF::doubleNF(const string &sOption) {
-  static unordered_map<string, u_int8_t> annotationMap = {
-      {"px", numericFormat::px},
-      {"pt", numericFormat::pt},
-      {"em", numericFormat::em},
-      {"percent", numericFormat::percent},
-      {"pct", numericFormat::percent},
-      {"%", numericFormat::percent},
-      {"autocalculate", numericFormat::autoCalculate},
-      {"auto", numericFormat::autoCalculate}};
+  static constexpr auto annotationMap = sortTable<uint8_t>(
+      {{"px", numericFormat::px},
+       {"pt", numericFormat::pt},
+       {"em", numericFormat::em},
+       {"percent", numericFormat::percent},
+       {"pct", numericFormat::percent},
+       {"%", numericFormat::percent},
+       {"autocalculate", numericFormat::autoCalculate},
+       {"auto", numericFormat::autoCalculate}});
 
   // default to auto calculate
   option = numericFormat::autoCalculate;
@@ -763,11 +803,11 @@ values. the function removes invalid characters and applies a toLower case
 transform
 
 \param const string_view &sListName
-\param const unordered_map<string,uint8_t> &optionMap
+\param const staticTable<uint8_t> &optionMap
 \param const string &_sOption
 */
 uint8_t viewManager::strToEnum(const string_view &sListName,
-                               const unordered_map<string, uint8_t> &optionMap,
+                               const staticTable<uint8_t> &optionMap,
                                const string &_sOption) {
   uint8_t ret = 0;
 
@@ -786,6 +826,8 @@ uint8_t viewManager::strToEnum(const string_view &sListName,
 
     throw std::invalid_argument(info);
   }
+
+  return ret;
 }
 
 /**
@@ -803,8 +845,8 @@ back to the enumeration value.
 
 */
 tuple<double, u_int8_t> viewManager::strToNumericAndEnum(
-    const string_view &sListName,
-    const unordered_map<string, uint8_t> &optionMap, const string &_sOption) {
+    const string_view &sListName, const staticTable<uint8_t> &optionMap,
+    const string &_sOption) {
 
   std::regex r("[\\s,_]+");
   std::string sTmp = std::regex_replace(_sOption, r, "");
@@ -818,7 +860,7 @@ tuple<double, u_int8_t> viewManager::strToNumericAndEnum(
   dRet = strtod(sTmp.data(), &pEnd);
 
   if (pEnd) {
-    auto it = optionMap.find(string(pEnd));
+    auto it = optionMap.find(pEnd);
     if (it != optionMap.end())
       ui8Ret = it->second;
   }
@@ -832,8 +874,8 @@ tuple<double, u_int8_t> viewManager::strToNumericAndEnum(
 transforms the textual input into the display options
 */
 viewManager::display::display(const string &sOption) {
-  static unordered_map<string, uint8_t> enumMap = {
-      {"inline", in_line}, {"block", block}, {"none", none}};
+  static constexpr auto enumMap = sortTable<uint8_t>(
+      {{"inline", in_line}, {"block", block}, {"none", none}});
   value =
       static_cast<display::optionEnum>(strToEnum("display", enumMap, sOption));
 }
@@ -844,8 +886,8 @@ viewManager::display::display(const string &sOption) {
 transforms the textual input into the position options
 */
 viewManager::position::position(const string &sOption) {
-  static unordered_map<string, uint8_t> enumMap = {{"absolute", absolute},
-                                                   {"relative", relative}};
+  static constexpr auto enumMap =
+      sortTable<uint8_t>({{"absolute", absolute}, {"relative", relative}});
   value = value = static_cast<position::optionEnum>(
       strToEnum("position", enumMap, sOption));
 }
@@ -856,10 +898,10 @@ viewManager::position::position(const string &sOption) {
  transforms the textual input into the textAlignment options
  */
 viewManager::textAlignment::textAlignment(const string &sOption) {
-  static unordered_map<string, uint8_t> enumMap = {{"left", left},
-                                                   {"center", center},
-                                                   {"right", right},
-                                                   {"justified", justified}};
+  static constexpr auto enumMap = sortTable<uint8_t>({{"left", left},
+                                                      {"center", center},
+                                                      {"right", right},
+                                                      {"justified", justified}});
   value = static_cast<textAlignment::optionEnum>(
       strToEnum("textAlignment", enumMap, sOption));
 }
@@ -870,8 +912,8 @@ viewManager::textAlignment::textAlignment(const string &sOption) {
 transforms the textual input into the lineHeight options
 */
 viewManager::lineHeight::lineHeight(const string &sOption) {
-  static unordered_map<string, uint8_t> enumMap = {{"normal", normal},
-                                                   {"numeric", numeric}};
+  static constexpr auto enumMap =
+      sortTable<uint8_t>({{"normal", normal}, {"numeric", numeric}});
   u_int8_t opt;
   tie(value, opt) = strToNumericAndEnum("lineHeight", enumMap, sOption);
   option = static_cast<lineHeight::optionEnum>(opt);
@@ -882,10 +924,10 @@ viewManager::lineHeight::lineHeight(const string &sOption) {
 transforms the textual input into the lineHeight options
 */
 viewManager::borderStyle::borderStyle(const string &sOption) {
-  static unordered_map<string, uint8_t> enumMap = {
-      {"none", none},   {"dotted", dotted},   {"dashed", dashed},
-      {"solid", solid}, {"doubled", doubled}, {"groove", groove},
-      {"ridge", ridge}, {"inset", inset},     {"outset", outset}};
+  static constexpr auto enumMap = sortTable<uint8_t>(
+      {{"none", none},   {"dotted", dotted},   {"dashed", dashed},
+       {"solid", solid}, {"doubled", doubled}, {"groove", groove},
+       {"ridge", ridge}, {"inset", inset},     {"outset", outset}});
   value = static_cast<borderStyle::optionEnum>(
       strToEnum("borderStyle", enumMap, sOption));
 }
@@ -897,14 +939,42 @@ transforms the string input to the list of options
 \param const string &_sOption is the option to translate
 */
 viewManager::listStyleType::listStyleType(const string &sOption) {
-  static unordered_map<string, uint8_t> enumMap = {
-      {"none", none},     {"disc", disc},       {"circle", circle},
-      {"square", square}, {"decimal", decimal}, {"alpha", alpha},
-      {"greek", greek},   {"latin", latin},     {"roman", roman}};
+  static constexpr auto enumMap = sortTable<uint8_t>(
+      {{"none", none},     {"disc", disc},       {"circle", circle},
+       {"square", square}, {"decimal", decimal}, {"alpha", alpha},
+       {"greek", greek},   {"latin", latin},     {"roman", roman}});
   value = static_cast<listStyleType::optionEnum>(
       strToEnum("listStyleType", enumMap, sOption));
 }
 
+/**
+\internal
+\brief viewerMode
+transforms the string input to the viewer modes
+\param const string &_sOption is the option to translate
+*/
+viewManager::viewerMode::viewerMode(const string &sOption) {
+  static constexpr auto enumMap =
+      sortTable<uint8_t>({{"window", window},
+                          {"headless", headless},
+                          {"framebuffer", framebuffer}});
+  value = static_cast<viewerMode::optionEnum>(
+      strToEnum("viewerMode", enumMap, sOption));
+}
+
+/**
+\internal
+\brief pixelFormat
+transforms the string input to the pixel formats
+\param const string &_sOption is the option to translate
+*/
+viewManager::pixelFormat::pixelFormat(const string &sOption) {
+  static constexpr auto enumMap = sortTable<uint8_t>(
+      {{"xrgb8888", xrgb8888}, {"rgb565", rgb565}, {"gray8", gray8}});
+  value = static_cast<pixelFormat::optionEnum>(
+      strToEnum("pixelFormat", enumMap, sOption));
+}
+
 /**
 \internal
 \class Viewer
@@ -919,8 +989,9 @@ listeners attached.
 */
 
 /**
-\brief the viewer constructor opens a window and establishes a root document
-object.
+\brief the viewer constructor establishes a root document object. The
+platform begins starting while the application builds the document, and
+the window is opened by processEvents.
 */
 viewManager::Viewer::Viewer(const vector<any> &attrs)
     : Element("Viewer", attrs) {
@@ -929,25 +1000,84 @@ viewManager::Viewer::Viewer(const vector<any> &attrs)
   documentState st;
   st.focusField = this;
   setAttribute<documentState>(st);
+
+  startPlatform();
 }
 
 /**
+\internal
+\brief starts the platform upon two worker tasks. One initializes the font
+library, loads the fontconfig configuration and opens the default face.
+The other connects to the display server. The time to the first frame is
+then the longest of these and the document construction rather than
+their sum. processEvents waits for both tasks.
+*/
+void viewManager::Viewer::startPlatform(void) {
+  eventHandler ev =
+      std::bind(&Viewer::dispatchEvent, this, std::placeholders::_1);
+
+  // the size is given when the window is opened.
+  m_device = std::make_unique<Visualizer::platform>(ev, 0, 0);
+
+  std::vector<std::string> faces = {DEFAULT_TEXTFACE};
+  try {
+    faces.push_back(readAttribute<textFace>().value);
+  } catch (const std::exception &e) {
+  }
+
+  // the framebuffer is drawn without a display server as well.
+  bool bHeadless = false;
+  try {
+    bHeadless = getAttribute<viewerMode>().value != viewerMode::window;
+  } catch (const std::exception &e) {
+  }
+
+  try {
+    m_device->setPixelFormat(getAttribute<pixelFormat>().value);
+  } catch (const std::exception &e) {
+  }
+
+  // the tasks use separate members of the platform, and the document does
+  // not use the platform until processEvents.
+  Visualizer::platform *device = m_device.get();
+  m_textStartup = std::async(std::launch::async, [device, faces]() {
+    device->initializeText();
+    device->preloadFaces(faces);
+  });
+  if (!bHeadless)
+    m_displayStartup =
+        std::async(std::launch::async, [device]() { device->connect(); });
+}
+
 /**
 \internal
 \brief deconstructor for the view manager object.
 */
-viewManager::Viewer::~Viewer() {}
+viewManager::Viewer::~Viewer() {
+  // the start up tasks reference the platform.
+  if (m_textStartup.valid())
+    m_textStartup.wait();
+  if (m_displayStartup.valid())
+    m_displayStartup.wait();
+}
 
 /**
   \internal
-  \brief The function is a recursive one that calculates the
-  items that could not be resolved previously. At the completetion
-  of this functionality, all items that appear within the viewport
-  should be calculated.
+  \brief The function calculates the items of an element that could
+  not be resolved previously. It is called for each element in tree order
+  by continueLayout. At the completetion of the walk, all items that
+  appear within the viewport should be calculated.
 
 */
 void viewManager::Viewer::treeOrderComputeLayout(double &dpenX, double &dpenY,Element &e) {
   doubleNF numeric = doubleNF(0_px);
+
+  // kept so that placeSubtree can place the element again by itself.
+  if (e.parent()) {
+    e.displayList.entryPenX = dpenX;
+    e.displayList.entryPenY = dpenY;
+    e.displayList.entryParentMaxY = e.parent()->get().maxY;
+  }
   /* the logic skips the calculation if it has already been
      performed. Also because of the walking order, object parents
      will already be resolved. This is a necessity for the process
@@ -1003,6 +1133,19 @@ void viewManager::Viewer::treeOrderComputeLayout(double &dpenX, double &dpenY,El
       }
     }
 
+    /* text that begins below the viewport and has not been measured is
+       given an estimated size. It is measured during idle time. */
+    bool bEstimate = false;
+    double dEstimatedWidth = 0;
+    double dEstimatedHeight = -1;
+#if defined(USE_PROGRESSIVE_LAYOUT)
+    bEstimate = !e.hasMetrics() && listEntry.y1 > displayList.y2 &&
+                (listEntry.bAutoCalculateRight ||
+                 listEntry.bAutoCalculateBottom);
+#endif
+    if (!bEstimate)
+      e.wordMetrics(*m_device.get());
+
     /* right position */
     if (!listEntry.bCalculatedRight) {
       if (listEntry.bAutoCalculateRight) {
@@ -1010,7 +1153,11 @@ void viewManager::Viewer::treeOrderComputeLayout(double &dpenX, double &dpenY,El
         if (listEntry.disp == display::in_line) {
           listEntry.ow = eParent.displayList.ow;
           listEntry.ow_nf = numericFormat::px;
-          listEntry.ow = e.computeWidestTextData(*m_device.get());
+          if (bEstimate)
+            e.estimateTextDataExtent(eParent.displayList.ow, listEntry.ow,
+                                     dEstimatedHeight);
+          else
+            listEntry.ow = e.computeWidestTextData(*m_device.get());
           // clamp to width of parent
           if (listEntry.ow > eParent.displayList.ow)
             listEntry.ow = eParent.displayList.ow;
@@ -1044,8 +1191,14 @@ void viewManager::Viewer::treeOrderComputeLayout(double &dpenX, double &dpenY,El
     if (!listEntry.bCalculatedBottom) {
       if (listEntry.bAutoCalculateBottom) {
         // get the height of the wrapped text in pixels.
-        listEntry.oh =
-            e.computeWrappedTextDataHeight(*m_device.get(), listEntry.ow);
+        if (bEstimate) {
+          e.estimateTextDataExtent(listEntry.ow, dEstimatedWidth,
+                                   dEstimatedHeight);
+          listEntry.oh = dEstimatedHeight;
+        } else {
+          listEntry.oh =
+              e.computeWrappedTextDataHeight(*m_device.get(), listEntry.ow);
+        }
         listEntry.oh_nf = numericFormat::px;
         listEntry.y2 = listEntry.y1 + listEntry.oh;
         listEntry.bCalculatedBottom = true;
@@ -1085,338 +1238,750 @@ void viewManager::Viewer::treeOrderComputeLayout(double &dpenX, double &dpenY,El
       e.penX=e.displayList.x1;
     //if(e.penY>=e.displayList.oh)
     //  break;
+
+    // the height is refined later only when it was estimated here.
+    if (bEstimate)
+      m_deferredMetrics.push_back(
+          {(std::size_t)&e, listEntry.ow, dEstimatedHeight});
   }
   e.penX=dpenX;
   e.penY=dpenY;
-
-  // iterate the children recursively.
-  for (auto &n : e.children()) {
-    treeOrderComputeLayout(e.penX, e.penY, n);
-  }
 }
 
 /**
-\brief The routine processes the list of elements such that the layout
-and units are all expressed within the model as pixel units. After this
-function is ran, each element will have a rectangle attached that expresses
-it's pixel size on the viewing device.
+\internal
+\brief The routine initializes the display list record of an element.
+All calculations that do not depend upon another element, such as
+absolute positions, are resolved. Elements that are not displayed are
+not added to the display list.
 */
-void viewManager::Viewer::computeLayout(Element &e) {
-  penX = 0;
-  penY = 0;
-
-  // clear the display list.
-  m_displayList.erase(m_displayList.begin(), m_displayList.end());
+void viewManager::Viewer::initializeDisplayList(Element &e) {
+  displayListItem &listEntry = e.displayList;
 
-  // ensure word break and font metrics indexing are performed. 
-  // This is used to know where to wrap textual data, calculations 
-  // of widths and heights of fields.
-  for (auto &ptr : elements) {
-    Element &e = *(ptr.second.get());
-    e.wordMetrics(*m_device.get());
-    e.penX=0;
-    e.penY=0;
-    e.maxX=0;
-    e.maxY=0;
-  }
+  // the style is shared with the elements of equal style here.
+  const computedStyle &style = e.style();
 
-  /*
-   This loop establishes all items that will be involved within the
-   display of elements. As well, the loop initalizes the displayList
-   class. Breaking the process into two parts simplifies the second
-   logic in that exception handling will not be used. The loop process 
-   also resolves all calculations without dependencies than can be 
-   found such as absolute positions
-
-   A particular area of interest is exception handling that occurrs.
-   As the result, items and options are set to default, however preserving
-   the unstored state within the attribute list. The display list has the
-   defaults set within its cachce.
-  */
-  for (auto &ptr : elements) {
-    // store local reference for ease of syntax
-    Element &e = *(ptr.second.get());
-    displayListItem &listEntry = e.displayList;
+  // items that are not displayed are not included in the list
+  const display *disp = style.find<display>();
+  if (disp && disp->value == display::optionEnum::none)
+    return;
 
-    // items that are not displayed are not included in the list
-    try {
-      if (e.getAttribute<display>().value == display::optionEnum::none)
-        continue;
-    } catch (std::exception e) {
-    }
+  // initialize base structure with defualts or the information from the
+  // class object needed for display
+  listEntry.bCalculatedTop = false;
+  listEntry.bCalculatedBottom = false;
+  listEntry.bCalculatedLeft = false;
+  listEntry.bCalculatedRight = false;
+  listEntry.bCalculatedWidth = false;
+  listEntry.bCalculatedHeight = false;
+  listEntry.bAutoCalculateTop = false;
+  listEntry.bAutoCalculateBottom = false;
+  listEntry.bAutoCalculateLeft = false;
+  listEntry.bAutoCalculateRight = false;
+
+  listEntry.x1 = 0;
+  listEntry.y1 = 0;
+  listEntry.x2 = 0;
+  listEntry.y2 = 0;
+  listEntry.ow = 0;
+  listEntry.oh = 0;
+
+  listEntry.disp = disp ? disp->value : display::in_line;
+  const position *pos = style.find<position>();
+  listEntry.pos = pos ? pos->value : position::relative;
+  try {
+    listEntry.zIndex = e.getAttribute<zIndex>().value;
+  } catch (std::exception e) {
+    listEntry.zIndex = 0;
+  }
 
-    // initialize base structure with defualts or the information from the
-    // class object needed for display
-    listEntry.bCalculatedTop = false;
-    listEntry.bCalculatedBottom = false;
-    listEntry.bCalculatedLeft = false;
-    listEntry.bCalculatedRight = false;
-    listEntry.bCalculatedWidth = false;
-    listEntry.bCalculatedHeight = false;
-    listEntry.bAutoCalculateTop = false;
-    listEntry.bAutoCalculateBottom = false;
-    listEntry.bAutoCalculateLeft = false;
-    listEntry.bAutoCalculateRight = false;
+  listEntry.ptr = &e;
 
-    listEntry.x1 = 0;
-    listEntry.y1 = 0;
-    listEntry.x2 = 0;
-    listEntry.y2 = 0;
-    listEntry.ow = 0;
-    listEntry.oh = 0;
+  // the numeric value is used to hold the class while reading information
+  doubleNF numeric = doubleNF(0_px);
 
+  /* if items are absolute, they can be calculated
+   absolute position items must have the coordinates expressed
+   in numerical values, not percentages. When percentages are used,
+   they are resolved after their depencency is calculated.
+   So basically this first phase resolves all measurements 
+   that can be converted or calculated.
+   At times the developer using the library may choose to have absolute
+   positioning. Or let the system calculate the defaults for the terms.
+  */
+  if (listEntry.pos == position::absolute) {
     try {
-      listEntry.disp = e.getAttribute<display>().value;
+      numeric = e.getAttribute<objectLeft>();
+      if (numeric.option == numericFormat::percent ||
+          numeric.option == numericFormat::autoCalculate) {
+        listEntry.x1 = numeric.value;
+        listEntry.x1_nf = numeric.option;
+
+      } else {
+        listEntry.x1 = numeric.toPx();
+        listEntry.x1_nf = numeric.option;
+        listEntry.bCalculatedLeft = true;
+      }
     } catch (std::exception e) {
-      listEntry.disp = display::in_line;
+      listEntry.x1_nf = numericFormat::autoCalculate;
+      listEntry.bAutoCalculateLeft = true;
     }
+
     try {
-      listEntry.pos = e.getAttribute<position>().value;
+      numeric = e.getAttribute<objectTop>();
+      if (numeric.option == numericFormat::percent ||
+          numeric.option == numericFormat::autoCalculate) {
+        listEntry.y1 = numeric.value;
+        listEntry.y1_nf = numeric.option;
+      } else {
+        listEntry.y1 = numeric.toPx();
+        listEntry.y1_nf = numeric.option;
+        listEntry.bCalculatedTop = true;
+      }
     } catch (std::exception e) {
-      listEntry.pos = position::relative;
+      listEntry.y1_nf = numericFormat::autoCalculate;
+      listEntry.bAutoCalculateTop = true;
     }
+  }
+
+  /*
+  These series of tests performs the logic of calculation when the value
+  can be determined without other dependency. If the item is not found
+  within the structure or if its option is set to auto calculate, the auto
+  calculate option is turned on within the display list structure.
+  */
+
+  /**************************************************** x1 object left */
+  if (!listEntry.bCalculatedLeft) {
     try {
-      listEntry.zIndex = e.getAttribute<zIndex>().value;
+      numeric = e.getAttribute<objectLeft>();
+      if (numeric.option == numericFormat::autoCalculate) {
+        listEntry.bAutoCalculateLeft = true;
+        listEntry.x1_nf = numeric.option;
+
+      } else if (numeric.option == numericFormat::percent) {
+        listEntry.x1 = numeric.value;
+        listEntry.x1_nf = numeric.option;
+
+      } else {
+        listEntry.x1 = numeric.toPx();
+        listEntry.x1_nf = numericFormat::px;
+        listEntry.bCalculatedLeft = true;
+      }
+
     } catch (std::exception e) {
-      listEntry.zIndex = 0;
+      listEntry.x1_nf = numericFormat::autoCalculate;
+      listEntry.bAutoCalculateLeft = true;
     }
+  }
 
-    listEntry.ptr = ptr.second.get();
+  /**************************************************** y1 object top */
+  if (!listEntry.bCalculatedTop) {
+    try {
+      numeric = e.getAttribute<objectTop>();
 
-    // the numeric value is used to hold the class while reading information
-    doubleNF numeric = doubleNF(0_px);
+      if (numeric.option == numericFormat::autoCalculate) {
+        listEntry.bAutoCalculateTop = true;
+        listEntry.y1_nf = numeric.option;
 
-    /* if items are absolute, they can be calculated
-     absolute position items must have the coordinates expressed
-     in numerical values, not percentages. When percentages are used,
-     they are resolved after their depencency is calculated.
-     So basically this first phase resolves all measurements 
-     that can be converted or calculated.
-     At times the developer using the library may choose to have absolute
-     positioning. Or let the system calculate the defaults for the terms.
-    */
-    if (listEntry.pos == position::absolute) {
-      try {
-        numeric = e.getAttribute<objectLeft>();
-        if (numeric.option == numericFormat::percent ||
-            numeric.option == numericFormat::autoCalculate) {
-          listEntry.x1 = numeric.value;
-          listEntry.x1_nf = numeric.option;
+      } else if (numeric.option == numericFormat::percent) {
+        listEntry.y1 = numeric.value;
+        listEntry.y1_nf = numeric.option;
 
-        } else {
-          listEntry.x1 = numeric.toPx();
-          listEntry.x1_nf = numeric.option;
-          listEntry.bCalculatedLeft = true;
-        }
-      } catch (std::exception e) {
-        listEntry.x1_nf = numericFormat::autoCalculate;
-        listEntry.bAutoCalculateLeft = true;
+      } else {
+        listEntry.y1 = numeric.toPx();
+        listEntry.y1_nf = numericFormat::px;
+        listEntry.bCalculatedTop = true;
       }
 
-      try {
-        numeric = e.getAttribute<objectTop>();
-        if (numeric.option == numericFormat::percent ||
-            numeric.option == numericFormat::autoCalculate) {
-          listEntry.y1 = numeric.value;
-          listEntry.y1_nf = numeric.option;
-        } else {
-          listEntry.y1 = numeric.toPx();
-          listEntry.y1_nf = numeric.option;
-          listEntry.bCalculatedTop = true;
-        }
-      } catch (std::exception e) {
-        listEntry.y1_nf = numericFormat::autoCalculate;
-        listEntry.bAutoCalculateTop = true;
-      }
+    } catch (std::exception e) {
+      listEntry.y1_nf = numericFormat::autoCalculate;
+      listEntry.bAutoCalculateTop = true;
     }
+  }
 
-    /*
-    These series of tests performs the logic of calculation when the value
-    can be determined without other dependency. If the item is not found
-    within the structure or if its option is set to auto calculate, the auto
-    calculate option is turned on within the display list structure.
-    */
+  /**************************************************** object width */
+  try {
+    numeric = e.getAttribute<objectWidth>();
+    if (numeric.option == numericFormat::autoCalculate) {
+      listEntry.bAutoCalculateRight = true;
+      listEntry.ow_nf = numeric.option;
 
-    /**************************************************** x1 object left */
-    if (!listEntry.bCalculatedLeft) {
-      try {
-        numeric = e.getAttribute<objectLeft>();
-        if (numeric.option == numericFormat::autoCalculate) {
-          listEntry.bAutoCalculateLeft = true;
-          listEntry.x1_nf = numeric.option;
+    } else if (numeric.option == numericFormat::percent) {
+      listEntry.ow = numeric.value;
+      listEntry.ow_nf = numeric.option;
 
-        } else if (numeric.option == numericFormat::percent) {
-          listEntry.x1 = numeric.value;
-          listEntry.x1_nf = numeric.option;
+    } else {
+      listEntry.ow = numeric.toPx();
+      listEntry.ow_nf = numericFormat::px;
+      // if the width is less than zero, it will
+      // not be visible, so do not include it
+      if (listEntry.ow <= 0.0)
+        return;
+      listEntry.bCalculatedWidth = true;
+    }
+  } catch (std::exception e) {
+    listEntry.ow_nf = numericFormat::autoCalculate;
+    listEntry.bAutoCalculateRight = true;
+  }
 
-        } else {
-          listEntry.x1 = numeric.toPx();
-          listEntry.x1_nf = numericFormat::px;
-          listEntry.bCalculatedLeft = true;
-        }
+  /**************************************************** object height */
+  try {
+    numeric = e.getAttribute<objectHeight>();
+    if (numeric.option == numericFormat::autoCalculate) {
+      listEntry.bAutoCalculateBottom = true;
+      listEntry.oh_nf = numeric.option;
 
-      } catch (std::exception e) {
-        listEntry.x1_nf = numericFormat::autoCalculate;
-        listEntry.bAutoCalculateLeft = true;
-      }
+    } else if (numeric.option == numericFormat::percent) {
+      listEntry.oh = numeric.value;
+      listEntry.oh_nf = numeric.option;
+
+    } else {
+      listEntry.oh = numeric.toPx();
+      listEntry.oh_nf = numericFormat::px;
+      // if the height is less than zero,
+      // it will not be visible, so do not include it
+      if (listEntry.oh <= 0.0)
+        return;
+      listEntry.bCalculatedHeight = true;
     }
+  } catch (std::exception e) {
+    listEntry.oh_nf = numericFormat::autoCalculate;
+    listEntry.bAutoCalculateBottom = true;
+  }
 
-    /**************************************************** y1 object top */
-    if (!listEntry.bCalculatedTop) {
-      try {
-        numeric = e.getAttribute<objectTop>();
+  // if the preceeding operations were resolved to find the widths or
+  // heights and the top or left coordinates are also known, the bottom
+  // may be found as well.
+  /**************************************************** object bottom */
+  if (listEntry.bCalculatedLeft && listEntry.bCalculatedWidth) {
+    listEntry.x2 = listEntry.x1 + listEntry.ow;
+    listEntry.bCalculatedRight = true;
+    listEntry.bAutoCalculateRight = false;
+  }
 
-        if (numeric.option == numericFormat::autoCalculate) {
-          listEntry.bAutoCalculateTop = true;
-          listEntry.y1_nf = numeric.option;
+  /**************************************************** object top */
+  if (listEntry.bCalculatedTop && listEntry.bCalculatedHeight) {
+    listEntry.y2 = listEntry.y1 + listEntry.oh;
+    listEntry.bCalculatedBottom = true;
+    listEntry.bAutoCalculateBottom = false;
+  }
 
-        } else if (numeric.option == numericFormat::percent) {
-          listEntry.y1 = numeric.value;
-          listEntry.y1_nf = numeric.option;
+  // add the item to the list and set the index.
+  // this stores the direct link to the calculation record
+  // within the vector.
+  m_displayList.push_back(&e.displayList);
+}
 
-        } else {
-          listEntry.y1 = numeric.toPx();
-          listEntry.y1_nf = numericFormat::px;
-          listEntry.bCalculatedTop = true;
-        }
+/**
+\brief The routine processes the list of elements such that the layout
+and units are all expressed within the model as pixel units. After this
+function is ran, each element will have a rectangle attached that expresses
+it's pixel size on the viewing device. The function runs the layout to
+completion, the paint event uses the time sliced form.
+*/
+void viewManager::Viewer::computeLayout(Element &e) {
+  beginLayout();
+  while (!continueLayout(std::chrono::steady_clock::time_point::max()))
+    ;
+  m_layout.changes = layoutGeneration;
+}
 
-      } catch (std::exception e) {
-        listEntry.y1_nf = numericFormat::autoCalculate;
-        listEntry.bAutoCalculateTop = true;
-      }
-    }
+/**
+\internal
+\brief starts a new layout, discarding one that is in progress. Elements
+are captured by their key within the elements map so that elements removed
+between slices are skipped.
+*/
+void viewManager::Viewer::beginLayout(void) {
+  penX = 0;
+  penY = 0;
 
-    /**************************************************** object width */
-    try {
-      numeric = e.getAttribute<objectWidth>();
-      if (numeric.option == numericFormat::autoCalculate) {
-        listEntry.bAutoCalculateRight = true;
-        listEntry.ow_nf = numeric.option;
+  // clear the display list.
+  m_displayList.erase(m_displayList.begin(), m_displayList.end());
+  m_deferredMetrics.clear();
+  m_nextDeferred = 0;
+
+  m_layout.keys.clear();
+  m_layout.keys.reserve(elements.size());
+  for (auto &ptr : elements)
+    m_layout.keys.push_back(ptr.first);
+  m_layout.next = 0;
+  m_layout.stack.clear();
+  m_layout.generation = treeGeneration;
+  m_layout.changes = layoutGeneration;
+  m_layout.bRedo = false;
+  m_layout.phase = layoutPhase::initialize;
+}
 
-      } else if (numeric.option == numericFormat::percent) {
-        listEntry.ow = numeric.value;
-        listEntry.ow_nf = numeric.option;
+/**
+\internal
+\brief continues the layout started by beginLayout until it completes or
+the deadline passes. The state between calls is kept within m_layout.
+\return true when the layout is complete.
+*/
+bool viewManager::Viewer::continueLayout(
+    std::chrono::steady_clock::time_point deadline) {
+  // elements were linked or removed between slices. The captured keys and
+  // the display list may name removed elements, so the layout restarts.
+  if (m_layout.phase != layoutPhase::complete &&
+      m_layout.generation != treeGeneration)
+    beginLayout();
+
+  if (m_layout.phase == layoutPhase::initialize) {
+    /*
+     This loop establishes all items that will be involved within the
+     display of elements. As well, the loop initalizes the displayList
+     class. Breaking the process into two parts simplifies the second
+     logic in that exception handling will not be used. The loop process 
+     also resolves all calculations without dependencies than can be 
+     found such as absolute positions
+
+     A particular area of interest is exception handling that occurrs.
+     As the result, items and options are set to default, however preserving
+     the unstored state within the attribute list. The display list has the
+     defaults set within its cachce.
+    */
+    while (m_layout.next < m_layout.keys.size()) {
+      if (std::chrono::steady_clock::now() >= deadline)
+        return false;
 
-      } else {
-        listEntry.ow = numeric.toPx();
-        listEntry.ow_nf = numericFormat::px;
-        // if the width is less than zero, it will
-        // not be visible, so do not include it
-        if (listEntry.ow <= 0.0)
-          continue;
-        listEntry.bCalculatedWidth = true;
-      }
-    } catch (std::exception e) {
-      listEntry.ow_nf = numericFormat::autoCalculate;
-      listEntry.bAutoCalculateRight = true;
+      auto it = elements.find(m_layout.keys[m_layout.next++]);
+      if (it == elements.end())
+        continue;
+
+      Element &e = *(it->second.get());
+#if !defined(USE_PROGRESSIVE_LAYOUT)
+      // ensure word break and font metrics indexing are performed.
+      // This is used to know where to wrap textual data, calculations
+      // of widths and heights of fields. With progressive layout, this
+      // is done during the tree walk so content below the viewport
+      // can be deferred.
+      e.wordMetrics(*m_device.get());
+#endif
+      e.penX = 0;
+      e.penY = 0;
+      e.maxX = 0;
+      e.maxY = 0;
+      initializeDisplayList(e);
     }
 
-    /**************************************************** object height */
-    try {
-      numeric = e.getAttribute<objectHeight>();
-      if (numeric.option == numericFormat::autoCalculate) {
-        listEntry.bAutoCalculateBottom = true;
-        listEntry.oh_nf = numeric.option;
+    /*
+    The second phase walks the document object model to resolve uncalculated
+    items that are relative, or percentage based that require the parent
+    to be calculated first. With respect to the priming rectangle, the
+    document viewer object or _root is established by the _w and _h
+    properties. These values are directly linked to the window size.
+    These values are placed into the object here since they can be
+    calculated directly.
+    */
+    Viewer &eRoot = getElement<Viewer>("_root");
+    eRoot.displayList.bAutoCalculateTop = false;
+    eRoot.displayList.bAutoCalculateLeft = false;
+    eRoot.displayList.bAutoCalculateBottom = false;
+    eRoot.displayList.bAutoCalculateRight = false;
+
+    eRoot.displayList.bCalculatedLeft = true;
+    eRoot.displayList.x1 = 0;
+    eRoot.displayList.bCalculatedTop = true;
+    eRoot.displayList.y1 = 0;
+    eRoot.displayList.bCalculatedRight = true;
+    eRoot.displayList.x2 = eRoot.getAttribute<objectWidth>().toPx();
+    eRoot.displayList.ow = eRoot.getAttribute<objectWidth>().toPx();
+    eRoot.displayList.bCalculatedBottom = true;
+    eRoot.displayList.y2 = eRoot.getAttribute<objectHeight>().toPx();
+    eRoot.displayList.oh = eRoot.getAttribute<objectHeight>().toPx();
+
+    m_layout.stack.push_back((std::size_t)&eRoot);
+    m_layout.phase = layoutPhase::walk;
+  }
 
-      } else if (numeric.option == numericFormat::percent) {
-        listEntry.oh = numeric.value;
-        listEntry.oh_nf = numeric.option;
+  if (m_layout.phase == layoutPhase::walk) {
+    // the document is walked in tree order. An explicit stack is used
+    // rather than recursion so that the walk may be suspended.
+    while (!m_layout.stack.empty()) {
+      if (std::chrono::steady_clock::now() >= deadline)
+        return false;
 
-      } else {
-        listEntry.oh = numeric.toPx();
-        listEntry.oh_nf = numericFormat::px;
-        // if the height is less than zero,
-        // it will not be visible, so do not include it
-        if (listEntry.oh <= 0.0)
-          continue;
-        listEntry.bCalculatedHeight = true;
-      }
-    } catch (std::exception e) {
-      listEntry.oh_nf = numericFormat::autoCalculate;
-      listEntry.bAutoCalculateBottom = true;
-    }
+      auto it = elements.find(m_layout.stack.back());
+      m_layout.stack.pop_back();
+      if (it == elements.end())
+        continue;
 
-    // if the preceeding operations were resolved to find the widths or
-    // heights and the top or left coordinates are also known, the bottom
-    // may be found as well.
-    /**************************************************** object bottom */
-    if (listEntry.bCalculatedLeft && listEntry.bCalculatedWidth) {
-      listEntry.x2 = listEntry.x1 + listEntry.ow;
-      listEntry.bCalculatedRight = true;
-      listEntry.bAutoCalculateRight = false;
+      placeElement(*(it->second.get()), m_layout.stack);
     }
 
-    /**************************************************** object top */
-    if (listEntry.bCalculatedTop && listEntry.bCalculatedHeight) {
-      listEntry.y2 = listEntry.y1 + listEntry.oh;
-      listEntry.bCalculatedBottom = true;
-      listEntry.bAutoCalculateBottom = false;
+    // sort the displayList by left, top, and zOrder
+    sort(m_displayList.begin(), m_displayList.end(),
+         [](displayListItem *a, displayListItem *b) {
+           return a->x1 < b->x1 && a->y1 < b->y1 && a->zIndex < b->zIndex;
+         });
+    m_layout.phase = layoutPhase::complete;
+  }
+
+  return true;
+}
+
+/**
+\internal
+\brief places one element of the tree walk and pushes its children upon
+the stack, the first child last so that it is visited next.
+*/
+void viewManager::Viewer::placeElement(Element &e,
+                                       std::vector<std::size_t> &stack) {
+  // an element advances the pen of its parent, the root its own.
+  auto eParent = e.parent();
+  Element &ePen = eParent ? eParent->get() : e;
+
+#if defined(USE_LAZY_MARKUP)
+  // deferred markup reached within a screen below the viewport is
+  // created. The new elements are visited in place of the placeholder.
+  auto pDeferred = dynamic_cast<deferredMarkup *>(&e);
+  if (pDeferred && pDeferred->completed() && !pDeferred->materialized() &&
+      ePen.penY <= displayList.y2 + displayList.oh) {
+    // the placeholder is destroyed, its entry is dropped beforehand.
+    m_displayList.erase(std::remove(m_displayList.begin(),
+                                    m_displayList.end(), &e.displayList),
+                        m_displayList.end());
+    ElementList created = pDeferred->materialize();
+    // the layout accounts for the elements it creates.
+    m_layout.generation = treeGeneration;
+    for (auto &n : created) {
+      Element &eNew = n.get();
+#if !defined(USE_PROGRESSIVE_LAYOUT)
+      eNew.wordMetrics(*m_device.get());
+#endif
+      eNew.penX = 0;
+      eNew.penY = 0;
+      eNew.maxX = 0;
+      eNew.maxY = 0;
+      initializeDisplayList(eNew);
     }
 
-  // add the item to the list and set the index.
-  // this stores the direct link to the calculation record
-  // within the vector.
-  listInsertion:
-    m_displayList.push_back(&e.displayList);
+    for (auto n = created.rbegin(); n != created.rend(); n++) {
+      if (n->get().m_parent == &ePen)
+        stack.push_back((std::size_t)&n->get());
+    }
+    return;
   }
+#endif
 
-  /*
-  The second phase walks the document object model to resolve uncalculated
-  items that are relative, or percentage based that require the parent
-  to be calculated first. With respect to the priming rectangle, the
-  document viewer object or _root is established by the _w and _h
-  properties. These values are directly linked to the window size.
-  These values are placed into the object here since they can be
-  calculated directly.
-  */
-  Viewer &eRoot = getElement<Viewer>("_root");
-  eRoot.displayList.bAutoCalculateTop = false;
-  eRoot.displayList.bAutoCalculateLeft = false;
-  eRoot.displayList.bAutoCalculateBottom = false;
-  eRoot.displayList.bAutoCalculateRight = false;
-
-  eRoot.displayList.bCalculatedLeft = true;
-  eRoot.displayList.x1 = 0;
-  eRoot.displayList.bCalculatedTop = true;
-  eRoot.displayList.y1 = 0;
-  eRoot.displayList.bCalculatedRight = true;
-  eRoot.displayList.x2 = eRoot.getAttribute<objectWidth>().toPx();
-  eRoot.displayList.ow = eRoot.getAttribute<objectWidth>().toPx();
-  eRoot.displayList.bCalculatedBottom = true;
-  eRoot.displayList.y2 = eRoot.getAttribute<objectHeight>().toPx();
-  eRoot.displayList.oh = eRoot.getAttribute<objectHeight>().toPx();
-
-  // recursively walk the document and calculate layout.
-  treeOrderComputeLayout(eRoot.penX, eRoot.penY, eRoot);
-
-  // sort the displayList by left, top, and zOrder
-  sort(m_displayList.begin(), m_displayList.end(),
-       [](displayListItem *a, displayListItem *b) {
-         return a->x1 < b->x1 && a->y1 < b->y1 && a->zIndex < b->zIndex;
-       });
+  treeOrderComputeLayout(ePen.penX, ePen.penY, e);
+
+  // children are pushed in reverse so the first is visited next.
+  for (Element *p = e.m_lastChild; p; p = p->m_previousSibling)
+    stack.push_back((std::size_t)p);
 }
 
 /**
 \internal
-\brief main entry point for the rendering subsystem. The head of
-the recursive process.
+\brief places the element and its descendants again from the pen their
+parent had when the element was last placed. The entries of the subtree
+are replaced within the display list. When the element keeps its
+rectangle, the elements after it are unaffected and the pen of the parent
+is restored.
+\return false when the rectangle changed, in which case the document must
+be laid out again.
 */
-void viewManager::Viewer::render(void) {
-  computeLayout(*this);
+bool viewManager::Viewer::placeSubtree(Element &e) {
+  auto eParentRef = e.parent();
+  if (!eParentRef)
+    return false;
+
+  Element &eParent = eParentRef->get();
+  const displayListItem before = e.displayList;
+
+  // the entries of the subtree are collected in tree order.
+  std::vector<Element *> subtree;
+  std::vector<Element *> stack{&e};
+  while (!stack.empty()) {
+    Element *p = stack.back();
+    stack.pop_back();
+    subtree.push_back(p);
+    for (Element *pChild = p->m_lastChild; pChild;
+         pChild = pChild->m_previousSibling)
+      stack.push_back(pChild);
+  }
 
-  /* the display list is a sorted entity providing a searchable list
-  for the beginning and ending of a viewport clipping region. */
-  for (auto n : m_displayList) {
-    n->ptr->render(*m_device.get());
+  std::unordered_set<const displayListItem *> entries;
+  for (auto p : subtree)
+    entries.insert(&p->displayList);
+  m_displayList.erase(std::remove_if(m_displayList.begin(),
+                                     m_displayList.end(),
+                                     [&entries](displayListItem *item) {
+                                       return entries.count(item) > 0;
+                                     }),
+                      m_displayList.end());
+
+  for (auto p : subtree) {
+#if !defined(USE_PROGRESSIVE_LAYOUT)
+    p->wordMetrics(*m_device.get());
+#endif
+    p->penX = 0;
+    p->penY = 0;
+    p->maxX = 0;
+    p->maxY = 0;
+    initializeDisplayList(*p);
+  }
+
+  const double dPenX = eParent.penX;
+  const double dPenY = eParent.penY;
+  const double dMaxY = eParent.maxY;
+  eParent.penX = before.entryPenX;
+  eParent.penY = before.entryPenY;
+  eParent.maxY = before.entryParentMaxY;
+
+  std::vector<std::size_t> walk{(std::size_t)&e};
+  while (!walk.empty()) {
+    auto it = elements.find(walk.back());
+    walk.pop_back();
+    if (it != elements.end())
+      placeElement(*(it->second.get()), walk);
   }
+
+  const displayListItem &after = e.displayList;
+  if (after.x1 != before.x1 || after.y1 != before.y1 ||
+      after.x2 != before.x2 || after.y2 != before.y2)
+    return false;
+
+  eParent.penX = dPenX;
+  eParent.penY = dPenY;
+  eParent.maxY = dMaxY;
+  return true;
 }
 
 /**
 \internal
-\brief
-This is the only entry point from the platform for the event
-dispatching system. The routine expects only certain types
-of messages from the platform. The other events, that are computed,
+\brief places the elements of the keys again and repaints, for changes
+that concern only those elements such as a face that finished loading. The
+document is laid out again when one of them changes size or position, or
+when the layout shown is from before the tree changed. A layout in progress
+is completed first and then repeated.
+*/
+void viewManager::Viewer::relayout(std::vector<std::size_t> keys) {
+  // a layout in progress places them again once it completes.
+  if (m_layout.phase != layoutPhase::complete) {
+    m_layout.bRedo = true;
+    return;
+  }
+
+  bool bPlaced = m_layout.generation == treeGeneration;
+
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  for (std::size_t i = 0; bPlaced && i < keys.size(); i++) {
+    auto it = elements.find(keys[i]);
+    if (it != elements.end())
+      bPlaced = placeSubtree(*(it->second.get()));
+  }
+
+  if (!bPlaced) {
+    m_bRefinePaint = false;
+    beginLayout();
+    layoutSlice();
+    return;
+  }
+
+  sort(m_displayList.begin(), m_displayList.end(),
+       [](displayListItem *a, displayListItem *b) {
+         return a->x1 < b->x1 && a->y1 < b->y1 && a->zIndex < b->zIndex;
+       });
+  // the changes were those of the elements placed.
+  m_layout.changes = layoutGeneration;
+  repaint();
+}
+
+/**
+\internal
+\brief draws the last complete layout again, for changes that do not move
+elements such as a color. A layout in progress paints when it completes,
+and a display list made before the tree changed is laid out again.
+*/
+void viewManager::Viewer::repaint(void) {
+  if (m_layout.phase != layoutPhase::complete)
+    return;
+
+  if (m_layout.generation != treeGeneration) {
+    beginLayout();
+    layoutSlice();
+    return;
+  }
+
+  m_device->clear();
+  renderDisplayList();
+  m_device->flip();
+}
+
+/**
+\internal
+\brief brings the layout up to date with the document. A layout in progress
+continues with its next slice, noting whether the document changed in the
+meantime so it is repeated once complete. Changes to the tree restart it
+within continueLayout. A complete layout is laid out again when the tree or
+a layout attribute changed since it began, and otherwise only repainted.
+*/
+void viewManager::Viewer::updateLayout(void) {
+  bool bChanged = m_layout.changes != layoutGeneration;
+
+  if (m_layout.phase != layoutPhase::complete) {
+    m_layout.bRedo = m_layout.bRedo || bChanged;
+    layoutSlice();
+  } else if (bChanged || m_layout.generation != treeGeneration) {
+    m_bRefinePaint = false;
+    beginLayout();
+    layoutSlice();
+  } else {
+    repaint();
+  }
+}
+
+/**
+\internal
+\brief applies the work gathered since the last frame, for the paint and
+wake events. Trims and posted functions may change anything and so are
+followed by updateLayout. Bindings, output and loaded faces concern their
+own elements, which are placed again when the layout shown is current.
+Bindings that change paint alone, and a paint with nothing changed, only
+repaint.
+*/
+void viewManager::Viewer::applyPendingWork(const bool bPaint) {
+  // trims asked for by other threads are applied here.
+  int requested = m_requestedTrim.exchange(-1);
+  if (requested >= 0)
+    trim(static_cast<trimLevel>(requested));
+
+  // results posted from the executor change the document first.
+  runUiTasks();
+
+  bool bCurrent = m_layout.phase == layoutPhase::complete &&
+                  m_layout.generation == treeGeneration &&
+                  m_layout.changes == layoutGeneration;
+
+  // bound values changed since the last frame are applied once each.
+  bindingQueue::flushResult bound = pendingBindings->flush();
+  std::vector<std::size_t> keys = flushPendingOutput();
+  std::vector<std::size_t> faces = takeFaceWaiters();
+  keys.insert(keys.end(), bound.keys.begin(), bound.keys.end());
+  keys.insert(keys.end(), faces.begin(), faces.end());
+
+  if (!bCurrent)
+    updateLayout();
+  else if (!keys.empty())
+    relayout(std::move(keys));
+  else if (bound.bApplied || bPaint)
+    repaint();
+}
+
+/**
+\internal
+\brief runs one slice of the layout bounded by LAYOUT_TIME_SLICE. The
+screen keeps the last complete frame until the layout completes, at which
+point the document is rendered and shown. Otherwise an idle event is
+requested so pending input is handled before the next slice.
+*/
+void viewManager::Viewer::layoutSlice(void) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(LAYOUT_TIME_SLICE);
+
+  bool bComplete = continueLayout(deadline);
+  // the changes made by the layout itself are accounted for. Those made
+  // between slices were noted within bRedo by updateLayout.
+  m_layout.changes = layoutGeneration;
+  if (!bComplete) {
+    m_device->requestIdle();
+    return;
+  }
+
+  m_device->clear();
+  renderDisplayList();
+  m_device->flip();
+  enforceMemoryBudget();
+
+  // the document changed while the layout was in progress. The frame is
+  // shown and the document laid out again in the following slices.
+  if (m_layout.bRedo) {
+    m_bRefinePaint = false;
+    beginLayout();
+    m_device->requestIdle();
+    return;
+  }
+
+  // the paint that completes refinement does not start another.
+  if (layoutEstimated() && !m_bRefinePaint)
+    m_device->requestIdle();
+  m_bRefinePaint = false;
+}
+
+/**
+\internal
+\brief main entry point for the rendering subsystem. The head of
+the recursive process.
+*/
+void viewManager::Viewer::render(void) {
+  computeLayout(*this);
+  renderDisplayList();
+}
+
+/**
+\internal
+\brief renders the elements of the last complete layout.
+*/
+void viewManager::Viewer::renderDisplayList(void) {
+  /* the display list is a sorted entity providing a searchable list
+  for the beginning and ending of a viewport clipping region. */
+  for (auto n : m_displayList) {
+    n->ptr->render(*m_device.get());
+  }
+}
+
+/**
+\internal
+\brief measures the elements whose size was estimated by the last
+layout. The work is bounded by PROGRESSIVE_LAYOUT_SLICE so that input is
+not delayed. Each measured element refines the document extent held in
+maxY. When all are measured, the document is painted with the exact layout.
+*/
+void viewManager::Viewer::processDeferredMetrics(void) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(PROGRESSIVE_LAYOUT_SLICE);
+
+  // the estimates are of a tree that has since changed.
+  if (m_layout.generation != treeGeneration) {
+    beginLayout();
+    layoutSlice();
+    return;
+  }
+
+  while (layoutEstimated() && std::chrono::steady_clock::now() < deadline) {
+    deferredMetricsItem &item = m_deferredMetrics[m_nextDeferred];
+    m_nextDeferred++;
+
+    auto it = elements.find(item.key);
+    if (it == elements.end())
+      continue;
+
+    Element &e = *(it->second.get());
+    e.wordMetrics(*m_device.get());
+    if (item.dEstimatedHeight >= 0)
+      maxY += e.computeWrappedTextDataHeight(*m_device.get(), item.dWidth) -
+              item.dEstimatedHeight;
+  }
+
+  if (layoutEstimated()) {
+    m_device->requestIdle();
+  } else {
+    beginLayout();
+    m_bRefinePaint = true;
+    layoutSlice();
+  }
+}
+
+/**
+\internal
+\brief
+This is the only entry point from the platform for the event
+dispatching system. The routine expects only certain types
+of messages from the platform. The other events, that are computed,
 are developed by this routine as needed. Each of these events, whether
 passed through as the same message, or developed is placed into the
 viewManager message queue. The background event dispatching fetches
@@ -1427,11 +1992,20 @@ processed from a queue and using a background thread.
 void viewManager::Viewer::dispatchEvent(const event &evt) {
   switch (evt.evtType) {
   case eventType::paint:
-    m_device->clear();
-    render();
-    m_device->flip();
+    applyPendingWork(true);
+    break;
+  case eventType::wake:
+    // work finished by other threads, such as loaded faces.
+    applyPendingWork(false);
+    break;
+  case eventType::idle:
+    if (m_layout.phase != layoutPhase::complete)
+      updateLayout();
+    else
+      processDeferredMetrics();
     break;
   case eventType::resize:
+    // the size is a layout attribute, laid out by the paint that follows.
     setAttribute<objectWidth>(
         {static_cast<double>(evt.width), numericFormat::px});
     setAttribute<objectHeight>(
@@ -1462,6 +2036,9 @@ void viewManager::Viewer::dispatchEvent(const event &evt) {
       m_device->fontScale++;
     else
       m_device->fontScale--;
+    // every measurement depends upon the font scale.
+    for (auto &ptr : elements)
+      ptr.second->invalidateMetrics();
     dispatchEvent(event{eventType::paint});
     break;
   case eventType::wheel:
@@ -1469,6 +2046,8 @@ void viewManager::Viewer::dispatchEvent(const event &evt) {
       m_device->fontScale += 1;
     else
       m_device->fontScale -= 1;
+    for (auto &ptr : elements)
+      ptr.second->invalidateMetrics();
     dispatchEvent(event{eventType::paint});
     break;
   }
@@ -1497,2667 +2076,8002 @@ buffer. while on windows the direct x library is used in combination
 with windows message queue processing.
 */
 void viewManager::Viewer::processEvents(void) {
-  // setup the event dispatcher
-  eventHandler ev =
-      std::bind(&Viewer::dispatchEvent, this, std::placeholders::_1);
-  m_device = std::make_unique<Visualizer::platform>(
-      ev, getAttribute<objectWidth>().value,
-      getAttribute<objectHeight>().value);
+  if (!m_device)
+    startPlatform();
 
-  m_device->openWindow(getAttribute<windowTitle>().value);
+  // errors of the start up tasks are raised here.
+  if (m_textStartup.valid())
+    m_textStartup.get();
+  if (m_displayStartup.valid())
+    m_displayStartup.get();
+
+  m_device->windowSize(getAttribute<objectWidth>().value,
+                       getAttribute<objectHeight>().value);
+
+  bool bFramebuffer = false;
+  try {
+    bFramebuffer =
+        getAttribute<viewerMode>().value == viewerMode::framebuffer;
+  } catch (const std::exception &e) {
+  }
+
+  if (bFramebuffer) {
+    std::string sDevice;
+    try {
+      sDevice = getAttribute<framebufferDevice>().value;
+    } catch (const std::exception &e) {
+    }
+    m_device->openFramebuffer(sDevice);
+  } else {
+    m_device->openWindow(getAttribute<windowTitle>().value);
+  }
+
+  // changes to bound values wake the message loop for a frame.
+  pendingBindings->setFrameRequest([this]() { m_device->wake(); });
 
   m_device->messageLoop();
+
+  pendingBindings->setFrameRequest({});
 }
 
 /**
-\addtogroup udl User Defined Literals
+\brief renders the document into memory without a window. The image is
+objectWidth by objectHeight pixels, four bytes each, blue, green, red and
+an unused byte, whatever the pixelFormat of the viewer. The
+layout is completed, including the text measured after an estimate, before
+the pixels are produced. The viewer is normally created with
+viewerMode::headless so that no display connection is made.
+*/
+const std::vector<u_int8_t> &viewManager::Viewer::renderImage(void) {
+  if (!m_device)
+    startPlatform();
 
-User defined liters are created for the project to consolidate parameter
-input.
+  if (m_textStartup.valid())
+    m_textStartup.get();
+  if (m_displayStartup.valid())
+    m_displayStartup.get();
 
-When more information would be required in a C++ constructor creation, the
-syntax provides the returning of the numerical format object in an easy to
-read syntax,
+  runUiTasks();
+  pendingBindings->flush();
+  flushPendingOutput();
 
-For example:
-    getElement("testDiv").setAttribute<objectTop>(10_px);
+  m_device->windowSize(getAttribute<objectWidth>().value,
+                       getAttribute<objectHeight>().value);
+  m_device->openOffscreen();
 
-rather than
-    getElement("testDiv").setAttribute<objectTop>(10, numericFormat::px);
+  computeLayout(*this);
+  if (layoutEstimated()) {
+    while (layoutEstimated())
+      processDeferredMetrics();
+    computeLayout(*this);
+  }
 
-@{
-*/
+  m_device->clear();
+  renderDisplayList();
+
+  return m_device->pixels32();
+}
 
 /**
-\brief enables labeling numeric literals as _pt. The operator returns a
-doubleNF object.
+\brief renders the document and writes the image to a file. The binary
+portable pixmap format is written as it needs no image library.
+\param const std::string &sFilename the name of the file to create.
 */
-auto viewManager::operator""_pt(unsigned long long int value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::pt};
+void viewManager::Viewer::saveImage(const std::string &sFilename) {
+  const std::vector<u_int8_t> &pixels = renderImage();
+  Visualizer::writePixmap(sFilename, pixels.data(), m_device->width(),
+                          m_device->height());
 }
 
 /**
-\brief enables labeling numeric literals as _pt. The operator returns a
-doubleNF object.
+\brief sends the frames shown by the viewer to clients connected upon a
+local socket. Only the tiles of the screen that change are sent. The
+address is "unix:path", "tcp:port" upon the loopback interface or
+"tcp:host:port".
+\param const std::string &sAddress the socket to listen upon.
 */
-auto viewManager::operator""_pt(long double value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::pt};
+void viewManager::Viewer::serveFrames(const std::string &sAddress) {
+  if (!m_device)
+    startPlatform();
+  m_device->serveFrames(sAddress);
 }
 
 /**
-\brief enables labeling numeric literals as _em. The operator returns a
-doubleNF object.
+\brief publishes the frames shown by the viewer into POSIX shared memory
+for recorders and compositors of other processes, which read them with
+Visualizer::frameExportReader.
+\param const std::string &sName the shared memory object name.
 */
-auto viewManager::operator""_em(unsigned long long int value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::em};
+void viewManager::Viewer::exportFrames(const std::string &sName) {
+  if (!m_device)
+    startPlatform();
+  m_device->exportFrames(sName);
 }
 
 /**
- \brief enables labeling numeric literals as _em. The operator returns a
- doubleNF object.
+\brief sets the number of bytes the caches may hold. After each frame, the
+images and then the surfaces are trimmed until the caches fit. The word
+metrics are needed by every layout, so the budget does not discard them,
+trim(trimLevel::metrics) does. The glyph cache is bounded by
+GLYPH_CACHE_BYTES rather than the budget. Zero removes the limit.
+\param std::size_t bytes the budget.
+\param std::function<void(const memoryUsage&)> fnExceeded is called with
+the cache usage when the glyphs and metrics alone exceed the budget. Until
+the caches fit again, it is not called again and nothing is trimmed.
 */
-auto viewManager::operator""_em(long double value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::em};
+void viewManager::Viewer::setMemoryBudget(
+    const std::size_t bytes,
+    const std::function<void(const memoryUsage &)> &fnExceeded) {
+  m_memoryBudget = bytes;
+  m_fnBudgetExceeded = fnExceeded;
+  m_bOverBudget = false;
+  enforceMemoryBudget();
 }
 
 /**
-\brief enables labeling numeric literals as _px. The operator returns a
-doubleNF object.
+\brief returns the bytes held by each cache. The images and metrics are
+those of the documents of the calling thread.
 */
-auto viewManager::operator""_px(unsigned long long int value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::px};
+viewManager::memoryUsage viewManager::Viewer::cacheUsage(void) const {
+  memoryUsage use{cacheBytes.images, 0, 0, cacheBytes.metrics};
+  if (m_device) {
+    use.surfaces = m_device->surfaceBytes();
+    use.glyphs = m_device->glyphBytes();
+  }
+  return use;
 }
 
 /**
-\brief enables labeling numeric literals as _px. The operator returns a
-doubleNF object.
+\brief discards the caches up to and including the level and returns the
+bytes freed from each. Discarding the metrics lays the document out again.
+It is called upon the thread of the document, other threads use
+requestTrim.
 */
-auto viewManager::operator""_px(long double value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::px};
+viewManager::memoryUsage viewManager::Viewer::trim(const trimLevel level) {
+  memoryUsage freed{0, 0, 0, 0};
+
+  for (auto &n : elements) {
+    IMAGE *image = dynamic_cast<IMAGE *>(n.second.get());
+    if (image)
+      freed.images += image->bitmap.trim();
+  }
+
+  if (level >= trimLevel::surfaces && m_device)
+    freed.surfaces = m_device->trimSurfaces();
+
+  if (level >= trimLevel::glyphs && m_device) {
+    // the font start up task uses the cache manager.
+    if (m_textStartup.valid())
+      m_textStartup.wait();
+    freed.glyphs = m_device->trimGlyphs();
+  }
+
+  if (level >= trimLevel::metrics) {
+    for (auto &n : elements)
+      freed.metrics += n.second->releaseMetrics();
+    if (freed.metrics && m_device)
+      m_device->wake();
+  }
+
+  return freed;
 }
 
 /**
-\brief enables labeling numeric literals as _percent. The operator returns a
-doubleNF object.
+\brief asks for a trim from any thread, such as a memory pressure
+handler. The deepest level requested is applied before the next frame.
 */
-auto viewManager::operator""_percent(unsigned long long int value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::percent};
+void viewManager::Viewer::requestTrim(const trimLevel level) {
+  int requested = m_requestedTrim.load();
+  while (requested < static_cast<int>(level) &&
+         !m_requestedTrim.compare_exchange_weak(requested,
+                                                static_cast<int>(level))) {
+  }
+  if (m_device)
+    m_device->wake();
 }
 
 /**
-\brief enables labeling numeric literals as _percent. The operator returns a
-doubleNF object.
+\brief trims the caches to the level each time the kernel reports memory
+pressure, using the pressure stall information of /proc/pressure/memory.
+A watch already started is replaced.
 */
-auto viewManager::operator""_percent(long double value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::percent};
+void viewManager::Viewer::watchMemoryPressure(const trimLevel level,
+                                              const std::string &sTrigger) {
+#if defined(__linux__)
+  m_pressureWatch.reset();
+  m_pressureWatch = std::make_unique<memoryPressureWatch>(
+      sTrigger, [this, level]() { requestTrim(level); });
+#elif defined(_WIN64)
+  throw std::runtime_error("Memory pressure is not watched upon this "
+                           "platform.");
+#endif
 }
 
 /**
-\brief enables labeling numeric literals as _pct. The operator returns a
-doubleNF object.
+\internal
+\brief trims the images and then the surfaces until the caches fit within
+the budget. When the glyphs and metrics, which the budget does not
+discard, exceed it alone, trimming cannot help. The state is reported once
+and the caches are left until they fit again.
 */
-auto viewManager::operator""_pct(unsigned long long int value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::percent};
+void viewManager::Viewer::enforceMemoryBudget(void) {
+  memoryUsage use = cacheUsage();
+  if (!m_memoryBudget || use.total() <= m_memoryBudget) {
+    m_bOverBudget = false;
+    return;
+  }
+
+  if (use.glyphs + use.metrics > m_memoryBudget) {
+    if (!m_bOverBudget && m_fnBudgetExceeded)
+      m_fnBudgetExceeded(use);
+    m_bOverBudget = true;
+    return;
+  }
+
+  if (use.images) {
+    trim(trimLevel::images);
+    use = cacheUsage();
+  }
+
+  if (use.total() > m_memoryBudget && use.surfaces)
+    trim(trimLevel::surfaces);
 }
 
 /**
-\brief enables labeling numeric literals as _pct. The operator returns a
-doubleNF object.
+\brief sets the number of workers of the executor and the processors they
+are bound to. It is called before the executor is first used.
+\param std::size_t nThreads the number of workers, zero for one per
+hardware thread.
+\param std::vector<int>& cpus the processors, worker i runs upon
+cpus[i % cpus.size()]. When empty, the workers are not bound.
+\exception std::runtime_error the executor has already started.
 */
-auto viewManager::operator""_pct(long double value) -> doubleNF {
-  return doubleNF{static_cast<double>(value), numericFormat::percent};
+void viewManager::Viewer::configureExecutor(const std::size_t nThreads,
+                                            const std::vector<int> &cpus) {
+  std::lock_guard<std::mutex> lock(m_executorLock);
+  if (m_executor)
+    throw std::runtime_error("The executor has already started.");
+  m_executorThreads = nThreads;
+  m_executorCpus = cpus;
 }
 
 /**
-\brief enables labeling numeric literals as _normal. The operator returns a
-doubleNF object.
+\brief the executor of the viewer, started by the first call. It may be
+called from any thread.
 */
-auto viewManager::operator""_normal(unsigned long long int value)
-    -> lineHeight {
-  return lineHeight{static_cast<double>(value), lineHeight::normal};
+viewManager::executor &viewManager::Viewer::tasks(void) {
+  std::lock_guard<std::mutex> lock(m_executorLock);
+  if (!m_executor)
+    m_executor = std::make_unique<executor>(m_executorThreads, m_executorCpus);
+  return *m_executor;
 }
 
 /**
-\brief enables labeling numeric literals as _normal. The operator returns a
-doubleNF object.
+\brief runs fn upon the thread of the message loop, where the document may
+be changed. It may be called from any thread. The functions are run in the
+order posted, before the next frame is laid out or, without a window,
+before renderImage lays out the document.
+\param std::function<void(void)> fn the function.
+\param cancellationToken& token drops fn when cancelled before it runs,
+such as the taskToken of the element it changes.
 */
-auto viewManager::operator""_normal(long double value) -> lineHeight {
-  return lineHeight{static_cast<double>(value), lineHeight::normal};
+void viewManager::Viewer::runOnUiThread(std::function<void(void)> fn,
+                                        const cancellationToken &token) {
+  {
+    std::lock_guard<std::mutex> lock(m_uiTasksLock);
+    m_uiTasks.emplace_back(std::move(fn), token);
+  }
+  m_device->wake();
 }
 
 /**
-\brief enables labeling numeric literals as _numeric. The operator returns a
-doubleNF object.
+\internal
+\brief returns the keys within the elements map of the elements whose
+face has loaded. A key is kept only while its element is still measured
+with the default face, so an element created at the address of a removed
+one is not mistaken for it.
 */
-auto viewManager::operator""_numeric(unsigned long long int value)
-    -> lineHeight {
-  return lineHeight{static_cast<double>(value), lineHeight::numeric};
+std::vector<std::size_t> viewManager::Viewer::takeFaceWaiters(void) {
+  std::vector<std::size_t> keys = m_device->takeFaceWaiters();
+  keys.erase(std::remove_if(keys.begin(), keys.end(),
+                            [](std::size_t key) {
+                              auto it = elements.find(key);
+                              return it == elements.end() ||
+                                     !it->second->m_bMetricsFallback;
+                            }),
+             keys.end());
+  return keys;
 }
 
 /**
-\brief enables labeling numeric literals as _numeric. The operator returns a
-doubleNF object.
+\internal
+\brief runs the functions posted by runOnUiThread.
 */
-auto viewManager::operator""_numeric(long double value) -> lineHeight {
-  return lineHeight{static_cast<double>(value), lineHeight::numeric};
+bool viewManager::Viewer::runUiTasks(void) {
+  std::vector<std::pair<std::function<void(void)>, cancellationToken>> ready;
+  {
+    std::lock_guard<std::mutex> lock(m_uiTasksLock);
+    ready.swap(m_uiTasks);
+  }
+
+  // a function may remove the element of one that follows.
+  for (auto &item : ready)
+    if (!item.second.cancelled())
+      item.first();
+  return !ready.empty();
 }
-/** @}*/
 
+#if defined(__linux__)
 /**
-  \addtogroup API Global Document API
-  @{
+\internal
+\brief registers the trigger with the kernel and starts the thread that
+waits upon it.
 */
+viewManager::memoryPressureWatch::memoryPressureWatch(
+    const std::string &sTrigger, const std::function<void(void)> &fn)
+    : m_fd(-1), m_stop{-1, -1}, m_fn(fn) {
+  m_fd = open("/proc/pressure/memory", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (m_fd < 0)
+    throw std::runtime_error("Memory pressure information is not "
+                             "available.");
+
+  // the trigger is written with its terminating zero.
+  if (write(m_fd, sTrigger.c_str(), sTrigger.size() + 1) < 0 ||
+      pipe2(m_stop, O_CLOEXEC) != 0) {
+    close(m_fd);
+    throw std::runtime_error("The memory pressure trigger was refused: " +
+                             sTrigger);
+  }
 
-/**
-\brief given the string id, the function returns
-the element.
+  m_thread = std::thread(&memoryPressureWatch::run, this);
+}
 
-jquery shows that handling large document models can be
-effectively managed using searching and iterators. Here,
-elements or groups of elements can be accessed through query strings.
-#, or *, or partial matches. Change attributes?
-@ for style,
+viewManager::memoryPressureWatch::~memoryPressureWatch() {
+  char c = 0;
+  write(m_stop[1], &c, 1);
+  m_thread.join();
+
+  close(m_stop[0]);
+  close(m_stop[1]);
+  close(m_fd);
+}
 
+/**
+\internal
+\brief the thread of the watch. The kernel signals the trigger as a
+priority event, and an error when the file is no longer monitored.
 */
-auto viewManager::query(const std::string &queryString) -> ElementList {
-  ElementList results;
-  if (queryString == "*") {
-    for (const auto &n : elements) {
-      results.push_back(std::ref(*(n.second.get())));
-    }
-  } else {
-    std::regex matchExpression(queryString.data(),
-                               std::regex_constants::ECMAScript |
-                                   std::regex_constants::icase);
-    for (const auto &n : elements) {
-      if (std::regex_match(n.second->getAttribute<indexBy>().value.data(),
-                           matchExpression))
-        results.push_back(std::ref(*(n.second.get())));
+void viewManager::memoryPressureWatch::run(void) {
+  pollfd fds[2] = {{m_fd, POLLPRI, 0}, {m_stop[0], POLLIN, 0}};
+
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
     }
+    if (fds[1].revents || (fds[0].revents & POLLERR))
+      break;
+    if (fds[0].revents & POLLPRI)
+      m_fn();
   }
-  return results;
 }
+#endif
+
+// the executor and index of the worker running on the thread, used to
+// post the tasks of a task to its own queue.
+static thread_local viewManager::executor *workerExecutor = nullptr;
+static thread_local std::size_t workerIndex = 0;
 
 /**
-\brief This version of the query interface provides a
-syntax whereby a lambda or a function may be used to provide matching.
-The function is simply passed an element within the traversal.
-The function is expected to return a true or false value.
+\brief starts the workers. With cpus given, worker i runs only upon
+cpus[i % cpus.size()].
+\param std::size_t nThreads the number of workers, zero for one per
+hardware thread.
+\param std::vector<int>& cpus the processors the workers are bound to.
 */
-auto viewManager::query(const ElementQuery &queryFunction) -> ElementList {
-  ElementList results;
-  for (const auto &n : elements) {
-    if (queryFunction(std::ref(*(n.second.get()))))
-      results.push_back(std::ref(*(n.second.get())));
-  }
-  return results;
-}
-
-/**
-\brief The hasElement function returns a true or false value if the
-index is found within the index. This may be used to avoid possible
-exceptions.
-*/
-bool viewManager::hasElement(const std::string &key) {
-  auto it = indexedElements.find(key);
-  return it != indexedElements.end();
-}
-/** @}*/
-
-Element::iterator &Element::iterator::operator=(Element *pNode) {
-  this->m_pCurrentNode = pNode;
-  return *this;
-}
-
-// Prefix ++ overload
-Element::iterator &Element::iterator::operator++() {
-  if (m_pCurrentNode)
-    m_pCurrentNode = m_pCurrentNode->m_nextSibling;
-  return *this;
-}
-
-// Postfix ++ overload
-Element::iterator Element::iterator::operator++(int) {
-  iterator it = *this;
-  ++*this;
-  return it;
-}
-
-// Prefix ++ overload
-Element::iterator &Element::iterator::operator--() {
-  if (m_pCurrentNode)
-    m_pCurrentNode = m_pCurrentNode->m_previousSibling;
-  return *this;
-}
-
-bool Element::iterator::operator!=(const Element::iterator &it) {
-  return m_pCurrentNode != it.m_pCurrentNode;
-}
+viewManager::executor::executor(const std::size_t nThreads,
+                                const std::vector<int> &cpus) {
+  std::size_t threads =
+      nThreads ? nThreads : std::max(1u, std::thread::hardware_concurrency());
 
-Element &Element::iterator::operator*() { return *m_pCurrentNode; }
+  for (std::size_t i = 0; i < threads; i++)
+    m_queues.push_back(std::make_unique<workerQueue>());
 
-Element::iterator Element::iterator::begin() {
-  return Element::iterator(m_pCurrentNode->m_firstChild);
-}
+  for (std::size_t i = 0; i < threads; i++) {
+    m_workers.emplace_back(&executor::run, this, i);
+    if (cpus.empty())
+      continue;
 
-Element::iterator Element::iterator::end() {
-  return Element::iterator(nullptr);
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[i % cpus.size()], &set);
+    pthread_setaffinity_np(m_workers.back().native_handle(), sizeof(set),
+                           &set);
+#elif defined(_WIN64)
+    SetThreadAffinityMask(m_workers.back().native_handle(),
+                          DWORD_PTR(1) << cpus[i % cpus.size()]);
+#endif
+  }
 }
 
 /**
-\internal
-\brief copy constructor
+\brief stops the workers once their running tasks return. Queued tasks
+are dropped.
 */
-viewManager::Element::Element(const Element &other) {
+viewManager::executor::~executor() {
+  {
+    std::lock_guard<std::mutex> lock(m_sleepLock);
+    m_bStop = true;
+  }
+  m_sleep.notify_all();
 
-  m_self = other.m_self;
-  m_parent = other.m_parent;
-  m_firstChild = other.m_firstChild;
-  m_lastChild = other.m_lastChild;
-  m_nextChild = other.m_nextChild;
-  m_previousChild = other.m_previousChild;
-  m_nextSibling = other.m_nextSibling;
-  m_previousSibling = other.m_previousSibling;
-  m_childCount = other.m_childCount;
-  attributes = other.attributes;
-  styles = other.styles;
+  for (auto &worker : m_workers)
+    worker.join();
 }
 
 /**
-\internal
-\brief move constructor
+\brief queues fn upon the lane of priority. The task is dropped if token
+is cancelled before a worker takes it.
+\param std::function<void(void)> fn the work. An exception it raises is
+discarded, use submit to receive it.
+\param taskPriority priority the lane of the task.
+\param cancellationToken& token cancels the task.
 */
-viewManager::Element::Element(Element &&other) noexcept {
-
-  m_self = other.m_self;
-  m_parent = other.m_parent;
-  m_firstChild = other.m_firstChild;
-  m_lastChild = other.m_lastChild;
-  m_nextChild = other.m_nextChild;
-  m_previousChild = other.m_previousChild;
-  m_nextSibling = other.m_nextSibling;
-  m_previousSibling = other.m_previousSibling;
-  m_childCount = other.m_childCount;
-  attributes = std::move(other.attributes);
-  styles = std::move(other.styles);
+void viewManager::executor::post(std::function<void(void)> fn,
+                                 const taskPriority priority,
+                                 const cancellationToken &token) {
+  std::size_t target = workerExecutor == this
+                           ? workerIndex
+                           : m_next.fetch_add(1) % m_queues.size();
+
+  // counted before the task is visible, so that a worker taking it cannot
+  // decrement first, and under the lock so that a worker about to sleep
+  // sees it.
+  {
+    std::lock_guard<std::mutex> sleepLock(m_sleepLock);
+    m_pending++;
+    workerQueue &queue = *m_queues[target];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    queue.lanes[static_cast<std::size_t>(priority)].push_back(
+        {std::move(fn), token});
+  }
+  m_sleep.notify_one();
 }
 
 /**
 \internal
-\brief copy assignment operator
+\brief takes the task of the highest lane, from the worker's own queue
+first and then from the others.
 */
-Element &viewManager::Element::operator=(const Element &other) {
+bool viewManager::executor::take(const std::size_t self, task &t) {
+  std::size_t count = m_queues.size();
+
+  for (std::size_t lane = 0; lane < 3; lane++) {
+    {
+      workerQueue &own = *m_queues[self];
+      std::lock_guard<std::mutex> lock(own.lock);
+      if (!own.lanes[lane].empty()) {
+        t = std::move(own.lanes[lane].back());
+        own.lanes[lane].pop_back();
+        return true;
+      }
+    }
 
-  // Self-assignment detection
-  if (&other == this)
-    return *this;
-  m_self = other.m_self;
-  m_parent = other.m_parent;
-  m_firstChild = other.m_firstChild;
-  m_lastChild = other.m_lastChild;
-  m_nextChild = other.m_nextChild;
-  m_previousChild = other.m_previousChild;
-  m_nextSibling = other.m_nextSibling;
-  m_previousSibling = other.m_previousSibling;
-  m_childCount = other.m_childCount;
-  attributes = other.attributes;
-  styles = other.styles;
-  return *this;
+    for (std::size_t i = 1; i < count; i++) {
+      workerQueue &victim = *m_queues[(self + i) % count];
+      std::lock_guard<std::mutex> lock(victim.lock);
+      if (!victim.lanes[lane].empty()) {
+        t = std::move(victim.lanes[lane].front());
+        victim.lanes[lane].pop_front();
+        return true;
+      }
+    }
+  }
+  return false;
 }
 
 /**
 \internal
-\brief move assignment operator
+\brief the loop of a worker. It sleeps while no task is queued.
 */
-Element &viewManager::Element::operator=(Element &&other) noexcept {
+void viewManager::executor::run(const std::size_t self) {
+  workerExecutor = this;
+  workerIndex = self;
+
+  while (true) {
+    task t;
+    if (take(self, t)) {
+      m_pending--;
+      if (t.token.cancelled())
+        continue;
+      try {
+        t.fn();
+      } catch (...) {
+      }
+      continue;
+    }
 
-  if (&other == this)
-    return *this;
-  m_self = other.m_self;
-  m_parent = other.m_parent;
-  m_firstChild = other.m_firstChild;
-  m_lastChild = other.m_lastChild;
-  m_nextChild = other.m_nextChild;
-  m_previousChild = other.m_previousChild;
-  m_nextSibling = other.m_nextSibling;
-  m_previousSibling = other.m_previousSibling;
-  m_childCount = other.m_childCount;
-  attributes = std::move(other.attributes);
-  styles = std::move(other.styles);
-  return *this;
+    std::unique_lock<std::mutex> lock(m_sleepLock);
+    m_sleep.wait(lock, [this]() { return m_bStop || m_pending > 0; });
+    if (m_bStop)
+      return;
+  }
 }
 
 /**
-  \brief
-  The function will parse the string as input searching for document tags.
-  These elements are added as children of the element for which the function
-  is invoked.
+\addtogroup udl User Defined Literals
 
-  \param sMarkup a std::string containing the markup.
-  \return Element& returns the referenced element for continuation syntax.
+User defined liters are created for the project to consolidate parameter
+input.
 
-  Example
-  -------
-  \snippet examples.cpp appendChild_markup
+When more information would be required in a C++ constructor creation, the
+syntax provides the returning of the numerical format object in an easy to
+read syntax,
 
-  \ref markupInputFormat
+For example:
+    getElement("testDiv").setAttribute<objectTop>(10_px);
+
+rather than
+    getElement("testDiv").setAttribute<objectTop>(10, numericFormat::px);
 
+@{
 */
-auto viewManager::Element::appendChild(const std::string &sMarkup)
-    -> Element & {
-  return (ingestMarkup(*this, sMarkup));
-}
 
 /**
-  \brief The function will append the given document element within
-  the parameter as a child.
-
-  \param newChild a new child element that was previously created.
-  \return Element& returns the referenced element for continuation syntax.
-
-  Example
-  -------
-  \snippet examples.cpp appendChild_element
+\brief enables labeling numeric literals as _pt. The operator returns a
+doubleNF object.
 */
-auto viewManager::Element::appendChild(Element &newChild) -> Element & {
-  newChild.m_parent = this;
-  newChild.m_previousSibling = m_lastChild;
-
-  if (!m_firstChild)
-    m_firstChild = newChild.m_self;
-
-  if (m_lastChild)
-    m_lastChild->m_nextSibling = newChild.m_self;
-
-  m_lastChild = newChild.m_self;
-  m_childCount++;
-
-  return (newChild);
+auto viewManager::operator""_pt(unsigned long long int value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::pt};
 }
 
 /**
-  \brief The function will append the given document elements within
-  the ElementList parameter as children.
-
-  \param elementCollection an ElementList of new child element that was
-  previously created.
-
-  \return Element& returns the referenced element for continuation syntax.
-
-  Example
-  -------
-  \snippet examples.cpp appendChild_elementlist
+\brief enables labeling numeric literals as _pt. The operator returns a
+doubleNF object.
 */
-auto viewManager::Element::appendChild(const ElementList &elementCollection)
-    -> Element & {
-  for (auto e : elementCollection) {
-    appendChild(e.get());
-  }
-  return (*this);
+auto viewManager::operator""_pt(long double value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::pt};
 }
 
 /**
-  \brief The function will append the given markup content as a sibling.
-
-  \param elementCollection an ElementList of new child element that was
-  previously created.
-
-  \return Element& returns the referenced element for continuation syntax.
-
-  Example
-  -------
-  \snippet examples.cpp append_markup
-
-  \ref markupInputFormat
-
-
+\brief enables labeling numeric literals as _em. The operator returns a
+doubleNF object.
 */
-auto viewManager::Element::append(const std::string &sMarkup) -> Element & {
-  Element *base = this->m_parent;
-  if (base == nullptr)
-    base = this;
-  return (ingestMarkup(*base, sMarkup));
+auto viewManager::operator""_em(unsigned long long int value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::em};
 }
 
 /**
-  \brief The function will append the given element as a sibling.
-
-  \return Element& returns the referenced element for continuation syntax.
-
-  Example
-  -------
-  \snippet examples.cpp append_element
-
+ \brief enables labeling numeric literals as _em. The operator returns a
+ doubleNF object.
 */
-auto viewManager::Element::append(Element &sibling) -> Element & {
-  m_nextSibling = sibling.m_self;
-  sibling.m_parent = this->m_parent;
-  sibling.m_previousSibling = this;
-
-  if (!this->m_parent->m_firstChild)
-    this->m_parent->m_firstChild = sibling.m_self;
-
-  this->m_parent->m_lastChild = sibling.m_self;
-
-  this->m_parent->m_childCount++;
-  return (sibling);
+auto viewManager::operator""_em(long double value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::em};
 }
 
 /**
-  \brief The function will append the collection of elements as a
-  siblings.
-
-  \param elementCollection an ElementList of new child element that was
+\brief enables labeling numeric literals as _px. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_px(unsigned long long int value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::px};
+}
+
+/**
+\brief enables labeling numeric literals as _px. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_px(long double value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::px};
+}
+
+/**
+\brief enables labeling numeric literals as _percent. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_percent(unsigned long long int value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::percent};
+}
+
+/**
+\brief enables labeling numeric literals as _percent. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_percent(long double value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::percent};
+}
+
+/**
+\brief enables labeling numeric literals as _pct. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_pct(unsigned long long int value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::percent};
+}
+
+/**
+\brief enables labeling numeric literals as _pct. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_pct(long double value) -> doubleNF {
+  return doubleNF{static_cast<double>(value), numericFormat::percent};
+}
+
+/**
+\brief enables labeling numeric literals as _normal. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_normal(unsigned long long int value)
+    -> lineHeight {
+  return lineHeight{static_cast<double>(value), lineHeight::normal};
+}
+
+/**
+\brief enables labeling numeric literals as _normal. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_normal(long double value) -> lineHeight {
+  return lineHeight{static_cast<double>(value), lineHeight::normal};
+}
+
+/**
+\brief enables labeling numeric literals as _numeric. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_numeric(unsigned long long int value)
+    -> lineHeight {
+  return lineHeight{static_cast<double>(value), lineHeight::numeric};
+}
+
+/**
+\brief enables labeling numeric literals as _numeric. The operator returns a
+doubleNF object.
+*/
+auto viewManager::operator""_numeric(long double value) -> lineHeight {
+  return lineHeight{static_cast<double>(value), lineHeight::numeric};
+}
+/** @}*/
+
+/**
+  \addtogroup API Global Document API
+  @{
+*/
+
+/**
+\brief given the string id, the function returns
+the element.
+
+jquery shows that handling large document models can be
+effectively managed using searching and iterators. Here,
+elements or groups of elements can be accessed through query strings.
+#, or *, or partial matches. Change attributes?
+@ for style,
+
+*/
+auto viewManager::query(const std::string &queryString) -> ElementList {
+  ElementList results;
+#if defined(USE_LAZY_MARKUP)
+  materializeDeferred();
+#endif
+  if (queryString == "*") {
+    for (const auto &n : elements) {
+      results.push_back(std::ref(*(n.second.get())));
+    }
+  } else {
+    std::regex matchExpression(queryString.data(),
+                               std::regex_constants::ECMAScript |
+                                   std::regex_constants::icase);
+    for (const auto &n : elements) {
+      if (std::regex_match(n.second->getAttribute<indexBy>().value.data(),
+                           matchExpression))
+        results.push_back(std::ref(*(n.second.get())));
+    }
+  }
+  return results;
+}
+
+/**
+\brief This version of the query interface provides a
+syntax whereby a lambda or a function may be used to provide matching.
+The function is simply passed an element within the traversal.
+The function is expected to return a true or false value.
+*/
+auto viewManager::query(const ElementQuery &queryFunction) -> ElementList {
+  ElementList results;
+#if defined(USE_LAZY_MARKUP)
+  materializeDeferred();
+#endif
+  for (const auto &n : elements) {
+    if (queryFunction(std::ref(*(n.second.get()))))
+      results.push_back(std::ref(*(n.second.get())));
+  }
+  return results;
+}
+
+/**
+\brief reconciles an existing element with a newly built fragment.
+\see Element::patch
+*/
+auto viewManager::patch(Element &existingElement, Element &newFragment)
+    -> Element & {
+  return existingElement.patch(newFragment);
+}
+
+/**
+\internal
+\brief returns the work that a change of the attribute type requires.
+*/
+viewManager::invalidation
+viewManager::attributeInvalidation(const std::type_index &tIndex) {
+  if (tIndex == typeid(textFace) || tIndex == typeid(textSize))
+    return invalidation::metrics;
+
+  if (tIndex == typeid(textColor) || tIndex == typeid(background) ||
+      tIndex == typeid(borderColor) || tIndex == typeid(opacity))
+    return invalidation::paint;
+
+  return invalidation::layout;
+}
+
+viewManager::bindingBase::bindingBase(Element &e, observableBase &source,
+                                      invalidation level)
+    : m_elementKey((std::size_t)&e), m_queue(pendingBindings),
+      m_source(source), m_level(level) {}
+
+viewManager::bindingBase::~bindingBase() {
+  if (auto q = m_queue.lock())
+    q->cancel(this);
+}
+
+/**
+\internal
+\brief queues the binding with the document it was made for, unless that
+thread has ended.
+*/
+void viewManager::bindingBase::queue(void) {
+  if (auto q = m_queue.lock())
+    q->schedule(this);
+}
+
+/**
+\internal
+\brief returns the bound element, or nullptr when it has been removed.
+*/
+Element *viewManager::bindingBase::element(void) {
+  auto it = elements.find(m_elementKey);
+  return it == elements.end() ? nullptr : it->second.get();
+}
+
+/**
+\internal
+\brief queues the binding unless it is queued already. The first binding
+queued after a frame requests the next one.
+*/
+void viewManager::bindingQueue::schedule(bindingBase *b) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (b->m_bPending)
+    return;
+
+  b->m_bPending = true;
+  m_pending.push_back(b);
+
+  if (!m_bFrameRequested && m_fnRequestFrame) {
+    m_bFrameRequested = true;
+    m_fnRequestFrame();
+  }
+}
+
+/**
+\internal
+\brief removes a binding that is being destroyed from the queue.
+*/
+void viewManager::bindingQueue::cancel(bindingBase *b) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!b->m_bPending)
+    return;
+
+  m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), b),
+                  m_pending.end());
+  b->m_bPending = false;
+}
+
+/**
+\internal
+\brief applies each queued binding once with its current value. Bindings
+whose element has been removed are dropped. The values are read under
+observableLock, and the binding functions run after it is released so
+that other threads may change values meanwhile.
+\return the strongest invalidation of the bindings applied and the keys
+of their elements.
+*/
+viewManager::bindingQueue::flushResult
+viewManager::bindingQueue::flush(void) {
+  flushResult result{false, invalidation::paint, {}};
+  std::vector<std::pair<std::size_t, bindingBase::applyStep>> steps;
+  {
+    std::lock_guard<std::recursive_mutex> graphLock(observableLock);
+    std::vector<bindingBase *> pending;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      pending.swap(m_pending);
+      m_bFrameRequested = false;
+      for (auto b : pending)
+        b->m_bPending = false;
+    }
+
+    for (auto b : pending) {
+      bindingBase::applyStep step;
+      if (!b->prepare(step)) {
+        b->m_source.removeBinding(b);
+        continue;
+      }
+      if (!step)
+        continue;
+
+      steps.push_back({b->m_elementKey, std::move(step)});
+      if (b->m_level > result.level)
+        result.level = b->m_level;
+      if (b->m_level != invalidation::paint)
+        result.keys.push_back(b->m_elementKey);
+    }
+  }
+
+  // a step may remove the element of one that follows.
+  for (auto &n : steps) {
+    auto it = elements.find(n.first);
+    if (it != elements.end())
+      n.second(*(it->second.get()));
+  }
+
+  result.bApplied = !steps.empty();
+  return result;
+}
+
+/**
+\internal
+\brief sets the function that requests a frame from the platform, or
+clears it with an empty function.
+*/
+void viewManager::bindingQueue::setFrameRequest(
+    const std::function<void(void)> &fn) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_fnRequestFrame = fn;
+  m_bFrameRequested = false;
+
+  if (m_fnRequestFrame && !m_pending.empty()) {
+    m_bFrameRequested = true;
+    m_fnRequestFrame();
+  }
+}
+
+/**
+\internal
+\brief detaches the value from the graph. Its bindings are destroyed.
+*/
+viewManager::observableBase::~observableBase() {
+  std::lock_guard<std::recursive_mutex> lock(observableLock);
+  for (auto d : m_dependencies)
+    d->m_dependents.erase(
+        std::remove(d->m_dependents.begin(), d->m_dependents.end(), this),
+        d->m_dependents.end());
+
+  for (auto d : m_dependents)
+    d->m_dependencies.erase(std::remove(d->m_dependencies.begin(),
+                                        d->m_dependencies.end(), this),
+                            d->m_dependencies.end());
+  m_bindings.clear();
+}
+
+/**
+\internal
+\brief queues the bindings of the value and marks the values that depend
+upon it stale. A value that is already stale has queued its bindings, so
+the walk stops there. The caller holds observableLock.
+*/
+void viewManager::observableBase::changed(void) {
+  for (auto &b : m_bindings)
+    b->queue();
+
+  for (auto d : m_dependents)
+    if (d->markStale())
+      d->changed();
+}
+
+void viewManager::observableBase::dependsOn(observableBase &dependency) {
+  dependency.m_dependents.push_back(this);
+  m_dependencies.push_back(&dependency);
+}
+
+/**
+\internal
+\brief keeps the binding and queues it so the element receives the
+current value with the next frame.
+*/
+void viewManager::observableBase::addBinding(std::unique_ptr<bindingBase> b) {
+  b->queue();
+  m_bindings.push_back(std::move(b));
+}
+
+void viewManager::observableBase::removeBinding(bindingBase *b) {
+  m_bindings.erase(std::remove_if(m_bindings.begin(), m_bindings.end(),
+                                  [b](auto &p) { return p.get() == b; }),
+                   m_bindings.end());
+}
+
+/**
+\brief The hasElement function returns a true or false value if the
+index is found within the index. This may be used to avoid possible
+exceptions.
+*/
+bool viewManager::hasElement(const std::string &key) {
+  auto it = indexedElements.find(key);
+#if defined(USE_LAZY_MARKUP)
+  if (it == indexedElements.end())
+    return deferredIndex.find(key) != deferredIndex.end();
+#endif
+  return it != indexedElements.end();
+}
+/** @}*/
+
+/**
+\internal
+\brief follows a child or sibling link of the tree traversal interface.
+With lazy markup, the placeholders among the children are created first,
+and those of markup still being parsed are passed over.
+*/
+Element *viewManager::Element::treeLink(Element *Element::*link) {
+#if defined(USE_LAZY_MARKUP)
+  bool bChild = link == &Element::m_firstChild || link == &Element::m_lastChild;
+  Element *pOwner = bChild ? this : m_parent;
+  if (pOwner && pOwner->m_deferredChildren) {
+    pOwner->materializeChildren();
+    bool bForward =
+        link == &Element::m_firstChild || link == &Element::m_nextSibling;
+    Element *p = this->*link;
+    while (p && dynamic_cast<deferredMarkup *>(p))
+      p = bForward ? p->m_nextSibling : p->m_previousSibling;
+    return p;
+  }
+#endif
+  return this->*link;
+}
+
+/**
+\brief the number of children. With lazy markup, the deferred children are
+created first.
+*/
+std::size_t viewManager::Element::childCount(void) {
+#if defined(USE_LAZY_MARKUP)
+  materializeChildren();
+  return m_childCount - m_deferredChildren;
+#else
+  return m_childCount;
+#endif
+}
+
+Element::iterator &Element::iterator::operator=(Element *pNode) {
+  this->m_pCurrentNode = pNode;
+  return *this;
+}
+
+// Prefix ++ overload
+Element::iterator &Element::iterator::operator++() {
+  if (m_pCurrentNode)
+    m_pCurrentNode = m_pCurrentNode->treeLink(&Element::m_nextSibling);
+  return *this;
+}
+
+// Postfix ++ overload
+Element::iterator Element::iterator::operator++(int) {
+  iterator it = *this;
+  ++*this;
+  return it;
+}
+
+// Prefix ++ overload
+Element::iterator &Element::iterator::operator--() {
+  if (m_pCurrentNode)
+    m_pCurrentNode = m_pCurrentNode->treeLink(&Element::m_previousSibling);
+  return *this;
+}
+
+bool Element::iterator::operator!=(const Element::iterator &it) {
+  return m_pCurrentNode != it.m_pCurrentNode;
+}
+
+Element &Element::iterator::operator*() { return *m_pCurrentNode; }
+
+Element::iterator Element::iterator::begin() {
+  return Element::iterator(m_pCurrentNode->treeLink(&Element::m_firstChild));
+}
+
+Element::iterator Element::iterator::end() {
+  return Element::iterator(nullptr);
+}
+
+/**
+\internal
+\brief copy constructor
+\details The copy takes the attributes, data, styles and word metrics of
+the other element. It is not placed within the document, so the tree links
+are empty. Listeners and text not yet committed are not copied.
+*/
+viewManager::Element::Element(const Element &other)
+    : softName(other.softName), penX(other.penX), penY(other.penY),
+      maxX(other.maxX), maxY(other.maxY), m_self(this), m_parent(nullptr),
+      m_firstChild(nullptr), m_lastChild(nullptr), m_nextChild(nullptr),
+      m_previousChild(nullptr), m_nextSibling(nullptr),
+      m_previousSibling(nullptr), m_childCount(0) {
+  ingestStream = other.ingestStream;
+  attributes = other.attributes;
+  m_usageAdaptorMap = other.m_usageAdaptorMap;
+  m_dataViews = other.m_dataViews;
+  styles = other.styles;
+  surface = 0;
+
+  // the same text measures the same, so layout skips measuring it again.
+  indexedWordMetrics = other.indexedWordMetrics;
+  m_bMetricsValid = other.m_bMetricsValid;
+  m_bMetricsFallback = other.m_bMetricsFallback;
+  m_metricBytes = other.m_metricBytes;
+  cacheBytes.metrics += m_metricBytes;
+  displayList = other.displayList;
+  displayList.ptr = this;
+
+  // a record the other element may still change is copied.
+  m_bStyleShared = other.m_bStyleShared;
+  if (other.m_style && !other.m_bStyleShared)
+    m_style = std::make_shared<computedStyle>(*other.m_style);
+  else
+    m_style = other.m_style;
+}
+
+/**
+\internal
+\brief move constructor
+*/
+viewManager::Element::Element(Element &&other) noexcept {
+
+  m_self = other.m_self;
+  m_parent = other.m_parent;
+  m_firstChild = other.m_firstChild;
+  m_lastChild = other.m_lastChild;
+  m_nextChild = other.m_nextChild;
+  m_previousChild = other.m_previousChild;
+  m_nextSibling = other.m_nextSibling;
+  m_previousSibling = other.m_previousSibling;
+  m_childCount = other.m_childCount;
+  attributes = std::move(other.attributes);
+  styles = std::move(other.styles);
+  m_style = std::move(other.m_style);
+  m_bStyleShared = other.m_bStyleShared;
+  takeOutput(other);
+}
+
+/**
+\internal
+\brief copy assignment operator
+*/
+Element &viewManager::Element::operator=(const Element &other) {
+
+  // Self-assignment detection
+  if (&other == this)
+    return *this;
+
+  // the element keeps its place within the tree and takes the values.
+  softName = other.softName;
+  ingestStream = other.ingestStream;
+  attributes = other.attributes;
+  m_usageAdaptorMap = other.m_usageAdaptorMap;
+  m_dataViews = other.m_dataViews;
+  styles = other.styles;
+
+  cacheBytes.metrics -= m_metricBytes;
+  indexedWordMetrics = other.indexedWordMetrics;
+  m_bMetricsValid = other.m_bMetricsValid;
+  m_bMetricsFallback = other.m_bMetricsFallback;
+  m_metricBytes = other.m_metricBytes;
+  cacheBytes.metrics += m_metricBytes;
+
+  m_bStyleShared = other.m_bStyleShared;
+  if (other.m_style && !other.m_bStyleShared)
+    m_style = std::make_shared<computedStyle>(*other.m_style);
+  else
+    m_style = other.m_style;
+  return *this;
+}
+
+/**
+\internal
+\brief move assignment operator
+*/
+Element &viewManager::Element::operator=(Element &&other) noexcept {
+
+  if (&other == this)
+    return *this;
+  m_self = other.m_self;
+  m_parent = other.m_parent;
+  m_firstChild = other.m_firstChild;
+  m_lastChild = other.m_lastChild;
+  m_nextChild = other.m_nextChild;
+  m_previousChild = other.m_previousChild;
+  m_nextSibling = other.m_nextSibling;
+  m_previousSibling = other.m_previousSibling;
+  m_childCount = other.m_childCount;
+  attributes = std::move(other.attributes);
+  styles = std::move(other.styles);
+  m_style = std::move(other.m_style);
+  m_bStyleShared = other.m_bStyleShared;
+  takeOutput(other);
+  return *this;
+}
+
+/**
+  \brief
+  The function will parse the string as input searching for document tags.
+  These elements are added as children of the element for which the function
+  is invoked.
+
+  \param sMarkup a std::string containing the markup.
+  \return Element& returns the referenced element for continuation syntax.
+
+  Example
+  -------
+  \snippet examples.cpp appendChild_markup
+
+  \ref markupInputFormat
+
+*/
+auto viewManager::Element::appendChild(const std::string &sMarkup)
+    -> Element & {
+  return (ingestMarkup(*this, sMarkup));
+}
+
+/**
+  \brief
+  The function parses the markup contained within a file. The elements are
+  added as children of the element for which the function is invoked.
+
+  \details
+  Files compressed with gzip, or with zstd when USE_ZSTD is defined, are
+  recognized by their leading bytes and decompressed as they are read.
+  Reading and decompression run on a second thread while the calling
+  thread parses the blocks already produced.
+
+  \param sFilename the path of the markup file.
+  \return Element& returns the referenced element for continuation syntax.
+  \exception std::runtime_error the file could not be opened or its
+  compressed contents are damaged.
+
+  \ref markupInputFormat
+
+  Example
+  -------
+  \snippet examples.cpp loadZstd
+
+*/
+auto viewManager::Element::load(const std::string &sFilename) -> Element & {
+  std::ifstream file(sFilename, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("The markup file " + sFilename +
+                             " could not be opened.");
+
+  markupBlockQueue queue;
+  std::thread reader([&file, &queue]() {
+    try {
+      readMarkupFile(file, queue);
+      queue.finish();
+    } catch (...) {
+      queue.finish(std::current_exception());
+    }
+  });
+
+  // the parser keeps the state of a tag split between blocks.
+  std::string block;
+  try {
+    while (queue.pop(block))
+      ingestMarkup(*this, block);
+  } catch (...) {
+    queue.cancel();
+    reader.join();
+    throw;
+  }
+
+  reader.join();
+  return *this;
+}
+
+/**
+\internal
+\brief The function is the reading side of load. The input is read in
+blocks of MARKUP_BLOCK_SIZE, decompressed when its leading bytes name
+gzip or zstd, and passed to the queue until the end of the input or until
+the parsing side cancels.
+*/
+void viewManager::Element::readMarkupFile(std::istream &input,
+                                          markupBlockQueue &queue) {
+  std::vector<char> in(MARKUP_BLOCK_SIZE);
+  const std::size_t outSize = MARKUP_BLOCK_SIZE * 4;
+
+  auto readBlock = [&input, &in]() -> std::size_t {
+    input.read(in.data(), in.size());
+    if (input.bad())
+      throw std::runtime_error("The markup file could not be read.");
+    return static_cast<std::size_t>(input.gcount());
+  };
+
+  // identify the format from the leading bytes.
+  std::array<unsigned char, 4> magic{};
+  input.read(reinterpret_cast<char *>(magic.data()), magic.size());
+  std::size_t magicSize = static_cast<std::size_t>(input.gcount());
+  input.clear();
+  input.seekg(0);
+
+  bool bGzip = magicSize >= 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+  bool bZstd = magicSize == 4 && magic[0] == 0x28 && magic[1] == 0xb5 &&
+               magic[2] == 0x2f && magic[3] == 0xfd;
+
+  if (bGzip) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK)
+      throw std::runtime_error("The gzip decompressor could not be "
+                               "initialized.");
+    std::unique_ptr<z_stream, int (*)(z_streamp)> zsGuard(&zs, inflateEnd);
+
+    int ret = Z_OK;
+    bool bDrained = true;
+    while (!queue.cancelled()) {
+      // inflate may hold output after consuming its input, so more input
+      // is read only once a call left room in the output.
+      if (zs.avail_in == 0 && bDrained) {
+        std::size_t n = readBlock();
+        if (n == 0)
+          break;
+        zs.next_in = reinterpret_cast<Bytef *>(in.data());
+        zs.avail_in = static_cast<uInt>(n);
+      }
+
+      std::string out(outSize, '\0');
+      zs.next_out = reinterpret_cast<Bytef *>(out.data());
+      zs.avail_out = static_cast<uInt>(out.size());
+      ret = inflate(&zs, Z_NO_FLUSH);
+
+      // files may hold several gzip members one after the other.
+      if (ret == Z_STREAM_END)
+        inflateReset(&zs);
+      else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        throw std::runtime_error("The gzip markup file is damaged.");
+
+      bDrained = zs.avail_out != 0;
+      out.resize(out.size() - zs.avail_out);
+      if (!out.empty())
+        queue.push(std::move(out));
+    }
+
+    if (ret != Z_STREAM_END && !queue.cancelled())
+      throw std::runtime_error("The gzip markup file is truncated.");
+
+  } else if (bZstd) {
+#if defined(USE_ZSTD)
+    std::unique_ptr<ZSTD_DStream, std::size_t (*)(ZSTD_DStream *)> ds(
+        ZSTD_createDStream(), ZSTD_freeDStream);
+    if (!ds || ZSTD_isError(ZSTD_initDStream(ds.get())))
+      throw std::runtime_error("The zstd decompressor could not be "
+                               "initialized.");
+
+    ZSTD_inBuffer zin{in.data(), 0, 0};
+    std::size_t ret = 0;
+    bool bDrained = true;
+    while (!queue.cancelled()) {
+      // a call that fills the output may leave decoded data within the
+      // stream, so more input is read only once a call left room.
+      if (zin.pos == zin.size && bDrained) {
+        std::size_t n = readBlock();
+        if (n == 0)
+          break;
+        zin = ZSTD_inBuffer{in.data(), n, 0};
+      }
+
+      std::string out(outSize, '\0');
+      ZSTD_outBuffer zout{out.data(), out.size(), 0};
+      ret = ZSTD_decompressStream(ds.get(), &zout, &zin);
+      if (ZSTD_isError(ret))
+        throw std::runtime_error("The zstd markup file is damaged. " +
+                                 std::string(ZSTD_getErrorName(ret)));
+
+      bDrained = zout.pos < zout.size;
+      out.resize(zout.pos);
+      if (!out.empty())
+        queue.push(std::move(out));
+    }
+
+    // with the decoder drained, a non zero hint means a frame is
+    // incomplete.
+    if (ret != 0 && !queue.cancelled())
+      throw std::runtime_error("The zstd markup file is truncated.");
+#else
+    throw std::runtime_error("The markup file is zstd compressed. The library "
+                             "must be built with USE_ZSTD.");
+#endif
+
+  } else {
+    while (!queue.cancelled()) {
+      std::size_t n = readBlock();
+      if (n == 0)
+        break;
+      queue.push(std::string(in.data(), n));
+    }
+  }
+}
+
+/**
+\internal
+\brief adds a block to the queue. The caller waits while the queue is
+full. Blocks pushed after the queue is cancelled are discarded.
+*/
+void viewManager::markupBlockQueue::push(std::string &&block) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_condition.wait(lock, [this]() {
+    return m_blocks.size() < capacity || m_bCancelled;
+  });
+  if (m_bCancelled)
+    return;
+  m_blocks.push_back(std::move(block));
+  m_condition.notify_all();
+}
+
+/**
+\internal
+\brief removes the next block from the queue, waiting for one when the
+queue is empty.
+\return false once the reader has finished and all blocks are consumed.
+\exception rethrows the error given to finish by the reader.
+*/
+bool viewManager::markupBlockQueue::pop(std::string &block) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_condition.wait(lock,
+                   [this]() { return !m_blocks.empty() || m_bFinished; });
+  if (m_blocks.empty()) {
+    if (m_error)
+      std::rethrow_exception(m_error);
+    return false;
+  }
+  block = std::move(m_blocks.front());
+  m_blocks.pop_front();
+  m_condition.notify_all();
+  return true;
+}
+
+/**
+\internal
+\brief called by the reader when it has no more blocks, with the error
+that stopped it if any.
+*/
+void viewManager::markupBlockQueue::finish(std::exception_ptr error) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_bFinished = true;
+  m_error = error;
+  m_condition.notify_all();
+}
+
+/**
+\internal
+\brief called by the parser to stop the reader early.
+*/
+void viewManager::markupBlockQueue::cancel(void) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_bCancelled = true;
+  m_condition.notify_all();
+}
+
+bool viewManager::markupBlockQueue::cancelled(void) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_bCancelled;
+}
+
+/**
+  \brief The function will append the given document element within
+  the parameter as a child.
+
+  \param newChild a new child element that was previously created.
+  \return Element& returns the referenced element for continuation syntax.
+
+  Example
+  -------
+  \snippet examples.cpp appendChild_element
+*/
+auto viewManager::Element::appendChild(Element &newChild) -> Element & {
+  treeGeneration++;
+  newChild.m_parent = this;
+  newChild.m_previousSibling = m_lastChild;
+
+  if (!m_firstChild)
+    m_firstChild = newChild.m_self;
+
+  if (m_lastChild)
+    m_lastChild->m_nextSibling = newChild.m_self;
+
+  m_lastChild = newChild.m_self;
+  m_childCount++;
+
+  return (newChild);
+}
+
+/**
+  \brief The function will append the given document elements within
+  the ElementList parameter as children.
+
+  \param elementCollection an ElementList of new child element that was
+  previously created.
+
+  \return Element& returns the referenced element for continuation syntax.
+
+  Example
+  -------
+  \snippet examples.cpp appendChild_elementlist
+*/
+auto viewManager::Element::appendChild(const ElementList &elementCollection)
+    -> Element & {
+  for (auto e : elementCollection) {
+    appendChild(e.get());
+  }
+  return (*this);
+}
+
+/**
+  \brief The function will append the given markup content as a sibling.
+
+  \param elementCollection an ElementList of new child element that was
+  previously created.
+
+  \return Element& returns the referenced element for continuation syntax.
+
+  Example
+  -------
+  \snippet examples.cpp append_markup
+
+  \ref markupInputFormat
+
+
+*/
+auto viewManager::Element::append(const std::string &sMarkup) -> Element & {
+  Element *base = this->m_parent;
+  if (base == nullptr)
+    base = this;
+  return (ingestMarkup(*base, sMarkup));
+}
+
+/**
+  \brief The function will append the given element as a sibling.
+
+  \return Element& returns the referenced element for continuation syntax.
+
+  Example
+  -------
+  \snippet examples.cpp append_element
+
+*/
+auto viewManager::Element::append(Element &sibling) -> Element & {
+  treeGeneration++;
+  m_nextSibling = sibling.m_self;
+  sibling.m_parent = this->m_parent;
+  sibling.m_previousSibling = this;
+
+  if (!this->m_parent->m_firstChild)
+    this->m_parent->m_firstChild = sibling.m_self;
+
+  this->m_parent->m_lastChild = sibling.m_self;
+
+  this->m_parent->m_childCount++;
+  return (sibling);
+}
+
+/**
+  \brief The function will append the collection of elements as a
+  siblings.
+
+  \param elementCollection an ElementList of new child element that was
   previously created.
 
-  \return Element& returns the referenced element for continuation syntax.
+  \return Element& returns the referenced element for continuation syntax.
+
+  Example
+  -------
+  \snippet examples.cpp append_elementlist
+*/
+auto viewManager::Element::append(ElementList &elementCollection) -> Element & {
+  for (auto &e : elementCollection)
+    append(e);
+  return (*this);
+}
+
+/**
+\brief The function sets the given attribute inside the elements indexed
+map. Settings are filtered on specific types to determine if it is a true
+attribute or one that is filtered to be a compound. Compound attributes
+require other operations such as data insertion into the data property or
+using an official attribute object where only an enumeration value is given.
+
+\param
+setting an attribute.
+
+The following are supported filtered types:
+- char
+- double
+- float
+- int
+- std::string
+- const char *
+- std::vector<char>
+- std::vector<double>
+- std::vector<float>
+- std::vector<int>
+- std::vector<std::string>
+- std::vector<std::vector<std::string>>
+- std::vector<std::vector<std::pair<int, std::string>>>
+- std::vector<std::vector<std::pair<int, std::string>>>
+
+Example
+-------
+\snippet examples.cpp setAttribute_base
+
+*/
+Element &viewManager::Element::setAttribute(const std::any &paramSetting) {
+
+  std::any setting = paramSetting;
+  /**
+  \internal
+  \enum _enumTypeFilter
+  */
+  enum _enumTypeFilter {
+    dt_char,
+    dt_double,
+    dt_float,
+    dt_int,
+    dt_std_string,
+    dt_const_char,
+    dt_vector_char,
+    dt_vector_double,
+    dt_vector_float,
+    dt_vector_int,
+    dt_vector_string,
+    dt_vector_vector_string,
+    dt_vector_pair_int_string,
+    dt_indexBy,
+    dt_display_enum,
+    dt_position_enum,
+    dt_textAlignment_enum,
+    dt_borderStyle_enum,
+    dt_listStyleType_enum,
+    dt_viewerMode_enum,
+    dt_pixelFormat_enum,
+
+    dt_nonFiltered
+  };
+  // filter table. The addresses of the type_info objects are constant, so
+  // the table needs no initialization. The common types are first.
+  static constexpr std::pair<const std::type_info *, _enumTypeFilter>
+      typeFilter[] = {
+          {&typeid(std::string), dt_std_string},
+          {&typeid(const char *), dt_const_char},
+          {&typeid(display::optionEnum), dt_display_enum},
+          {&typeid(position::optionEnum), dt_position_enum},
+          {&typeid(textAlignment::optionEnum), dt_textAlignment_enum},
+          {&typeid(indexBy), dt_indexBy},
+          {&typeid(double), dt_double},
+          {&typeid(int), dt_int},
+          {&typeid(float), dt_float},
+          {&typeid(char), dt_char},
+          {&typeid(std::vector<std::string>), dt_vector_string},
+          {&typeid(std::vector<double>), dt_vector_double},
+          {&typeid(std::vector<float>), dt_vector_float},
+          {&typeid(std::vector<int>), dt_vector_int},
+          {&typeid(std::vector<char>), dt_vector_char},
+          {&typeid(std::vector<std::vector<std::string>>),
+           dt_vector_vector_string},
+          {&typeid(std::vector<std::vector<std::pair<int, std::string>>>),
+           dt_vector_pair_int_string},
+          {&typeid(borderStyle::optionEnum), dt_borderStyle_enum},
+          {&typeid(listStyleType::optionEnum), dt_listStyleType_enum},
+          {&typeid(viewerMode::optionEnum), dt_viewerMode_enum},
+          {&typeid(pixelFormat::optionEnum), dt_pixelFormat_enum}};
+
+  // set search result defaults for not found in filter
+  _enumTypeFilter dtFilter = dt_nonFiltered;
+  bool bSaveInMap = false;
+  for (auto &n : typeFilter)
+    if (*n.first == setting.type()) {
+      dtFilter = n.second;
+      break;
+    }
+
+  /* filter these types specifically and do not store them in the map.
+  these items change the dataAdaptor. This creates a more usable
+  syntax for population of large and small data within the
+  simple initializer list format given within the attribute list.*/
+  switch (dtFilter) {
+  case dt_char: {
+    auto v = std::any_cast<char>(setting);
+    data<char>() = std::vector<char>{v};
+  } break;
+  case dt_double: {
+    auto v = std::any_cast<double>(setting);
+    data<double>() = std::vector<double>{v};
+  } break;
+  case dt_float: {
+    auto v = std::any_cast<float>(setting);
+    data<float>() = std::vector<float>{v};
+  } break;
+  case dt_int: {
+    auto v = std::any_cast<int>(setting);
+    data<int>() = std::vector<int>{v};
+  } break;
+  case dt_const_char: {
+    auto v = std::any_cast<const char *>(setting);
+    data<std::string>() = std::vector<std::string>{v};
+  } break;
+  case dt_std_string: {
+    auto v = std::any_cast<std::string>(setting);
+    data<std::string>() = std::vector<std::string>{v};
+  } break;
+  case dt_vector_char: {
+    auto v = std::any_cast<std::vector<char>>(setting);
+    data<char>() = v;
+  } break;
+  case dt_vector_double: {
+    auto v = std::any_cast<std::vector<double>>(setting);
+    data<double>() = v;
+  } break;
+  case dt_vector_float: {
+    auto v = std::any_cast<std::vector<float>>(setting);
+    data<float>() = v;
+  } break;
+  case dt_vector_int: {
+    auto v = std::any_cast<std::vector<int>>(setting);
+    data<int>() = v;
+  } break;
+  case dt_vector_string: {
+    auto v = std::any_cast<std::vector<std::string>>(setting);
+    data<std::string>() = v;
+  } break;
+  case dt_vector_vector_string: {
+    auto v = std::any_cast<std::vector<std::vector<std::string>>>(setting);
+    data<std::vector<std::string>>() = v;
+  } break;
+  case dt_vector_pair_int_string: {
+    auto v = std::any_cast<std::vector<std::pair<int, std::string>>>(setting);
+    data<std::pair<int, std::string>>() = v;
+  } break;
+  // attributes stored in map but filtered for processing.
+  case dt_indexBy: {
+    updateIndexBy(std::any_cast<indexBy>(setting));
+    bSaveInMap = true;
+  } break;
+  case dt_display_enum: {
+    setting = display{std::any_cast<display::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+  case dt_position_enum: {
+    setting = position{std::any_cast<position::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+  case dt_textAlignment_enum: {
+    setting =
+        textAlignment{std::any_cast<textAlignment::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+  case dt_borderStyle_enum: {
+    setting = borderStyle{std::any_cast<borderStyle::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+  case dt_listStyleType_enum: {
+    setting =
+        listStyleType{std::any_cast<listStyleType::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+  case dt_viewerMode_enum: {
+    setting = viewerMode{std::any_cast<viewerMode::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+  case dt_pixelFormat_enum: {
+    setting =
+        pixelFormat{std::any_cast<pixelFormat::optionEnum>(paramSetting)};
+    bSaveInMap = true;
+  } break;
+
+  // other items are not filtered, so just pass through to storage.
+  case dt_nonFiltered: {
+    bSaveInMap = true;
+  } break;
+  }
+
+  if (bSaveInMap) {
+    // data changes above invalidate through data<T>(). Of the attributes,
+    // only the text face and size affect measurement.
+    invalidation level = attributeInvalidation(std::type_index(setting.type()));
+    if (level == invalidation::metrics)
+      invalidateMetrics();
+    else if (level == invalidation::layout)
+      layoutGeneration++;
+
+    if (computedStyle::isProperty(std::type_index(setting.type()))) {
+      detachStyle();
+      m_style->set(setting);
+    } else {
+      attributes[std::type_index(setting.type())] = setting;
+    }
+  }
+  return *this;
+}
+
+/**
+\internal
+\brief The attribute being set can be contained in an array of std::any
+Typically the caller does not use this function but relies on the
+varodic template version.
+*/
+Element &
+viewManager::Element::setAttribute(const std::vector<std::any> &attribs) {
+  for (auto n : attribs)
+    setAttribute(n);
+  return *this;
+}
+
+/**
+\internal
+
+\brief updates the id within the index if the item has changed.
+
+*/
+void viewManager::Element::updateIndexBy(const indexBy &setting) {
+  // changing id just changes
+  // the key in elementById
+  // map
+  std::string oldKey = "";
+  const std::string &newKey = setting.value;
+  auto it = attributes.find(std::type_index(typeid(indexBy)));
+
+  // get the key of the old id
+  if (it != attributes.end()) {
+    oldKey = std::any_cast<indexBy>(it->second).value;
+  }
+
+  // case a. key is not blank,
+  // yet it is the same value
+  // as the old key therefore
+  // there is no change.
+  if (!oldKey.empty() && oldKey == newKey) {
+    return;
+    // case b. remap just the
+    // key
+  } else if (!oldKey.empty() && !newKey.empty()) {
+    auto nodeHandler = indexedElements.extract(oldKey);
+    nodeHandler.key() = newKey;
+    indexedElements.insert(std::move(nodeHandler));
+    // case c. remove key from
+    // map
+  } else if (!oldKey.empty() && newKey.empty()) {
+    indexedElements.erase(oldKey);
+    // case d. did not exist
+    // before, add key to map
+  } else if (!newKey.empty()) {
+    indexedElements.insert({newKey, std::ref(*this)});
+  }
+  return;
+}
+
+/**
+\brief inserts the given element before the named second parameter.
+The version of the function is useful when the element is indexed by a
+string and a reference to it does not exist.
+
+\param Element &newChild
+
+\param std::string sID
+
+Example
+-------
+\snippet examples.cpp insertBefore_string
+*/
+auto viewManager::Element::insertBefore(Element &newChild, std::string &sID)
+    -> Element & {
+  return insertBefore(newChild, getElement(sID));
+}
+
+/**
+\brief inserts the given element before the named second parameter.
+
+\param Element &newChild
+
+\param Element &existingElement
+
+Example
+-------
+\snippet examples.cpp insertBefore
+*/
+auto viewManager::Element::insertBefore(Element &newChild,
+                                        Element &existingElement) -> Element & {
+  treeGeneration++;
+  Element &child = newChild;
+  // maintain tree structure
+  child.m_parent = existingElement.m_parent;
+  child.m_nextSibling = existingElement.m_self;
+  child.m_previousSibling = existingElement.m_previousSibling;
+  existingElement.m_previousSibling = child.m_self;
+  // provide linkage
+  if (child.m_previousSibling)
+    child.m_previousSibling->m_nextSibling = child.m_self;
+  if (child.m_nextSibling)
+    child.m_nextSibling->m_previousSibling = child.m_self;
+  // case where insert is at the first
+  if (existingElement.m_self == m_firstChild) {
+    m_firstChild = child.m_self;
+  }
+  m_childCount++;
+  return child;
+}
+
+/**
+\brief inserts the given element after the named second parameter element.
+The version of the function is useful when the element is indexed by a
+string and a reference to it does not exist.
+
+\param Element &newChild
+
+\param std::string sID
+
+Example
+-------
+\snippet examples.cpp insertAfter_string
+*/
+auto viewManager::Element::insertAfter(Element &newChild, std::string &sID)
+    -> Element & {
+  return insertAfter(newChild, getElement(sID));
+}
+
+/**
+\brief inserts the given element after the named second parameter element.
+
+\param Element &newChild
+
+\param Element &existingElement
+
+Example
+-------
+\snippet examples.cpp insertAfter
+*/
+auto viewManager::Element::insertAfter(Element &newChild,
+                                       Element &existingElement) -> Element & {
+  treeGeneration++;
+
+  // maintain tree structure
+  newChild.m_parent = existingElement.m_parent;
+  newChild.m_nextSibling = existingElement.m_previousSibling;
+  newChild.m_previousSibling = existingElement.m_self;
+  if (existingElement.m_nextSibling)
+    existingElement.m_nextSibling->m_previousSibling = newChild.m_self;
+
+  existingElement.m_nextSibling = newChild.m_self;
+
+  // case where insert is at the end
+  if (existingElement.m_self == m_lastChild) {
+    m_lastChild = newChild.m_self;
+  }
+  m_childCount++;
+  return newChild;
+}
+
+/**
+\brief replaces the child with the new one specified.
+\details The function replaces the reference child with the new one
+selected. The ne child should be within the first parameter while the second
+parameter should contain an existing child. When the oldChild is replaced,
+it is removed from the indexBy list and its memory is freed.
+
+\param Element& newChild a newly created child.
+\param std::string& sID an existing child that is to be replaced.
+
+Example
+-------
+\snippet examples.cpp replaceChild_string
+*/
+auto viewManager::Element::replaceChild(Element &newChild, std::string &sID)
+    -> Element & {
+  return replaceChild(newChild, getElement(sID));
+}
+
+/**
+\brief replaces the child with the new one specified.
+\details The function replaces the reference child with the new one
+selected. The new child should be within the first parameter while the
+second parameter should contain an existing child. When the oldChild is
+replaced, it is removed from the indexBy list and its memory is freed.
+
+\param Element& newChild a newly created child.
+\param Element& oldChild an existing child that is to be replaced.
+
+Example
+-------
+\snippet examples.cpp replaceChild
+*/
+auto viewManager::Element::replaceChild(Element &newChild, Element &oldChild)
+    -> Element & {
+  treeGeneration++;
+
+  // unattach the old one and insert the new one
+  if (oldChild.m_parent->m_firstChild == oldChild.m_self)
+    oldChild.m_parent->m_firstChild = newChild.m_self;
+
+  if (oldChild.m_parent->m_lastChild == oldChild.m_self)
+    oldChild.m_parent->m_lastChild = newChild.m_self;
+
+  if (oldChild.m_previousSibling)
+    oldChild.m_previousSibling->m_nextSibling = newChild.m_self;
+
+  if (oldChild.m_nextSibling)
+    oldChild.m_nextSibling->m_previousSibling = newChild.m_self;
+
+  newChild.m_parent = oldChild.m_parent;
+
+  // remove reference from string id indexed list
+  try {
+    indexedElements.erase(oldChild.getAttribute<indexBy>().value);
+
+  } catch (const std::exception &e) {
+    // std::cout << " Exception: " << e.what() << "\n";
+  }
+
+  // remove the element smart pointer
+  auto it = elements.find((std::size_t)oldChild.m_self);
+  if (it != elements.end())
+    elements.erase(it);
+
+  return *this;
+}
+
+/**
+\internal
+\brief compares two attributes of the same type.
+*/
+template <typename T>
+static bool attributeEqual(const std::any &a, const std::any &b) {
+  return std::any_cast<const T &>(a) == std::any_cast<const T &>(b);
+}
+
+#define ATTRIBUTE_COMPARATOR(NAME)                                             \
+  { std::type_index(typeid(NAME)), attributeEqual<NAME> }
+
+/**
+\internal
+\var attributeComparators holds the comparison of each attribute type that
+patch reconciles. Attributes of other types, such as the document state,
+are taken from the fragment when given and otherwise left alone.
+*/
+static const std::unordered_map<std::type_index,
+                                bool (*)(const std::any &, const std::any &)>
+    attributeComparators = {
+        ATTRIBUTE_COMPARATOR(indexBy),       ATTRIBUTE_COMPARATOR(display),
+        ATTRIBUTE_COMPARATOR(position),      ATTRIBUTE_COMPARATOR(objectTop),
+        ATTRIBUTE_COMPARATOR(objectLeft),    ATTRIBUTE_COMPARATOR(objectHeight),
+        ATTRIBUTE_COMPARATOR(objectWidth),   ATTRIBUTE_COMPARATOR(scrollTop),
+        ATTRIBUTE_COMPARATOR(scrollLeft),    ATTRIBUTE_COMPARATOR(background),
+        ATTRIBUTE_COMPARATOR(opacity),       ATTRIBUTE_COMPARATOR(textFace),
+        ATTRIBUTE_COMPARATOR(textSize),      ATTRIBUTE_COMPARATOR(textWeight),
+        ATTRIBUTE_COMPARATOR(textColor),     ATTRIBUTE_COMPARATOR(textAlignment),
+        ATTRIBUTE_COMPARATOR(textIndent),    ATTRIBUTE_COMPARATOR(tabSize),
+        ATTRIBUTE_COMPARATOR(lineHeight),    ATTRIBUTE_COMPARATOR(marginTop),
+        ATTRIBUTE_COMPARATOR(marginLeft),    ATTRIBUTE_COMPARATOR(marginBottom),
+        ATTRIBUTE_COMPARATOR(marginRight),   ATTRIBUTE_COMPARATOR(paddingTop),
+        ATTRIBUTE_COMPARATOR(paddingLeft),   ATTRIBUTE_COMPARATOR(paddingBottom),
+        ATTRIBUTE_COMPARATOR(paddingRight),  ATTRIBUTE_COMPARATOR(borderStyle),
+        ATTRIBUTE_COMPARATOR(borderWidth),   ATTRIBUTE_COMPARATOR(borderColor),
+        ATTRIBUTE_COMPARATOR(borderRadius),  ATTRIBUTE_COMPARATOR(focusIndex),
+        ATTRIBUTE_COMPARATOR(zIndex),        ATTRIBUTE_COMPARATOR(listStyleType),
+        ATTRIBUTE_COMPARATOR(windowTitle)};
+
+/**
+\internal
+\brief true for attributes with a format or unit within an option member.
+*/
+template <typename T, typename = void>
+struct hasOptionMember : std::false_type {};
+template <typename T>
+struct hasOptionMember<T, std::void_t<decltype(T::option)>> : std::true_type {};
+
+/**
+\internal
+\brief hashes the value of a style property, and its format or unit when
+it has one.
+*/
+template <typename T> static std::size_t styleHash(const std::any &a) {
+  const T &v = std::any_cast<const T &>(a);
+  typedef decltype(T::value) valueType;
+  std::size_t h = 0;
+
+  if constexpr (std::is_same_v<valueType, std::string>) {
+    h = std::hash<std::string>{}(v.value);
+  } else if constexpr (std::is_same_v<valueType, std::array<double, 4>>) {
+    for (auto d : v.value)
+      h = h * 31 + std::hash<double>{}(d);
+  } else {
+    h = std::hash<double>{}(static_cast<double>(v.value));
+  }
+
+  if constexpr (hasOptionMember<T>::value)
+    h = h * 31 + static_cast<std::size_t>(v.option);
+  return h;
+}
+
+/**
+\internal
+\brief the comparison and hash of each style property.
+*/
+typedef struct {
+  bool (*equal)(const std::any &, const std::any &);
+  std::size_t (*hash)(const std::any &);
+} stylePropertyFunctions;
+
+#define STYLE_PROPERTY_ENTRY(NAME)                                             \
+  {std::type_index(typeid(NAME)), {attributeEqual<NAME>, styleHash<NAME>}},
+
+static const std::unordered_map<std::type_index, stylePropertyFunctions>
+    styleProperties = {STYLE_PROPERTIES(STYLE_PROPERTY_ENTRY)};
+
+/**
+\internal
+\brief returns true when the attribute type is held by the computed style.
+*/
+bool viewManager::computedStyle::isProperty(const std::type_index &tIndex) {
+  return styleProperties.find(tIndex) != styleProperties.end();
+}
+
+/**
+\internal
+\brief sets a property. The record must not be shared.
+*/
+void viewManager::computedStyle::set(const std::any &setting) {
+  m_properties[std::type_index(setting.type())] = setting;
+  m_text.reset();
+}
+
+/**
+\internal
+\brief hashes the properties. The order of the map does not change the
+result.
+*/
+std::size_t viewManager::computedStyle::hash(void) const {
+  std::size_t h = m_properties.size();
+  for (auto &n : m_properties) {
+    std::size_t v = styleProperties.at(n.first).hash(n.second);
+    h += (n.first.hash_code() ^ (v + 0x9e3779b97f4a7c15ULL + (v << 6))) *
+         0xff51afd7ed558ccdULL;
+  }
+  return h;
+}
+
+bool viewManager::computedStyle::operator==(const computedStyle &other) const {
+  if (m_properties.size() != other.m_properties.size())
+    return false;
+
+  for (auto &n : m_properties) {
+    auto it = other.m_properties.find(n.first);
+    if (it == other.m_properties.end() ||
+        !styleProperties.at(n.first).equal(n.second, it->second))
+      return false;
+  }
+  return true;
+}
+
+/**
+\internal
+\brief returns the text face, size, line height, color and alignment with
+the defaults for those not given. They are resolved once for the record.
+*/
+const viewManager::resolvedTextStyle &
+viewManager::computedStyle::text(void) const {
+  if (m_text)
+    return *m_text;
+
+  resolvedTextStyle ts{DEFAULT_TEXTFACE, DEFAULT_TEXTSIZE, 1.0,
+                       DEFAULT_TEXTCOLOR, textAlignment::left};
+
+  if (auto face = find<textFace>())
+    ts.sTextFace = face->value;
+
+  if (auto size = find<textSize>())
+    ts.dTextSize = textSize(*size).toPt();
+
+  // the line height is given in a decimal range.
+  if (auto lh = find<lineHeight>())
+    if (lh->option == lineHeight::normal)
+      ts.dLineHeight = lh->value;
+
+  if (auto color = find<textColor>())
+    ts.textColor = (static_cast<int>(color->value[0]) << 16) |
+                   (static_cast<int>(color->value[1]) << 8) |
+                   static_cast<int>(color->value[2]);
+
+  if (auto align = find<textAlignment>())
+    ts.alignment = align->value;
+
+  m_text = ts;
+  return *m_text;
+}
+
+/**
+\internal
+\brief returns the record of the thread equal to the style, which is
+added when there is none. Entries of records no longer used are removed
+as the table grows.
+*/
+std::shared_ptr<viewManager::computedStyle>
+viewManager::internStyle(const std::shared_ptr<computedStyle> &style) {
+  static thread_local std::size_t sweepSize = 64;
+
+  std::size_t h = style->hash();
+  auto range = internedStyles.equal_range(h);
+  for (auto it = range.first; it != range.second; it++) {
+    auto shared = it->second.lock();
+    if (shared && *shared == *style)
+      return shared;
+  }
+
+  if (internedStyles.size() >= sweepSize) {
+    for (auto it = internedStyles.begin(); it != internedStyles.end();)
+      it = it->second.expired() ? internedStyles.erase(it) : std::next(it);
+    sweepSize = std::max<std::size_t>(64, internedStyles.size() * 2);
+  }
+
+  internedStyles.emplace(h, style);
+  return style;
+}
+
+/**
+\internal
+\brief shares the style of the element with the elements of equal style.
+Called for each element when the layout begins.
+*/
+void viewManager::Element::resolveStyle(void) {
+  if (m_style && !m_bStyleShared) {
+    m_style = internStyle(m_style);
+    m_bStyleShared = true;
+  }
+}
+
+/**
+\brief returns the computed style of the element, resolving it first.
+Elements without style properties return an empty record.
+*/
+const viewManager::computedStyle &viewManager::Element::style(void) {
+  static thread_local const computedStyle emptyStyle;
+
+  resolveStyle();
+  return m_style ? *m_style : emptyStyle;
+}
+
+/**
+\internal
+\brief gives the element its own copy of a shared style so that it may be
+changed.
+*/
+void viewManager::Element::detachStyle(void) {
+  if (!m_style)
+    m_style = std::make_shared<computedStyle>();
+  else if (m_bStyleShared)
+    m_style = std::make_shared<computedStyle>(*m_style);
+  m_bStyleShared = false;
+}
+
+/**
+\brief reconciles the element with a newly built fragment of the same
+shape.
+\details The fragment is typically built again from application data. Rather
+than replacing the existing tree, the two trees are compared. Children are
+matched by their indexBy key, or otherwise by type in order. Matched
+elements keep their identity, word metrics and layout, taking only the
+attributes and data that differ. Children of the fragment without a match
+are moved into the tree, and existing children without a match are
+removed. The fragment is consumed by the call.
+
+When the element and the fragment differ in type, the fragment replaces
+the element.
+
+\param Element& newFragment the tree holding the desired state.
+\return Element& the element that now holds the state.
+
+\exception std::invalid_argument is thrown when the types differ and the
+element has no parent to replace it within.
+*/
+auto viewManager::Element::patch(Element &newFragment) -> Element & {
+  treeGeneration++;
+  if (&newFragment == this)
+    return *this;
+
+  if (typeid(*this) != typeid(newFragment)) {
+    if (!m_parent) {
+      std::string info = "The element cannot be replaced by a fragment of a "
+                         "different type since it has no parent.";
+      throw std::invalid_argument(info);
+    }
+    m_parent->replaceChild(newFragment, *this);
+    return newFragment;
+  }
+
+  patchAttributes(newFragment);
+  patchData(newFragment);
+  patchChildren(newFragment);
+
+  // unlink the fragment root when it was attached somewhere.
+  if (Element *p = newFragment.m_parent) {
+    if (p->m_firstChild == newFragment.m_self)
+      p->m_firstChild = newFragment.m_nextSibling;
+    if (p->m_lastChild == newFragment.m_self)
+      p->m_lastChild = newFragment.m_previousSibling;
+    if (newFragment.m_previousSibling)
+      newFragment.m_previousSibling->m_nextSibling = newFragment.m_nextSibling;
+    if (newFragment.m_nextSibling)
+      newFragment.m_nextSibling->m_previousSibling =
+          newFragment.m_previousSibling;
+    p->m_childCount--;
+  }
+  releasePatched(newFragment, false);
+
+  return *this;
+}
+
+/**
+\internal
+\brief takes the attributes of the fragment element that differ. The id of
+the fragment element is released first so that this element may take it.
+Attributes of known types that the fragment does not have are removed.
+*/
+void viewManager::Element::patchAttributes(Element &fresh) {
+  bool bChanged = false;
+
+  auto itIndex = fresh.attributes.find(std::type_index(typeid(indexBy)));
+  if (itIndex != fresh.attributes.end()) {
+    auto itKey =
+        indexedElements.find(std::any_cast<indexBy &>(itIndex->second).value);
+    if (itKey != indexedElements.end() &&
+        itKey->second.get().m_self == fresh.m_self)
+      indexedElements.erase(itKey);
+  }
+
+  for (auto &n : fresh.attributes) {
+    auto it = attributes.find(n.first);
+    auto itCompare = attributeComparators.find(n.first);
+    if (it != attributes.end() && itCompare != attributeComparators.end() &&
+        itCompare->second(it->second, n.second))
+      continue;
+
+    setAttribute(n.second);
+    bChanged = true;
+  }
+
+  for (auto it = attributes.begin(); it != attributes.end();) {
+    if (fresh.attributes.find(it->first) == fresh.attributes.end() &&
+        attributeComparators.find(it->first) != attributeComparators.end()) {
+      if (it->first == std::type_index(typeid(indexBy))) {
+        auto itKey =
+            indexedElements.find(std::any_cast<indexBy &>(it->second).value);
+        if (itKey != indexedElements.end() &&
+            itKey->second.get().m_self == m_self)
+          indexedElements.erase(itKey);
+      }
+      it = attributes.erase(it);
+      bChanged = true;
+    } else {
+      it++;
+    }
+  }
+
+  // the style is taken whole when any property differs.
+  bool bSameStyle = fresh.m_style && m_style
+                        ? *fresh.m_style == *m_style
+                        : (!fresh.m_style || fresh.m_style->empty()) &&
+                              (!m_style || m_style->empty());
+  if (!bSameStyle) {
+    m_style = fresh.m_style;
+    m_bStyleShared = fresh.m_bStyleShared;
+    fresh.m_style.reset();
+    bChanged = true;
+  }
+
+  // the fragment element no longer holds an id.
+  fresh.attributes.erase(std::type_index(typeid(indexBy)));
+
+  if (bChanged)
+    invalidateMetrics();
+}
+
+/**
+\internal
+\brief takes the data of the fragment element that differs. Data types the
+fragment does not have are cleared.
+*/
+void viewManager::Element::patchData(Element &fresh) {
+  bool bChanged = false;
+
+  for (auto &n : fresh.m_usageAdaptorMap) {
+    if (n.first == typeid(textArena))
+      bChanged |= patchTextRows(fresh);
+    else if (n.first == typeid(std::vector<std::string>))
+      bChanged |= patchDataAdaptor<std::string>(fresh);
+    else if (n.first == typeid(std::vector<double>))
+      bChanged |= patchDataAdaptor<double>(fresh);
+    else if (n.first == typeid(std::vector<float>))
+      bChanged |= patchDataAdaptor<float>(fresh);
+    else if (n.first == typeid(std::vector<int>))
+      bChanged |= patchDataAdaptor<int>(fresh);
+    else if (n.first == typeid(std::vector<char>))
+      bChanged |= patchDataAdaptor<char>(fresh);
+    else {
+      // types that cannot be compared are taken
+      m_usageAdaptorMap[n.first] = std::move(n.second);
+      bChanged = true;
+    }
+  }
+
+  for (auto it = m_usageAdaptorMap.begin(); it != m_usageAdaptorMap.end();) {
+    if (fresh.m_usageAdaptorMap.find(it->first) ==
+        fresh.m_usageAdaptorMap.end()) {
+      it = m_usageAdaptorMap.erase(it);
+      bChanged = true;
+    } else {
+      it++;
+    }
+  }
+
+  if (bChanged)
+    invalidateMetrics();
+}
+
+/**
+\internal
+\brief takes the data of type T from the fragment element when it differs.
+\return true when the data was taken.
+*/
+template <typename T>
+bool viewManager::Element::patchDataAdaptor(Element &fresh) {
+  auto tIndex = std::type_index(typeid(std::vector<T>));
+  auto &freshAdaptor =
+      std::any_cast<usageAdaptor<T> &>(fresh.m_usageAdaptorMap[tIndex]);
+
+  auto it = m_usageAdaptorMap.find(tIndex);
+  if (it != m_usageAdaptorMap.end() &&
+      std::any_cast<usageAdaptor<T> &>(it->second).data() ==
+          freshAdaptor.data())
+    return false;
+
+  m_usageAdaptorMap[tIndex] = std::move(fresh.m_usageAdaptorMap[tIndex]);
+  return true;
+}
+
+/**
+\internal
+\brief takes the text rows from the fragment element when they differ.
+\return true when the rows were taken.
+*/
+bool viewManager::Element::patchTextRows(Element &fresh) {
+  auto tIndex = std::type_index(typeid(textArena));
+  auto &freshRows =
+      std::any_cast<textArena &>(fresh.m_usageAdaptorMap[tIndex]);
+
+  auto it = m_usageAdaptorMap.find(tIndex);
+  if (it != m_usageAdaptorMap.end() &&
+      std::any_cast<textArena &>(it->second) == freshRows)
+    return false;
+
+  m_usageAdaptorMap[tIndex] = std::move(fresh.m_usageAdaptorMap[tIndex]);
+  return true;
+}
+
+/**
+\internal
+\brief reconciles the children with those of the fragment element. The
+sibling links are rebuilt in the order of the fragment, so moving an
+element does not create it again.
+*/
+void viewManager::Element::patchChildren(Element &fresh) {
+  std::unordered_map<std::string, Element *> keyed;
+  std::unordered_map<std::type_index, std::deque<Element *>> unkeyed;
+
+  auto keyOf = [](Element *e) {
+    auto it = e->attributes.find(std::type_index(typeid(indexBy)));
+    return it == e->attributes.end()
+               ? std::string()
+               : std::any_cast<indexBy &>(it->second).value;
+  };
+
+  for (Element *p = m_firstChild; p; p = p->m_nextSibling) {
+    std::string sKey = keyOf(p);
+    if (sKey.empty())
+      unkeyed[std::type_index(typeid(*p))].push_back(p);
+    else
+      keyed[sKey] = p;
+  }
+
+  std::vector<Element *> freshChildren;
+  for (Element *p = fresh.m_firstChild; p; p = p->m_nextSibling)
+    freshChildren.push_back(p);
+
+  std::vector<Element *> order;
+  std::vector<Element *> moved;
+  for (Element *f : freshChildren) {
+    Element *match = nullptr;
+    std::string sKey = keyOf(f);
+
+    if (!sKey.empty()) {
+      auto it = keyed.find(sKey);
+      if (it != keyed.end() && typeid(*it->second) == typeid(*f)) {
+        match = it->second;
+        keyed.erase(it);
+      }
+    } else {
+      auto it = unkeyed.find(std::type_index(typeid(*f)));
+      if (it != unkeyed.end() && !it->second.empty()) {
+        match = it->second.front();
+        it->second.pop_front();
+      }
+    }
+
+    if (match) {
+      match->patchAttributes(*f);
+      match->patchData(*f);
+      match->patchChildren(*f);
+      releasePatched(*f, false);
+      order.push_back(match);
+    } else {
+      order.push_back(f);
+      moved.push_back(f);
+    }
+  }
+
+  // existing children without a match are removed.
+  for (auto &n : keyed)
+    releasePatched(*n.second, true);
+  for (auto &n : unkeyed)
+    for (Element *p : n.second)
+      releasePatched(*p, true);
+
+  // rebuild the sibling links in the new order.
+  m_firstChild = nullptr;
+  m_lastChild = nullptr;
+  m_childCount = 0;
+  for (Element *p : order) {
+    p->m_parent = m_self;
+    p->m_previousSibling = m_lastChild;
+    p->m_nextSibling = nullptr;
+    if (m_lastChild)
+      m_lastChild->m_nextSibling = p;
+    else
+      m_firstChild = p;
+    m_lastChild = p;
+    m_childCount++;
+  }
+
+  fresh.m_firstChild = nullptr;
+  fresh.m_lastChild = nullptr;
+  fresh.m_childCount = 0;
+
+  // ids of moved elements may have been erased with removed ones.
+  for (Element *p : moved)
+    indexSubtree(*p);
+}
+
+/**
+\internal
+\brief frees an element that patch no longer uses. Its id is erased only
+when the index refers to it. With bSubtree, the children are freed too,
+otherwise they have already been moved or freed.
+*/
+void viewManager::Element::releasePatched(Element &e, bool bSubtree) {
+  treeGeneration++;
+  if (bSubtree)
+    e.removeChildren();
+
+  auto it = e.attributes.find(std::type_index(typeid(indexBy)));
+  if (it != e.attributes.end()) {
+    auto itKey =
+        indexedElements.find(std::any_cast<indexBy &>(it->second).value);
+    if (itKey != indexedElements.end() &&
+        itKey->second.get().m_self == e.m_self)
+      indexedElements.erase(itKey);
+  }
+
+  auto itElement = elements.find((std::size_t)e.m_self);
+  if (itElement != elements.end())
+    elements.erase(itElement);
+}
+
+/**
+\internal
+\brief places the ids of the element and its descendants within the index.
+*/
+void viewManager::Element::indexSubtree(Element &e) {
+  auto it = e.attributes.find(std::type_index(typeid(indexBy)));
+  if (it != e.attributes.end()) {
+    auto &sKey = std::any_cast<indexBy &>(it->second).value;
+    if (!sKey.empty())
+      indexedElements.insert_or_assign(sKey, std::ref(e));
+  }
+
+  for (Element *p = e.m_firstChild; p; p = p->m_nextSibling)
+    indexSubtree(*p);
+}
+
+/**
+\brief copies the element, and with bDeep its descendants, as a new tree
+that is not yet within the document.
+\details Each element is copied as the type it was created as, taking its
+attributes, data, styles and word metrics. Elements of the same style share
+one style record, and the copied word metrics let the first layout of the
+copy skip measuring text. Listeners are not copied.
+
+The indexBy ids of the copies are given sIdSuffix and placed within the
+index. When sIdSuffix is empty, the copies have no id, so the index keeps
+referring to the original elements.
+
+\param bool bDeep copies the descendants as well.
+\param std::string& sIdSuffix appended to the ids of the copies.
+\return Element& the copy of the element, to be inserted into the
+document.
+
+\exception std::invalid_argument is thrown when an element of the tree was
+not made by createElement, such as the Viewer.
+
+Example
+-------
+\snippet examples.cpp clone
+*/
+auto viewManager::Element::clone(const bool bDeep,
+                                 const std::string &sIdSuffix) -> Element & {
+  if (!m_fnClone)
+    throw std::invalid_argument("the element cannot be cloned");
+
+  // the tree is checked and counted first so that the storage grows once
+  // and a failure leaves nothing behind.
+  std::size_t nCount = 1;
+  for (const Element *p = bDeep ? m_firstChild : nullptr; p;) {
+    if (!p->m_fnClone)
+      throw std::invalid_argument("the element cannot be cloned");
+    nCount++;
+    if (p->m_firstChild) {
+      p = p->m_firstChild;
+    } else {
+      while (p != this && !p->m_nextSibling)
+        p = p->m_parent;
+      p = p == this ? nullptr : p->m_nextSibling;
+    }
+  }
+  elements.reserve(elements.size() + nCount);
+
+  Element &root = m_fnClone(*this);
+  root.cloneIndexBy(sIdSuffix);
+  if (!bDeep)
+    return root;
+
+  // each copy is linked at the end of its parent's copy as it is made, so
+  // the links are complete after the one walk.
+  std::vector<std::pair<const Element *, Element *>> pending;
+  pending.reserve(nCount);
+  pending.emplace_back(this, &root);
+  while (!pending.empty()) {
+    auto [pSource, pParent] = pending.back();
+    pending.pop_back();
+    for (const Element *p = pSource->m_firstChild; p; p = p->m_nextSibling) {
+      Element &copy = p->m_fnClone(*p);
+      copy.cloneIndexBy(sIdSuffix);
+      copy.m_parent = pParent;
+      copy.m_previousSibling = pParent->m_lastChild;
+      if (pParent->m_lastChild)
+        pParent->m_lastChild->m_nextSibling = &copy;
+      else
+        pParent->m_firstChild = &copy;
+      pParent->m_lastChild = &copy;
+      pParent->m_childCount++;
+      if (p->m_firstChild)
+        pending.emplace_back(p, &copy);
+    }
+  }
+  return root;
+}
+
+/**
+\internal
+\brief gives the copied id of a cloned element the suffix and indexes it,
+or removes the id when there is no suffix.
+*/
+void viewManager::Element::cloneIndexBy(const std::string &sIdSuffix) {
+  auto it = attributes.find(std::type_index(typeid(indexBy)));
+  if (it == attributes.end())
+    return;
+
+  auto &sKey = std::any_cast<indexBy &>(it->second).value;
+  if (sIdSuffix.empty() || sKey.empty()) {
+    attributes.erase(it);
+    return;
+  }
+  sKey += sIdSuffix;
+  indexedElements.insert_or_assign(sKey, std::ref(*this));
+}
+
+/**
+\brief the token for tasks working for the element. It is cancelled when
+the element is removed, which drops its queued tasks and the functions
+given to runOnUiThread with it.
+
+Example
+-------
+\snippet examples.cpp executor
+*/
+cancellationToken viewManager::Element::taskToken(void) {
+  if (!m_tasks.cancellable())
+    m_tasks = cancellationToken::create();
+  return m_tasks;
+}
+
+/**
+\brief moves the element to the specified location.
+\details The method provides a shortened call to move both coordinates
+at the same time. The objectTop and objectLeft are set. The method accepts
+numerical values and only sets the value of the attribute. It does not
+change the numerical format of the underlying attribute values.
+
+Example
+-------
+\snippet examples.cpp move
+*/
+auto viewManager::Element::move(const double t, const double l) -> Element & {
+  getAttribute<objectTop>().value = t;
+  getAttribute<objectLeft>().value = l;
+  return *this;
+}
+
+/**
+\brief resizes the element
+\details The method provides a shortened call to resize an element.
+The objectWidth and objectHeight are set at the same time. The method
+accepts numerical values and only sets the value of the attribute. It does
+not change the numerical format of the underlying attribute values.
+
+Example
+-------
+\snippet examples.cpp resize
+*/
+auto viewManager::Element::resize(const double w, const double h) -> Element & {
+  getAttribute<objectWidth>().value = w;
+  getAttribute<objectHeight>().value = h;
+  return *this;
+}
+
+/**
+\brief removes the element from the document tree and free the memory
+associated.
+
+\details The remove method provides an easy method to delete an
+object from the document hierarchy. The method does not provide continuation
+syntax as after the call is complete, all memory associated with the object
+will be freed. The indexBy list is also modified to update the change.
+
+Example
+-------
+\snippet examples.cpp remove
+*/
+void viewManager::Element::remove(void) {
+  treeGeneration++;
+  // recursively remove all children
+  removeChildren();
+
+  // update tree linkage
+  if (m_parent && m_parent->m_firstChild == m_self)
+    m_parent->m_firstChild = m_nextSibling;
+
+  if (m_parent && m_parent->m_lastChild == m_self)
+    m_parent->m_lastChild = m_previousSibling;
+
+  if (m_nextSibling)
+    m_nextSibling->m_previousSibling = m_previousSibling;
+
+  if (m_previousSibling)
+    m_previousSibling->m_nextSibling = m_nextSibling;
+
+#if defined(USE_LAZY_MARKUP)
+  if (m_parent && dynamic_cast<deferredMarkup *>(this))
+    m_parent->m_deferredChildren--;
+#endif
+
+  // remove reference from string id indexed list
+  try {
+    indexedElements.erase(getAttribute<indexBy>().value);
+
+  } catch (const std::exception &e) {
+    // std::cout << " Exception: " << e.what() << "\n";
+  }
+
+  // free smart pointer
+  auto it = elements.find((std::size_t)m_self);
+  if (it != elements.end())
+    elements.erase(it);
+
+  return;
+}
+
+/**
+\brief removes a child element from the list and free the associated memory.
+\param std::string& isID is an existing child of the referenced element to
+remove.
+
+\details The removeChild destroys an existing child element of a document
+tree. After the function completes, all associated reference within the
+system will be discontinued. This includes the smart pointer and the indexBy
+list.
+
+\exception std::invalid_argument may be thrown if the element is not found
+by the given id or the referenced element is not a child.
+
+Example
+-------
+\snippet examples.cpp removeChild_string
+*/
+auto viewManager::Element::removeChild(std::string &sID) -> Element & {
+  return removeChild(getElement(sID));
+}
+
+/**
+\brief removes a child element from the list and free the associated memory.
+\param Element& oldChild is an existing child of the referenced element to
+remove.
+
+\details The removeChild destroys an existing child element of a document
+tree. After the function completes, all associated reference within the
+system will be discontinued. This includes the smart pointer and the indexBy
+list.
+
+\exception std::invalid_argument may be thrown if the element is not a
+child. Example
+-------
+\snippet examples.cpp removeChild
+*/
+auto viewManager::Element::removeChild(Element &oldChild) -> Element & {
+  treeGeneration++;
+  // only remove children that are attached to the object
+  if (oldChild.m_parent != m_self) {
+    std::string info = "Referenced element is not a child.";
+    throw std::invalid_argument(info);
+  }
+
+  // recursively remove children
+  auto pItem = oldChild.m_firstChild;
+  while (pItem) {
+    pItem->removeChild(*pItem);
+    pItem = pItem->m_nextSibling;
+  }
+
+  // modify tree linkage
+  if (m_firstChild == oldChild.m_self) {
+    m_firstChild = oldChild.m_nextSibling;
+  }
+
+  if (m_lastChild == oldChild.m_self) {
+    m_lastChild = oldChild.m_previousSibling;
+  }
+
+  if (oldChild.m_previousSibling)
+    oldChild.m_previousSibling->m_nextSibling = oldChild.m_nextSibling;
+
+  if (oldChild.m_nextSibling)
+    oldChild.m_nextSibling->m_previousSibling = oldChild.m_previousSibling;
+
+  // update string index list
+  try {
+    indexedElements.erase(oldChild.getAttribute<indexBy>().value);
+
+  } catch (const std::exception &e) {
+    // std::cout << " Exception: " << e.what() << "\n";
+  }
+
+#if defined(USE_LAZY_MARKUP)
+  if (dynamic_cast<deferredMarkup *>(&oldChild))
+    m_deferredChildren--;
+#endif
+
+  // free memory
+  auto it = elements.find((std::size_t)oldChild.m_self);
+  if (it != elements.end())
+    elements.erase(it);
+
+  m_childCount--;
+  return *this;
+}
+
+/**
+\brief removes all children from the document tree associated with the given
+element and free the memory.
+\details The removeChild is a bulk operation function in which all
+child document elements of the referenced element is freed. After the
+function completes, all associated references will not longer be tracked
+within the system.
+
+Example
+-------
+\snippet examples.cpp removeChildren
+
+*/
+auto viewManager::Element::removeChildren(void) -> Element & {
+  treeGeneration++;
+
+  auto pItem = m_firstChild;
+  while (pItem) {
+    std::size_t storageKey = (std::size_t)pItem;
+    if (pItem->m_childCount)
+      pItem->removeChildren();
+
+    // update string index list
+    try {
+      indexedElements.erase(pItem->getAttribute<indexBy>().value);
+
+    } catch (const std::exception &e) {
+      // std::cout << " Exception: " << e.what() << "\n";
+    }
+
+    // free memory
+    pItem = pItem->m_nextSibling;
+    auto it = elements.find(storageKey);
+    if (it != elements.end())
+      elements.erase(it);
+  }
+
+  // update linkage
+  m_firstChild = nullptr;
+  m_lastChild = nullptr;
+  m_childCount = 0;
+#if defined(USE_LAZY_MARKUP)
+  m_deferredChildren = 0;
+#endif
+
+  return *this;
+}
+
+/**
+\brief The function removes all children and data from the
+the element. All memory for each of the elements is freed.
+
+\details The clear method is a bulk operation that removes
+all associated data within the public data members as well as
+all manually document elements. It should be noted that
+all of the data() adapters are erased.
+
+Example
+-------
+\snippet examples.cpp clear
+*/
+auto viewManager::Element::clear(void) -> Element & {
+  invalidateMetrics();
+  // delete all items in the dat vector
+  auto n = m_usageAdaptorMap.begin();
+  while (n != m_usageAdaptorMap.end())
+    n = m_usageAdaptorMap.erase(n);
+
+  removeChildren();
+  return *this;
+}
+
+/**
+\internal
+
+\brief The function maps the event id to the appropriate vector of the
+element.
+
+\param eventType evtType
+*/
+vector<eventHandler> &viewManager::Element::getEventVector(eventType evtType) {
+  switch (evtType) {
+  case eventType::focus:
+    return onfocus;
+  case eventType::blur:
+    return onblur;
+  case eventType::resize:
+    return onresize;
+  case eventType::keydown:
+    return onkeydown;
+  case eventType::keyup:
+    return onkeyup;
+  case eventType::keypress:
+    return onkeypress;
+  case eventType::mouseenter:
+    return onmouseenter;
+  case eventType::mouseleave:
+    return onmouseleave;
+  case eventType::mousemove:
+    return onmousemove;
+  case eventType::mousedown:
+    return onmousedown;
+  case eventType::mouseup:
+    return onmouseup;
+  case eventType::click:
+    return onclick;
+  case eventType::dblclick:
+    return ondblclick;
+  case eventType::contextmenu:
+    return oncontextmenu;
+  case eventType::wheel:
+    return onwheel;
+  default:
+    throw std::invalid_argument("Element events do not include this type.");
+  }
+}
+/**
+\internal
+\brief
+The function will return the address of a std::function for the purposes
+of equality testing. Function from
+https://stackoverflow.com/questions/20833453/comparing-stdfunctions-for-equality
+
+*/
+template <typename T, typename... U>
+size_t getAddress(std::function<T(U...)> f) {
+  typedef T(fnType)(U...);
+  fnType **fnPointer = f.template target<fnType *>();
+  return (size_t)*fnPointer;
+}
+
+/**
+\brief adds a new event handler to the element.
+\param eventType - the type of event to associate the handler with.
+\param eventHandler - the std::function to invoke when the event occurs
+within the system.
+
+\details The addListener function provides an method for attaching
+an event handler with a event of the referenced element. The
+method accepts a function as its eventHandler. This is a std::function
+which may be a lambda, or a function pointer. The following events
+are accepted:
+
+\copydoc viewManager::eventType
+
+Example
+-------
+\snippet examples.cpp addListener
+
+*/
+auto viewManager::Element::addListener(eventType evtType,
+                                       eventHandler evtHandler) -> Element & {
+  getEventVector(evtType).push_back(evtHandler);
+  return *this;
+}
+
+/**
+
+\brief The function is invoked when an event occurrs. Normally this occurs
+from the platform device. However, this may be invoked by the soft
+generation of events.
+
+*/
+void viewManager::Element::dispatch(const event &e) {
+  auto &v = getEventVector(e.evtType);
+  for (auto &fn : v)
+    fn(e);
+}
+
+/**
+\brief removes dispatching of an event to the caller.
+<summary>The function will remove an event listener from the list of
+events to receive messages.</summary>
+
+\param evtType is the type of event to remove.</param>
+\param evtHandler is the event to remove.?</param>
+
+Example
+-------
+\snippet examples.cpp removeListener
+
+*/
+auto viewManager::Element::removeListener(eventType evtType,
+                                          eventHandler evtHandler)
+    -> Element & {
+  auto &eventList = getEventVector(evtType);
+  auto it = eventList.begin();
+  while (it != eventList.end()) {
+    if (getAddress(*it) == getAddress(evtHandler))
+      it = eventList.erase(it);
+    else
+      it++;
+  }
+  return *this;
+}
+
+/**
+\internal
+\brief The function provides the calculation of all word break by
+recording the index of spaces. This is used by the layout system
+to determine where to wrap text based upon the font metrics. The function
+also provides measurement in pixels of textual data based upon the font.
+The routine measureTextWidth within the devie object is used for this. The
+routine stores the results in an unordered_map indexed by the typeid.
+A vector of std::size_t notes the index position within the string
+where the space is.
+*/
+void viewManager::Element::wordMetrics(Visualizer::platform &device) {
+  // get the textface and point size that is used for the element's
+  // data
+  const resolvedTextStyle &ts = style().text();
+  const string &stextface = ts.sTextFace;
+  double dsize = ts.dTextSize;
+
+  // the metrics are kept until the data, attributes or font scale change.
+  // Elements measured with the fallback face while their own face was
+  // loading are measured again once it arrives.
+  if (m_bMetricsValid &&
+      !(m_bMetricsFallback && device.isFaceLoaded(stextface)))
+    return;
+
+  m_bMetricsFallback = !device.isFaceLoaded(stextface);
+  m_bMetricsValid = true;
+  // noted by the key of the element within the elements map.
+  if (m_bMetricsFallback)
+    device.waitForFace(stextface, (std::size_t)m_self);
+
+  size_t storageTypeID;
+  // find all word breaks within the string
+  indexedWordMetrics.erase(indexedWordMetrics.begin(),
+                           indexedWordMetrics.end());
+  cacheBytes.metrics -= m_metricBytes;
+  m_metricBytes = 0;
+  string sScratch;
+  for (auto &m : m_usageAdaptorMap) {
+    size_t textDataSize = 0;
+
+    // get the number of elements
+    if (m.first == typeid(textArena)) {
+      storageTypeID = m.first.hash_code();
+      textDataSize = any_cast<textArena &>(m.second).size();
+
+    } else if (m.first == typeid(vector<string>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = any_cast<usageAdaptor<string> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(vector<double>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = any_cast<usageAdaptor<double> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(vector<float>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = any_cast<usageAdaptor<float> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(vector<int>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = any_cast<usageAdaptor<int> &>(m.second);
+      textDataSize = o.textDataSize();
+    }
+
+    // iterate the data within the element,
+    // get both the size of the rendered field and
+    for (std::size_t idx = 0; idx < textDataSize; idx++) {
+      std::string_view s;
+
+      if (m.first == typeid(textArena)) {
+        s = any_cast<textArena &>(m.second)[idx];
+      } else if (m.first == typeid(vector<string>)) {
+        auto &o = any_cast<usageAdaptor<string> &>(m.second);
+        s = o.textView(idx, sScratch);
+      } else if (m.first == typeid(vector<double>)) {
+        auto &o = any_cast<usageAdaptor<double> &>(m.second);
+        s = o.textView(idx, sScratch);
+      } else if (m.first == typeid(vector<float>)) {
+        auto &o = any_cast<usageAdaptor<float> &>(m.second);
+        s = o.textView(idx, sScratch);
+      } else if (m.first == typeid(vector<int>)) {
+        auto &o = any_cast<usageAdaptor<int> &>(m.second);
+        s = o.textView(idx, sScratch);
+      }
+
+      // build a tuple vector contains the totaling width as the string
+      // progresses including the space, the width of the text without a space,
+      // and the position of the space within the text
+      vector<wordMetricType> positions;
+      size_t pos = s.find_first_of(" \n\t");
+      size_t begin = 0;
+      double dtotal = 0;
+      std::string_view text;
+      double width;
+      double dspacesize = device.measureTextWidth(stextface, dsize, " ");
+      while (pos != s.npos) {
+        text = s.substr(begin, pos - begin);
+        width = device.measureTextWidth(stextface, dsize, text);
+        dtotal += width + dspacesize;
+        positions.push_back({dtotal, width, pos});
+        begin = pos + 1;
+        pos = s.find_first_of(" \n\t", begin);
+      }
+
+      // handle last part of string
+      text = s.substr(begin);
+      width = device.measureTextWidth(stextface, dsize, text);
+      dtotal += width + dspacesize;
+      positions.push_back({dtotal, width, pos});
+
+      // the map node is counted as the entry and three links.
+      std::size_t bytes =
+          sizeof(decltype(indexedWordMetrics)::value_type) +
+          3 * sizeof(void *) + positions.capacity() * sizeof(wordMetricType);
+      m_metricBytes += bytes;
+      cacheBytes.metrics += bytes;
+
+      indexedWordMetrics[{storageTypeID, idx}] = std::move(positions);
+    }
+  }
+}
+
+/**
+\internal
+\brief the arranged view of the adaptor fitted to its rows, or nullptr when
+the rows are displayed in the order of the data.
+*/
+const dataView *
+viewManager::Element::displayedRows(const std::type_index &tIndex,
+                                    const std::size_t nRows) {
+  auto it = m_dataViews.find(tIndex);
+  if (it == m_dataViews.end())
+    return nullptr;
+  it->second.fit(nRows);
+  return &it->second;
+}
+
+/**
+\internal
+\brief discards the measured words so that the next layout measures the
+element again. Returns the bytes freed.
+*/
+std::size_t viewManager::Element::releaseMetrics(void) {
+  std::size_t freed = m_metricBytes;
+  indexedWordMetrics.clear();
+  invalidateMetrics();
+  cacheBytes.metrics -= m_metricBytes;
+  m_metricBytes = 0;
+  return freed;
+}
+
+/**
+\internal
+\brief The routine finds the largest string within the group of data elements.
+*/
+double
+viewManager::Element::computeWidestTextData(Visualizer::platform &device) {
+  double dMaxWidth = 0;
+  size_t storageTypeID;
+
+  for (auto &m : m_usageAdaptorMap) {
+    size_t textDataSize = 0;
+    // get the size of the amount of data
+    if (m.first == typeid(textArena)) {
+      storageTypeID = m.first.hash_code();
+      textDataSize = std::any_cast<textArena &>(m.second).size();
+
+    } else if (m.first == typeid(std::vector<std::string>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<double>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<float>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<int>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
+      textDataSize = o.textDataSize();
+    }
+
+    // iterate the word Metrics of the displayed rows
+    const dataView *pView = displayedRows(m.first, textDataSize);
+    size_t nDisplayed = pView ? pView->size() : textDataSize;
+    for (size_t n = 0; n < nDisplayed; n++) {
+      size_t idx = pView ? (*pView)[n] : n;
+
+      // find the textual layout positions for wrapping
+      vector<wordMetricType> lineWordMetrics;
+      auto it = indexedWordMetrics.find({storageTypeID, idx});
+      if (it != indexedWordMetrics.end()) {
+        lineWordMetrics = it->second;
+      }
+
+      // if the line will fit within the defined rectangle, show it without
+      // searching
+      if (dMaxWidth <= lineWordMetrics.back().totalWidth)
+        dMaxWidth = lineWordMetrics.back().totalWidth;
+    }
+  }
+  return dMaxWidth;
+}
+
+/**
+\internal
+\brief The routine estimates the size of the textual data without
+measuring glyphs. The character count is scaled by the average advance and
+line height of typical faces. It is used by progressive layout for content
+below the viewport.
+*/
+void viewManager::Element::estimateTextDataExtent(double dWrappingWidth,
+                                                  double &dWidth,
+                                                  double &dHeight) {
+  const resolvedTextStyle &ts = style().text();
+  double dSize = ts.dTextSize;
+  double dLineHeight = ts.dLineHeight;
+
+  const double dAdvance = dSize * 0.5;
+  const double dTextLineHeight = dSize * 1.2 * dLineHeight;
+  size_t linesDisplayed = 0;
+  std::string sScratch;
+
+  dWidth = 0;
+  for (auto &m : m_usageAdaptorMap) {
+    size_t textDataSize = 0;
+
+    if (m.first == typeid(textArena)) {
+      textDataSize = std::any_cast<textArena &>(m.second).size();
+    } else if (m.first == typeid(std::vector<std::string>)) {
+      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
+      textDataSize = o.textDataSize();
+    } else if (m.first == typeid(std::vector<double>)) {
+      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
+      textDataSize = o.textDataSize();
+    } else if (m.first == typeid(std::vector<float>)) {
+      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
+      textDataSize = o.textDataSize();
+    } else if (m.first == typeid(std::vector<int>)) {
+      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
+      textDataSize = o.textDataSize();
+    }
+
+    const dataView *pView = displayedRows(m.first, textDataSize);
+    size_t nDisplayed = pView ? pView->size() : textDataSize;
+    for (size_t n = 0; n < nDisplayed; n++) {
+      size_t idx = pView ? (*pView)[n] : n;
+      size_t textLength = 0;
+
+      if (m.first == typeid(textArena)) {
+        textLength = std::any_cast<textArena &>(m.second)[idx].size();
+      } else if (m.first == typeid(std::vector<std::string>)) {
+        auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
+        textLength = o.textView(idx, sScratch).size();
+      } else if (m.first == typeid(std::vector<double>)) {
+        auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
+        textLength = o.textView(idx, sScratch).size();
+      } else if (m.first == typeid(std::vector<float>)) {
+        auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
+        textLength = o.textView(idx, sScratch).size();
+      } else if (m.first == typeid(std::vector<int>)) {
+        auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
+        textLength = o.textView(idx, sScratch).size();
+      }
+
+      double dLineWidth = textLength * dAdvance;
+      if (dLineWidth > dWidth)
+        dWidth = dLineWidth;
+
+      if (dWrappingWidth <= 0 || dLineWidth <= dWrappingWidth)
+        linesDisplayed++;
+      else
+        linesDisplayed +=
+            static_cast<size_t>(std::ceil(dLineWidth / dWrappingWidth));
+    }
+  }
+
+  if (dWrappingWidth > 0 && dWidth > dWrappingWidth)
+    dWidth = dWrappingWidth;
+
+  dHeight = linesDisplayed * dTextLineHeight;
+}
+
+/**
+\internal
+\brief The routine performs a virtual wrapping of the textual data based
+upon the contents of the information.
+*/
+double
+viewManager::Element::computeWrappedTextDataHeight(Visualizer::platform &device,
+                                                   double dWrappingWidth) {
+  string sTextFace;
+  int tSize;
+  double dFaceHeight;
+  double dLineHeight;
+  double dTextLineHeight;
+  size_t linesDisplayed = 0;
+
+  const resolvedTextStyle &ts = style().text();
+  sTextFace = ts.sTextFace;
+  tSize = static_cast<int>(ts.dTextSize);
+
+  // adjust the textline height to pixel values for advancement.
+  dLineHeight = ts.dLineHeight;
+  dFaceHeight = device.measureFaceHeight(sTextFace, tSize);
+  dTextLineHeight = dFaceHeight * dLineHeight;
+  size_t storageTypeID;
+  for (auto &m : m_usageAdaptorMap) {
+    size_t textDataSize = 0;
+    // get the size of the amount of data
+    if (m.first == typeid(textArena)) {
+      storageTypeID = m.first.hash_code();
+      textDataSize = std::any_cast<textArena &>(m.second).size();
+
+    } else if (m.first == typeid(std::vector<std::string>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<double>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<float>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<int>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
+      textDataSize = o.textDataSize();
+    }
+
+    // iterate the displayed strings within the data
+    const dataView *pView = displayedRows(m.first, textDataSize);
+    size_t nDisplayed = pView ? pView->size() : textDataSize;
+    for (size_t n = 0; n < nDisplayed; n++) {
+      size_t idx = pView ? (*pView)[n] : n;
+
+      // find the textual layout positions for wrapping
+      vector<wordMetricType> lineWordMetrics;
+      auto it = indexedWordMetrics.find({storageTypeID, idx});
+      if (it != indexedWordMetrics.end()) {
+        lineWordMetrics = it->second;
+      }
+
+      // if the line will fit within the defined rectangle, show it without
+      // searching
+      if (dWrappingWidth >= lineWordMetrics.back().totalWidth) {
+        linesDisplayed++;
+      } else {
+        // find the width that can be drawn within the given rectangle of text.
+        // and break apart the text into line wrapping.
+        double dConsumedSpace = 0;
+        double dTotalConsumedSpace = 0;
+        for (auto &n : lineWordMetrics) {
+          if (n.totalWidth - dTotalConsumedSpace > dWrappingWidth) {
+
+            // accumulate the total amount of horizontal space within the
+            // string that has been rendered.
+            dTotalConsumedSpace = dTotalConsumedSpace + dConsumedSpace;
+            dConsumedSpace = 0;
+            linesDisplayed++;
+
+            // display last part of unbroken contigious string, last time
+            // processing
+            if (lineWordMetrics.back().totalWidth - dTotalConsumedSpace <=
+                displayList.ow) {
+              linesDisplayed++;
+              break;
+            }
+          }
+
+          dConsumedSpace = n.totalWidth - dTotalConsumedSpace;
+        }
+      }
+    }
+  }
+  return linesDisplayed * dTextLineHeight;
+}
+
+/**
+\internal
+\brief This is the main function which invokes drawing of the item and
+its children. It is called recursively when painting needs to occur.
+This function is used internally and is not necessary to invoke. That
+is, system already invokes this as part of the processing stack. The
+work performed by this routine is accomplished using the surface image.
+*/
+void viewManager::Element::render(Visualizer::platform &device) {
+  string sTextFace;
+  int tSize;
+  int tColor;
+  textAlignment tAlign = textAlignment(textAlignment::left);
+  double dFaceHeight;
+  double dLineHeight;
+  double dTextLineHeight;
+
+  const resolvedTextStyle &ts = style().text();
+  sTextFace = ts.sTextFace;
+  tSize = static_cast<int>(ts.dTextSize);
+  tColor = ts.textColor;
+  tAlign = textAlignment(ts.alignment);
+
+  // adjust the textline height to pixel values for advancement.
+  dLineHeight = ts.dLineHeight;
+  dFaceHeight = device.measureFaceHeight(sTextFace, tSize);
+  dTextLineHeight = dFaceHeight * dLineHeight;
+  size_t storageTypeID;
+
+  for (auto &m : m_usageAdaptorMap) {
+    size_t textDataSize = 0;
+    // get the size of the amount of data
+    if (m.first == typeid(textArena)) {
+      storageTypeID = m.first.hash_code();
+      textDataSize = std::any_cast<textArena &>(m.second).size();
+
+    } else if (m.first == typeid(std::vector<std::string>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<double>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<float>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
+      textDataSize = o.textDataSize();
+
+    } else if (m.first == typeid(std::vector<int>)) {
+      storageTypeID = m.first.hash_code();
+      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
+      textDataSize = o.textDataSize();
+    }
+
+    // iterate the displayed strings within the data, the metrics are those
+    // of the row's position within the data.
+    size_t linesDisplayed = 0;
+    string sScratch;
+    const dataView *pView = displayedRows(m.first, textDataSize);
+    size_t nDisplayed = pView ? pView->size() : textDataSize;
+    for (size_t n = 0; n < nDisplayed; n++) {
+      size_t idx = pView ? (*pView)[n] : n;
+      std::string_view s;
+
+      if (m.first == typeid(textArena)) {
+        s = std::any_cast<textArena &>(m.second)[idx];
+      } else if (m.first == typeid(std::vector<std::string>)) {
+        auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
+        s = o.textView(idx, sScratch);
+      } else if (m.first == typeid(std::vector<double>)) {
+        auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
+        s = o.textView(idx, sScratch);
+      } else if (m.first == typeid(std::vector<float>)) {
+        auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
+        s = o.textView(idx, sScratch);
+      } else if (m.first == typeid(std::vector<int>)) {
+        auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
+        s = o.textView(idx, sScratch);
+      }
+
+      // find the textual layout positions for wrapping
+      vector<wordMetricType> lineWordMetrics;
+      auto it = indexedWordMetrics.find({storageTypeID, idx});
+      if (it != indexedWordMetrics.end()) {
+        lineWordMetrics = it->second;
+      }
+
+      // if the line will fit within the defined rectangle, show it without
+      // searching
+      if (displayList.ow >= lineWordMetrics.back().totalWidth) {
+        // draw within the calculated layout rectangle.
+        device.drawText(sTextFace, tSize, s, tColor, displayList.x1,
+                        displayList.y1 + linesDisplayed * dTextLineHeight,
+                        displayList.x2, displayList.y2, tAlign);
+        linesDisplayed++;
+      } else {
+        // find the width that can be drawn within the given rectangle of text.
+        // and break apart the text into line wrapping.
+        bool bDone = false;
+        double dyPos = displayList.y1;
+        wordMetricType lastMetric=lineWordMetrics[0];
+        size_t lastCharacterRendered = 0;
+        std::string_view sText;
+        double dConsumedSpace = 0;
+        double dTotalConsumedSpace = 0;
+        for (auto &n : lineWordMetrics) {
+          if (n.totalWidth - dTotalConsumedSpace > displayList.ow) {
+            // get the piece of text that is calculate to fit within the
+            // bounds.
+            sText = s.substr(lastCharacterRendered,
+                             lastMetric.spacePosition - lastCharacterRendered);
+
+            // draw within the calculated layout rectangle.
+            device.drawText(sTextFace, tSize, sText, tColor, displayList.x1,
+                            displayList.y1 + linesDisplayed * dTextLineHeight,
+                            displayList.x2, displayList.y2, tAlign);
+
+            // accumulate the total amount of horizontal space within the
+            // string that has been rendered.
+            dTotalConsumedSpace = dTotalConsumedSpace + dConsumedSpace;
+            dConsumedSpace = 0;
+            lastCharacterRendered = lastMetric.spacePosition + 1;
+            linesDisplayed++;
+
+            // display last part of unbroken contigious string, last time
+            // processing
+            if (lineWordMetrics.back().totalWidth - dTotalConsumedSpace <=
+                displayList.ow) {
+              sText =
+                  s.substr(lastCharacterRendered,
+                           lastMetric.spacePosition - lastCharacterRendered);
+
+              // draw within the calculated layout rectangle.
+              device.drawText(sTextFace, tSize, sText, tColor, displayList.x1,
+                              displayList.y1 + linesDisplayed * dTextLineHeight,
+                              displayList.x2, displayList.y2, tAlign);
+              linesDisplayed++;
+
+              lastMetric = lineWordMetrics.back();
+              break;
+            }
+          }
+
+          dConsumedSpace = n.totalWidth - dTotalConsumedSpace;
+          lastMetric = n;
+        }
+      }
+    }
+  }
+}
+
+/**
+\internal
+\brief The image is drawn at the size of its layout rectangle. Without
+pixels, the element renders its data as any other element.
+*/
+void viewManager::IMAGE::render(Visualizer::platform &device) {
+  if (bitmap.empty()) {
+    Element::render(device);
+    return;
+  }
+
+  device.drawImage(bitmap, static_cast<int>(displayList.x1),
+                   static_cast<int>(displayList.y1),
+                   static_cast<int>(displayList.ow),
+                   static_cast<int>(displayList.oh));
+}
+
+/**
+\internal
+\brief adds a point. Only the last node of each level of the summary
+changes.
+*/
+void viewManager::seriesSummary::append(const double value) {
+  m_values.push_back(value);
+
+  std::size_t i = (m_values.size() - 1) / SERIES_SUMMARY_BLOCK;
+  if (m_levels.empty())
+    m_levels.emplace_back();
+
+  for (auto &level : m_levels) {
+    if (i == level.size()) {
+      level.push_back({value, value});
+    } else {
+      level[i].min = std::min(level[i].min, value);
+      level[i].max = std::max(level[i].max, value);
+    }
+    i >>= 1;
+  }
+
+  // the root has split, a level is added above it.
+  if (m_levels.back().size() > 1)
+    rebuild(m_levels.front().size() - 1);
+}
+
+/**
+\internal
+\brief adds many points. The summary is computed once for the new blocks.
+*/
+void viewManager::seriesSummary::append(const std::vector<double> &values) {
+  if (values.empty())
+    return;
+
+  std::size_t first = m_values.size();
+  m_values.insert(m_values.end(), values.begin(), values.end());
+  changed(first);
+}
+
+/**
+\internal
+\brief replaces the points.
+*/
+void viewManager::seriesSummary::assign(std::vector<double> &&values) {
+  m_values = std::move(values);
+  m_levels.clear();
+  changed(0);
+}
+
+/**
+\internal
+\brief notes the points from first onward were modified, inserted or
+removed through values().
+*/
+void viewManager::seriesSummary::changed(const std::size_t first) {
+  rebuild(first / SERIES_SUMMARY_BLOCK);
+}
+
+void viewManager::seriesSummary::clear(void) {
+  m_values.clear();
+  m_levels.clear();
+}
+
+/**
+\internal
+\brief recomputes the summary nodes from the given leaf block to the end
+of each level. Levels are added or removed so the top level has one node.
+*/
+void viewManager::seriesSummary::rebuild(const std::size_t firstBlock) {
+  std::size_t blocks =
+      (m_values.size() + SERIES_SUMMARY_BLOCK - 1) / SERIES_SUMMARY_BLOCK;
+  if (blocks == 0) {
+    m_levels.clear();
+    return;
+  }
+
+  if (m_levels.empty())
+    m_levels.emplace_back();
+
+  auto &leaves = m_levels.front();
+  leaves.resize(blocks);
+  for (std::size_t b = firstBlock; b < blocks; b++) {
+    auto it = m_values.begin() + b * SERIES_SUMMARY_BLOCK;
+    auto itEnd = m_values.begin() +
+                 std::min(m_values.size(), (b + 1) * SERIES_SUMMARY_BLOCK);
+    auto [itMin, itMax] = std::minmax_element(it, itEnd);
+    leaves[b] = {*itMin, *itMax};
+  }
+
+  std::size_t first = firstBlock;
+  std::size_t k = 1;
+  for (; m_levels[k - 1].size() > 1; k++) {
+    if (k == m_levels.size())
+      m_levels.emplace_back();
+
+    const auto &below = m_levels[k - 1];
+    auto &level = m_levels[k];
+    level.resize((below.size() + 1) / 2);
+    first >>= 1;
+    for (std::size_t i = first; i < level.size(); i++) {
+      level[i] = below[i * 2];
+      if (i * 2 + 1 < below.size()) {
+        level[i].min = std::min(level[i].min, below[i * 2 + 1].min);
+        level[i].max = std::max(level[i].max, below[i * 2 + 1].max);
+      }
+    }
+  }
+  m_levels.resize(k);
+}
+
+/**
+\internal
+\brief returns the minimum and maximum of the points first up to last.
+Whole blocks are taken from the summary, climbing a level whenever a
+pair of nodes is covered. The range must not be empty.
+*/
+viewManager::seriesSummary::extent
+viewManager::seriesSummary::query(std::size_t first, std::size_t last) const {
+  extent ret{std::numeric_limits<double>::infinity(),
+             -std::numeric_limits<double>::infinity()};
+  last = std::min(last, m_values.size());
+
+  auto scan = [&](std::size_t from, std::size_t to) {
+    for (std::size_t i = from; i < to; i++) {
+      ret.min = std::min(ret.min, m_values[i]);
+      ret.max = std::max(ret.max, m_values[i]);
+    }
+  };
+  auto take = [&](const extent &e) {
+    ret.min = std::min(ret.min, e.min);
+    ret.max = std::max(ret.max, e.max);
+  };
+
+  std::size_t blockBegin =
+      (first + SERIES_SUMMARY_BLOCK - 1) / SERIES_SUMMARY_BLOCK;
+  std::size_t blockEnd = last / SERIES_SUMMARY_BLOCK;
+
+  // within a single block, the points are scanned.
+  if (blockBegin >= blockEnd) {
+    scan(first, last);
+    return ret;
+  }
+
+  scan(first, blockBegin * SERIES_SUMMARY_BLOCK);
+  scan(blockEnd * SERIES_SUMMARY_BLOCK, last);
+
+  for (std::size_t k = 0; blockBegin < blockEnd; k++) {
+    if (blockBegin & 1)
+      take(m_levels[k][blockBegin++]);
+    if (blockEnd & 1)
+      take(m_levels[k][--blockEnd]);
+    blockBegin >>= 1;
+    blockEnd >>= 1;
+  }
+
+  return ret;
+}
+
+/**
+\internal
+\brief draws the visible points within the layout rectangle. With more
+points than columns, each column is drawn as the span between the minimum
+and maximum of its points, joined to the span of the previous column.
+Otherwise the points are joined by lines.
+*/
+void viewManager::CHART::render(Visualizer::platform &device) {
+  int x = static_cast<int>(displayList.x1);
+  int y = static_cast<int>(displayList.y1);
+  int w = static_cast<int>(displayList.ow);
+  int h = static_cast<int>(displayList.oh);
+
+  std::size_t first = std::min(viewFirst, series.size());
+  std::size_t count = series.size() - first;
+  if (viewCount)
+    count = std::min(count, viewCount);
+  if (w <= 0 || h <= 0 || count == 0)
+    return;
+
+  double dMin = rangeMin, dMax = rangeMax;
+  if (bAutoRange) {
+    auto e = series.query(first, first + count);
+    dMin = e.min;
+    dMax = e.max;
+  }
+  if (dMax <= dMin)
+    dMax = dMin + 1;
+
+  double dScale = (h - 1) / (dMax - dMin);
+  auto toY = [&](double v) {
+    return y + (h - 1) - static_cast<int>(std::lround((v - dMin) * dScale));
+  };
+
+  device.pushClip(x, y, w, h);
+  int bottom = y + h;
+
+  if (count <= static_cast<std::size_t>(w)) {
+    const auto &values = series.values();
+    double dStep = count > 1 ? static_cast<double>(w - 1) / (count - 1) : 0;
+    int prevX = x, prevY = toY(values[first]);
+
+    for (std::size_t i = 0; i < count; i++) {
+      int px = x + static_cast<int>(std::lround(i * dStep));
+      int py = toY(values[first + i]);
+      if (style == chartStyle::area)
+        device.fillRect(prevX, py, std::max(px - prevX, 1), bottom - py,
+                        fillColor);
+      device.drawLine(prevX, prevY, px, py, lineColor);
+      prevX = px;
+      prevY = py;
+    }
+
+  } else {
+    int prevTop = 0, prevBottom = 0;
+
+    for (int c = 0; c < w; c++) {
+      std::size_t from = first + count * c / w;
+      std::size_t to = first + count * (c + 1) / w;
+      auto e = series.query(from, to);
+      int top = toY(e.max);
+      int bot = toY(e.min);
+
+      if (style == chartStyle::area)
+        device.fillRect(x + c, top, 1, bottom - top, fillColor);
+
+      if (c > 0) {
+        top = std::min(top, prevBottom);
+        bot = std::max(bot, prevTop);
+      }
+      device.fillRect(x + c, top, 1, bot - top + 1, lineColor);
+      prevTop = toY(e.max);
+      prevBottom = toY(e.min);
+    }
+  }
+
+  device.popClip();
+}
+
+/**
+\brief Uses the standard printf function to format the given
+parameters with the format string. When the Boolean member
+ingestStream is set to true, the API inserts the named
+elements within the markup into the document along with any
+text.
+
+\param fmt is a printf format string. It should be a literal
+string.
+\param ...  is a variable argument parameter passed to the standard
+  printf function.
+
+\code
+  vector<string> movies={"The Hulk",
+                        "Super Action Hero",
+                        "Star Invader Eclipse"};
+
+  auto& e=createElement();
+  e.ingestStream=true;
+  e.printf("The movie theatre is <blue>opened</blue> today for matinee.");
+  e.printf("Here is a list of movies: <ul>");
+
+  for(auto n : movies)
+    e.prinf("<li>%s</li>",n.c_str());
+  e.printf("</ul>");
+
+\endcode
+
+\note If a literal is not used for the first parameter, a warning will
+be issued. This warning is effective because at times, it reminds the
+developer that if the format string comes from a foreign source
+and is not controlled, the stack may be violated.
+\endnote
+
+
+\ref markupInputFormat
+
+
+*/
+void viewManager::Element::printf(const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  m_output.appendFormatted(fmt, ap);
+  va_end(ap);
+
+  writeOutput(false);
+}
+
+/**
+\internal
+\brief formats at the end of the buffer using the capacity already
+allocated. The buffer grows only when the text does not fit.
+*/
+void viewManager::outputBuffer::appendFormatted(const char *fmt, va_list ap) {
+  std::size_t used = m_text.size();
+  m_text.resize(std::max(m_text.capacity(), used + 128));
+
+  va_list apRetry;
+  va_copy(apRetry, ap);
+/* These are checked with the __attribute__ setting on the printf
+ * declare. Turning them off here makes it only report warnings to
+ * calls of that member function and not these. */
+#pragma clang diagnostic ignored "-Wformat-security"
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+  int len = vsnprintf(&m_text[used], m_text.size() - used, fmt, ap);
+  if (len >= 0 && used + static_cast<std::size_t>(len) >= m_text.size()) {
+    m_text.resize(used + static_cast<std::size_t>(len) + 1);
+    len = vsnprintf(&m_text[used], m_text.size() - used, fmt, apRetry);
+  }
+#pragma clang diagnostic warning "-Wformat-security"
+#pragma clang diagnostic warning "-Wformat-nonliteral"
+  va_end(apRetry);
+
+  m_text.resize(len < 0 ? used : used + static_cast<std::size_t>(len));
+}
+
+/**
+\internal
+\brief passes each complete line to fn without its new line character
+and removes them from the buffer. When bPartial is set, the remaining
+partial line is passed as well. Returns the number of lines passed.
+*/
+std::size_t viewManager::outputBuffer::takeLines(
+    const std::function<void(std::string_view)> &fn, const bool bPartial) {
+  std::string_view sv(m_text);
+  std::size_t lines = 0;
+  std::size_t start = 0;
+  std::size_t end;
+
+  while ((end = sv.find('\n', start)) != std::string_view::npos) {
+    fn(sv.substr(start, end - start));
+    lines++;
+    start = end + 1;
+  }
+
+  if (bPartial && start < sv.size()) {
+    fn(sv.substr(start));
+    lines++;
+    start = sv.size();
+  }
+
+  m_text.erase(0, start);
+  return lines;
+}
+
+/**
+\internal
+\brief moves the output buffer to the document. Markup is ingested as it
+arrives since the parser holds the state of an incomplete tag. Otherwise
+complete lines become rows of data(), and a partial line is remembered
+within pendingOutput so the next frame shows it.
+*/
+void viewManager::Element::writeOutput(const bool bFlush) {
+  if (ingestStream) {
+    if (!m_output.empty()) {
+      ingestMarkup(*this, m_output.text());
+      m_output.clear();
+    }
+    return;
+  }
+
+  if (m_output.hasLine() || (bFlush && !m_output.empty())) {
+    // lines go to the text rows when the element uses them.
+    auto it = m_usageAdaptorMap.find(std::type_index(typeid(textArena)));
+    if (it != m_usageAdaptorMap.end()) {
+      auto &rows = std::any_cast<textArena &>(it->second);
+      invalidateMetrics();
+      m_output.takeLines(
+          [&rows](std::string_view line) { rows.push_back(line); }, bFlush);
+    } else {
+      auto &d = data();
+      m_output.takeLines(
+          [&d](std::string_view line) { d.emplace_back(line); }, bFlush);
+    }
+  }
+
+  if (!m_output.empty() && !m_bOutputPending) {
+    m_bOutputPending = true;
+    pendingOutput.push_back(this);
+  }
+}
+
+/**
+\internal
+\brief takes the partial line of a moved element. The pendingOutput entry
+is kept by address, so it is moved to this element.
+*/
+void viewManager::Element::takeOutput(Element &other) {
+  m_output = std::move(other.m_output);
+  other.m_output.clear();
+  if (!other.m_bOutputPending)
+    return;
+
+  other.m_bOutputPending = false;
+  if (m_bOutputPending) {
+    pendingOutput.erase(
+        std::remove(pendingOutput.begin(), pendingOutput.end(), &other),
+        pendingOutput.end());
+  } else {
+    std::replace(pendingOutput.begin(), pendingOutput.end(), &other, this);
+    m_bOutputPending = true;
+  }
+}
+
+/**
+\brief commits the partial line of output as a row of data().
+*/
+void viewManager::Element::flush(void) { writeOutput(true); }
+
+Element &viewManager::Element::operator<<(
+    std::ostream &(*manip)(std::ostream &)) {
+  using manipulator = std::ostream &(*)(std::ostream &);
+  if (manip == static_cast<manipulator>(std::endl))
+    m_output.append('\n');
+  writeOutput(true);
+  return *this;
+}
+
+/**
+\brief returns the row, throwing std::out_of_range when the index is not
+within the storage.
+*/
+std::string_view viewManager::textArena::at(const std::size_t idx) const {
+  if (idx >= m_rows.size())
+    throw std::out_of_range("textArena row index is out of range.");
+  return (*this)[idx];
+}
+
+/**
+\internal
+\brief copies the text to the end of the last block. A new block is begun
+when it does not fit, so the text of a row is never moved while in use.
+*/
+viewManager::textArena::row
+viewManager::textArena::store(const std::string_view &s) {
+  if (s.size() > UINT32_MAX)
+    throw std::length_error("textArena row exceeds the storage limit.");
+
+  if (m_chunks.empty() ||
+      m_chunks.back().capacity() - m_chunks.back().size() < s.size()) {
+    m_chunks.emplace_back();
+    m_chunks.back().reserve(std::max<std::size_t>(TEXT_ARENA_CHUNK, s.size()));
+  }
+
+  std::string &chunk = m_chunks.back();
+  row r = {static_cast<uint32_t>(m_chunks.size() - 1),
+           static_cast<uint32_t>(chunk.size()),
+           static_cast<uint32_t>(s.size())};
+  chunk.append(s);
+  m_bytes += s.size();
+  return r;
+}
+
+/**
+\internal
+\brief notes the text of a row as unused. The callers compact the storage
+once enough of it is unused.
+*/
+void viewManager::textArena::release(const row &r) {
+  m_bytes -= r.length;
+  m_unused += r.length;
+}
+
+void viewManager::textArena::push_back(const std::string_view &s) {
+  m_rows.push_back(store(s));
+}
+
+void viewManager::textArena::insert(const std::size_t idx,
+                                    const std::string_view &s) {
+  if (idx > m_rows.size())
+    throw std::out_of_range("textArena row index is out of range.");
+  m_rows.insert(m_rows.begin() + idx, store(s));
+}
+
+/**
+\brief replaces the text of the row. The former text is left unused
+within its block.
+*/
+void viewManager::textArena::assign(const std::size_t idx,
+                                    const std::string_view &s) {
+  if (idx >= m_rows.size())
+    throw std::out_of_range("textArena row index is out of range.");
+  row r = store(s);
+  release(m_rows[idx]);
+  m_rows[idx] = r;
+
+  if (m_unused > TEXT_ARENA_CHUNK && m_unused > m_bytes)
+    compact();
+}
+
+/**
+\brief removes the rows from first up to but not including last.
+*/
+void viewManager::textArena::erase(const std::size_t first,
+                                   const std::size_t last) {
+  if (first > last || last > m_rows.size())
+    throw std::out_of_range("textArena row range is out of range.");
+
+  for (std::size_t i = first; i < last; i++)
+    release(m_rows[i]);
+  m_rows.erase(m_rows.begin() + first, m_rows.begin() + last);
+
+  if (m_rows.empty())
+    clear();
+  else if (m_unused > TEXT_ARENA_CHUNK && m_unused > m_bytes)
+    compact();
+}
+
+void viewManager::textArena::clear(void) {
+  m_chunks.clear();
+  m_rows.clear();
+  m_bytes = 0;
+  m_unused = 0;
+}
+
+/**
+\brief copies the rows in order into new blocks, leaving out the unused
+text. Rows that are read in sequence are then adjacent in memory.
+*/
+void viewManager::textArena::compact(void) {
+  std::vector<std::string> chunks;
+  chunks.swap(m_chunks);
+  m_bytes = 0;
+  m_unused = 0;
+
+  for (auto &r : m_rows)
+    r = store(std::string_view(chunks[r.chunk].data() + r.offset, r.length));
+}
+
+bool viewManager::textArena::operator==(const textArena &other) const {
+  if (m_rows.size() != other.m_rows.size() || m_bytes != other.m_bytes)
+    return false;
+
+  for (std::size_t i = 0; i < m_rows.size(); i++)
+    if ((*this)[i] != other[i])
+      return false;
+
+  return true;
+}
+
+/**
+\brief returns the rows to the order of the data. The filter is kept.
+*/
+void viewManager::dataView::unsort(void) {
+  std::iota(m_order.begin(), m_order.end(), 0);
+  select();
+}
+
+/**
+\brief displays all of the rows again. The order is kept.
+*/
+void viewManager::dataView::unfilter(void) {
+  m_selected.clear();
+  select();
+}
+
+/**
+\internal
+\brief brings the view to the number of rows within the data. Rows added
+are displayed at the end and rows removed from the end are dropped, the
+arrangement of the others is kept.
+*/
+void viewManager::dataView::fit(const std::size_t nRows) {
+  if (nRows == m_dataSize)
+    return;
+
+  if (nRows > m_dataSize) {
+    m_order.resize(nRows);
+    std::iota(m_order.begin() + m_dataSize, m_order.end(), m_dataSize);
+  } else {
+    m_order.erase(std::remove_if(m_order.begin(), m_order.end(),
+                                 [nRows](const std::size_t idx) {
+                                   return idx >= nRows;
+                                 }),
+                  m_order.end());
+  }
+  if (!m_selected.empty())
+    m_selected.resize(nRows, true);
+  m_dataSize = nRows;
+  select();
+}
+
+/**
+\internal
+\brief gathers the selected rows in the order of the view. Without a
+filter, rows() is the order itself.
+*/
+void viewManager::dataView::select(void) {
+  m_rows.clear();
+  if (m_selected.empty())
+    return;
+  for (auto idx : m_order)
+    if (m_selected[idx])
+      m_rows.push_back(idx);
+}
+
+/**
+\internal
+\brief commits the partial lines of output written since the last frame,
+returning the keys of the elements written.
+*/
+std::vector<std::size_t> viewManager::flushPendingOutput(void) {
+  std::vector<Element *> pending;
+  pending.swap(pendingOutput);
+
+  std::vector<std::size_t> keys;
+  for (auto e : pending) {
+    e->m_bOutputPending = false;
+    e->writeOutput(true);
+    keys.push_back((std::size_t)e);
+  }
+  return keys;
+}
+
+/**
+\internal
+\brief The ingestMarkup function provides a method to parse markup that is
+similar to HTML. The format is more restrictive in that the parser is not as
+forgiving for errors.
+
+\details
+The routine is called by the functions that allow a markup string.
+This routine uses the object factory and color map to query the
+contents of the maps.
+
+The parser context applies memory to successive calls to the function.
+This is important for functions like printf or the stream insertion
+operators so that markup gets interpreted correctly. Since there is one of
+these contexts per element, each element operates independently.
+
+The parser acts in a two phase operation, first locating each of the tags
+as markup and those that appears as tags but are not markup elements. The
+second phase builds the elements and applies the attributes to the
+elements. Since document fragments can be nested, the parser function
+maintains a stack of created elements.
+
+\ref markupInputFormat
+
+*/
+Element &viewManager::Element::ingestMarkup(Element &node,
+                                            const std::string &markup) {
+
+  static thread_local parserContext pc;
+
+  if (pc.elementStack.size() == 0)
+    pc.elementStack.push_back(node);
+
+#if defined(USE_PARALLEL_PARSE)
+  // large input is parsed in parallel when no tag or text is pending
+  // from a previous call.
+  if (markup.size() >= PARALLEL_PARSE_THRESHOLD && pc.parsedData.empty() &&
+      !pc.bSignal && !pc.bTerminal && pc.sCapture.empty() &&
+      pc.sText.empty())
+    return ingestMarkupParallel(node, pc, markup);
+#endif
+  tokenizeMarkup(pc, markup);
+
+  return buildMarkup(node, pc);
+}
+
+/**
+\internal
+\brief The first phase of ingestMarkup. The markup is tokenized into the
+parsedData of the context. The context holds the state of an incomplete
+tag or text so that the next call continues it. The function does not
+create elements, so it may run on several contexts at once.
+*/
+void viewManager::Element::tokenizeMarkup(parserContext &pc,
+                                          std::string_view markup) {
+  // tokenize the markup string
+  for (auto ch : markup) {
+    switch (ch) {
+    case '<':
+      if (pc.sText.size() != 0) {
+        pc.parsedData.emplace_back(textData, false, pc.sText);
+        pc.sText = "";
+      }
+      pc.bAttributeList=false;
+      pc.bAttributeListValue=false;
+      pc.bSignal = true;
+      pc.bSkip = true;
+      break;
+    case ' ':
+      if (pc.bSignal && (!pc.bToken || pc.bAttributeList)) {
+        pc.bQuery = true;
+        pc.bSkip = true;
+      }
+      break;
+    case '=':
+      if (pc.bAttributeList) {
+        pc.bQuery = true;
+        pc.bSkip = true;
+      }
+      break;
+    case '>':
+      if (pc.bSignal) {
+        pc.bSignal = false;
+        pc.bToken = false;
+        pc.bSkip = true;
+        pc.bQuery = true;
+      }
+      break;
+    case '/':
+      if (pc.bSignal) {
+        pc.bTerminal = true;
+        pc.bSkip = true;
+      }
+      break;
+    }
+
+    // the query flag is on when a item has been tokenized after a signal
+    // has been found.
+    if (pc.bQuery)
+      processParseContext(pc);
 
-  Example
-  -------
-  \snippet examples.cpp append_elementlist
+    if (!pc.bSkip)
+      if (pc.bSignal)
+        pc.sCapture += ch;
+      else
+        pc.sText += ch;
+
+    pc.bSkip = false;
+  }
+
+  // if text exists, add as a textdata element.
+  if (pc.sText.size() != 0) {
+    pc.parsedData.emplace_back(textData, false, pc.sText);
+    pc.sText = "";
+  }
+}
+
+/**
+\internal
+\brief The second phase of ingestMarkup. Elements are created from the
+tokens and appended beneath node. Tokens of incomplete tags are left
+within the context.
 */
-auto viewManager::Element::append(ElementList &elementCollection) -> Element & {
-  for (auto &e : elementCollection)
-    append(e);
-  return (*this);
+Element &viewManager::Element::buildMarkup(Element &node, parserContext &pc) {
+  // second phase, iterate over the parsed context and develop the elements,
+  // color text nodes, and set attributes for the items on the stack. once
+  // items are processed, they are removed from the stack using the delete
+  // range operator, For a complete tag to exist, the end tab must also
+  // exist.
+  auto item = pc.parsedData.begin();
+  while (item != pc.parsedData.end()) {
+
+    // if the item is processed
+    if (get<1>(*item))
+      continue;
+
+#if defined(USE_LAZY_MARKUP)
+    // top level elements, and what follows them within the group, are
+    // recorded upon a tape rather than created.
+    if (pc.deferred ||
+        (get<0>(*item) == element && pc.elementStack.size() == 1)) {
+      deferMarkup(pc, item);
+      item++;
+      continue;
+    }
+#endif
+
+    switch (get<0>(*item)) {
+    case element: {
+      Element &e =
+          get<const factoryMap::value_type *>(get<2>(*item))->second({});
+      pc.elementStack.back().get().appendChild(e);
+      pc.elementStack.push_back(e);
+      get<1>(*item) = true;
+    } break;
+
+    case elementTerminal: {
+      pc.elementStack.pop_back();
+      // mark as processed
+      get<1>(*item) = true;
+    } break;
+
+    // the attribute and value are handled here together
+    case attribute: {
+      auto itAttributeValue = std::next(item, 1);
+      if (itAttributeValue != pc.parsedData.end() &&
+          get<0>(*itAttributeValue) == attributeValue) {
+        get<const attributeStringMap::value_type *>(get<2>(*item))
+            ->second.second(pc.elementStack.back(),
+                            get<string>(get<2>(*itAttributeValue)));
+        get<1>(*itAttributeValue) = true;
+        // mark as processed
+        get<1>(*item) = true;
+        item++;
+      }
+
+    } break;
+
+    case attributeSimple: {
+      get<const attributeStringMap::value_type *>(get<2>(*item))
+          ->second.second(pc.elementStack.back(), "");
+      // mark as processed
+      get<1>(*item) = true;
+    } break;
+
+    case color: {
+      auto &e = pc.elementStack.back().get().appendChild<textNode>(
+          textColor{get<colorNF>(get<2>(*item))});
+      pc.elementStack.push_back(e);
+      get<1>(*item) = true;
+    } break;
+
+    case textData: {
+      pc.elementStack.back().get().data().push_back(get<string>(get<2>(*item)));
+      get<1>(*item) = true;
+      break;
+    }
+    }
+
+    // goto next item
+    item++;
+  }
+
+#if defined(USE_LAZY_MARKUP)
+  // the group is closed at the end of the input unless an element within
+  // it continues with the next input.
+  if (pc.deferred && pc.deferredDepth == 0)
+    closeDeferredMarkup(pc);
+#endif
+
+  // if all items have been terminated, and only one element is on the stack
+  // it should be the node, so pop it off.
+  if (pc.elementStack.size() == 1) {
+    Element &eRet = pc.elementStack.back().get();
+    if (eRet.m_self == node.m_self)
+      pc.elementStack.pop_back();
+  }
+
+  // erase processed items when marked,
+  pc.parsedData.erase(std::remove_if(pc.parsedData.begin(), pc.parsedData.end(),
+                                     [](auto &n) { return get<1>(n); }),
+                      pc.parsedData.end());
+
+  return node;
 }
 
+#if defined(USE_LAZY_MARKUP)
 /**
-\brief The function sets the given attribute inside the elements indexed
-map. Settings are filtered on specific types to determine if it is a true
-attribute or one that is filtered to be a compound. Compound attributes
-require other operations such as data insertion into the data property or
-using an official attribute object where only an enumeration value is given.
+\internal
+\brief records one token upon the tape of the open deferred group,
+opening a group when there is none. Ids are noted within deferredIndex so
+getElement can find the group. The group is closed once it is large and
+no element within it is open.
+*/
+void viewManager::Element::deferMarkup(
+    parserContext &pc,
+    std::vector<std::tuple<itemType, bool, parserOperator>>::iterator &item) {
+  if (!pc.deferred) {
+    auto &e = _createElement<deferredMarkup>({});
+    Element &eParent = pc.elementStack.back().get();
+    eParent.appendChild(e);
+    eParent.m_deferredChildren++;
+    pc.deferred = &e;
+    pc.deferredDepth = 0;
+  }
 
-\param
-setting an attribute.
+  markupTape &tape = pc.deferred->tape;
+  auto &payload = get<2>(*item);
 
-The following are supported filtered types:
-- char
-- double
-- float
-- int
-- std::string
-- const char *
-- std::vector<char>
-- std::vector<double>
-- std::vector<float>
-- std::vector<int>
-- std::vector<std::string>
-- std::vector<std::vector<std::string>>
-- std::vector<std::vector<std::pair<int, std::string>>>
-- std::vector<std::vector<std::pair<int, std::string>>>
+  switch (get<0>(*item)) {
+  case element:
+    tape.pushElement(get<const factoryMap::value_type *>(payload));
+    pc.deferredDepth++;
+    break;
 
-Example
--------
-\snippet examples.cpp setAttribute_base
+  case elementTerminal:
+    tape.pushTerminal();
+    pc.deferredDepth = std::max(0, pc.deferredDepth - 1);
+    break;
+
+  case attribute: {
+    // the value may arrive with the next input.
+    auto itAttributeValue = std::next(item, 1);
+    if (itAttributeValue == pc.parsedData.end() ||
+        get<0>(*itAttributeValue) != attributeValue)
+      return;
+
+    auto entry = get<const attributeStringMap::value_type *>(payload);
+    auto &sValue = get<string>(get<2>(*itAttributeValue));
+    tape.pushAttribute(entry, sValue);
+    if (markupTape::isIndexAttribute(entry))
+      deferredIndex[sValue] = (std::size_t)pc.deferred;
+
+    get<1>(*itAttributeValue) = true;
+    item++;
+  } break;
+
+  case attributeSimple:
+    tape.pushAttribute(get<const attributeStringMap::value_type *>(payload),
+                       "");
+    break;
+
+  case color:
+    tape.pushColor(get<colorNF>(payload));
+    pc.deferredDepth++;
+    break;
+
+  case textData:
+    tape.pushText(get<string>(payload));
+    break;
+
+  default:
+    return;
+  }
+
+  // mark as processed
+  get<1>(*item) = true;
+
+  if (pc.deferredDepth == 0 && tape.size() >= LAZY_MARKUP_GROUP)
+    closeDeferredMarkup(pc);
+}
+
+/**
+\internal
+\brief closes the open deferred group. It may be materialized from then
+on.
+*/
+void viewManager::Element::closeDeferredMarkup(parserContext &pc) {
+  pc.deferred->complete();
+  pc.deferred = nullptr;
+  pc.deferredDepth = 0;
+}
+
+void viewManager::markupTape::pushElement(const factoryMap::value_type *entry) {
+  node n{nodeType::element, 0, 0};
+  n.element = entry;
+  m_nodes.push_back(n);
+  m_elementCount++;
+}
+
+void viewManager::markupTape::pushTerminal(void) {
+  node n{nodeType::elementTerminal, 0, 0};
+  n.element = nullptr;
+  m_nodes.push_back(n);
+}
+
+void viewManager::markupTape::pushAttribute(
+    const attributeStringMap::value_type *entry, const std::string &value) {
+  node n{nodeType::attribute, static_cast<uint32_t>(m_arena.size()),
+         static_cast<uint32_t>(value.size())};
+  n.attribute = entry;
+  m_arena += value;
+  m_nodes.push_back(n);
+}
+
+void viewManager::markupTape::pushColor(const colorNF &color) {
+  node n{nodeType::color, static_cast<uint32_t>(m_colors.size()), 0};
+  n.element = nullptr;
+  m_colors.push_back(color);
+  m_nodes.push_back(n);
+}
+
+void viewManager::markupTape::pushText(const std::string &text) {
+  node n{nodeType::textData, static_cast<uint32_t>(m_arena.size()),
+         static_cast<uint32_t>(text.size())};
+  n.element = nullptr;
+  m_arena += text;
+  m_nodes.push_back(n);
+}
+
+/**
+\internal
+\brief releases the memory of the tape.
+*/
+void viewManager::markupTape::clear(void) {
+  std::string().swap(m_arena);
+  std::vector<node>().swap(m_nodes);
+  std::vector<colorNF>().swap(m_colors);
+  m_elementCount = 0;
+}
+
+/**
+\internal
+\brief true for the attributes that set indexBy.
+*/
+bool viewManager::markupTape::isIndexAttribute(
+    const attributeStringMap::value_type *entry) {
+  return entry->first == "id" || entry->first == "indexby";
+}
+
+/**
+\internal
+\brief returns the ids given to elements upon the tape.
+*/
+std::vector<std::string> viewManager::markupTape::indexKeys(void) const {
+  std::vector<std::string> ret;
+  for (auto &n : m_nodes)
+    if (n.type == nodeType::attribute && isIndexAttribute(n.attribute))
+      ret.emplace_back(m_arena, n.offset, n.length);
+  return ret;
+}
+
+/**
+\internal
+\brief creates the elements upon the tape. Top level elements are
+inserted into parent before the given child, the others are appended to
+the element that encloses them as buildMarkup does.
+\return the created elements in document order.
+*/
+ElementList viewManager::markupTape::build(Element &parent,
+                                           Element &before) const {
+  ElementList ret;
+  ElementList stack{parent};
+
+  auto place = [&](Element &e) {
+    if (stack.size() == 1)
+      parent.insertBefore(e, before);
+    else
+      stack.back().get().appendChild(e);
+    stack.push_back(e);
+    ret.push_back(e);
+  };
+
+  for (auto &n : m_nodes) {
+    switch (n.type) {
+    case nodeType::element:
+      place(n.element->second({}));
+      break;
+
+    case nodeType::elementTerminal:
+      if (stack.size() > 1)
+        stack.pop_back();
+      break;
+
+    case nodeType::attribute:
+      n.attribute->second.second(stack.back(),
+                                 m_arena.substr(n.offset, n.length));
+      break;
+
+    case nodeType::color:
+      place(_createElement<textNode>({textColor{m_colors[n.offset]}}));
+      break;
+
+    case nodeType::textData:
+      stack.back().get().data().push_back(m_arena.substr(n.offset, n.length));
+      break;
+    }
+  }
+
+  return ret;
+}
+
+/**
+\internal
+\brief notes the group is complete. Until materialized, the placeholder
+takes a height estimated from the number of elements and the amount of
+text upon the tape.
+*/
+void viewManager::deferredMarkup::complete(void) {
+  // characters upon a typical line of text
+  const std::size_t lineLength = 80;
+
+  std::size_t lines = tape.elementCount() + tape.textSize() / lineLength;
+  setAttribute(objectHeight{lines * DEFAULT_TEXTSIZE * 1.2, numericFormat::px});
+  m_bCompleted = true;
+}
+
+/**
+\internal
+\brief creates the elements upon the tape before the placeholder and
+removes the placeholder, which is destroyed upon return.
+\return the created elements in document order.
+*/
+ElementList viewManager::deferredMarkup::materialize(void) {
+  Element *pParent = m_parent;
+  if (m_bMaterialized || !m_bCompleted || !pParent)
+    return {};
+
+  for (auto &sKey : tape.indexKeys())
+    deferredIndex.erase(sKey);
+
+  ElementList ret = tape.build(*pParent, *this);
+  m_bMaterialized = true;
+  pParent->removeChild(*this);
+
+  return ret;
+}
+
+/**
+\internal
+\brief creates the completed placeholders among the children.
+*/
+void viewManager::Element::materializeChildren(void) {
+  if (!m_deferredChildren)
+    return;
+
+  // each placeholder removes itself, so they are gathered first.
+  std::vector<deferredMarkup *> groups;
+  for (Element *p = m_firstChild; p; p = p->m_nextSibling) {
+    auto pDeferred = dynamic_cast<deferredMarkup *>(p);
+    if (pDeferred && pDeferred->completed())
+      groups.push_back(pDeferred);
+  }
+
+  for (auto pDeferred : groups)
+    pDeferred->materialize();
+}
+
+/**
+\internal
+\brief materializes the deferred group holding the given id.
+\return true when the id was found within a group.
+*/
+bool viewManager::materializeDeferred(const std::string &key) {
+  auto it = deferredIndex.find(key);
+  if (it == deferredIndex.end())
+    return false;
+
+  auto itElement = elements.find(it->second);
+  if (itElement == elements.end()) {
+    deferredIndex.erase(it);
+    return false;
+  }
 
+  auto pDeferred = dynamic_cast<deferredMarkup *>(itElement->second.get());
+  if (!pDeferred || !pDeferred->completed())
+    return false;
+
+  pDeferred->materialize();
+  return indexedElements.find(key) != indexedElements.end();
+}
+
+/**
+\internal
+\brief materializes every completed deferred group so that the whole
+document may be searched.
 */
-Element &viewManager::Element::setAttribute(const std::any &paramSetting) {
+void viewManager::materializeDeferred(void) {
+  // creating elements changes the map, so the groups are gathered first.
+  std::vector<deferredMarkup *> groups;
+  for (auto &n : elements) {
+    auto pDeferred = dynamic_cast<deferredMarkup *>(n.second.get());
+    if (pDeferred && pDeferred->completed() && !pDeferred->materialized())
+      groups.push_back(pDeferred);
+  }
 
-  std::any setting = paramSetting;
-  /**
-  \internal
-  \enum _enumTypeFilter
-  */
-  enum _enumTypeFilter {
-    dt_char,
-    dt_double,
-    dt_float,
-    dt_int,
-    dt_std_string,
-    dt_const_char,
-    dt_vector_char,
-    dt_vector_double,
-    dt_vector_float,
-    dt_vector_int,
-    dt_vector_string,
-    dt_vector_vector_string,
-    dt_vector_pair_int_string,
-    dt_indexBy,
-    dt_display_enum,
-    dt_position_enum,
-    dt_textAlignment_enum,
-    dt_borderStyle_enum,
-    dt_listStyleType_enum,
+  for (auto pDeferred : groups)
+    pDeferred->materialize();
+}
+#endif
 
-    dt_nonFiltered
-  };
-  // filter map
-  static std::unordered_map<size_t, _enumTypeFilter> _umapTypeFilter = {
-      {std::type_index(typeid(char)).hash_code(), dt_char},
-      {std::type_index(typeid(double)).hash_code(), dt_double},
-      {std::type_index(typeid(float)).hash_code(), dt_float},
-      {std::type_index(typeid(int)).hash_code(), dt_int},
-      {std::type_index(typeid(std::string)).hash_code(), dt_std_string},
-      {std::type_index(typeid(const char *)).hash_code(), dt_const_char},
-      {std::type_index(typeid(std::vector<char>)).hash_code(), dt_vector_char},
-      {std::type_index(typeid(std::vector<double>)).hash_code(),
-       dt_vector_double},
-      {std::type_index(typeid(std::vector<float>)).hash_code(),
-       dt_vector_float},
-      {std::type_index(typeid(std::vector<int>)).hash_code(), dt_vector_int},
-      {std::type_index(typeid(std::vector<std::string>)).hash_code(),
-       dt_vector_string},
-      {std::type_index(typeid(std::vector<std::vector<std::string>>))
-           .hash_code(),
-       dt_vector_vector_string},
-      {std::type_index(
-           typeid(std::vector<std::vector<std::pair<int, std::string>>>))
-           .hash_code(),
-       dt_vector_pair_int_string},
-      {std::type_index(typeid(indexBy)).hash_code(), dt_indexBy},
-      {std::type_index(typeid(display::optionEnum)).hash_code(),
-       dt_display_enum},
-      {std::type_index(typeid(position::optionEnum)).hash_code(),
-       dt_position_enum},
-      {std::type_index(typeid(textAlignment::optionEnum)).hash_code(),
-       dt_textAlignment_enum},
-      {std::type_index(typeid(borderStyle::optionEnum)).hash_code(),
-       dt_borderStyle_enum},
-      {std::type_index(typeid(listStyleType::optionEnum)).hash_code(),
-       dt_listStyleType_enum}
+#if defined(USE_PARALLEL_PARSE)
+/**
+\internal
+\brief The function finds positions within the markup where parsing may
+begin with a fresh parser context. A position is the start of a tag at the
+top level, where the tokenizer holds nothing from the tags before it.
+Positions are at least chunkSize apart.
+
+\details Element tags with a known name and no '/' other than the leading
+one are counted directly. Other tags, such as colors, unknown names or
+values holding a '/', are passed to the tokenizer. Its context shows the
+state they leave for the tags that follow, and its tokens the change of
+depth. The scan stops when the markup closes more elements than it opens.
+*/
+std::vector<std::size_t>
+viewManager::Element::markupSplitPoints(const std::string &markup,
+                                        std::size_t chunkSize) {
+  std::vector<std::size_t> splits;
+  std::size_t chunkBegin = 0;
+  int depth = 0;
+  parserContext pc{};
+
+  std::size_t pos = markup.find('<');
+  while (pos != std::string::npos && depth >= 0) {
+    // a tag is ended by '>', or by a '<' that begins another.
+    std::size_t tagEnd = markup.find_first_of("<>", pos + 1);
+    bool bClosed = tagEnd != std::string::npos && markup[tagEnd] == '>';
+    std::size_t next = bClosed ? tagEnd + 1 : tagEnd;
+    bool bFresh = !pc.bSignal && !pc.bTerminal && pc.sCapture.empty();
+
+    if (bFresh && depth == 0 && pos - chunkBegin >= chunkSize) {
+      splits.push_back(pos);
+      chunkBegin = pos;
+    }
 
-  };
-  // set search result defaults for not found in filter
-  _enumTypeFilter dtFilter = dt_nonFiltered;
-  bool bSaveInMap = false;
-  auto it = _umapTypeFilter.find(setting.type().hash_code());
-  if (it != _umapTypeFilter.end())
-    dtFilter = it->second;
+    bool bTerminal = pos + 1 < markup.size() && markup[pos + 1] == '/';
+    std::size_t nameBegin = pos + (bTerminal ? 2 : 1);
+    std::size_t nameEnd = bClosed ? markup.find_first_of(" />", nameBegin)
+                                  : std::string::npos;
+
+    bool bSimple = bFresh && bClosed && nameEnd > nameBegin &&
+                   nameEnd <= tagEnd && markup[nameEnd] != '/' &&
+                   (!bTerminal || nameEnd == tagEnd) &&
+                   std::find(markup.begin() + nameEnd,
+                             markup.begin() + tagEnd,
+                             '/') == markup.begin() + tagEnd;
+    if (bSimple) {
+      string sKey = markup.substr(nameBegin, nameEnd - nameBegin);
+      std::transform(sKey.begin(), sKey.end(), sKey.begin(),
+                     [](unsigned char c) { return std::tolower(c); });
+      bSimple = objectFactoryMap.find(sKey) != objectFactoryMap.end();
+    }
 
-  /* filter these types specifically and do not store them in the map.
-  these items change the dataAdaptor. This creates a more usable
-  syntax for population of large and small data within the
-  simple initializer list format given within the attribute list.*/
-  switch (dtFilter) {
-  case dt_char: {
-    auto v = std::any_cast<char>(setting);
-    data<char>() = std::vector<char>{v};
-  } break;
-  case dt_double: {
-    auto v = std::any_cast<double>(setting);
-    data<double>() = std::vector<double>{v};
-  } break;
-  case dt_float: {
-    auto v = std::any_cast<float>(setting);
-    data<float>() = std::vector<float>{v};
-  } break;
-  case dt_int: {
-    auto v = std::any_cast<int>(setting);
-    data<int>() = std::vector<int>{v};
-  } break;
-  case dt_const_char: {
-    auto v = std::any_cast<const char *>(setting);
-    data<std::string>() = std::vector<std::string>{v};
-  } break;
-  case dt_std_string: {
-    auto v = std::any_cast<std::string>(setting);
-    data<std::string>() = std::vector<std::string>{v};
-  } break;
-  case dt_vector_char: {
-    auto v = std::any_cast<std::vector<char>>(setting);
-    data<char>() = v;
-  } break;
-  case dt_vector_double: {
-    auto v = std::any_cast<std::vector<double>>(setting);
-    data<double>() = v;
-  } break;
-  case dt_vector_float: {
-    auto v = std::any_cast<std::vector<float>>(setting);
-    data<float>() = v;
-  } break;
-  case dt_vector_int: {
-    auto v = std::any_cast<std::vector<int>>(setting);
-    data<int>() = v;
-  } break;
-  case dt_vector_string: {
-    auto v = std::any_cast<std::vector<std::string>>(setting);
-    data<std::string>() = v;
-  } break;
-  case dt_vector_vector_string: {
-    auto v = std::any_cast<std::vector<std::vector<std::string>>>(setting);
-    data<std::vector<std::string>>() = v;
-  } break;
-  case dt_vector_pair_int_string: {
-    auto v = std::any_cast<std::vector<std::pair<int, std::string>>>(setting);
-    data<std::pair<int, std::string>>() = v;
-  } break;
-  // attributes stored in map but filtered for processing.
-  case dt_indexBy: {
-    updateIndexBy(std::any_cast<indexBy>(setting));
-    bSaveInMap = true;
-  } break;
-  case dt_display_enum: {
-    setting = display{std::any_cast<display::optionEnum>(paramSetting)};
-    bSaveInMap = true;
-  } break;
-  case dt_position_enum: {
-    setting = position{std::any_cast<position::optionEnum>(paramSetting)};
-    bSaveInMap = true;
-  } break;
-  case dt_textAlignment_enum: {
-    setting =
-        textAlignment{std::any_cast<textAlignment::optionEnum>(paramSetting)};
-    bSaveInMap = true;
-  } break;
-  case dt_borderStyle_enum: {
-    setting = borderStyle{std::any_cast<borderStyle::optionEnum>(paramSetting)};
-    bSaveInMap = true;
-  } break;
-  case dt_listStyleType_enum: {
-    setting =
-        listStyleType{std::any_cast<listStyleType::optionEnum>(paramSetting)};
-    bSaveInMap = true;
-  } break;
+    if (bSimple) {
+      depth += bTerminal ? -1 : 1;
+    } else {
+      std::size_t count =
+          (next == std::string::npos ? markup.size() : next) - pos;
+      tokenizeMarkup(pc, std::string_view(markup).substr(pos, count));
+      for (auto &item : pc.parsedData) {
+        if (get<0>(item) == elementTerminal && --depth < 0)
+          break;
+        if (get<0>(item) == element || get<0>(item) == color)
+          depth++;
+      }
+      pc.parsedData.clear();
+    }
 
-  // other items are not filtered, so just pass through to storage.
-  case dt_nonFiltered: {
-    bSaveInMap = true;
-  } break;
+    pos = next == std::string::npos ? next : markup.find('<', next);
   }
 
-  if (bSaveInMap)
-    attributes[std::type_index(setting.type())] = setting;
-  return *this;
+  return splits;
 }
 
 /**
 \internal
-\brief The attribute being set can be contained in an array of std::any
-Typically the caller does not use this function but relies on the
-varodic template version.
+\brief builds the elements of a piece of markup upon a worker thread. The
+piece begins and ends at the top level. The elements are built beneath a
+holder within the document of the worker, then passed out of it, and the
+worker's document is released.
 */
-Element &
-viewManager::Element::setAttribute(const std::vector<std::any> &attribs) {
-  for (auto n : attribs)
-    setAttribute(n);
-  return *this;
+viewManager::Element::markupFragment
+viewManager::Element::buildMarkupFragment(std::string_view markup) {
+  auto &holder = _createElement<DIV>({});
+  parserContext pc{};
+  pc.elementStack.push_back(holder);
+  holder.tokenizeMarkup(pc, markup);
+  holder.buildMarkup(holder, pc);
+
+  markupFragment fragment;
+  fragment.text = std::move(holder.data());
+  for (Element *p = holder.m_firstChild; p; p = p->m_nextSibling)
+    fragment.roots.push_back(p);
+  // the roots are unlinked so the holder is released alone.
+  holder.m_firstChild = nullptr;
+  holder.m_lastChild = nullptr;
+  holder.m_childCount = 0;
+
+  for (auto &n : elements)
+    if (n.first != (std::size_t)&holder)
+      fragment.owned.push_back(std::move(n.second));
+  for (auto &n : indexedElements)
+    fragment.index.emplace_back(n.first, &n.second.get());
+#if defined(USE_LAZY_MARKUP)
+  fragment.deferred.assign(deferredIndex.begin(), deferredIndex.end());
+  fragment.deferredChildren = holder.m_deferredChildren;
+#endif
+
+  releaseElements();
+  return fragment;
 }
 
 /**
 \internal
+\brief takes the elements of a fragment into the document of the calling
+thread and appends its roots and text to the parent. An id already within
+the index keeps its element, as when the markup is parsed in order.
+*/
+void viewManager::Element::adoptMarkupFragment(Element &parent,
+                                               markupFragment &fragment) {
+  for (auto &e : fragment.owned) {
+    std::size_t key = (std::size_t)e.get();
+    elements.emplace(key, std::move(e));
+  }
+  for (auto &n : fragment.index)
+    indexedElements.insert({n.first, std::ref(*n.second)});
+#if defined(USE_LAZY_MARKUP)
+  deferredIndex.insert(fragment.deferred.begin(), fragment.deferred.end());
+  parent.m_deferredChildren += fragment.deferredChildren;
+#endif
 
-\brief updates the id within the index if the item has changed.
+  if (!fragment.text.empty()) {
+    auto &text = parent.data();
+    std::move(fragment.text.begin(), fragment.text.end(),
+              std::back_inserter(text));
+  }
 
+  for (auto p : fragment.roots)
+    parent.appendChild(*p);
+}
+
+/**
+\internal
+\brief Parses large markup on several threads. The markup is divided at
+the positions given by markupSplitPoints. The pieces between them are
+built by buildMarkupFragment upon their own threads, while the first piece
+is parsed into the caller's context. The fragments are then appended in
+document order, and the last piece, which may leave a tag or element open
+for the next call, is parsed into the context as well.
 */
-void viewManager::Element::updateIndexBy(const indexBy &setting) {
-  // changing id just changes
-  // the key in elementById
-  // map
-  std::string oldKey = "";
-  const std::string &newKey = setting.value;
-  auto it = attributes.find(std::type_index(typeid(indexBy)));
+Element &viewManager::Element::ingestMarkupParallel(Element &node,
+                                                    parserContext &pc,
+                                                    const std::string &markup) {
+  std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::size_t> splits =
+      markupSplitPoints(markup, markup.size() / threads);
+
+  if (splits.size() < 2) {
+    tokenizeMarkup(pc, markup);
+    return buildMarkup(node, pc);
+  }
 
-  // get the key of the old id
-  if (it != attributes.end()) {
-    oldKey = std::any_cast<indexBy>(it->second).value;
+  std::string_view sv(markup);
+  std::vector<std::future<markupFragment>> tasks;
+  for (std::size_t i = 0; i + 1 < splits.size(); i++)
+    tasks.emplace_back(std::async(std::launch::async,
+                                  &Element::buildMarkupFragment,
+                                  sv.substr(splits[i], splits[i + 1] -
+                                                           splits[i])));
+
+  tokenizeMarkup(pc, sv.substr(0, splits.front()));
+  buildMarkup(node, pc);
+
+  // the first piece ends at the top level, where the fragments continue.
+  Element &parent =
+      pc.elementStack.empty() ? node : pc.elementStack.back().get();
+  for (auto &task : tasks) {
+    markupFragment fragment = task.get();
+    adoptMarkupFragment(parent, fragment);
   }
 
-  // case a. key is not blank,
-  // yet it is the same value
-  // as the old key therefore
-  // there is no change.
-  if (!oldKey.empty() && oldKey == newKey) {
-    return;
-    // case b. remap just the
-    // key
-  } else if (!oldKey.empty() && !newKey.empty()) {
-    auto nodeHandler = indexedElements.extract(oldKey);
-    nodeHandler.key() = newKey;
-    indexedElements.insert(std::move(nodeHandler));
-    // case c. remove key from
-    // map
-  } else if (!oldKey.empty() && newKey.empty()) {
-    indexedElements.erase(oldKey);
-    // case d. did not exist
-    // before, add key to map
-  } else if (!newKey.empty()) {
-    indexedElements.insert({newKey, std::ref(*this)});
+  if (pc.elementStack.empty())
+    pc.elementStack.push_back(node);
+  tokenizeMarkup(pc, sv.substr(splits.back()));
+  return buildMarkup(node, pc);
+}
+#endif
+
+/**
+\internal
+\brief The function processes one query of a parse context.
+\details The first process of the function is to transform the
+input to lowr case to ensure case insensitive comparisons. The
+pc parserContext structure operates on a stream basis. Therefore
+the logic within this function provides the pass through and control
+break logic to implement the functionality. An intersting effect
+is that at times a token must be completely found before it may be
+processed. For example the ID of a element should be sent within one
+context.
+
+*/
+void viewManager::Element::processParseContext(
+    viewManager::Element::parserContext &pc) {
+
+  string sKey = pc.sCapture;
+  std::transform(sKey.begin(), sKey.end(), sKey.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+
+  if (pc.bAttributeList && !pc.bAttributeListValue) {
+
+    // store iterator to the function
+    auto it = attributeFactory.find(sKey);
+    if (it != attributeFactory.end())
+
+      // if the attribute is a series of two tokens
+      if (get<0>(it->second)) {
+        pc.parsedData.emplace_back(attribute, false, &(*it));
+        pc.bAttributeListValue = true; // value is expected to follow.
+
+      } else {
+        pc.parsedData.emplace_back(attributeSimple, false, &(*it));
+        pc.bAttributeListValue = false;
+      }
+    pc.sCapture = "";
+    pc.bQuery = false;
+    if (!pc.bSignal)
+      pc.bToken = false;
+
+  } else if (pc.bAttributeList && pc.bAttributeListValue) {
+    pc.parsedData.emplace_back(attributeValue, false, pc.sCapture);
+    pc.sCapture = "";
+    pc.bQuery = false;
+
+    if (!pc.bSignal) {
+      pc.bAttributeList = false;
+    }
+    pc.bAttributeListValue = false;
+
+  } else {
+
+    auto it = objectFactoryMap.find(sKey);
+    if (it != objectFactoryMap.end()) {
+
+      if (pc.bTerminal) {
+        pc.parsedData.emplace_back(elementTerminal, false, "");
+        pc.bToken = false;
+        pc.bTerminal = false;
+        pc.bAttributeList = false;
+        pc.bAttributeListValue = false;
+
+      } else {
+        // store the entry of the element factory
+        pc.parsedData.emplace_back(element, false, &(*it));
+        pc.bToken = true;
+        pc.bAttributeList = true;
+        pc.bAttributeListValue = false;
+      }
+
+      pc.sCapture = "";
+      pc.bQuery = false;
+
+    } else {
+      // store the color object within the parser payload
+      auto it = colorNF::colorIndex(sKey);
+      if (it != colorNF::colorFactory.end()) {
+        pc.parsedData.emplace_back(color, false, colorNF(it));
+      }
+
+      // illegal match found, pipe contents into ?
+      pc.bQuery = false;
+    }
   }
-  return;
 }
 
 /**
-\brief inserts the given element before the named second parameter.
-The version of the function is useful when the element is indexed by a
-string and a reference to it does not exist.
-
-\param Element &newChild
+\internal
+\var nodes contains a list of the elements and their coordinates.
+*/
+thread_local std::unordered_map<std::size_t, std::reference_wrapper<Element>>
+    nodes;
 
-\param std::string sID
+std::size_t viewManager::Visualizer::allocate(Element &e) {
+  static thread_local std::size_t token = 0;
+  std::size_t ret = token;
+  nodes.emplace(ret, std::ref<Element>(e));
+  token++;
+  return ret;
+}
+void viewManager::Visualizer::deallocate(const std::size_t &token) {}
 
-Example
--------
-\snippet examples.cpp insertBefore_string
+/**
+\internal
+\brief creates an image of the given size. The pixels are zero.
 */
-auto viewManager::Element::insertBefore(Element &newChild, std::string &sID)
-    -> Element & {
-  return insertBefore(newChild, getElement(sID));
+viewManager::Visualizer::imageSurface::imageSurface(const unsigned int w,
+                                                    const unsigned int h)
+    : m_width(0), m_height(0), m_cachedBytes(0) {
+  resize(w, h);
 }
 
 /**
-\brief inserts the given element before the named second parameter.
-
-\param Element &newChild
-
-\param Element &existingElement
-
-Example
--------
-\snippet examples.cpp insertBefore
+\internal
+\brief copies the pixels only. The mip chain and scaled copies are
+created again when the copy is drawn.
 */
-auto viewManager::Element::insertBefore(Element &newChild,
-                                        Element &existingElement) -> Element & {
-  Element &child = newChild;
-  // maintain tree structure
-  child.m_parent = existingElement.m_parent;
-  child.m_nextSibling = existingElement.m_self;
-  child.m_previousSibling = existingElement.m_previousSibling;
-  existingElement.m_previousSibling = child.m_self;
-  // provide linkage
-  if (child.m_previousSibling)
-    child.m_previousSibling->m_nextSibling = child.m_self;
-  if (child.m_nextSibling)
-    child.m_nextSibling->m_previousSibling = child.m_self;
-  // case where insert is at the first
-  if (existingElement.m_self == m_firstChild) {
-    m_firstChild = child.m_self;
+viewManager::Visualizer::imageSurface::imageSurface(const imageSurface &other)
+    : m_width(other.m_width), m_height(other.m_height),
+      m_pixels(other.m_pixels), m_cachedBytes(0) {}
+
+viewManager::Visualizer::imageSurface &
+viewManager::Visualizer::imageSurface::operator=(const imageSurface &other) {
+  if (this != &other) {
+    invalidate();
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_pixels = other.m_pixels;
   }
-  m_childCount++;
-  return child;
+  return *this;
 }
 
 /**
-\brief inserts the given element after the named second parameter element.
-The version of the function is useful when the element is indexed by a
-string and a reference to it does not exist.
-
-\param Element &newChild
-
-\param std::string sID
+\internal
+\brief changes the size of the image. The contents are not preserved.
+*/
+void viewManager::Visualizer::imageSurface::resize(const unsigned int w,
+                                                   const unsigned int h) {
+  invalidate();
+  m_width = w;
+  m_height = h;
+  m_pixels.assign(static_cast<std::size_t>(w) * h, 0);
+}
 
-Example
--------
-\snippet examples.cpp insertAfter_string
+/**
+\internal
+\brief replaces the image with w x h pixels given row by row.
 */
-auto viewManager::Element::insertAfter(Element &newChild, std::string &sID)
-    -> Element & {
-  return insertAfter(newChild, getElement(sID));
+void viewManager::Visualizer::imageSurface::setPixels(const unsigned int w,
+                                                      const unsigned int h,
+                                                      const uint32_t *pixels) {
+  invalidate();
+  m_width = w;
+  m_height = h;
+  m_pixels.assign(pixels, pixels + static_cast<std::size_t>(w) * h);
 }
 
 /**
-\brief inserts the given element after the named second parameter element.
+\internal
+\brief sets one pixel. Coordinates outside of the image are ignored.
+*/
+void viewManager::Visualizer::imageSurface::putPixel(const unsigned int x,
+                                                     const unsigned int y,
+                                                     const uint32_t color) {
+  if (x >= m_width || y >= m_height)
+    return;
+  invalidate();
+  m_pixels[x + y * m_width] = color;
+}
 
-\param Element &newChild
+/**
+\internal
+\brief discards the mip chain and the scaled copies. It is called when
+the pixels change.
+*/
+void viewManager::Visualizer::imageSurface::invalidate(void) {
+  if (!m_mipChain.empty())
+    m_mipChain.clear();
+  if (!m_scaledCache.empty())
+    m_scaledCache.clear();
+  cacheBytes.images -= m_cachedBytes;
+  m_cachedBytes = 0;
+}
 
-\param Element &existingElement
+/**
+\internal
+\brief discards the mip chain and the scaled copies to free memory. They
+are made again when the image is next drawn. Returns the bytes freed.
+*/
+std::size_t viewManager::Visualizer::imageSurface::trim(void) {
+  std::size_t freed = m_cachedBytes;
+  invalidate();
+  return freed;
+}
 
-Example
--------
-\snippet examples.cpp insertAfter
+/**
+\internal
+\brief returns the image scaled to w x h. The copy is cached by size, at
+most IMAGE_SCALE_CACHE_SIZE copies are kept.
 */
-auto viewManager::Element::insertAfter(Element &newChild,
-                                       Element &existingElement) -> Element & {
+const viewManager::Visualizer::imageSurface &
+viewManager::Visualizer::imageSurface::scaled(const unsigned int w,
+                                              const unsigned int h) {
+  if (w == m_width && h == m_height)
+    return *this;
 
-  // maintain tree structure
-  newChild.m_parent = existingElement.m_parent;
-  newChild.m_nextSibling = existingElement.m_previousSibling;
-  newChild.m_previousSibling = existingElement.m_self;
-  if (existingElement.m_nextSibling)
-    existingElement.m_nextSibling->m_previousSibling = newChild.m_self;
+  for (auto it = m_scaledCache.begin(); it != m_scaledCache.end(); it++) {
+    if (it->w == w && it->h == h) {
+      // most recently used is kept at the front
+      m_scaledCache.splice(m_scaledCache.begin(), m_scaledCache, it);
+      return *m_scaledCache.front().surface;
+    }
+  }
 
-  existingElement.m_nextSibling = newChild.m_self;
+  auto surface = std::make_unique<imageSurface>(w, h);
+  resample(mipLevel(w, h), *surface);
 
-  // case where insert is at the end
-  if (existingElement.m_self == m_lastChild) {
-    m_lastChild = newChild.m_self;
+  std::size_t bytes = static_cast<std::size_t>(w) * h * sizeof(uint32_t);
+  m_cachedBytes += bytes;
+  cacheBytes.images += bytes;
+
+  m_scaledCache.push_front(scaledCopy{w, h, std::move(surface)});
+  while (m_scaledCache.size() > IMAGE_SCALE_CACHE_SIZE) {
+    auto &last = m_scaledCache.back();
+    bytes = static_cast<std::size_t>(last.w) * last.h * sizeof(uint32_t);
+    m_cachedBytes -= bytes;
+    cacheBytes.images -= bytes;
+    m_scaledCache.pop_back();
   }
-  m_childCount++;
-  return newChild;
+
+  return *m_scaledCache.front().surface;
 }
 
 /**
-\brief replaces the child with the new one specified.
-\details The function replaces the reference child with the new one
-selected. The ne child should be within the first parameter while the second
-parameter should contain an existing child. When the oldChild is replaced,
-it is removed from the indexBy list and its memory is freed.
+\internal
+\brief returns the smallest mip level that is at least w x h, so the
+bilinear resample that follows never reduces by more than half. Levels
+are built as they are first needed.
+*/
+const viewManager::Visualizer::imageSurface &
+viewManager::Visualizer::imageSurface::mipLevel(const unsigned int w,
+                                                const unsigned int h) {
+  const imageSurface *level = this;
+  std::size_t index = 0;
+
+  while (level->m_width / 2 >= std::max(w, 1u) &&
+         level->m_height / 2 >= std::max(h, 1u)) {
+    if (index == m_mipChain.size()) {
+      auto next = std::make_unique<imageSurface>(level->m_width / 2,
+                                                 level->m_height / 2);
+      halve(*level, *next);
+
+      std::size_t bytes = static_cast<std::size_t>(next->m_width) *
+                          next->m_height * sizeof(uint32_t);
+      m_cachedBytes += bytes;
+      cacheBytes.images += bytes;
+      m_mipChain.push_back(std::move(next));
+    }
+    level = m_mipChain[index].get();
+    index++;
+  }
 
-\param Element& newChild a newly created child.
-\param std::string& sID an existing child that is to be replaced.
+  return *level;
+}
 
-Example
--------
-\snippet examples.cpp replaceChild_string
+/**
+\brief the rounded mean of each channel of four pixels, (sum + 2) / 4.
+halve gives the same result with or without SSE2.
 */
-auto viewManager::Element::replaceChild(Element &newChild, std::string &sID)
-    -> Element & {
-  return replaceChild(newChild, getElement(sID));
+uint32_t viewManager::Visualizer::imageSurface::boxAverage(const uint32_t a,
+                                                           const uint32_t b,
+                                                           const uint32_t c,
+                                                           const uint32_t d) {
+  uint32_t ret = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    uint32_t sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) +
+                   ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+    ret |= ((sum + 2) >> 2) << shift;
+  }
+  return ret;
 }
 
 /**
-\brief replaces the child with the new one specified.
-\details The function replaces the reference child with the new one
-selected. The new child should be within the first parameter while the
-second parameter should contain an existing child. When the oldChild is
-replaced, it is removed from the indexBy list and its memory is freed.
-
-\param Element& newChild a newly created child.
-\param Element& oldChild an existing child that is to be replaced.
+\brief reduces src to half its size into dst with a 2x2 box filter of
+boxAverage. An odd last row or column of src is not sampled.
 
 Example
 -------
-\snippet examples.cpp replaceChild
+\snippet examples.cpp halve
 */
-auto viewManager::Element::replaceChild(Element &newChild, Element &oldChild)
-    -> Element & {
-
-  // unattach the old one and insert the new one
-  if (oldChild.m_parent->m_firstChild == oldChild.m_self)
-    oldChild.m_parent->m_firstChild = newChild.m_self;
-
-  if (oldChild.m_parent->m_lastChild == oldChild.m_self)
-    oldChild.m_parent->m_lastChild = newChild.m_self;
+void viewManager::Visualizer::imageSurface::halve(const imageSurface &src,
+                                                  imageSurface &dst) {
+#if defined(USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+#endif
 
-  if (oldChild.m_previousSibling)
-    oldChild.m_previousSibling->m_nextSibling = newChild.m_self;
+  for (unsigned int y = 0; y < dst.m_height; y++) {
+    const uint32_t *r0 = src.row(y * 2);
+    const uint32_t *r1 = src.row(y * 2 + 1);
+    uint32_t *out = dst.row(y);
+    unsigned int x = 0;
+
+#if defined(USE_SSE2)
+    // four destination pixels from eight source pixels of each row. The
+    // channels are widened to 16 bits so that the sums are exact, two
+    // source pixels to a register.
+    for (; x + 4 <= dst.m_width; x += 4) {
+      const __m128i *p0 = reinterpret_cast<const __m128i *>(r0 + x * 2);
+      const __m128i *p1 = reinterpret_cast<const __m128i *>(r1 + x * 2);
+      __m128i a = _mm_loadu_si128(p0);
+      __m128i b = _mm_loadu_si128(p1);
+      __m128i c = _mm_loadu_si128(p0 + 1);
+      __m128i d = _mm_loadu_si128(p1 + 1);
+
+      // the rows are summed, source pixels 0 1, 2 3, 4 5 and 6 7.
+      __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                 _mm_unpacklo_epi8(b, zero));
+      __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                 _mm_unpackhi_epi8(b, zero));
+      __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(c, zero),
+                                 _mm_unpacklo_epi8(d, zero));
+      __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(c, zero),
+                                 _mm_unpackhi_epi8(d, zero));
+
+      // then the even and odd columns, destination pixels 0 1 and 2 3.
+      __m128i q0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1),
+                                 _mm_unpackhi_epi64(s0, s1));
+      __m128i q1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3),
+                                 _mm_unpackhi_epi64(s2, s3));
+      q0 = _mm_srli_epi16(_mm_add_epi16(q0, two), 2);
+      q1 = _mm_srli_epi16(_mm_add_epi16(q1, two), 2);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x),
+                       _mm_packus_epi16(q0, q1));
+    }
+#endif
 
-  if (oldChild.m_nextSibling)
-    oldChild.m_nextSibling->m_previousSibling = newChild.m_self;
+    for (; x < dst.m_width; x++)
+      out[x] = boxAverage(r0[x * 2], r0[x * 2 + 1], r1[x * 2], r1[x * 2 + 1]);
+  }
+}
 
-  newChild.m_parent = oldChild.m_parent;
+/**
+\internal
+\brief scales src to the size of dst with bilinear filtering. Weights are
+8 bit fixed point. The source coordinates of each column are computed once.
+*/
+void viewManager::Visualizer::imageSurface::resample(const imageSurface &src,
+                                                     imageSurface &dst) {
+  if (src.empty() || dst.empty())
+    return;
 
-  // remove reference from string id indexed list
-  try {
-    indexedElements.erase(oldChild.getAttribute<indexBy>().value);
+  // maps a destination coordinate to the two source coordinates and the
+  // weight of the second, sampling at pixel centers.
+  auto sourceCoordinate = [](unsigned int d, unsigned int dstSize,
+                             unsigned int srcSize, unsigned int &s0,
+                             unsigned int &s1, uint16_t &weight) {
+    double s = (d + 0.5) * srcSize / dstSize - 0.5;
+    if (s < 0)
+      s = 0;
+    s0 = static_cast<unsigned int>(s);
+    if (s0 >= srcSize - 1) {
+      s0 = srcSize - 1;
+      s = s0;
+    }
+    s1 = std::min(s0 + 1, srcSize - 1);
+    weight = static_cast<uint16_t>((s - s0) * 256 + 0.5);
+  };
 
-  } catch (const std::exception &e) {
-    // std::cout << " Exception: " << e.what() << "\n";
+  std::vector<unsigned int> x0(dst.m_width);
+  std::vector<unsigned int> x1(dst.m_width);
+  std::vector<uint16_t> fx(dst.m_width);
+  for (unsigned int x = 0; x < dst.m_width; x++)
+    sourceCoordinate(x, dst.m_width, src.m_width, x0[x], x1[x], fx[x]);
+
+  for (unsigned int y = 0; y < dst.m_height; y++) {
+    unsigned int y0, y1;
+    uint16_t fy;
+    sourceCoordinate(y, dst.m_height, src.m_height, y0, y1, fy);
+    const uint32_t *r0 = src.row(y0);
+    const uint32_t *r1 = src.row(y1);
+    uint32_t *out = dst.row(y);
+
+#if defined(USE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wy0 = _mm_set1_epi16(static_cast<short>(256 - fy));
+    const __m128i wy1 = _mm_set1_epi16(static_cast<short>(fy));
+
+    for (unsigned int x = 0; x < dst.m_width; x++) {
+      // the left and right samples are held as 16 bit channels within the
+      // low and high halves of the register.
+      __m128i top = _mm_unpacklo_epi8(
+          _mm_unpacklo_epi32(_mm_cvtsi32_si128(r0[x0[x]]),
+                             _mm_cvtsi32_si128(r0[x1[x]])),
+          zero);
+      __m128i bottom = _mm_unpacklo_epi8(
+          _mm_unpacklo_epi32(_mm_cvtsi32_si128(r1[x0[x]]),
+                             _mm_cvtsi32_si128(r1[x1[x]])),
+          zero);
+      __m128i v = _mm_srli_epi16(
+          _mm_add_epi16(_mm_mullo_epi16(top, wy0), _mm_mullo_epi16(bottom, wy1)),
+          8);
+
+      short wx1 = static_cast<short>(fx[x]);
+      short wx0 = static_cast<short>(256 - fx[x]);
+      __m128i h = _mm_mullo_epi16(
+          v, _mm_set_epi16(wx1, wx1, wx1, wx1, wx0, wx0, wx0, wx0));
+      h = _mm_srli_epi16(_mm_add_epi16(h, _mm_srli_si128(h, 8)), 8);
+      out[x] = static_cast<uint32_t>(
+          _mm_cvtsi128_si32(_mm_packus_epi16(h, zero)));
+    }
+#else
+    for (unsigned int x = 0; x < dst.m_width; x++) {
+      uint32_t p00 = r0[x0[x]], p01 = r0[x1[x]];
+      uint32_t p10 = r1[x0[x]], p11 = r1[x1[x]];
+      uint32_t ret = 0;
+      for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t top = (((p00 >> shift) & 0xFF) * (256 - fx[x]) +
+                        ((p01 >> shift) & 0xFF) * fx[x]);
+        uint32_t bottom = (((p10 >> shift) & 0xFF) * (256 - fx[x]) +
+                           ((p11 >> shift) & 0xFF) * fx[x]);
+        ret |= (((top >> 8) * (256 - fy) + (bottom >> 8) * fy) >> 8) << shift;
+      }
+      out[x] = ret;
+    }
+#endif
   }
+}
 
-  // remove the element smart pointer
-  auto it = elements.find((std::size_t)oldChild.m_self);
-  if (it != elements.end())
-    elements.erase(it);
+/**
+\internal
+\brief writes pixels in the format of the offscreen buffer, blue, green,
+red and an unused byte, as a binary portable pixmap. The format needs no
+image library.
+*/
+void viewManager::Visualizer::writePixmap(const std::string &sFilename,
+                                          const u_int8_t *pixels,
+                                          const unsigned short w,
+                                          const unsigned short h) {
+  std::ofstream out(sFilename, std::ios::binary);
+  if (!out)
+    throw std::runtime_error("The image file could not be created: " +
+                             sFilename);
+
+  out << "P6\n" << w << " " << h << "\n255\n";
+
+  std::vector<char> row(static_cast<std::size_t>(w) * 3);
+  for (std::size_t y = 0; y < h; y++) {
+    const u_int8_t *p = &pixels[y * w * 4];
+    for (std::size_t x = 0; x < w; x++, p += 4) {
+      row[x * 3] = static_cast<char>(p[2]);
+      row[x * 3 + 1] = static_cast<char>(p[1]);
+      row[x * 3 + 2] = static_cast<char>(p[0]);
+    }
+    out.write(row.data(), static_cast<std::streamsize>(row.size()));
+  }
 
-  return *this;
+  if (!out)
+    throw std::runtime_error("The image file could not be written: " +
+                             sFilename);
 }
 
+#if defined(__linux__)
 /**
-\brief moves the element to the specified location.
-\details The method provides a shortened call to move both coordinates
-at the same time. The objectTop and objectLeft are set. The method accepts
-numerical values and only sets the value of the attribute. It does not
-change the numerical format of the underlying attribute values.
-
-Example
--------
-\snippet examples.cpp move
+\internal
+\brief appends a little endian number of the given size to the stream.
 */
-auto viewManager::Element::move(const double t, const double l) -> Element & {
-  getAttribute<objectTop>().value = t;
-  getAttribute<objectLeft>().value = l;
-  return *this;
+static void putFrameNumber(std::vector<u_int8_t> &out, const uint32_t value,
+                           const int bytes) {
+  for (int i = 0; i < bytes; i++)
+    out.push_back(static_cast<u_int8_t>(value >> (i * 8)));
 }
 
 /**
-\brief resizes the element
-\details The method provides a shortened call to resize an element.
-The objectWidth and objectHeight are set at the same time. The method
-accepts numerical values and only sets the value of the attribute. It does
-not change the numerical format of the underlying attribute values.
-
-Example
--------
-\snippet examples.cpp resize
+\internal
+\brief reads a little endian number of the given size.
 */
-auto viewManager::Element::resize(const double w, const double h) -> Element & {
-  getAttribute<objectWidth>().value = w;
-  getAttribute<objectHeight>().value = h;
-  return *this;
+static uint32_t getFrameNumber(const u_int8_t *p, const int bytes) {
+  uint32_t value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= static_cast<uint32_t>(p[i]) << (i * 8);
+  return value;
 }
 
 /**
-\brief removes the element from the document tree and free the memory
-associated.
-
-\details The remove method provides an easy method to delete an
-object from the document hierarchy. The method does not provide continuation
-syntax as after the call is complete, all memory associated with the object
-will be freed. The indexBy list is also modified to update the change.
-
-Example
--------
-\snippet examples.cpp remove
+\internal
+\brief opens the socket given by a frame address, either listening for
+clients or connected to a server. The address is "unix:path", "tcp:port"
+upon the loopback interface or "tcp:host:port".
 */
-void viewManager::Element::remove(void) {
-  // recursively remove all children
-  removeChildren();
-
-  // update tree linkage
-  if (m_parent && m_parent->m_firstChild == m_self)
-    m_parent->m_firstChild = m_nextSibling;
-
-  if (m_parent && m_parent->m_lastChild == m_self)
-    m_parent->m_lastChild = m_previousSibling;
-
-  if (m_nextSibling)
-    m_nextSibling->m_previousSibling = m_previousSibling;
+int viewManager::Visualizer::frameSocket(const std::string &sAddress,
+                                         const bool bListen) {
+  int fd = -1;
+  int ret = -1;
+
+  if (sAddress.compare(0, 5, "unix:") == 0) {
+    std::string sPath = sAddress.substr(5);
+    sockaddr_un addr{};
+    if (sPath.empty() || sPath.size() >= sizeof(addr.sun_path))
+      throw std::invalid_argument("The frame socket path is not valid: " +
+                                  sAddress);
+    addr.sun_family = AF_UNIX;
+    std::copy(sPath.begin(), sPath.end(), addr.sun_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0) {
+      if (bListen) {
+        // a socket left by an earlier server is replaced. Any other file
+        // at the path is kept and the bind fails.
+        struct stat st;
+        if (lstat(sPath.data(), &st) == 0 && S_ISSOCK(st.st_mode))
+          unlink(sPath.data());
+        ret = bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+      } else {
+        ret = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+      }
+    }
 
-  if (m_previousSibling)
-    m_previousSibling->m_nextSibling = m_nextSibling;
+  } else if (sAddress.compare(0, 4, "tcp:") == 0) {
+    std::string sHost = "127.0.0.1";
+    std::string sPort = sAddress.substr(4);
+    std::size_t colon = sPort.rfind(':');
+    if (colon != std::string::npos) {
+      sHost = sPort.substr(0, colon);
+      sPort = sPort.substr(colon + 1);
+    }
 
-  // remove reference from string id indexed list
-  try {
-    indexedElements.erase(getAttribute<indexBy>().value);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    int port = 0;
+    auto [ptr, ec] =
+        std::from_chars(sPort.data(), sPort.data() + sPort.size(), port);
+    if (ec != std::errc() || ptr != sPort.data() + sPort.size() || port <= 0 ||
+        port > 65535 || inet_pton(AF_INET, sHost.data(), &addr.sin_addr) != 1)
+      throw std::invalid_argument("The frame address is not valid: " +
+                                  sAddress);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0) {
+      int one = 1;
+      if (bListen) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ret = bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+      } else {
+        ret = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+      }
+      // tiles are small writes that should not wait for one another.
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
 
-  } catch (const std::exception &e) {
-    // std::cout << " Exception: " << e.what() << "\n";
+  } else {
+    throw std::invalid_argument(
+        "The frame address must begin with unix: or tcp: " + sAddress);
   }
 
-  // free smart pointer
-  auto it = elements.find((std::size_t)m_self);
-  if (it != elements.end())
-    elements.erase(it);
+  if (ret == 0 && bListen)
+    ret = listen(fd, 8);
 
-  return;
+  if (ret != 0) {
+    std::string sError = strerror(errno);
+    if (fd >= 0)
+      close(fd);
+    throw std::runtime_error("The frame socket could not be opened: " +
+                             sAddress + " " + sError);
+  }
+
+  return fd;
 }
 
 /**
-\brief removes a child element from the list and free the associated memory.
-\param std::string& isID is an existing child of the referenced element to
-remove.
+\internal
+\brief opens the socket and starts the threads of the server. Frames are
+sent once submit is called.
+*/
+viewManager::Visualizer::frameServer::frameServer(const std::string &sAddress)
+    : m_bStop(false), m_nextW(0), m_nextH(0), m_bFrameReady(false), m_w(0),
+      m_h(0) {
+  m_listen = frameSocket(sAddress, true);
+  if (sAddress.compare(0, 5, "unix:") == 0)
+    m_sPath = sAddress.substr(5);
+
+  m_acceptor = std::thread(&frameServer::acceptClients, this);
+  m_encoder = std::thread(&frameServer::encodeFrames, this);
+  m_sender = std::thread(&frameServer::sendFrames, this);
+}
 
-\details The removeChild destroys an existing child element of a document
-tree. After the function completes, all associated reference within the
-system will be discontinued. This includes the smart pointer and the indexBy
-list.
+/**
+\internal
+\brief stops the threads and closes the connections.
+*/
+viewManager::Visualizer::frameServer::~frameServer() {
+  m_bStop = true;
+
+  // shutting down the listening socket releases accept.
+  shutdown(m_listen, SHUT_RDWR);
+  {
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    m_frameReady.notify_all();
+  }
+  {
+    // shutting down the clients releases a send in progress, so the
+    // sender is not waited upon.
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    for (auto fd : m_clients)
+      shutdown(fd, SHUT_RDWR);
+    m_sendReady.notify_all();
+    m_sendSpace.notify_all();
+  }
 
-\exception std::invalid_argument may be thrown if the element is not found
-by the given id or the referenced element is not a child.
+  m_acceptor.join();
+  m_encoder.join();
+  m_sender.join();
+
+  close(m_listen);
+  if (!m_sPath.empty())
+    unlink(m_sPath.data());
+
+  for (auto fd : m_clients)
+    close(fd);
+  for (auto fd : m_joining)
+    close(fd);
+  for (auto &frame : m_sendQueue)
+    for (auto fd : frame.joining)
+      close(fd);
+}
 
-Example
--------
-\snippet examples.cpp removeChild_string
+/**
+\internal
+\brief gives the frame shown by the platform to the encoder. The pixels are
+copied and the caller does not wait for the encoding. A frame not yet
+taken by the encoder is replaced.
 */
-auto viewManager::Element::removeChild(std::string &sID) -> Element & {
-  return removeChild(getElement(sID));
+void viewManager::Visualizer::frameServer::submit(
+    const std::vector<u_int8_t> &pixels, const unsigned short w,
+    const unsigned short h) {
+  std::size_t bytes = static_cast<std::size_t>(w) * h * 4;
+  if (pixels.size() < bytes)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_frameMutex);
+  m_next.assign(pixels.begin(), pixels.begin() + bytes);
+  m_nextW = w;
+  m_nextH = h;
+  m_bFrameReady = true;
+  m_frameReady.notify_one();
 }
 
 /**
-\brief removes a child element from the list and free the associated memory.
-\param Element& oldChild is an existing child of the referenced element to
-remove.
+\internal
+\brief accepts the clients. They are given to the encoder which sends
+every tile of the next frame along with them. Writes to a client wait at
+most FRAME_SERVER_SEND_TIMEOUT.
+*/
+void viewManager::Visualizer::frameServer::acceptClients(void) {
+  while (!m_bStop) {
+    int fd = accept(m_listen, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      return;
+    }
 
-\details The removeChild destroys an existing child element of a document
-tree. After the function completes, all associated reference within the
-system will be discontinued. This includes the smart pointer and the indexBy
-list.
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval timeout{FRAME_SERVER_SEND_TIMEOUT / 1000,
+                    (FRAME_SERVER_SEND_TIMEOUT % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
 
-\exception std::invalid_argument may be thrown if the element is not a
-child. Example
--------
-\snippet examples.cpp removeChild
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    m_joining.push_back(fd);
+    m_frameReady.notify_one();
+  }
+}
+
+/**
+\internal
+\brief compares a rectangle of two frames, the number of bytes of each
+row being given. The rows are compared sixteen bytes at a time.
 */
-auto viewManager::Element::removeChild(Element &oldChild) -> Element & {
-  // only remove children that are attached to the object
-  if (oldChild.m_parent != m_self) {
-    std::string info = "Referenced element is not a child.";
-    throw std::invalid_argument(info);
+bool viewManager::Visualizer::regionChanged(
+    const u_int8_t *a, const std::size_t strideA, const u_int8_t *b,
+    const std::size_t strideB, const std::size_t bytes,
+    const unsigned int rows) {
+  for (unsigned int y = 0; y < rows; y++, a += strideA, b += strideB) {
+    std::size_t i = 0;
+#if defined(USE_SSE2)
+    for (; i + 16 <= bytes; i += 16) {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF)
+        return true;
+    }
+#endif
+    if (i < bytes && std::memcmp(a + i, b + i, bytes - i) != 0)
+      return true;
   }
+  return false;
+}
 
-  // recursively remove children
-  auto pItem = oldChild.m_firstChild;
-  while (pItem) {
-    pItem->removeChild(*pItem);
-    pItem = pItem->m_nextSibling;
+/**
+\internal
+\brief appends a tile to the stream. Runs of equal pixels are used when
+shorter than the raw pixels, and zlib is tried when the runs do not reduce
+the tile to a quarter.
+*/
+void viewManager::Visualizer::frameServer::encodeTile(
+    const u_int8_t *pixels, const unsigned short x, const unsigned short y,
+    const unsigned short tw, const unsigned short th,
+    std::vector<u_int8_t> &out) {
+  const std::size_t rowBytes = static_cast<std::size_t>(tw) * 4;
+  const std::size_t rawBytes = rowBytes * th;
+
+  m_tile.resize(rawBytes);
+  for (unsigned short row = 0; row < th; row++)
+    std::memcpy(&m_tile[row * rowBytes],
+                pixels + ((static_cast<std::size_t>(y) + row) * m_w + x) * 4,
+                rowBytes);
+
+  // runs of a 16 bit count and the pixel.
+  m_encoded.clear();
+  const uint32_t *p = reinterpret_cast<const uint32_t *>(m_tile.data());
+  const std::size_t count = rawBytes / 4;
+  for (std::size_t i = 0; i < count && m_encoded.size() < rawBytes;) {
+    std::size_t run = 1;
+    while (i + run < count && run < 0xFFFF && p[i + run] == p[i])
+      run++;
+    putFrameNumber(m_encoded, static_cast<uint32_t>(run), 2);
+    putFrameNumber(m_encoded, p[i], 4);
+    i += run;
   }
 
-  // modify tree linkage
-  if (m_firstChild == oldChild.m_self) {
-    m_firstChild = oldChild.m_nextSibling;
+  tileEncoding encoding = tileEncoding::rle;
+  const u_int8_t *data = m_encoded.data();
+  std::size_t length = m_encoded.size();
+  if (length >= rawBytes) {
+    encoding = tileEncoding::raw;
+    data = m_tile.data();
+    length = rawBytes;
   }
 
-  if (m_lastChild == oldChild.m_self) {
-    m_lastChild = oldChild.m_previousSibling;
+  std::vector<u_int8_t> compressed;
+  if (length > rawBytes / 4) {
+    uLongf compressedSize = compressBound(static_cast<uLong>(rawBytes));
+    compressed.resize(compressedSize);
+    if (compress2(compressed.data(), &compressedSize, m_tile.data(),
+                  static_cast<uLong>(rawBytes), Z_BEST_SPEED) == Z_OK &&
+        compressedSize < length) {
+      encoding = tileEncoding::zlib;
+      data = compressed.data();
+      length = compressedSize;
+    }
   }
 
-  if (oldChild.m_previousSibling)
-    oldChild.m_previousSibling->m_nextSibling = oldChild.m_nextSibling;
+  putFrameNumber(out, x, 2);
+  putFrameNumber(out, y, 2);
+  putFrameNumber(out, tw, 2);
+  putFrameNumber(out, th, 2);
+  putFrameNumber(out, static_cast<uint32_t>(encoding), 1);
+  putFrameNumber(out, static_cast<uint32_t>(length), 4);
+  out.insert(out.end(), data, data + length);
+}
 
-  if (oldChild.m_nextSibling)
-    oldChild.m_nextSibling->m_previousSibling = oldChild.m_previousSibling;
+/**
+\internal
+\brief compares each frame with the last one sent and encodes the tiles
+that differ. Every tile is encoded when the size changes or clients join.
+*/
+void viewManager::Visualizer::frameServer::encodeFrames(void) {
+  while (true) {
+    encodedFrame frame;
+    bool bNewFrame = false;
+    bool bKeyFrame = false;
+
+    {
+      std::unique_lock<std::mutex> lock(m_frameMutex);
+      // clients that join before the first frame wait for it.
+      m_frameReady.wait(lock, [this]() {
+        return m_bStop || m_bFrameReady || (!m_joining.empty() && m_w);
+      });
+      if (m_bStop)
+        return;
+
+      if (m_bFrameReady) {
+        m_current.swap(m_next);
+        bKeyFrame = m_nextW != m_w || m_nextH != m_h;
+        m_w = m_nextW;
+        m_h = m_nextH;
+        m_bFrameReady = false;
+        bNewFrame = true;
+      }
+      frame.joining.swap(m_joining);
+    }
 
-  // update string index list
-  try {
-    indexedElements.erase(oldChild.getAttribute<indexBy>().value);
+    bKeyFrame = bKeyFrame || !frame.joining.empty();
+    const std::vector<u_int8_t> &pixels = bNewFrame ? m_current : m_previous;
+    const std::size_t stride = static_cast<std::size_t>(m_w) * 4;
+
+    std::vector<u_int8_t> &out = frame.bytes;
+    putFrameNumber(out, FRAME_STREAM_MAGIC, 4);
+    putFrameNumber(out, m_w, 2);
+    putFrameNumber(out, m_h, 2);
+    std::size_t countOffset = out.size();
+    putFrameNumber(out, 0, 4);
+
+    uint32_t tiles = 0;
+    for (unsigned int y = 0; y < m_h; y += FRAME_SERVER_TILE) {
+      unsigned int th = std::min<unsigned int>(FRAME_SERVER_TILE, m_h - y);
+      for (unsigned int x = 0; x < m_w; x += FRAME_SERVER_TILE) {
+        unsigned int tw = std::min<unsigned int>(FRAME_SERVER_TILE, m_w - x);
+        std::size_t offset = y * stride + static_cast<std::size_t>(x) * 4;
+        if (!bKeyFrame &&
+            !regionChanged(&pixels[offset], stride, &m_previous[offset],
+                           stride, static_cast<std::size_t>(tw) * 4, th))
+          continue;
+        encodeTile(pixels.data(), x, y, tw, th, out);
+        tiles++;
+      }
+    }
 
-  } catch (const std::exception &e) {
-    // std::cout << " Exception: " << e.what() << "\n";
-  }
+    if (bNewFrame)
+      m_previous.swap(m_current);
 
-  // free memory
-  auto it = elements.find((std::size_t)oldChild.m_self);
-  if (it != elements.end())
-    elements.erase(it);
+    if (!tiles && frame.joining.empty())
+      continue;
 
-  m_childCount--;
-  return *this;
+    for (int i = 0; i < 4; i++)
+      out[countOffset + i] = static_cast<u_int8_t>(tiles >> (i * 8));
+
+    std::unique_lock<std::mutex> lock(m_sendMutex);
+    m_sendSpace.wait(lock, [this]() {
+      return m_bStop || m_sendQueue.size() < FRAME_SERVER_QUEUE;
+    });
+    if (m_bStop) {
+      for (auto fd : frame.joining)
+        close(fd);
+      return;
+    }
+    m_sendQueue.push_back(std::move(frame));
+    m_sendReady.notify_one();
+  }
 }
 
 /**
-\brief removes all children from the document tree associated with the given
-element and free the memory.
-\details The removeChild is a bulk operation function in which all
-child document elements of the referenced element is freed. After the
-function completes, all associated references will not longer be tracked
-within the system.
+\internal
+\brief writes the encoded frames to the clients. A client whose connection
+fails, or that does not read within FRAME_SERVER_SEND_TIMEOUT, is closed.
+*/
+void viewManager::Visualizer::frameServer::sendFrames(void) {
+  std::vector<int> clients;
+  std::vector<int> dropped;
+
+  while (true) {
+    encodedFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(m_sendMutex);
+      m_sendReady.wait(lock,
+                       [this]() { return m_bStop || !m_sendQueue.empty(); });
+      if (m_bStop)
+        return;
+      frame = std::move(m_sendQueue.front());
+      m_sendQueue.pop_front();
+      m_sendSpace.notify_one();
+
+      m_clients.insert(m_clients.end(), frame.joining.begin(),
+                       frame.joining.end());
+      clients = m_clients;
+    }
 
-Example
--------
-\snippet examples.cpp removeChildren
+    dropped.clear();
+    for (auto fd : clients) {
+      const u_int8_t *p = frame.bytes.data();
+      std::size_t remaining = frame.bytes.size();
+      while (remaining) {
+        ssize_t sent = send(fd, p, remaining, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+          continue;
+        // EAGAIN is the send timeout of a client that stopped reading.
+        if (sent <= 0) {
+          dropped.push_back(fd);
+          break;
+        }
+        p += sent;
+        remaining -= static_cast<std::size_t>(sent);
+      }
+    }
+
+    if (dropped.empty())
+      continue;
+
+    // the descriptors are closed with the lock held so the destructor does
+    // not shut down one that has been reused.
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    for (auto fd : dropped) {
+      m_clients.erase(std::remove(m_clients.begin(), m_clients.end(), fd),
+                      m_clients.end());
+      close(fd);
+    }
+  }
+}
 
+/**
+\internal
+\brief reads the given number of bytes from the socket.
 */
-auto viewManager::Element::removeChildren(void) -> Element & {
+static bool readFrameBytes(const int fd, u_int8_t *p, std::size_t n) {
+  while (n) {
+    ssize_t got = read(fd, p, n);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return false;
+    p += got;
+    n -= static_cast<std::size_t>(got);
+  }
+  return true;
+}
 
-  auto pItem = m_firstChild;
-  while (pItem) {
-    std::size_t storageKey = (std::size_t)pItem;
-    if (pItem->m_childCount)
-      pItem->removeChildren();
+/**
+\internal
+\brief reads one frame from the server and applies its tiles. Returns
+false when the connection is closed.
+*/
+bool viewManager::Visualizer::frameDecoder::receive(const int fd) {
+  u_int8_t header[12];
+  if (!readFrameBytes(fd, header, sizeof(header)))
+    return false;
+
+  if (getFrameNumber(header, 4) != FRAME_STREAM_MAGIC)
+    throw std::runtime_error("The frame stream is not valid.");
+
+  unsigned short w = static_cast<unsigned short>(getFrameNumber(header + 4, 2));
+  unsigned short h = static_cast<unsigned short>(getFrameNumber(header + 6, 2));
+  if (w != m_width || h != m_height) {
+    m_width = w;
+    m_height = h;
+    m_pixels.assign(static_cast<std::size_t>(w) * h * 4, 0);
+  }
 
-    // update string index list
-    try {
-      indexedElements.erase(pItem->getAttribute<indexBy>().value);
+  m_tiles = getFrameNumber(header + 8, 4);
+  m_frameBytes = sizeof(header);
+
+  for (std::size_t i = 0; i < m_tiles; i++) {
+    u_int8_t tileHeader[13];
+    if (!readFrameBytes(fd, tileHeader, sizeof(tileHeader)))
+      return false;
+
+    unsigned int x = getFrameNumber(tileHeader, 2);
+    unsigned int y = getFrameNumber(tileHeader + 2, 2);
+    unsigned int tw = getFrameNumber(tileHeader + 4, 2);
+    unsigned int th = getFrameNumber(tileHeader + 6, 2);
+    auto encoding = static_cast<tileEncoding>(tileHeader[8]);
+    std::size_t length = getFrameNumber(tileHeader + 9, 4);
+    if (x + tw > m_width || y + th > m_height)
+      throw std::runtime_error("The frame stream holds a tile outside the "
+                               "frame.");
+
+    // the server sends raw pixels when no encoding is smaller, so no tile
+    // is longer than its pixels.
+    const std::size_t rowBytes = static_cast<std::size_t>(tw) * 4;
+    const std::size_t rawBytes = rowBytes * th;
+    if (length > rawBytes)
+      throw std::runtime_error("The frame stream holds a tile longer than "
+                               "its pixels.");
+
+    m_data.resize(length);
+    if (!readFrameBytes(fd, m_data.data(), length))
+      return false;
+    m_frameBytes += sizeof(tileHeader) + length;
+
+    bool bValid = false;
+
+    switch (encoding) {
+    case tileEncoding::raw:
+      m_tile = m_data;
+      bValid = length == rawBytes;
+      break;
 
-    } catch (const std::exception &e) {
-      // std::cout << " Exception: " << e.what() << "\n";
+    case tileEncoding::rle: {
+      m_tile.clear();
+      for (std::size_t n = 0; n + 6 <= length; n += 6) {
+        uint32_t pixel = getFrameNumber(&m_data[n + 2], 4);
+        std::size_t run = getFrameNumber(&m_data[n], 2);
+        if (m_tile.size() + run * 4 > rawBytes)
+          break;
+        for (std::size_t r = 0; r < run; r++)
+          putFrameNumber(m_tile, pixel, 4);
+      }
+      bValid = m_tile.size() == rawBytes && length % 6 == 0;
+    } break;
+
+    case tileEncoding::zlib: {
+      m_tile.resize(rawBytes);
+      uLongf size = static_cast<uLongf>(rawBytes);
+      bValid = uncompress(m_tile.data(), &size, m_data.data(),
+                          static_cast<uLong>(length)) == Z_OK &&
+               size == rawBytes;
+    } break;
     }
 
-    // free memory
-    pItem = pItem->m_nextSibling;
-    auto it = elements.find(storageKey);
-    if (it != elements.end())
-      elements.erase(it);
-  }
+    if (!bValid)
+      throw std::runtime_error("The frame stream holds a tile that could "
+                               "not be decoded.");
 
-  // update linkage
-  m_firstChild = nullptr;
-  m_lastChild = nullptr;
-  m_childCount = 0;
+    for (unsigned int row = 0; row < th; row++)
+      std::memcpy(&m_pixels[((y + row) * m_width + x) * 4],
+                  &m_tile[row * rowBytes], rowBytes);
+  }
 
-  return *this;
+  return true;
 }
 
 /**
-\brief The function removes all children and data from the
-the element. All memory for each of the elements is freed.
-
-\details The clear method is a bulk operation that removes
-all associated data within the public data members as well as
-all manually document elements. It should be noted that
-all of the data() adapters are erased.
-
-Example
--------
-\snippet examples.cpp clear
+\internal
+\brief rounds the size of a part of the frame export to a cache line.
 */
-auto viewManager::Element::clear(void) -> Element & {
-  // delete all items in the dat vector
-  auto n = m_usageAdaptorMap.begin();
-  while (n != m_usageAdaptorMap.end())
-    n = m_usageAdaptorMap.erase(n);
-
-  removeChildren();
-  return *this;
+static std::size_t frameExportAlign(const std::size_t n) {
+  return (n + 63) & ~static_cast<std::size_t>(63);
 }
 
 /**
 \internal
+\brief creates the shared memory ring. The name is that given to shm_open,
+a leading slash being added when it has none.
+*/
+viewManager::Visualizer::frameExport::frameExport(
+    const std::string &sName, const unsigned int slots,
+    const unsigned short maxWidth, const unsigned short maxHeight)
+    : m_sName(sName), m_memory(nullptr), m_size(0), m_ring(nullptr),
+      m_sequence(0) {
+  if (m_sName.empty() || m_sName[0] != '/')
+    m_sName.insert(0, "/");
+  if (!slots || !maxWidth || !maxHeight)
+    throw std::invalid_argument("The frame export requires a size and at "
+                                "least one slot.");
+
+  const std::size_t slotBytes =
+      frameExportAlign(sizeof(frameSlotHeader)) +
+      frameExportAlign(static_cast<std::size_t>(maxWidth) * maxHeight * 4);
+  m_size = frameExportAlign(sizeof(frameRingHeader)) + slotBytes * slots;
+
+  int fd = shm_open(m_sName.data(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if (fd < 0)
+    throw std::runtime_error("The frame export could not be created: " +
+                             m_sName + " " + strerror(errno));
+
+  void *p = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(m_size)) == 0)
+    p = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  std::string sError = strerror(errno);
+  close(fd);
+
+  if (p == MAP_FAILED) {
+    shm_unlink(m_sName.data());
+    throw std::runtime_error("The frame export could not be mapped: " +
+                             m_sName + " " + sError);
+  }
 
-\brief The function maps the event id to the appropriate vector.
-This is kept statically here for resource management.
+  // the memory is zero filled. The magic number is written last, so a
+  // consumer that finds it sees the rest of the header.
+  m_memory = static_cast<u_int8_t *>(p);
+  m_ring = new (m_memory) frameRingHeader;
+  m_ring->slots = slots;
+  m_ring->slotBytes = slotBytes;
+  m_ring->maxWidth = maxWidth;
+  m_ring->maxHeight = maxHeight;
+  m_ring->notify.store(0, std::memory_order_relaxed);
+  m_ring->sequence.store(0, std::memory_order_relaxed);
+  for (unsigned int i = 0; i < slots; i++)
+    new (slot(i)) frameSlotHeader{};
+
+  std::atomic_thread_fence(std::memory_order_release);
+  m_ring->magic = FRAME_EXPORT_MAGIC;
+}
 
-\param eventType evtType
+/**
+\internal
+\brief removes the shared memory. Consumers that have it mapped keep their
+mapping.
 */
-vector<eventHandler> &viewManager::Element::getEventVector(eventType evtType) {
-  static unordered_map<eventType, vector<eventHandler> &> eventTypeMap = {
-      {eventType::focus, onfocus},
-      {eventType::blur, onblur},
-      {eventType::resize, onresize},
-      {eventType::keydown, onkeydown},
-      {eventType::keyup, onkeyup},
-      {eventType::keypress, onkeypress},
-      {eventType::mouseenter, onmouseenter},
-      {eventType::mouseleave, onmouseleave},
-      {eventType::mousemove, onmousemove},
-      {eventType::mousedown, onmousedown},
-      {eventType::mouseup, onmouseup},
-      {eventType::click, onclick},
-      {eventType::dblclick, ondblclick},
-      {eventType::contextmenu, oncontextmenu},
-      {eventType::wheel, onwheel}};
-  auto it = eventTypeMap.find(evtType);
-  return it->second;
+viewManager::Visualizer::frameExport::~frameExport() {
+  munmap(m_memory, m_size);
+  shm_unlink(m_sName.data());
 }
+
 /**
 \internal
-\brief
-The function will return the address of a std::function for the purposes
-of equality testing. Function from
-https://stackoverflow.com/questions/20833453/comparing-stdfunctions-for-equality
-
+\brief returns the slot that holds the frame of the sequence number.
 */
-template <typename T, typename... U>
-size_t getAddress(std::function<T(U...)> f) {
-  typedef T(fnType)(U...);
-  fnType **fnPointer = f.template target<fnType *>();
-  return (size_t)*fnPointer;
+viewManager::Visualizer::frameSlotHeader *
+viewManager::Visualizer::frameExport::slot(const uint64_t sequence) {
+  return reinterpret_cast<frameSlotHeader *>(
+      m_memory + frameExportAlign(sizeof(frameRingHeader)) +
+      (sequence % m_ring->slots) * m_ring->slotBytes);
 }
 
 /**
-\brief adds a new event handler to the element.
-\param eventType - the type of event to associate the handler with.
-\param eventHandler - the std::function to invoke when the event occurs
-within the system.
+\internal
+\brief writes the frame to the next slot and wakes the consumers. The
+damage is found by comparing the frame with the previous slot in tiles.
+Rows of tiles that changed over the same columns are joined into one
+rectangle. A frame that does not differ is not published.
+*/
+void viewManager::Visualizer::frameExport::publish(
+    const std::vector<u_int8_t> &pixels, const unsigned short w,
+    const unsigned short h) {
+  if (pixels.size() < static_cast<std::size_t>(w) * h * 4)
+    return;
 
-\details The addListener function provides an method for attaching
-an event handler with a event of the referenced element. The
-method accepts a function as its eventHandler. This is a std::function
-which may be a lambda, or a function pointer. The following events
-are accepted:
+  const uint32_t cw = std::min<uint32_t>(w, m_ring->maxWidth);
+  const uint32_t ch = std::min<uint32_t>(h, m_ring->maxHeight);
+  const std::size_t srcStride = static_cast<std::size_t>(w) * 4;
+  const std::size_t dstStride = static_cast<std::size_t>(cw) * 4;
+  const std::size_t pixelOffset = frameExportAlign(sizeof(frameSlotHeader));
+
+  frameDamage damage[FRAME_EXPORT_DAMAGE];
+  uint32_t damageCount = 0;
+  bool bWhole = true;
+
+  frameSlotHeader *previous = m_sequence ? slot(m_sequence) : nullptr;
+  if (previous && previous->width == cw && previous->height == ch) {
+    bWhole = false;
+    const u_int8_t *prior =
+        reinterpret_cast<const u_int8_t *>(previous) + pixelOffset;
+
+    for (uint32_t y = 0; y < ch && !bWhole; y += FRAME_SERVER_TILE) {
+      uint32_t th = std::min<uint32_t>(FRAME_SERVER_TILE, ch - y);
+      uint32_t x1 = cw;
+      uint32_t x2 = 0;
+      for (uint32_t x = 0; x < cw; x += FRAME_SERVER_TILE) {
+        uint32_t tw = std::min<uint32_t>(FRAME_SERVER_TILE, cw - x);
+        if (regionChanged(&pixels[y * srcStride + x * 4], srcStride,
+                          &prior[y * dstStride + x * 4], dstStride, tw * 4,
+                          th)) {
+          x1 = std::min(x1, x);
+          x2 = x + tw;
+        }
+      }
+      if (x1 >= x2)
+        continue;
 
-\copydoc viewManager::eventType
+      frameDamage *last = damageCount ? &damage[damageCount - 1] : nullptr;
+      if (last && last->x == x1 && last->w == x2 - x1 && last->y + last->h == y)
+        last->h += th;
+      else if (damageCount < FRAME_EXPORT_DAMAGE)
+        damage[damageCount++] = frameDamage{x1, y, x2 - x1, th};
+      else
+        bWhole = true;
+    }
 
-Example
--------
-\snippet examples.cpp addListener
+    if (!bWhole && !damageCount)
+      return;
+  }
+
+  if (bWhole) {
+    damage[0] = frameDamage{0, 0, cw, ch};
+    damageCount = 1;
+  }
+
+  // a consumer reading the slot sees the sequence change and discards it.
+  const uint64_t sequence = m_sequence + 1;
+  frameSlotHeader *next = slot(sequence);
+  next->sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  next->width = cw;
+  next->height = ch;
+  next->stride = static_cast<uint32_t>(dstStride);
+  next->damageCount = damageCount;
+  std::copy(damage, damage + damageCount, next->damage);
+
+  u_int8_t *dst = reinterpret_cast<u_int8_t *>(next) + pixelOffset;
+  if (srcStride == dstStride)
+    std::memcpy(dst, pixels.data(), dstStride * ch);
+  else
+    for (uint32_t y = 0; y < ch; y++)
+      std::memcpy(dst + y * dstStride, &pixels[y * srcStride], dstStride);
+
+  next->sequence.store(sequence, std::memory_order_release);
+  m_ring->sequence.store(sequence, std::memory_order_release);
+  m_ring->notify.fetch_add(1, std::memory_order_release);
+  syscall(SYS_futex, &m_ring->notify, FUTEX_WAKE, INT_MAX, nullptr, nullptr,
+          0);
 
+  m_sequence = sequence;
+}
+
+/**
+\internal
+\brief maps the shared memory of a frame export created by another
+process.
 */
-auto viewManager::Element::addListener(eventType evtType,
-                                       eventHandler evtHandler) -> Element & {
-  getEventVector(evtType).push_back(evtHandler);
-  return *this;
+viewManager::Visualizer::frameExportReader::frameExportReader(
+    const std::string &sName)
+    : m_memory(nullptr), m_size(0), m_ring(nullptr), m_lastSequence(0),
+      m_skipped(0) {
+  std::string sPath = sName;
+  if (sPath.empty() || sPath[0] != '/')
+    sPath.insert(0, "/");
+
+  int fd = shm_open(sPath.data(), O_RDONLY, 0);
+  if (fd < 0)
+    throw std::runtime_error("The frame export could not be opened: " +
+                             sPath + " " + strerror(errno));
+
+  struct stat info;
+  void *p = MAP_FAILED;
+  if (fstat(fd, &info) == 0 &&
+      static_cast<std::size_t>(info.st_size) >= sizeof(frameRingHeader)) {
+    m_size = static_cast<std::size_t>(info.st_size);
+    p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+
+  if (p == MAP_FAILED)
+    throw std::runtime_error("The frame export could not be mapped: " +
+                             sPath);
+
+  m_memory = static_cast<u_int8_t *>(p);
+  m_ring = reinterpret_cast<const frameRingHeader *>(m_memory);
+  bool bValid = m_ring->magic == FRAME_EXPORT_MAGIC;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  bValid = bValid && m_ring->slots &&
+           m_size >= frameExportAlign(sizeof(frameRingHeader)) +
+                         m_ring->slotBytes * m_ring->slots;
+
+  if (!bValid) {
+    munmap(m_memory, m_size);
+    throw std::runtime_error("The frame export is not complete: " + sPath);
+  }
+}
+
+viewManager::Visualizer::frameExportReader::~frameExportReader() {
+  munmap(m_memory, m_size);
 }
 
 /**
-
-\brief The function is invoked when an event occurrs. Normally this occurs
-from the platform device. However, this may be invoked by the soft
-generation of events.
-
+\internal
+\brief waits until a frame newer than the last acquired is published or
+the time passes. Returns true when there is a new frame.
 */
-void viewManager::Element::dispatch(const event &e) {
-  auto &v = getEventVector(e.evtType);
-  for (auto &fn : v)
-    fn(e);
+bool viewManager::Visualizer::frameExportReader::wait(
+    const std::chrono::milliseconds timeout) {
+  uint32_t notify = m_ring->notify.load(std::memory_order_acquire);
+  if (m_ring->sequence.load(std::memory_order_acquire) > m_lastSequence)
+    return true;
+
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+  syscall(SYS_futex, &m_ring->notify, FUTEX_WAIT, notify, &ts, nullptr, 0);
+
+  return m_ring->sequence.load(std::memory_order_acquire) > m_lastSequence;
 }
 
 /**
-\brief removes dispatching of an event to the caller.
-<summary>The function will remove an event listener from the list of
-events to receive messages.</summary>
+\internal
+\brief gives the latest frame when it is newer than the last acquired.
+The frames between them are skipped and counted, and the frame is marked
+whole since its damage does not cover theirs.
+*/
+bool viewManager::Visualizer::frameExportReader::acquire(frame &f) {
+  const std::size_t pixelOffset = frameExportAlign(sizeof(frameSlotHeader));
 
-\param evtType is the type of event to remove.</param>
-\param evtHandler is the event to remove.?</param>
+  while (true) {
+    uint64_t sequence = m_ring->sequence.load(std::memory_order_acquire);
+    if (sequence <= m_lastSequence)
+      return false;
 
-Example
--------
-\snippet examples.cpp removeListener
+    const u_int8_t *p = m_memory + frameExportAlign(sizeof(frameRingHeader)) +
+                        (sequence % m_ring->slots) * m_ring->slotBytes;
+    const frameSlotHeader *header =
+        reinterpret_cast<const frameSlotHeader *>(p);
 
-*/
-auto viewManager::Element::removeListener(eventType evtType,
-                                          eventHandler evtHandler)
-    -> Element & {
-  auto eventList = getEventVector(evtType);
-  auto it = eventList.begin();
-  while (it != eventList.end()) {
-    if (getAddress(*it) == getAddress(evtHandler))
-      it = eventList.erase(it);
-    else
-      it++;
+    // the producer may already be writing the slot again.
+    if (header->sequence.load(std::memory_order_acquire) != sequence)
+      continue;
+
+    if (m_lastSequence)
+      m_skipped += sequence - m_lastSequence - 1;
+    f.bWhole = !m_lastSequence || sequence != m_lastSequence + 1;
+    m_lastSequence = sequence;
+
+    f.sequence = sequence;
+    f.header = header;
+    f.pixels = p + pixelOffset;
+    return true;
   }
-  return *this;
 }
 
 /**
 \internal
-\brief The function provides the calculation of all word break by
-recording the index of spaces. This is used by the layout system
-to determine where to wrap text based upon the font metrics. The function
-also provides measurement in pixels of textual data based upon the font.
-The routine measureTextWidth within the devie object is used for this. The
-routine stores the results in an unordered_map indexed by the typeid.
-A vector of std::size_t notes the index position within the string
-where the space is.
+\brief returns true when the slot of the frame was not written while the
+frame was used.
 */
-void viewManager::Element::wordMetrics(Visualizer::platform &device) {
-  // -- optimizations can be made here
-  // caching the stream
-  // caching the word breaks.
-  string stextface;
-  double dsize;
+bool viewManager::Visualizer::frameExportReader::intact(const frame &f) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return f.header->sequence.load(std::memory_order_relaxed) == f.sequence;
+}
+#endif
 
-  // get the textface and point size that is used for the element's
-  // data
-  try {
-    stextface = getAttribute<textFace>().value;
-  } catch (exception e) {
-    stextface = DEFAULT_TEXTFACE;
+#if defined(__linux__) && defined(USE_LINUX_FRAMEBUFFER)
+/**
+\internal
+\brief opens the display device. An empty name tries the first DRM card,
+then /dev/fb0, then FRAMEBUFFER_FILE. The size and format are those of the
+file when a file is used, and requests otherwise.
+*/
+viewManager::Visualizer::framebufferOutput::framebufferOutput(
+    const std::string &sDevice, const unsigned short w,
+    const unsigned short h, const pixelFormat::optionEnum format)
+    : m_kind(outputKind::file), m_fd(-1), m_width(0), m_height(0),
+      m_stride(0), m_format(format), m_map(nullptr), m_mapSize(0),
+      m_buffers{}, m_back(0), m_crtc(0), m_connector(0), m_savedCrtc{},
+      m_bFlipPending(false) {
+
+  if (sDevice.compare(0, 5, "file:") == 0) {
+    openFile(sDevice.substr(5), w, h, format);
+  } else if (sDevice.compare(0, 7, "/dev/fb") == 0) {
+    if (!openFbdev(sDevice))
+      throw std::runtime_error("The framebuffer could not be opened: " +
+                               sDevice);
+  } else if (!sDevice.empty()) {
+    if (!openDrm(sDevice, format))
+      throw std::runtime_error("The DRM device could not be opened: " +
+                               sDevice);
+  } else if (!openDrm("/dev/dri/card0", format) && !openFbdev("/dev/fb0")) {
+    openFile(FRAMEBUFFER_FILE, w, h, format);
   }
+}
 
-  try {
-    dsize = getAttribute<textSize>().toPt();
-  } catch (exception e) {
-    dsize = DEFAULT_TEXTSIZE;
+viewManager::Visualizer::framebufferOutput::~framebufferOutput() { close(); }
+
+/**
+\internal
+\brief releases the buffers. The mode the card had before is restored.
+*/
+void viewManager::Visualizer::framebufferOutput::close(void) {
+  if (m_kind == outputKind::drm && m_fd >= 0) {
+    // a flip still pending would complete upon a removed buffer.
+    if (m_bFlipPending) {
+      char events[1024];
+      ::read(m_fd, events, sizeof(events));
+    }
+
+    if (m_savedCrtc.crtc_id) {
+      m_savedCrtc.set_connectors_ptr =
+          reinterpret_cast<uint64_t>(&m_connector);
+      m_savedCrtc.count_connectors = 1;
+      ioctl(m_fd, DRM_IOCTL_MODE_SETCRTC, &m_savedCrtc);
+    }
+
+    for (auto &b : m_buffers) {
+      if (b.map)
+        munmap(b.map, b.size);
+      if (b.fb)
+        ioctl(m_fd, DRM_IOCTL_MODE_RMFB, &b.fb);
+      if (b.handle) {
+        drm_mode_destroy_dumb destroy{};
+        destroy.handle = b.handle;
+        ioctl(m_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+      }
+      b = dumbBuffer{};
+    }
   }
-  size_t storageTypeID;
-  // find all word breaks within the string
-  indexedWordMetrics.erase(indexedWordMetrics.begin(),
-                           indexedWordMetrics.end());
-  for (auto m : m_usageAdaptorMap) {
-    size_t textDataSize = 0;
 
-    // get the number of elements
-    if (m.first == typeid(vector<string>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = any_cast<usageAdaptor<string> &>(m.second);
-      textDataSize = o.textDataSize();
+  if (m_map)
+    munmap(m_map, m_mapSize);
+  m_map = nullptr;
 
-    } else if (m.first == typeid(vector<double>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = any_cast<usageAdaptor<double> &>(m.second);
-      textDataSize = o.textDataSize();
+  if (m_fd >= 0)
+    ::close(m_fd);
+  m_fd = -1;
+}
 
-    } else if (m.first == typeid(vector<float>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = any_cast<usageAdaptor<float> &>(m.second);
-      textDataSize = o.textDataSize();
+/**
+\internal
+\brief sets the preferred mode of the first connected output of the card
+upon two dumb buffers. Returns false when the card cannot be used.
+*/
+bool viewManager::Visualizer::framebufferOutput::openDrm(
+    const std::string &sPath, const pixelFormat::optionEnum format) {
+  m_kind = outputKind::drm;
+  m_fd = open(sPath.data(), O_RDWR | O_CLOEXEC);
+  if (m_fd < 0)
+    return false;
+
+  // the counts are read first, then the identifiers.
+  drm_mode_card_res res{};
+  if (ioctl(m_fd, DRM_IOCTL_MODE_GETRESOURCES, &res) != 0) {
+    close();
+    return false;
+  }
+  std::vector<uint32_t> crtcs(res.count_crtcs);
+  std::vector<uint32_t> connectors(res.count_connectors);
+  res.count_fbs = 0;
+  res.count_encoders = 0;
+  res.crtc_id_ptr = reinterpret_cast<uint64_t>(crtcs.data());
+  res.connector_id_ptr = reinterpret_cast<uint64_t>(connectors.data());
+  if (ioctl(m_fd, DRM_IOCTL_MODE_GETRESOURCES, &res) != 0 || crtcs.empty()) {
+    close();
+    return false;
+  }
 
-    } else if (m.first == typeid(vector<int>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = any_cast<usageAdaptor<int> &>(m.second);
-      textDataSize = o.textDataSize();
-    }
+  drm_mode_modeinfo mode{};
+  bool bFound = false;
+  for (auto id : connectors) {
+    drm_mode_get_connector conn{};
+    conn.connector_id = id;
+    if (ioctl(m_fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn) != 0)
+      continue;
 
-    // iterate the data within the element,
-    // get both the size of the rendered field and
-    for (std::size_t idx = 0; idx < textDataSize; idx++) {
-      string s;
+    // a connection of one is connected.
+    if (conn.connection != 1 || !conn.count_modes)
+      continue;
 
-      if (m.first == typeid(vector<string>)) {
-        auto &o = any_cast<usageAdaptor<string> &>(m.second);
-        s = o.textData(idx);
-      } else if (m.first == typeid(vector<double>)) {
-        auto &o = any_cast<usageAdaptor<double> &>(m.second);
-        s = o.textData(idx);
-      } else if (m.first == typeid(vector<float>)) {
-        auto &o = any_cast<usageAdaptor<float> &>(m.second);
-        s = o.textData(idx);
-      } else if (m.first == typeid(vector<int>)) {
-        auto &o = any_cast<usageAdaptor<int> &>(m.second);
-        s = o.textData(idx);
-      }
+    std::vector<drm_mode_modeinfo> modes(conn.count_modes);
+    conn.count_props = 0;
+    conn.count_encoders = 0;
+    conn.modes_ptr = reinterpret_cast<uint64_t>(modes.data());
+    if (ioctl(m_fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn) != 0 || modes.empty())
+      continue;
 
-      // build a tuple vector contains the totaling width as the string
-      // progresses including the space, the width of the text without a space,
-      // and the position of the space within the text
-      vector<wordMetricType> positions;
-      size_t pos = s.find_first_of(" \n\t");
-      size_t begin = 0;
-      double dtotal = 0;
-      string text;
-      double width;
-      double dspacesize = device.measureTextWidth(stextface, dsize, " ");
-      while (pos != s.npos) {
-        text = s.substr(begin, pos - begin);
-        width = device.measureTextWidth(stextface, dsize, text);
-        dtotal += width + dspacesize;
-        positions.push_back({dtotal, width, pos});
-        begin = pos + 1;
-        pos = s.find_first_of(" \n\t", begin);
-      }
+    // the first mode is the preferred one.
+    mode = modes[0];
+    m_connector = id;
+    m_crtc = crtcs[0];
+    if (conn.encoder_id) {
+      drm_mode_get_encoder enc{};
+      enc.encoder_id = conn.encoder_id;
+      if (ioctl(m_fd, DRM_IOCTL_MODE_GETENCODER, &enc) == 0 && enc.crtc_id)
+        m_crtc = enc.crtc_id;
+    }
+    bFound = true;
+    break;
+  }
 
-      // handle last part of string
-      text = s.substr(begin);
-      width = device.measureTextWidth(stextface, dsize, text);
-      dtotal += width + dspacesize;
-      positions.push_back({dtotal, width, pos});
+  if (!bFound) {
+    close();
+    return false;
+  }
 
-      indexedWordMetrics[{storageTypeID, idx}] = positions;
+  // rgb565 is scanned out directly, other formats use xrgb8888.
+  m_format = format == pixelFormat::rgb565 ? pixelFormat::rgb565
+                                           : pixelFormat::xrgb8888;
+  uint32_t bpp = m_format == pixelFormat::rgb565 ? 16 : 32;
+  m_width = mode.hdisplay;
+  m_height = mode.vdisplay;
+
+  for (auto &b : m_buffers) {
+    drm_mode_create_dumb create{};
+    create.width = m_width;
+    create.height = m_height;
+    create.bpp = bpp;
+    if (ioctl(m_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0) {
+      close();
+      return false;
     }
+    b.handle = create.handle;
+    b.pitch = create.pitch;
+    b.size = create.size;
+
+    drm_mode_fb_cmd fb{};
+    fb.width = m_width;
+    fb.height = m_height;
+    fb.pitch = b.pitch;
+    fb.bpp = bpp;
+    fb.depth = bpp == 16 ? 16 : 24;
+    fb.handle = b.handle;
+    drm_mode_map_dumb map{};
+    map.handle = b.handle;
+    if (ioctl(m_fd, DRM_IOCTL_MODE_ADDFB, &fb) != 0 ||
+        ioctl(m_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0) {
+      close();
+      return false;
+    }
+    b.fb = fb.fb_id;
+
+    void *p = mmap(nullptr, b.size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                   static_cast<off_t>(map.offset));
+    if (p == MAP_FAILED) {
+      close();
+      return false;
+    }
+    b.map = static_cast<u_int8_t *>(p);
+    std::memset(b.map, 0xFF, b.size);
+  }
+
+  // setting the mode requires being the DRM master.
+  drm_mode_crtc saved{};
+  saved.crtc_id = m_crtc;
+  if (ioctl(m_fd, DRM_IOCTL_MODE_GETCRTC, &saved) == 0)
+    m_savedCrtc = saved;
+
+  drm_mode_crtc crtc{};
+  crtc.crtc_id = m_crtc;
+  crtc.fb_id = m_buffers[0].fb;
+  crtc.set_connectors_ptr = reinterpret_cast<uint64_t>(&m_connector);
+  crtc.count_connectors = 1;
+  crtc.mode = mode;
+  crtc.mode_valid = 1;
+  if (ioctl(m_fd, DRM_IOCTL_MODE_SETCRTC, &crtc) != 0) {
+    m_savedCrtc = drm_mode_crtc{};
+    close();
+    return false;
   }
+
+  m_back = 1;
+  m_sDescription = sPath + " " + std::to_string(m_width) + "x" +
+                   std::to_string(m_height) + " drm";
+  return true;
 }
 
 /**
 \internal
-\brief The routine finds the largest string within the group of data elements.
+\brief returns the pixel format whose channel positions are those of the
+fbdev mode, or false when there is none. An 8 bit mode is gray only when
+the device says so or when its palette can be loaded with a gray ramp.
 */
-double
-viewManager::Element::computeWidestTextData(Visualizer::platform &device) {
-  double dMaxWidth = 0;
-  size_t storageTypeID;
+static bool fbdevFormat(const int fd, const fb_var_screeninfo &var,
+                        const fb_fix_screeninfo &fix,
+                        pixelFormat::optionEnum &format) {
+  auto channel = [](const fb_bitfield &f, const unsigned int offset,
+                    const unsigned int length) {
+    return f.offset == offset && f.length == length && f.msb_right == 0;
+  };
 
-  for (auto m : m_usageAdaptorMap) {
-    size_t textDataSize;
-    // get the size of the amount of data
-    if (m.first == typeid(std::vector<std::string>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
-      textDataSize = o.textDataSize();
+  if (var.bits_per_pixel == 32 && channel(var.red, 16, 8) &&
+      channel(var.green, 8, 8) && channel(var.blue, 0, 8)) {
+    format = pixelFormat::xrgb8888;
+    return true;
+  }
 
-    } else if (m.first == typeid(std::vector<double>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
-      textDataSize = o.textDataSize();
+  if (var.bits_per_pixel == 16 && channel(var.red, 11, 5) &&
+      channel(var.green, 5, 6) && channel(var.blue, 0, 5)) {
+    format = pixelFormat::rgb565;
+    return true;
+  }
 
-    } else if (m.first == typeid(std::vector<float>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
-      textDataSize = o.textDataSize();
+  if (var.bits_per_pixel != 8)
+    return false;
 
-    } else if (m.first == typeid(std::vector<int>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
-      textDataSize = o.textDataSize();
-    }
+  if (var.grayscale == 1) {
+    format = pixelFormat::gray8;
+    return true;
+  }
 
-    // iterate the word Metrics
-    for (size_t idx = 0; idx < textDataSize; idx++) {
+  if (fix.visual != FB_VISUAL_PSEUDOCOLOR)
+    return false;
 
-      // find the textual layout positions for wrapping
-      vector<wordMetricType> lineWordMetrics;
-      auto it = indexedWordMetrics.find({storageTypeID, idx});
-      if (it != indexedWordMetrics.end()) {
-        lineWordMetrics = it->second;
-      }
+  std::array<__u16, 256> ramp;
+  for (std::size_t i = 0; i < ramp.size(); i++)
+    ramp[i] = static_cast<__u16>(i * 0x101);
+  fb_cmap cmap{0, 256, ramp.data(), ramp.data(), ramp.data(), nullptr};
+  if (ioctl(fd, FBIOPUTCMAP, &cmap) != 0)
+    return false;
 
-      // if the line will fit within the defined rectangle, show it without
-      // searching
-      if (dMaxWidth <= lineWordMetrics.back().totalWidth)
-        dMaxWidth = lineWordMetrics.back().totalWidth;
-    }
-  }
-  return dMaxWidth;
+  format = pixelFormat::gray8;
+  return true;
 }
 
 /**
 \internal
-\brief The routine performs a virtual wrapping of the textual data based
-upon the contents of the information.
+\brief maps the memory of a fbdev device. Returns false when it cannot be
+used. A mode whose channels are laid out differently from the pixel
+formats is changed to 32 bit when the driver allows it.
 */
-double
-viewManager::Element::computeWrappedTextDataHeight(Visualizer::platform &device,
-                                                   double dWrappingWidth) {
-  string sTextFace;
-  int tSize;
-  double dFaceHeight;
-  double dLineHeight;
-  double dTextLineHeight;
-  size_t linesDisplayed = 0;
-
-  try {
-    sTextFace = getAttribute<textFace>().value;
-  } catch (const std::exception &e) {
-    sTextFace = DEFAULT_TEXTFACE;
+bool viewManager::Visualizer::framebufferOutput::openFbdev(
+    const std::string &sPath) {
+  m_kind = outputKind::fbdev;
+  m_fd = open(sPath.data(), O_RDWR | O_CLOEXEC);
+  if (m_fd < 0)
+    return false;
+
+  fb_var_screeninfo var{};
+  fb_fix_screeninfo fix{};
+  if (ioctl(m_fd, FBIOGET_VSCREENINFO, &var) != 0 ||
+      ioctl(m_fd, FBIOGET_FSCREENINFO, &fix) != 0) {
+    close();
+    return false;
   }
 
-  try {
-    auto v = getAttribute<textSize>().toPt();
-    tSize = static_cast<int>(v);
-  } catch (const std::exception &e) {
-    tSize = DEFAULT_TEXTSIZE;
+  if (!fbdevFormat(m_fd, var, fix, m_format)) {
+    fb_var_screeninfo request = var;
+    request.bits_per_pixel = 32;
+    request.grayscale = 0;
+    request.red = fb_bitfield{16, 8, 0};
+    request.green = fb_bitfield{8, 8, 0};
+    request.blue = fb_bitfield{0, 8, 0};
+    request.transp = fb_bitfield{0, 0, 0};
+    request.activate = FB_ACTIVATE_NOW;
+
+    if (ioctl(m_fd, FBIOPUT_VSCREENINFO, &request) != 0 ||
+        ioctl(m_fd, FBIOGET_VSCREENINFO, &var) != 0 ||
+        ioctl(m_fd, FBIOGET_FSCREENINFO, &fix) != 0 ||
+        !fbdevFormat(m_fd, var, fix, m_format)) {
+      close();
+      return false;
+    }
   }
 
-  // adjust the textline height to pixel values for advancement.
-  // the lineheight is given in a decimal range.
-  dLineHeight = 1.0;
-  try {
-    auto lh = getAttribute<lineHeight>();
-    if (lh.option == lineHeight::normal)
-      dLineHeight = lh.value;
-  } catch (std::exception e) {
+  m_width = static_cast<unsigned short>(var.xres);
+  m_height = static_cast<unsigned short>(var.yres);
+  m_stride = fix.line_length;
+  m_mapSize = fix.smem_len;
+
+  void *p = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                 0);
+  if (p == MAP_FAILED) {
+    close();
+    return false;
   }
-  dFaceHeight = device.measureFaceHeight(sTextFace, tSize);
-  dTextLineHeight = dFaceHeight * dLineHeight;
-  size_t storageTypeID;
-  for (auto m : m_usageAdaptorMap) {
-    size_t textDataSize;
-    // get the size of the amount of data
-    if (m.first == typeid(std::vector<std::string>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
-      textDataSize = o.textDataSize();
+  m_map = static_cast<u_int8_t *>(p);
 
-    } else if (m.first == typeid(std::vector<double>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
-      textDataSize = o.textDataSize();
+  m_sDescription = sPath + " " + std::to_string(m_width) + "x" +
+                   std::to_string(m_height) + " fbdev";
+  return true;
+}
 
-    } else if (m.first == typeid(std::vector<float>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
-      textDataSize = o.textDataSize();
+/**
+\internal
+\brief maps a file holding one frame of the given size and format for
+running without display hardware.
+*/
+void viewManager::Visualizer::framebufferOutput::openFile(
+    const std::string &sPath, const unsigned short w, const unsigned short h,
+    const pixelFormat::optionEnum format) {
+  m_kind = outputKind::file;
+  m_format = format;
+  m_width = w ? w : 800;
+  m_height = h ? h : 600;
+  unsigned int bytes = format == pixelFormat::rgb565 ? 2
+                       : format == pixelFormat::gray8 ? 1
+                                                      : 4;
+  m_stride = static_cast<std::size_t>(m_width) * bytes;
+  m_mapSize = m_stride * m_height;
+
+  m_fd = open(sPath.data(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  void *p = MAP_FAILED;
+  if (m_fd >= 0 && ftruncate(m_fd, static_cast<off_t>(m_mapSize)) == 0)
+    p = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (p == MAP_FAILED) {
+    close();
+    throw std::runtime_error("The framebuffer file could not be created: " +
+                             sPath);
+  }
+  m_map = static_cast<u_int8_t *>(p);
 
-    } else if (m.first == typeid(std::vector<int>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
-      textDataSize = o.textDataSize();
+  m_sDescription = sPath + " " + std::to_string(m_width) + "x" +
+                   std::to_string(m_height) + " file";
+}
+
+/**
+\internal
+\brief copies a frame in the format of the device to the screen. With DRM
+the frame is copied to the hidden buffer which is flipped at the next
+vertical blank, the previous flip being waited for first.
+*/
+void viewManager::Visualizer::framebufferOutput::present(
+    const u_int8_t *pixels, const unsigned short w, const unsigned short h) {
+  const unsigned int bytes = m_format == pixelFormat::rgb565 ? 2
+                             : m_format == pixelFormat::gray8 ? 1
+                                                              : 4;
+  const std::size_t srcStride = static_cast<std::size_t>(w) * bytes;
+  const std::size_t rowBytes =
+      static_cast<std::size_t>(std::min(w, m_width)) * bytes;
+  const unsigned short rows = std::min(h, m_height);
+
+  u_int8_t *dst = m_map;
+  std::size_t dstStride = m_stride;
+
+  if (m_kind == outputKind::drm) {
+    if (m_bFlipPending) {
+      char events[1024];
+      ::read(m_fd, events, sizeof(events));
+      m_bFlipPending = false;
     }
+    dst = m_buffers[m_back].map;
+    dstStride = m_buffers[m_back].pitch;
+  }
 
-    // iterate the strings within the data
-    for (size_t idx = 0; idx < textDataSize; idx++) {
+  for (unsigned short y = 0; y < rows; y++)
+    std::memcpy(dst + y * dstStride, pixels + y * srcStride, rowBytes);
+
+  if (m_kind == outputKind::drm) {
+    drm_mode_crtc_page_flip flip{};
+    flip.crtc_id = m_crtc;
+    flip.fb_id = m_buffers[m_back].fb;
+    flip.flags = DRM_MODE_PAGE_FLIP_EVENT;
+    if (ioctl(m_fd, DRM_IOCTL_MODE_PAGE_FLIP, &flip) == 0) {
+      m_bFlipPending = true;
+      m_back ^= 1;
+    }
+  }
+}
 
-      // find the textual layout positions for wrapping
-      vector<wordMetricType> lineWordMetrics;
-      auto it = indexedWordMetrics.find({storageTypeID, idx});
-      if (it != indexedWordMetrics.end()) {
-        lineWordMetrics = it->second;
-      }
+/**
+\internal
+\brief opens the event devices that report keys or pointer motion. The
+devices that cannot be read, usually for lack of permission, are passed
+over.
+*/
+viewManager::Visualizer::evdevInput::evdevInput(
+    const eventHandler &evtDispatcher, const unsigned short w,
+    const unsigned short h)
+    : dispatchEvent(evtDispatcher), m_width(w), m_height(h), m_x(w / 2),
+      m_y(h / 2), m_bMoved(false), m_bShift(false) {
+  DIR *dir = opendir("/dev/input");
+  if (!dir)
+    return;
 
-      // if the line will fit within the defined rectangle, show it without
-      // searching
-      if (dWrappingWidth >= lineWordMetrics.back().totalWidth) {
-        linesDisplayed++;
-      } else {
-        // find the width that can be drawn within the given rectangle of text.
-        // and break apart the text into line wrapping.
-        double dConsumedSpace = 0;
-        double dTotalConsumedSpace = 0;
-        for (auto &n : lineWordMetrics) {
-          if (n.totalWidth - dTotalConsumedSpace > dWrappingWidth) {
+  while (dirent *entry = readdir(dir)) {
+    if (std::strncmp(entry->d_name, "event", 5) != 0)
+      continue;
 
-            // accumulate the total amount of horizontal space within the
-            // string that has been rendered.
-            dTotalConsumedSpace = dTotalConsumedSpace + dConsumedSpace;
-            dConsumedSpace = 0;
-            linesDisplayed++;
+    std::string sPath = std::string("/dev/input/") + entry->d_name;
+    int fd = open(sPath.data(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+      continue;
 
-            // display last part of unbroken contigious string, last time
-            // processing
-            if (lineWordMetrics.back().totalWidth - dTotalConsumedSpace <=
-                displayList.ow) {
-              linesDisplayed++;
-              break;
-            }
-          }
+    inputDevice device{};
+    device.fd = fd;
+    device.bAbsolute = ioctl(fd, EVIOCGABS(ABS_X), &device.absX) == 0 &&
+                       ioctl(fd, EVIOCGABS(ABS_Y), &device.absY) == 0 &&
+                       device.absX.maximum > device.absX.minimum &&
+                       device.absY.maximum > device.absY.minimum;
+    m_devices.push_back(device);
+  }
+  closedir(dir);
+}
 
-          dConsumedSpace = n.totalWidth - dTotalConsumedSpace;
+viewManager::Visualizer::evdevInput::~evdevInput() {
+  for (auto &device : m_devices)
+    close(device.fd);
+}
+
+/**
+\internal
+\brief appends the descriptors of the devices to a poll list.
+*/
+void viewManager::Visualizer::evdevInput::descriptors(
+    std::vector<pollfd> &fds) const {
+  for (auto &device : m_devices)
+    fds.push_back(pollfd{device.fd, POLLIN, 0});
+}
+
+/**
+\internal
+\brief reads the pending input of a device. Motion is reported once for
+each report of the device.
+*/
+void viewManager::Visualizer::evdevInput::read(const int fd) {
+  auto it = std::find_if(m_devices.begin(), m_devices.end(),
+                         [fd](const inputDevice &d) { return d.fd == fd; });
+  if (it == m_devices.end())
+    return;
+  const inputDevice &device = *it;
+
+  input_event events[64];
+  ssize_t got;
+  while ((got = ::read(fd, events, sizeof(events))) > 0) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(got) / sizeof(events[0]);
+         i++) {
+      const input_event &e = events[i];
+      switch (e.type) {
+      case EV_REL:
+        if (e.code == REL_X) {
+          m_x = std::clamp(m_x + e.value, 0, m_width - 1);
+          m_bMoved = true;
+        } else if (e.code == REL_Y) {
+          m_y = std::clamp(m_y + e.value, 0, m_height - 1);
+          m_bMoved = true;
+        } else if (e.code == REL_WHEEL) {
+          dispatchEvent(event{eventType::wheel, static_cast<short>(m_x),
+                              static_cast<short>(m_y),
+                              static_cast<short>(e.value)});
         }
+        break;
+
+      case EV_ABS:
+        // touch screens report positions in their own range.
+        if (device.bAbsolute && e.code == ABS_X) {
+          m_x = (e.value - device.absX.minimum) * (m_width - 1) /
+                (device.absX.maximum - device.absX.minimum);
+          m_bMoved = true;
+        } else if (device.bAbsolute && e.code == ABS_Y) {
+          m_y = (e.value - device.absY.minimum) * (m_height - 1) /
+                (device.absY.maximum - device.absY.minimum);
+          m_bMoved = true;
+        }
+        break;
+
+      case EV_KEY:
+        key(e.code, e.value);
+        break;
+
+      case EV_SYN:
+        if (m_bMoved)
+          dispatchEvent(event{eventType::mousemove, static_cast<short>(m_x),
+                              static_cast<short>(m_y), 0});
+        m_bMoved = false;
+        break;
       }
     }
   }
-  return linesDisplayed * dTextLineHeight;
 }
 
 /**
 \internal
-\brief This is the main function which invokes drawing of the item and
-its children. It is called recursively when painting needs to occur.
-This function is used internally and is not necessary to invoke. That
-is, system already invokes this as part of the processing stack. The
-work performed by this routine is accomplished using the surface image.
+\brief dispatches a button or key. The value is one when pressed, two
+when repeated and zero when released.
 */
-void viewManager::Element::render(Visualizer::platform &device) {
-  string sTextFace;
-  int tSize;
-  int tColor;
-  textAlignment tAlign = textAlignment(textAlignment::left);
-  double dFaceHeight;
-  double dLineHeight;
-  double dTextLineHeight;
-
-  try {
-    sTextFace = getAttribute<textFace>().value;
-  } catch (const std::exception &e) {
-    sTextFace = DEFAULT_TEXTFACE;
+void viewManager::Visualizer::evdevInput::key(const unsigned short code,
+                                              const int value) {
+  short button = 0;
+  switch (code) {
+  case BTN_LEFT:
+  case BTN_TOUCH:
+    button = 1;
+    break;
+  case BTN_MIDDLE:
+    button = 2;
+    break;
+  case BTN_RIGHT:
+    button = 3;
+    break;
   }
 
-  try {
-    auto v = getAttribute<textSize>().toPt();
-    tSize = static_cast<int>(v);
-  } catch (const std::exception &e) {
-    tSize = DEFAULT_TEXTSIZE;
+  if (button) {
+    if (value != 2)
+      dispatchEvent(event{value ? eventType::mousedown : eventType::mouseup,
+                          static_cast<short>(m_x), static_cast<short>(m_y),
+                          button});
+    return;
   }
 
-  try {
-    array<double, 4> tc = getAttribute<textColor>().value;
-    tColor = (static_cast<int>(tc[0]) << 16) | (static_cast<int>(tc[1]) << 8) |
-             static_cast<int>(tc[2]);
-  } catch (const std::exception &e) {
-    tColor = DEFAULT_TEXTCOLOR;
+  if (code == KEY_LEFTSHIFT || code == KEY_RIGHTSHIFT) {
+    m_bShift = value != 0;
+    return;
   }
 
-  try {
-    tAlign = getAttribute<textAlignment>();
-  } catch (const std::exception &e) {
-    tAlign = textAlignment::left;
-  }
+  // the characters of a US layout, by key code.
+  static constexpr char lower[] = "\0\0"
+                                  "1234567890-="
+                                  "\0\0"
+                                  "qwertyuiop[]"
+                                  "\0\0"
+                                  "asdfghjkl;'`"
+                                  "\0"
+                                  "\\zxcvbnm,./"
+                                  "\0"
+                                  "*"
+                                  "\0"
+                                  " ";
+  static constexpr char upper[] = "\0\0"
+                                  "!@#$%^&*()_+"
+                                  "\0\0"
+                                  "QWERTYUIOP{}"
+                                  "\0\0"
+                                  "ASDFGHJKL:\"~"
+                                  "\0"
+                                  "|ZXCVBNM<>?"
+                                  "\0"
+                                  "*"
+                                  "\0"
+                                  " ";
+
+  char c = code < sizeof(lower) - 1 ? (m_bShift ? upper : lower)[code] : 0;
+  unsigned int sym = c ? static_cast<unsigned char>(c) : keysym(code);
+  if (!sym)
+    return;
 
-  // adjust the textline height to pixel values for advancement.
-  // the lineheight is given in a decimal range.
-  dLineHeight = 1.0;
-  try {
-    auto lh = getAttribute<lineHeight>();
-    if (lh.option == lineHeight::normal)
-      dLineHeight = lh.value;
-  } catch (std::exception e) {
+  if (!value)
+    dispatchEvent(event{eventType::keyup, sym});
+  else if (c)
+    dispatchEvent(event{eventType::keypress, c});
+  else
+    dispatchEvent(event{eventType::keydown, sym});
+}
+
+/**
+\internal
+\brief returns the X keysym of a key that is not a character.
+*/
+unsigned int
+viewManager::Visualizer::evdevInput::keysym(const unsigned short code) {
+  if (code >= KEY_F1 && code <= KEY_F10)
+    return XK_F1 + (code - KEY_F1);
+
+  switch (code) {
+  case KEY_ESC:
+    return XK_Escape;
+  case KEY_BACKSPACE:
+    return XK_BackSpace;
+  case KEY_TAB:
+    return XK_Tab;
+  case KEY_ENTER:
+  case KEY_KPENTER:
+    return XK_Return;
+  case KEY_HOME:
+    return XK_Home;
+  case KEY_END:
+    return XK_End;
+  case KEY_UP:
+    return XK_Up;
+  case KEY_DOWN:
+    return XK_Down;
+  case KEY_LEFT:
+    return XK_Left;
+  case KEY_RIGHT:
+    return XK_Right;
+  case KEY_PAGEUP:
+    return XK_Page_Up;
+  case KEY_PAGEDOWN:
+    return XK_Page_Down;
+  case KEY_INSERT:
+    return XK_Insert;
+  case KEY_DELETE:
+    return XK_Delete;
   }
-  dFaceHeight = device.measureFaceHeight(sTextFace, tSize);
-  dTextLineHeight = dFaceHeight * dLineHeight;
-  size_t storageTypeID;
+  return 0;
+}
+#endif
 
-  for (auto m : m_usageAdaptorMap) {
-    size_t textDataSize;
-    // get the size of the amount of data
-    if (m.first == typeid(std::vector<std::string>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
-      textDataSize = o.textDataSize();
+/**
+  \internal
+  \brief constructor for the platform object. The platform object is coded
+  such that each of the operating systems supported is encapsulated within
+  preprocessor blocks.
 
-    } else if (m.first == typeid(std::vector<double>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
-      textDataSize = o.textDataSize();
+  \param eventHandler evtDispatcher the dispatcher routine which connects
+  the platform to the object model system. \param unsigned short width -
+  window size. \param unsigned short height - window size.
+*/
+viewManager::Visualizer::platform::platform(const eventHandler &evtDispatcher,
+                                            const unsigned short width,
+                                            const unsigned short height) {
+  dispatchEvent = evtDispatcher;
+  _w = width;
+  _h = height;
+  fontScale = 0;
+  m_bWakeable = false;
+  m_bIdleRequested = false;
+  m_bHeadless = false;
+  m_format = pixelFormat::xrgb8888;
+  resetClip();
 
-    } else if (m.first == typeid(std::vector<float>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
-      textDataSize = o.textDataSize();
+// initialize private members
+#if defined(__linux__)
+#if defined(USE_LINUX_FRAMEBUFFER)
+  m_wakeEvent = -1;
+#endif
+  m_xdisplay = nullptr;
+  m_connection = nullptr;
+  m_screen = nullptr;
+  m_window = 0;
+  m_pix = 0;
+  m_syms = nullptr;
+  m_foreground = 0;
 
-    } else if (m.first == typeid(std::vector<int>)) {
-      storageTypeID = m.first.hash_code();
-      auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
-      textDataSize = o.textDataSize();
-    }
+#elif defined(_WIN64)
 
-    // iterate the strings within the data
-    size_t linesDisplayed = 0;
-    for (size_t idx = 0; idx < textDataSize; idx++) {
-      string s;
+  m_hwnd = 0x00;
+  CoInitialize(NULL);
 
-      if (m.first == typeid(std::vector<std::string>)) {
-        auto &o = std::any_cast<usageAdaptor<std::string> &>(m.second);
-        s = o.textData(idx);
-      } else if (m.first == typeid(std::vector<double>)) {
-        auto &o = std::any_cast<usageAdaptor<double> &>(m.second);
-        s = o.textData(idx);
-      } else if (m.first == typeid(std::vector<float>)) {
-        auto &o = std::any_cast<usageAdaptor<float> &>(m.second);
-        s = o.textData(idx);
-      } else if (m.first == typeid(std::vector<int>)) {
-        auto &o = std::any_cast<usageAdaptor<int> &>(m.second);
-        s = o.textData(idx);
-      }
+#endif
 
-      // find the textual layout positions for wrapping
-      vector<wordMetricType> lineWordMetrics;
-      auto it = indexedWordMetrics.find({storageTypeID, idx});
-      if (it != indexedWordMetrics.end()) {
-        lineWordMetrics = it->second;
-      }
+#ifdef USE_INLINE_RENDERER
+  m_freeType = nullptr;
+  m_cacheManager = nullptr;
+  m_bGlyphsCached = false;
+#endif
+}
 
-      // if the line will fit within the defined rectangle, show it without
-      // searching
-      if (displayList.ow >= lineWordMetrics.back().totalWidth) {
-        // draw within the calculated layout rectangle.
-        device.drawText(sTextFace, tSize, s, tColor, displayList.x1,
-                        displayList.y1 + idx * dTextLineHeight, displayList.x2,
-                        displayList.y2, tAlign);
-      } else {
-        // find the width that can be drawn within the given rectangle of text.
-        // and break apart the text into line wrapping.
-        bool bDone = false;
-        double dyPos = displayList.y1;
-        wordMetricType lastMetric=lineWordMetrics[0];
-        size_t lastCharacterRendered = 0;
-        string sText;
-        double dConsumedSpace = 0;
-        double dTotalConsumedSpace = 0;
-        for (auto &n : lineWordMetrics) {
-          if (n.totalWidth - dTotalConsumedSpace > displayList.ow) {
-            // get the piece of text that is calculate to fit within the
-            // bounds.
-            sText = s.substr(lastCharacterRendered,
-                             lastMetric.spacePosition - lastCharacterRendered);
+/**
+  \internal
+  \brief initializes the font library and its caches. The Viewer calls
+  this upon a worker task while the document is built, so it must not
+  touch the display connection.
+*/
+void viewManager::Visualizer::platform::initializeText(void) {
+#ifdef USE_INLINE_RENDERER
+  if (m_freeType)
+    return;
 
-            // draw within the calculated layout rectangle.
-            device.drawText(sTextFace, tSize, sText, tColor, displayList.x1,
-                            displayList.y1 + linesDisplayed * dTextLineHeight,
-                            displayList.x2, displayList.y2, tAlign);
+  const char *errText = "The freetype library could not be initialized.";
 
-            // accumulate the total amount of horizontal space within the
-            // string that has been rendered.
-            dTotalConsumedSpace = dTotalConsumedSpace + dConsumedSpace;
-            dConsumedSpace = 0;
-            lastCharacterRendered = lastMetric.spacePosition + 1;
-            linesDisplayed++;
+  FT_Error error;
 
-            // display last part of unbroken contigious string, last time
-            // processing
-            if (lineWordMetrics.back().totalWidth - dTotalConsumedSpace <=
-                displayList.ow) {
-              sText =
-                  s.substr(lastCharacterRendered,
-                           lastMetric.spacePosition - lastCharacterRendered);
+  // init the freetype library
+  error = FT_Init_FreeType(&m_freeType);
+  if (error)
+    throw std::runtime_error(errText);
 
-              // draw within the calculated layout rectangle.
-              device.drawText(sTextFace, tSize, sText, tColor, displayList.x1,
-                              displayList.y1 + linesDisplayed * dTextLineHeight,
-                              displayList.x2, displayList.y2, tAlign);
-              linesDisplayed++;
+  // initalize the freetype cache
+  error = FTC_Manager_New(m_freeType, 0, 0, GLYPH_CACHE_BYTES, &faceRequestor,
+                          NULL, &m_cacheManager);
+  if (error)
+    throw std::runtime_error(errText);
 
-              lastMetric = lineWordMetrics.back();
-              break;
-            }
-          }
+#ifdef USE_GREYSCALE_ANTIALIAS
+  // initialize the bitmap cache
+  error = FTC_SBitCache_New(m_cacheManager, &m_bitCache);
+  if (error)
+    throw std::runtime_error(errText);
 
-          dConsumedSpace = n.totalWidth - dTotalConsumedSpace;
-          lastMetric = n;
-        }
-      }
-    }
-  }
-}
+#elif defined USE_LCD_FILTER
 
-/**
-\brief Uses the standard printf function to format the given
-parameters with the format string. When the Boolean member
-ingestStream is set to true, the API inserts the named
-elements within the markup into the document along with any
-text.
+  // initialize the image cache
+  error = FTC_ImageCache_New(m_cacheManager, &m_imageCache);
+  if (error)
+    throw std::runtime_error(errText);
 
-\param fmt is a printf format string. It should be a literal
-string.
-\param ...  is a variable argument parameter passed to the standard
-  printf function.
+#endif
 
-\code
-  vector<string> movies={"The Hulk",
-                        "Super Action Hero",
-                        "Star Invader Eclipse"};
+  error = FTC_CMapCache_New(m_cacheManager, &m_cmapCache);
+  if (error)
+    throw std::runtime_error(errText);
 
-  auto& e=createElement();
-  e.ingestStream=true;
-  e.printf("The movie theatre is <blue>opened</blue> today for matinee.");
-  e.printf("Here is a list of movies: <ul>");
+#endif
+}
+/**
+  \internal
+  \brief terminates the xserver connection
+  and frees resources.
+*/
+viewManager::Visualizer::platform::~platform() {
+  // the window is closed first, font loads still in flight reference
+  // this object.
+  closeWindow();
+
+// Freetype can be used for windows or linux
+#ifdef USE_INLINE_RENDERER
+  // the library may not have been started when the viewer was never run.
+  if (m_cacheManager)
+    FTC_Manager_Done(m_cacheManager);
+  if (m_freeType)
+    FT_Done_FreeType(m_freeType);
+#endif
+
+#if defined(_WIN64)
+  CoUninitialize();
+#endif
+}
+/**
+  \internal
+  \brief resolves the faces and opens the default one so that the first
+  paint finds them within the cache. Faces other than the default are read
+  by their loading tasks. Called after initializeText upon the same task.
+*/
+void viewManager::Visualizer::platform::preloadFaces(
+    const std::vector<std::string> &faces) {
+#ifdef USE_INLINE_RENDERER
+  for (auto &sFace : faces)
+    getFaceID(sFace);
 
-  for(auto n : movies)
-    e.prinf("<li>%s</li>",n.c_str());
-  e.printf("</ul>");
+  measureFaceHeight(DEFAULT_TEXTFACE, DEFAULT_TEXTSIZE);
+#endif
+}
 
-\endcode
+/**
+  \internal
+  \brief opens the connection to the display server. The Viewer calls
+  this upon a worker task while the document is built. The window is
+  created later by openWindow on the user interface thread.
+*/
+void viewManager::Visualizer::platform::connect(void) {
+#if defined(__linux__)
+  if (m_connection)
+    return;
 
-\note If a literal is not used for the first parameter, a warning will
-be issued. This warning is effective because at times, it reminds the
-developer that if the format string comes from a foreign source
-and is not controlled, the stack may be violated.
-\endnote
+  // this open provide interoperability between xcb and xwindows
+  // this is used here because of the necessity of key mapping.
+  m_xdisplay = XOpenDisplay(nullptr);
+  if (!m_xdisplay)
+    throw std::runtime_error("Could not open the display.");
 
+  /* get the connection to the X server */
+  m_connection = XGetXCBConnection(m_xdisplay);
 
-\ref markupInputFormat
+  /* Get the first screen */
+  m_screen = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data;
+  m_syms = xcb_key_symbols_alloc(m_connection);
+#endif
+}
 
+/**
+  \internal
+  \brief opens a window on the target OS
 
 */
-void viewManager::Element::printf(const char *fmt, ...) {
+void viewManager::Visualizer::platform::openWindow(
+    const std::string &sWindowTitle) {
 #if defined(__linux__)
-  va_list ap;
-  va_start(ap, fmt);
-  char *buffer = nullptr;
-/* These are checked with the __attribute__ setting on the function
- * declare above. Turning them off here makes it only report warnings to
- * calls of this member function and not the asprintf call. As well,
- * buffer is passed as a double pointer and is used to note the allocated
- * memory. It is also freed within this routine. */
-#pragma clang diagnostic ignored "-Wformat-security"
-#pragma clang diagnostic ignored "-Wformat-nonliteral"
-  vasprintf(&buffer, fmt, ap);
-#pragma clang diagnostic warning "-Wformat-security"
-#pragma clang diagnostic warning "-Wformat-nonliteral"
-
-  // if stream ingestion is on, interprets the markup as it arrives.
-  if (ingestStream)
-    ingestMarkup(*this, buffer);
-  else
-    data().push_back(buffer);
+  connect();
 
-  free(buffer);
-  va_end(ap);
-#elif defined(_WIN64)
-  va_list ap;
-  va_start(ap, fmt);
-  char *buffer = nullptr;
-  int len;
+  /* Create black (foreground) graphic context */
+  m_window = m_screen->root;
+  m_graphics = xcb_generate_id(m_connection);
+  uint32_t mask = XCB_GC_FOREGROUND | XCB_GC_GRAPHICS_EXPOSURES;
+  uint32_t values[2] = {m_screen->black_pixel, 0};
+  xcb_create_gc(m_connection, m_graphics, m_window, mask, values);
 
-  len = _vscprintf_l(fmt, NULL, ap) + 1;
-  buffer = (char *)malloc(len * sizeof(char));
-  len = vsprintf_s(buffer, len, fmt, ap);
+  /* Create a window */
+  m_window = xcb_generate_id(m_connection);
+  mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
+  values[0] = m_screen->white_pixel;
+  values[1] = XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_KEY_PRESS |
+              XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
+              XCB_EVENT_MASK_BUTTON_MOTION | XCB_EVENT_MASK_BUTTON_PRESS |
+              XCB_EVENT_MASK_BUTTON_RELEASE;
 
-  // if stream ingestion is on, interprets the markup as it arrives.
-  if (ingestStream)
-    ingestMarkup(*this, buffer);
-  else
-    data().push_back(buffer);
+  xcb_create_window(
+      m_connection, XCB_COPY_FROM_PARENT, m_window, m_screen->root, 0, 0,
+      static_cast<unsigned short>(_w), static_cast<unsigned short>(_h), 10,
+      XCB_WINDOW_CLASS_INPUT_OUTPUT, m_screen->root_visual, mask, values);
+  // set window title
+  xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_window,
+                      XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, sWindowTitle.size(),
+                      sWindowTitle.data());
 
-  free(buffer);
-  va_end(ap);
-#endif
-}
+  /* Map the window on the screen and flush*/
+  xcb_map_window(m_connection, m_window);
+  xcb_flush(m_connection);
 
-/**
-\internal
-\brief The ingestMarkup function provides a method to parse markup that is
-similar to HTML. The format is more restrictive in that the parser is not as
-forgiving for errors.
+  // create offscreen bitmap
+  resize(_w, _h);
 
-\details
-The routine is called by the functions that allow a markup string.
-This routine uses the object factory and color map to query the
-contents of the maps.
+  m_bWakeable = true;
+  return;
 
-The parser context applies memory to successive calls to the function.
-This is important for functions like printf or the stream insertion
-operators so that markup gets interpreted correctly. Since there is one of
-these contexts per element, each element operates independently.
+#elif defined(_WIN64)
 
-The parser acts in a two phase operation, first locating each of the tags
-as markup and those that appears as tags but are not markup elements. The
-second phase builds the elements and applies the attributes to the
-elements. Since document fragments can be nested, the parser function
-maintains a stack of created elements.
+  // Register the window class.
+  WNDCLASSEX wcex = {sizeof(WNDCLASSEX)};
+  wcex.style = CS_HREDRAW | CS_VREDRAW;
+  wcex.lpfnWndProc = &Visualizer::platform::WndProc;
+  wcex.cbClsExtra = 0;
+  wcex.cbWndExtra = sizeof(LONG_PTR);
+  wcex.hInstance = HINST_THISCOMPONENT;
+  wcex.hbrBackground = NULL;
+  wcex.lpszMenuName = NULL;
+  wcex.hCursor = LoadCursor(NULL, IDI_APPLICATION);
+  wcex.lpszClassName = "viewManagerApp";
+  RegisterClassEx(&wcex);
+  // Create the window.
+  m_hwnd =
+      CreateWindow("viewManagerApp", sWindowTitle.data(), WS_OVERLAPPEDWINDOW,
+                   CW_USEDEFAULT, CW_USEDEFAULT, static_cast<UINT>(_w),
+                   static_cast<UINT>(_h), NULL, NULL, HINST_THISCOMPONENT, 0L);
 
-\ref markupInputFormat
+  SetWindowLongPtr(m_hwnd, GWLP_USERDATA, (long long)this);
 
-*/
-Element &viewManager::Element::ingestMarkup(Element &node,
-                                            const std::string &markup) {
+  if (!initializeVideo())
+    throw std::runtime_error("Could not initalize direct x video subsystem.");
 
-  static parserContext pc;
+  // create offscreen bitmap
+  resize(_w, _h);
 
-  if (pc.elementStack.size() == 0)
-    pc.elementStack.push_back(node);
+  ShowWindow(m_hwnd, SW_SHOWNORMAL);
+  UpdateWindow(m_hwnd);
 
-  // pointer to the input buffer.
-  const char *p = markup.data();
+  m_bWakeable = true;
 
-  // tokenize the markup string
-  for (auto ch : markup) {
-    switch (ch) {
-    case '<':
-      if (pc.sText.size() != 0) {
-        pc.parsedData.emplace_back(textData, false, pc.sText);
-        pc.sText = "";
-      }
-      pc.bAttributeList=false;
-      pc.bAttributeListValue=false;
-      pc.bSignal = true;
-      pc.bSkip = true;
-      break;
-    case ' ':
-      if (pc.bSignal && (!pc.bToken || pc.bAttributeList)) {
-        pc.bQuery = true;
-        pc.bSkip = true;
-      }
-      break;
-    case '=':
-      if (pc.bAttributeList) {
-        pc.bQuery = true;
-        pc.bSkip = true;
-      }
-      break;
-    case '>':
-      if (pc.bSignal) {
-        pc.bSignal = false;
-        pc.bToken = false;
-        pc.bSkip = true;
-        pc.bQuery = true;
-      }
-      break;
-    case '/':
-      if (pc.bSignal) {
-        pc.bTerminal = true;
-        pc.bSkip = true;
-      }
-      break;
-    }
+#endif
+}
 
-    // the query flag is on when a item has been tokenized after a signal
-    // has been found.
-    if (pc.bQuery)
-      processParseContext(pc);
+/**
+  \internal
+  \brief Initalize the direct 3 video system.
 
-    if (!pc.bSkip)
-      if (pc.bSignal)
-        pc.sCapture += ch;
-      else
-        pc.sText += ch;
+  Orginal code from
+*/
+#ifdef _WIN64
+bool viewManager::Visualizer::platform::initializeVideo() {
+  HRESULT hr;
 
-    pc.bSkip = false;
-  }
+  // Create a Direct2D factory.
+  hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pD2DFactory);
 
-  // if text exists, add as a textdata element.
-  if (pc.sText.size() != 0) {
-    pc.parsedData.emplace_back(textData, false, pc.sText);
-    pc.sText = "";
-  }
+  RECT rc;
+  GetClientRect(m_hwnd, &rc);
 
-  // second phase, iterate over the parsed context and develop the elements,
-  // color text nodes, and set attributes for the items on the stack. once
-  // items are processed, they are removed from the stack using the delete
-  // range operator, For a complete tag to exist, the end tab must also
-  // exist.
-  auto item = pc.parsedData.begin();
-  while (item != pc.parsedData.end()) {
+  D2D1_SIZE_U size = D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top);
 
-    // if the item is processed
-    if (get<1>(*item))
-      continue;
+  // Create a Direct2D render target.
+  hr = m_pD2DFactory->CreateHwndRenderTarget(
+      D2D1::RenderTargetProperties(),
+      D2D1::HwndRenderTargetProperties(m_hwnd, size), &m_pRenderTarget);
+  return true;
+}
 
-    switch (get<0>(*item)) {
-    case element: {
-      Element &e = get<factoryLambda>(get<2>(*item))({});
-      pc.elementStack.back().get().appendChild(e);
-      pc.elementStack.push_back(e);
-      get<1>(*item) = true;
-    } break;
+/**
+  \brief terminateVideo
+  \description the routine frees the resources of directx.
+*/
+void viewManager::Visualizer::platform::terminateVideo(void) {
+  m_pD2DFactory->Release();
+  m_pRenderTarget->Release();
+}
 
-    case elementTerminal: {
-      pc.elementStack.pop_back();
-      // mark as processed
-      get<1>(*item) = true;
-    } break;
+#endif
 
-    // the attribute and value are handled here together
-    case attribute: {
-      auto itAttributeValue = std::next(item, 1);
-      if (itAttributeValue != pc.parsedData.end() &&
-          get<0>(*itAttributeValue) == attributeValue) {
-        get<attributeLambda>(get<2>(*item))(
-            pc.elementStack.back(), get<string>(get<2>(*itAttributeValue)));
-        get<1>(*itAttributeValue) = true;
-        // mark as processed
-        get<1>(*item) = true;
-        item++;
-      }
+/**
+  \internal
+  \brief closes a window on the target OS. Wakes are refused from here on
+  and the font loads, which wake the window, are waited for before the
+  connection is released. The font library itself is kept.
+*/
+void viewManager::Visualizer::platform::closeWindow(void) {
+  {
+    std::lock_guard<std::mutex> lock(m_wakeLock);
+    m_bWakeable = false;
+  }
 
-    } break;
+#ifdef USE_INLINE_RENDERER
+  for (auto &n : m_faceCache)
+    if (n.second.loader.valid())
+      n.second.loader.wait();
+#endif
 
-    case attributeSimple: {
-      get<attributeLambda>(get<2>(*item))(pc.elementStack.back(), "");
-      // mark as processed
-      get<1>(*item) = true;
-    } break;
+#if defined(__linux__)
+#if defined(USE_LINUX_FRAMEBUFFER)
+  m_input.reset();
+  m_framebuffer.reset();
+  if (m_wakeEvent >= 0)
+    close(m_wakeEvent);
+  m_wakeEvent = -1;
+#endif
 
-    case color: {
-      auto &e = pc.elementStack.back().get().appendChild<textNode>(
-          textColor{get<colorNF>(get<2>(*item))});
-      pc.elementStack.push_back(e);
-      get<1>(*item) = true;
-    } break;
+  if (m_connection) {
+    if (m_window) {
+      xcb_shm_detach(m_connection, m_info.shmseg);
+      shmdt(m_info.shmaddr);
 
-    case textData: {
-      pc.elementStack.back().get().data().push_back(get<string>(get<2>(*item)));
-      get<1>(*item) = true;
-      break;
-    }
+      xcb_free_pixmap(m_connection, m_pix);
+      xcb_free_gc(m_connection, m_foreground);
+      xcb_destroy_window(m_connection, m_window);
+      m_window = 0;
     }
+    xcb_key_symbols_free(m_syms);
+    m_syms = nullptr;
 
-    // goto next item
-    item++;
-  }
-
-  // if all items have been terminated, and only one element is on the stack
-  // it should be the node, so pop it off.
-  if (pc.elementStack.size() == 1) {
-    Element &eRet = pc.elementStack.back().get();
-    if (eRet.m_self == node.m_self)
-      pc.elementStack.pop_back();
+    xcb_disconnect(m_connection);
+    XCloseDisplay(m_xdisplay);
+    m_connection = nullptr;
+    m_xdisplay = nullptr;
   }
 
-  // erase processed items when marked,
-  pc.parsedData.erase(std::remove_if(pc.parsedData.begin(), pc.parsedData.end(),
-                                     [](auto &n) { return get<1>(n); }),
-                      pc.parsedData.end());
+#elif defined(_WIN64)
+  if (m_hwnd && IsWindow(m_hwnd))
+    DestroyWindow(m_hwnd);
+  m_hwnd = 0x00;
 
-  return node;
+#endif
 }
 
+#if defined(_WIN64)
+
 /**
 \internal
-\brief The function processes one query of a parse context.
-\details The first process of the function is to transform the
-input to lowr case to ensure case insensitive comparisons. The
-pc parserContext structure operates on a stream basis. Therefore
-the logic within this function provides the pass through and control
-break logic to implement the functionality. An intersting effect
-is that at times a token must be completely found before it may be
-processed. For example the ID of a element should be sent within one
-context.
+\brief The default window message processor for the application.
+This is the version of the Microsoft Windows operating system.
 
 */
-void viewManager::Element::processParseContext(
-    viewManager::Element::parserContext &pc) {
-
-  string sKey = pc.sCapture;
-  std::transform(sKey.begin(), sKey.end(), sKey.begin(),
-                 [](unsigned char c) { return std::tolower(c); });
+LRESULT CALLBACK viewManager::Visualizer::platform::WndProc(HWND hwnd,
+                                                            UINT message,
+                                                            WPARAM wParam,
+                                                            LPARAM lParam) {
+  LRESULT result = 0;
+  bool handled = false;
+  /** get the platform objext which is stored within the user data of the
+   window. this is necessary as the wndproc for the windows operating system
+   is called from an external library. The routine needs to be a static
+   implementation which is not directly locate within the class.
+  */
+  LONG_PTR lpUserData = GetWindowLongPtr(hwnd, GWLP_USERDATA);
+  platform *platformInstance = (platform *)lpUserData;
+  switch (message) {
+  case WM_SIZE:
+    platformInstance->dispatchEvent(event{eventType::resize,
+                                          static_cast<short>(LOWORD(lParam)),
+                                          static_cast<short>(HIWORD(lParam))});
+    result = 0;
+    handled = true;
+    break;
+  case WM_KEYDOWN: {
+    UINT scandCode = (lParam >> 8) & 0xFFFFFF00;
+    platformInstance->dispatchEvent(
+        event{eventType::keydown, (unsigned int)wParam});
+    handled = true;
+  } break;
+  case WM_KEYUP: {
+    UINT scandCode = (lParam >> 8) & 0xFFFFFF00;
+    platformInstance->dispatchEvent(
+        event{eventType::keyup, (unsigned int)wParam});
+    handled = true;
+  } break;
+  case WM_CHAR: {
+    // filter out some of the control keys that
+    // slip through such as the back and tab keys
+    if (wParam > 27) {
+      WCHAR tmp[2];
+      tmp[0] = wParam;
+      tmp[1] = 0x00;
+      char ch = wParam;
+      platformInstance->dispatchEvent(event{eventType::keypress, ch});
+      handled = true;
+    }
+  } break;
+  case WM_LBUTTONDOWN:
+    platformInstance->dispatchEvent(
+        event{eventType::mousedown, static_cast<short>(LOWORD(lParam)),
+              static_cast<short>(HIWORD(lParam)), 1});
+    handled = true;
+    break;
+  case WM_LBUTTONUP:
+    platformInstance->dispatchEvent(
+        event{eventType::mouseup, static_cast<short>(LOWORD(lParam)),
+              static_cast<short>(HIWORD(lParam)), 1});
+    handled = true;
+    break;
+  case WM_MBUTTONDOWN:
+    platformInstance->dispatchEvent(
+        event{eventType::mousedown, static_cast<short>(LOWORD(lParam)),
+              static_cast<short>(HIWORD(lParam)), 2});
+    handled = true;
+    break;
+  case WM_MBUTTONUP:
+    platformInstance->dispatchEvent(
+        event{eventType::mouseup, static_cast<short>(LOWORD(lParam)),
+              static_cast<short>(HIWORD(lParam)), 2});
+    handled = true;
+    break;
+  case WM_RBUTTONDOWN:
+    platformInstance->dispatchEvent(
+        event{eventType::mousedown, static_cast<short>(LOWORD(lParam)),
+              static_cast<short>(HIWORD(lParam)), 3});
+    handled = true;
+    break;
+  case WM_RBUTTONUP:
+    platformInstance->dispatchEvent(
+        event{eventType::mouseup, static_cast<short>(LOWORD(lParam)),
+              static_cast<short>(HIWORD(lParam)), 3});
+    handled = true;
+    break;
+  case WM_MOUSEMOVE:
+    platformInstance->dispatchEvent(event{eventType::mousemove,
+                                          static_cast<short>(LOWORD(lParam)),
+                                          static_cast<short>(HIWORD(lParam))});
+    result = 0;
+    handled = true;
+    break;
+  case WM_MOUSEWHEEL: {
+    platformInstance->dispatchEvent(event{
+        eventType::wheel, static_cast<short>(LOWORD(lParam)),
+        static_cast<short>(HIWORD(lParam)), GET_WHEEL_DELTA_WPARAM(wParam)});
+    handled = true;
+  } break;
+  case WM_DISPLAYCHANGE:
+    InvalidateRect(hwnd, NULL, FALSE);
+    result = 0;
+    handled = true;
+    break;
+  case WM_PAINT: {
+    PAINTSTRUCT ps;
+    HDC hdc = BeginPaint(hwnd, &ps);
+    platformInstance->dispatchEvent(event{eventType::paint});
+    EndPaint(hwnd, &ps);
+    ValidateRect(hwnd, NULL);
+    result = 0;
+    handled = true;
+  } break;
+  case WM_APP:
+    // posted by wake().
+    platformInstance->dispatchEvent(event{eventType::wake});
+    result = 0;
+    handled = true;
+    break;
+  case WM_DESTROY:
+    PostQuitMessage(0);
+    result = 1;
+    handled = true;
+    break;
+  }
+  if (!handled)
+    result = DefWindowProc(hwnd, message, wParam, lParam);
+  return result;
+}
+#endif
 
-  if (pc.bAttributeList && !pc.bAttributeListValue) {
+/**
+\internal
+\brief the routine handles the message processing for the specific
+operating system. The function is called from processEvents.
 
-    // store iterator to the function
-    auto it = attributeFactory.find(sKey);
-    if (it != attributeFactory.end())
+*/
+void viewManager::Visualizer::platform::messageLoop(void) {
+#if defined(__linux__)
+#if defined(USE_LINUX_FRAMEBUFFER)
+  if (m_framebuffer) {
+    framebufferLoop();
+    return;
+  }
+#endif
 
-      // if the attribute is a series of two tokens
-      if (get<0>(it->second)) {
-        pc.parsedData.emplace_back(attribute, false, get<1>(it->second));
-        pc.bAttributeListValue = true; // value is expected to follow.
+  xcb_generic_event_t *xcbEvent;
 
-      } else {
-        pc.parsedData.emplace_back(attributeSimple, false, get<1>(it->second));
-        pc.bAttributeListValue = false;
+  while (true) {
+    // when idle work is requested, the queue is polled rather than
+    // waited upon. The idle event is dispatched once it is empty.
+    if (m_bIdleRequested) {
+      xcbEvent = xcb_poll_for_event(m_connection);
+      if (!xcbEvent) {
+        if (xcb_connection_has_error(m_connection))
+          break;
+        m_bIdleRequested = false;
+        dispatchEvent(event{eventType::idle});
+        continue;
       }
-    pc.sCapture = "";
-    pc.bQuery = false;
-    if (!pc.bSignal)
-      pc.bToken = false;
-
-  } else if (pc.bAttributeList && pc.bAttributeListValue) {
-    pc.parsedData.emplace_back(attributeValue, false, pc.sCapture);
-    pc.sCapture = "";
-    pc.bQuery = false;
-
-    if (!pc.bSignal) {
-      pc.bAttributeList = false;
+    } else if (!(xcbEvent = xcb_wait_for_event(m_connection))) {
+      break;
     }
-    pc.bAttributeListValue = false;
-
-  } else {
 
-    auto it = objectFactoryMap.find(sKey);
-    if (it != objectFactoryMap.end()) {
-
-      if (pc.bTerminal) {
-        pc.parsedData.emplace_back(elementTerminal, false, "");
-        pc.bToken = false;
-        pc.bTerminal = false;
-        pc.bAttributeList = false;
-        pc.bAttributeListValue = false;
+    switch (xcbEvent->response_type & ~0x80) {
+    case XCB_MOTION_NOTIFY: {
+      xcb_motion_notify_event_t *motion = (xcb_motion_notify_event_t *)xcbEvent;
+      dispatchEvent(event{
+          eventType::mousemove,
+          motion->event_x,
+          motion->event_y,
+      });
+    } break;
+    case XCB_BUTTON_PRESS: {
+      xcb_button_press_event_t *bp = (xcb_button_press_event_t *)xcbEvent;
+      if (bp->detail == XCB_BUTTON_INDEX_4 ||
+          bp->detail == XCB_BUTTON_INDEX_5) {
+        dispatchEvent(event{eventType::wheel, bp->event_x, bp->event_y,
+                            bp->detail == XCB_BUTTON_INDEX_4 ? 1 : -1});
 
       } else {
-        // store lambda for the element factory
-        pc.parsedData.emplace_back(element, false, it->second);
-        pc.bToken = true;
-        pc.bAttributeList = true;
-        pc.bAttributeListValue = false;
+        dispatchEvent(
+            event{eventType::mousedown, bp->event_x, bp->event_y, bp->detail});
       }
-
-      pc.sCapture = "";
-      pc.bQuery = false;
-
-    } else {
-      // store the color object within the parser payload
-      auto it = colorNF::colorIndex(sKey);
-      if (it != colorNF::colorFactory.end()) {
-        pc.parsedData.emplace_back(color, false, colorNF(it));
+    } break;
+    case XCB_BUTTON_RELEASE: {
+      xcb_button_release_event_t *br = (xcb_button_release_event_t *)xcbEvent;
+      // ignore button 4 and 5 which are wheel events.
+      if (br->detail != XCB_BUTTON_INDEX_4 && br->detail != XCB_BUTTON_INDEX_5)
+        dispatchEvent(
+            event{eventType::mouseup, br->event_x, br->event_y, br->detail});
+    } break;
+    case XCB_KEY_PRESS: {
+      xcb_key_press_event_t *kp = (xcb_key_press_event_t *)xcbEvent;
+      xcb_keysym_t sym = xcb_key_press_lookup_keysym(m_syms, kp, 0);
+      if (sym < 0x99) {
+        XKeyEvent keyEvent;
+        keyEvent.display = m_xdisplay;
+        keyEvent.keycode = kp->detail;
+        keyEvent.state = kp->state;
+        std::array<char, 16> buf{};
+        if (XLookupString(&keyEvent, buf.data(), buf.size(), nullptr, nullptr))
+          dispatchEvent(event{eventType::keypress, (char)buf[0]});
+      } else {
+        dispatchEvent(event{eventType::keydown, sym});
       }
-
-      // illegal match found, pipe contents into ?
-      pc.bQuery = false;
+    } break;
+    case XCB_KEY_RELEASE: {
+      xcb_key_release_event_t *kr = (xcb_key_release_event_t *)xcbEvent;
+      xcb_keysym_t sym = xcb_key_press_lookup_keysym(m_syms, kr, 0);
+      dispatchEvent(event{eventType::keyup, sym});
+    } break;
+    case XCB_EXPOSE: {
+      flip();
+    } break;
+    case XCB_CLIENT_MESSAGE: {
+      // posted by wake() when background work such as a font load
+      // completes.
+      dispatchEvent(event{eventType::wake});
+    } break;
     }
+    free(xcbEvent);
+  }
+#elif defined(_WIN64)
+  MSG msg;
+  while (true) {
+    if (m_bIdleRequested && !PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE)) {
+      m_bIdleRequested = false;
+      dispatchEvent(event{eventType::idle});
+      continue;
+    }
+    if (!GetMessage(&msg, NULL, 0, 0))
+      break;
+    TranslateMessage(&msg);
+    DispatchMessage(&msg);
   }
+#endif
 }
 
 /**
 \internal
-\var nodes contains a list of the elements and their coordinates.
+\brief requests that an idle event be dispatched once the message queue
+is empty. The request is consumed by the dispatch, the handler requests
+again when it has more work.
 */
-std::unordered_map<std::size_t, std::reference_wrapper<Element>> nodes;
-
-std::size_t viewManager::Visualizer::allocate(Element &e) {
-  static std::size_t token = 0;
-  std::size_t ret = token;
-  nodes.emplace(ret, std::ref<Element>(e));
-  token++;
-  return ret;
+void viewManager::Visualizer::platform::requestIdle(void) {
+  m_bIdleRequested = true;
 }
-void viewManager::Visualizer::deallocate(const std::size_t &token) {}
 
 /**
-  \internal
-  \brief constructor for the platform object. The platform object is coded
-  such that each of the operating systems supported is encapsulated within
-  preprocessor blocks.
+\internal
+\brief The faceRequestor is a callback routine that provides
+creation of a face object. The parameter face_id is a pointer
+that is named as user information by the cache system.
 
-  \param eventHandler evtDispatcher the dispatcher routine which connects
-  the platform to the object model system. \param unsigned short width -
-  window size. \param unsigned short height - window size.
+\param FTC_FaceID face_id the user generated index
+\param FT_Library library handle to the free type library
+\param FT_Pointer request_data unused
+\param FT_Face *aface the newly ycreated fash object.
 */
-viewManager::Visualizer::platform::platform(const eventHandler &evtDispatcher,
-                                            const unsigned short width,
-                                            const unsigned short height) {
-  dispatchEvent = evtDispatcher;
-  _w = width;
-  _h = height;
-  fontScale = 0;
-
-// initialize private members
-#if defined(__linux__)
-  m_connection = nullptr;
-  m_screen = nullptr;
-  m_window = 0;
-  m_syms = nullptr;
-  m_foreground = 0;
-
-#elif defined(_WIN64)
-
-  m_hwnd = 0x00;
-  CoInitialize(NULL);
-
-#endif
-
-#ifdef USE_INLINE_RENDERER
-  const char *errText = "The freetype library could not be initialized.";
-
+FT_Error viewManager::Visualizer::platform::faceRequestor(
+    FTC_FaceID face_id, FT_Library library, FT_Pointer request_data,
+    FT_Face *aface) {
   FT_Error error;
+  faceCacheStruct *fID = static_cast<faceCacheStruct *>(face_id);
 
-  // init the freetype library
-  error = FT_Init_FreeType(&m_freeType);
-  if (error)
-    throw std::runtime_error(errText);
-
-  // initalize the freetype cache
-  error = FTC_Manager_New(m_freeType, 0, 0, 0, &faceRequestor, NULL,
-                          &m_cacheManager);
-  if (error)
-    throw std::runtime_error(errText);
-
-#ifdef USE_GREYSCALE_ANTIALIAS
-  // initialize the bitmap cache
-  error = FTC_SBitCache_New(m_cacheManager, &m_bitCache);
-  if (error)
-    throw std::runtime_error(errText);
-
-#elif defined USE_LCD_FILTER
+  // the bytes were read by the loading task, so creating the face
+  // does not block on the disk. The buffer must outlive the face, it
+  // does since face cache records are never removed.
+  if (!fID->file)
+    return FT_Err_Cannot_Open_Resource;
 
-  // initialize the image cache
-  error = FTC_ImageCache_New(m_cacheManager, &m_imageCache);
+  if (!fID->file->fileData.empty())
+    error = FT_New_Memory_Face(
+        library, fID->file->fileData.data(),
+        static_cast<FT_Long>(fID->file->fileData.size()), 0, aface);
+  else
+    error = FT_New_Face(library, fID->file->filePath.data(), 0, aface);
   if (error)
-    throw std::runtime_error(errText);
-
-#endif
+    return error;
 
-  error = FTC_CMapCache_New(m_cacheManager, &m_cmapCache);
-  if (error)
-    throw std::runtime_error(errText);
+  // we want to use unicode
+  error = FT_Select_Charmap(*aface, FT_ENCODING_UNICODE);
 
-#endif
+  return error;
 }
 /**
-  \internal
-  \brief terminates the xserver connection
-  and frees resources.
-*/
-viewManager::Visualizer::platform::~platform() {
-// Freetype can be used for windows or linux
-#ifdef USE_INLINE_RENDERER
-  FTC_Manager_Done(m_cacheManager);
-  FT_Done_FreeType(m_freeType);
-#endif
-
-#if defined(__linux__)
-  xcb_shm_detach(m_connection, m_info.shmseg);
-  shmdt(m_info.shmaddr);
-
-  xcb_free_pixmap(m_connection, m_pix);
-  xcb_free_gc(m_connection, m_foreground);
-  xcb_key_symbols_free(m_syms);
-
-  xcb_destroy_window(m_connection, m_window);
-  xcb_disconnect(m_connection);
-  XCloseDisplay(m_xdisplay);
+\internal
+\brief The function provides the building and location of a textFace name
+The function independently works on linux vs. windows. The linux is much
+more advanced in that it uses the fontconfig api. This api provides for
+family matching as a browser would incorporate. Whereas the windows portion
+uses the registry access and simply compares a string.
 
-#elif defined(_WIN64)
-  CoUninitialize();
+The function comes from the following source:
+https://stackoverflow.com/questions/10542832/how-to-use-fontconfig-to-get-font-list-c-c
+https://stackoverflow.com/questions/3954223/platform-independent-way-to-get-font-directory
 
-#endif
-}
-/**
-  \internal
-  \brief opens a window on the target OS
+\param sTextFace
 
 */
-void viewManager::Visualizer::platform::openWindow(
-    const std::string &sWindowTitle) {
-#if defined(__linux__)
-  // this open provide interoperability between xcb and xwindows
-  // this is used here because of the necessity of key mapping.
-  m_xdisplay = XOpenDisplay(nullptr);
-
-  /* get the connection to the X server */
-  m_connection = XGetXCBConnection(m_xdisplay);
+std::string viewManager::Visualizer::platform::getFontFilename(
+    const std::string &sTextFace) {
+  std::string fontFileReturn;
 
-  /* Get the first screen */
-  m_screen = xcb_setup_roots_iterator(xcb_get_setup(m_connection)).data;
-  m_syms = xcb_key_symbols_alloc(m_connection);
+#if defined(__linux__)
 
-  /* Create black (foreground) graphic context */
-  m_window = m_screen->root;
-  m_graphics = xcb_generate_id(m_connection);
-  uint32_t mask = XCB_GC_FOREGROUND | XCB_GC_GRAPHICS_EXPOSURES;
-  uint32_t values[2] = {m_screen->black_pixel, 0};
-  xcb_create_gc(m_connection, m_graphics, m_window, mask, values);
+  // loading the configuration scans the font directories. It is done once
+  // and shared. Fontconfig does not promise that matching against one
+  // configuration from several threads is safe, so the loading tasks take
+  // turns.
+  static FcConfig *config = FcInitLoadConfigAndFonts();
+  static std::mutex configLock;
+  std::lock_guard<std::mutex> lock(configLock);
 
-  /* Create a window */
-  m_window = xcb_generate_id(m_connection);
-  mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
-  values[0] = m_screen->white_pixel;
-  values[1] = XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_KEY_PRESS |
-              XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
-              XCB_EVENT_MASK_BUTTON_MOTION | XCB_EVENT_MASK_BUTTON_PRESS |
-              XCB_EVENT_MASK_BUTTON_RELEASE;
+  // configure the search pattern,
+  // assume "name" is a std::string with the desired font name in it
+  FcPattern *pat = FcNameParse((const FcChar8 *)(sTextFace.c_str()));
+  FcConfigSubstitute(config, pat, FcMatchPattern);
+  FcDefaultSubstitute(pat);
 
-  xcb_create_window(
-      m_connection, XCB_COPY_FROM_PARENT, m_window, m_screen->root, 0, 0,
-      static_cast<unsigned short>(_w), static_cast<unsigned short>(_h), 10,
-      XCB_WINDOW_CLASS_INPUT_OUTPUT, m_screen->root_visual, mask, values);
-  // set window title
-  xcb_change_property(m_connection, XCB_PROP_MODE_REPLACE, m_window,
-                      XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, sWindowTitle.size(),
-                      sWindowTitle.data());
+  // find the font
+  FcResult ret;
+  FcPattern *font = FcFontMatch(config, pat, &ret);
+  if (font) {
+    FcChar8 *file = NULL;
+    if (FcPatternGetString(font, FC_FILE, 0, &file) == FcResultMatch) {
+      // save the file to another std::string
+      fontFileReturn = (char *)file;
+    }
+    FcPatternDestroy(font);
+  }
 
-  /* Map the window on the screen and flush*/
-  xcb_map_window(m_connection, m_window);
-  xcb_flush(m_connection);
+  FcPatternDestroy(pat);
 
-  // create offscreen bitmap
-  resize(_w, _h);
+#elif defined(_WIN64)
 
-  return;
+  wstring subKey = L"Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
 
-#elif defined(_WIN64)
+  HKEY regKey = 0;
+  LONG ret;
+  wstring wsName;
+  DWORD dwNameSize;
+  vector<BYTE> vValue;
+  DWORD dwValueSize;
+  DWORD dwType = 0;
+  DWORD index = 0;
+  wstring wsSearch;
 
-  // Register the window class.
-  WNDCLASSEX wcex = {sizeof(WNDCLASSEX)};
-  wcex.style = CS_HREDRAW | CS_VREDRAW;
-  wcex.lpfnWndProc = &Visualizer::platform::WndProc;
-  wcex.cbClsExtra = 0;
-  wcex.cbWndExtra = sizeof(LONG_PTR);
-  wcex.hInstance = HINST_THISCOMPONENT;
-  wcex.hbrBackground = NULL;
-  wcex.lpszMenuName = NULL;
-  wcex.hCursor = LoadCursor(NULL, IDI_APPLICATION);
-  wcex.lpszClassName = "viewManagerApp";
-  RegisterClassEx(&wcex);
-  // Create the window.
-  m_hwnd =
-      CreateWindow("viewManagerApp", sWindowTitle.data(), WS_OVERLAPPEDWINDOW,
-                   CW_USEDEFAULT, CW_USEDEFAULT, static_cast<UINT>(_w),
-                   static_cast<UINT>(_h), NULL, NULL, HINST_THISCOMPONENT, 0L);
+  // convert input string to a multibyte wstring.
+  int wsSize =
+      MultiByteToWideChar(CP_ACP, MB_ERR_INVALID_CHARS, sTextFace.data(),
+                          sTextFace.size(), wsSearch.data(), 0);
+  wsSearch.resize(wsSize);
+  MultiByteToWideChar(CP_ACP, MB_ERR_INVALID_CHARS, sTextFace.data(),
+                      sTextFace.size(), wsSearch.data(), wsSize);
 
-  SetWindowLongPtr(m_hwnd, GWLP_USERDATA, (long long)this);
+  // open the registry key
+  ret = RegOpenKeyExW(HKEY_LOCAL_MACHINE, subKey.c_str(), 0, KEY_READ, &regKey);
+  if (ret != ERROR_SUCCESS) {
+    string errorCode;
+    errorCode = "Could not open windows registry (" + to_string(ret) + ")";
+    throw std::runtime_error(errorCode);
+  }
 
-  if (!initializeVideo())
-    throw std::runtime_error("Could not initalize direct x video subsystem.");
+  // get the number of entries
+  DWORD valueCount;
+  DWORD maxValueNameLen;
+  DWORD maxValueLen;
 
-  // create offscreen bitmap
-  resize(_w, _h);
+  // get the numer of items and the maximum lengths.
+  ret = RegQueryInfoKey(regKey, nullptr, nullptr, nullptr, nullptr, nullptr,
+                        nullptr, &valueCount, &maxValueNameLen, &maxValueLen,
+                        nullptr, nullptr);
+  if (ret != ERROR_SUCCESS) {
+    string errorCode;
+    errorCode = "Could not open windows registry (" + to_string(ret) + ")";
+    throw std::runtime_error(errorCode);
+  }
 
-  ShowWindow(m_hwnd, SW_SHOWNORMAL);
-  UpdateWindow(m_hwnd);
+  // resize for space and clear
+  maxValueLen++;
+  maxValueNameLen++;
+  wsName.resize(maxValueNameLen);
+  vValue.resize(maxValueLen);
+  bool bFound = false;
 
-#endif
-}
+  // look for a match
+  for (DWORD index = 0; index < valueCount; index++) {
 
-/**
-  \internal
-  \brief Initalize the direct 3 video system.
+    // get registry value
+    dwNameSize = maxValueNameLen;
+    dwValueSize = maxValueLen;
+    ret = RegEnumValueW(regKey, index, wsName.data(), &dwNameSize, NULL,
+                        &dwType, vValue.data(), &dwValueSize);
+    if (ret != ERROR_SUCCESS) {
+      string errorCode;
+      errorCode = "Could not open windows registry (" + to_string(ret) + ")";
+      throw std::runtime_error(errorCode);
+    }
 
-  Orginal code from
-*/
-#ifdef _WIN64
-bool viewManager::Visualizer::platform::initializeVideo() {
-  HRESULT hr;
+    // match name or file names
+    if (_wcsnicmp(wsName.c_str(), wsSearch.c_str(), wsSearch.size()) == 0) {
+      bFound = true;
+      break;
+    }
+  }
 
-  // Create a Direct2D factory.
-  hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pD2DFactory);
+  // close the registry key
+  RegCloseKey(regKey);
 
-  RECT rc;
-  GetClientRect(m_hwnd, &rc);
+  /**
+    Some font filenames within the registry have the path built in
+    while most windows fonts do not. This provides the full path.
+    For simplicity, check the second and third characters of the
+    file name to determine if it has a drive specifier.
+  */
+  LPWSTR lpwData = reinterpret_cast<LPWSTR>(vValue.data());
+  wstring wsfontFileReturn;
 
-  D2D1_SIZE_U size = D2D1::SizeU(rc.right - rc.left, rc.bottom - rc.top);
+  // if (!bFound)
+  // wcscpy_s(lpwData, L"arial.ttf");
 
-  // Create a Direct2D render target.
-  hr = m_pD2DFactory->CreateHwndRenderTarget(
-      D2D1::RenderTargetProperties(),
-      D2D1::HwndRenderTargetProperties(m_hwnd, size), &m_pRenderTarget);
-  return true;
-}
+  if (_wcsnicmp(lpwData + 1, L":\\", 2) == 0) {
+    wsfontFileReturn = lpwData;
 
-/**
-  \brief terminateVideo
-  \description the routine frees the resources of directx.
-*/
-void viewManager::Visualizer::platform::terminateVideo(void) {
-  m_pD2DFactory->Release();
-  m_pRenderTarget->Release();
-}
+  } else {
+    wsfontFileReturn.resize(MAX_PATH);
+    int lLen = GetSystemWindowsDirectoryW(wsfontFileReturn.data(), MAX_PATH);
+    wsfontFileReturn.resize(lLen);
+    wsfontFileReturn.append(L"\\Fonts\\");
+    wsfontFileReturn.append(lpwData);
+  }
 
+  // convert the widestring to an utf8 or default character representation
+  fontFileReturn.resize(MAX_PATH);
+  DWORD dw =
+      WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS,
+                          wsfontFileReturn.data(), wsfontFileReturn.size(),
+                          fontFileReturn.data(), MAX_PATH, nullptr, nullptr);
+  fontFileReturn.resize(dw);
 #endif
 
+  return fontFileReturn;
+}
+
 /**
-  \internal
-  \brief closes a window on the target OS
+\internal
+\brief The drawText function provides textual character rendering.
 
+\param std::string
+Optimized Blend
+https://www.codeguru.com/cpp/cpp/algorithms/general/article.php/c15989/Tip-An-Optimized-Formula-for-Alpha-Blending-Pixels.htm
 
 */
-void viewManager::Visualizer::platform::closeWindow(void) {
-#if defined(__linux__)
+void viewManager::Visualizer::platform::drawText(
+    const std::string &sTextFace, const int pointSize,
+    const std::string_view &s, const unsigned int foregroundColor, int x1,
+    int y1, int x2, int y2,
+    textAlignment tAlign) {
+  bool bProcessedOnce = false;
+  FT_Error error;
+  FTC_ScalerRec scaler;
+  FT_Size sizeFace;
+  FT_UInt glyph_index = 0;
+  FT_UInt previous_index = 0;
 
-#elif defined(_WIN64)
+  // store a cache record for loaded fonts.
+  FTC_FaceID faceID = getFaceID(sTextFace);
 
-#endif
-}
+  // having this as a local variable
+  scaler.face_id = faceID;
+  scaler.pixel = 0;
+  scaler.height = (pointSize + fontScale) * 64;
+  scaler.width = (pointSize + fontScale) * 64;
 
-#if defined(_WIN64)
+  scaler.x_res = 96;
+  scaler.y_res = 96;
 
-/**
-\internal
-\brief The default window message processor for the application.
-This is the version of the Microsoft Windows operating system.
+  // get the face
+  m_bGlyphsCached = true;
+  error = FTC_Manager_LookupSize(m_cacheManager, &scaler, &sizeFace);
 
-*/
-LRESULT CALLBACK viewManager::Visualizer::platform::WndProc(HWND hwnd,
-                                                            UINT message,
-                                                            WPARAM wParam,
-                                                            LPARAM lParam) {
-  LRESULT result = 0;
-  bool handled = false;
-  /** get the platform objext which is stored within the user data of the
-   window. this is necessary as the wndproc for the windows operating system
-   is called from an external library. The routine needs to be a static
-   implementation which is not directly locate within the class.
-  */
-  LONG_PTR lpUserData = GetWindowLongPtr(hwnd, GWLP_USERDATA);
-  platform *platformInstance = (platform *)lpUserData;
-  switch (message) {
-  case WM_SIZE:
-    platformInstance->dispatchEvent(event{eventType::resize,
-                                          static_cast<short>(LOWORD(lParam)),
-                                          static_cast<short>(HIWORD(lParam))});
-    result = 0;
-    handled = true;
-    break;
-  case WM_KEYDOWN: {
-    UINT scandCode = (lParam >> 8) & 0xFFFFFF00;
-    platformInstance->dispatchEvent(
-        event{eventType::keydown, (unsigned int)wParam});
-    handled = true;
-  } break;
-  case WM_KEYUP: {
-    UINT scandCode = (lParam >> 8) & 0xFFFFFF00;
-    platformInstance->dispatchEvent(
-        event{eventType::keyup, (unsigned int)wParam});
-    handled = true;
-  } break;
-  case WM_CHAR: {
-    // filter out some of the control keys that
-    // slip through such as the back and tab keys
-    if (wParam > 27) {
-      WCHAR tmp[2];
-      tmp[0] = wParam;
-      tmp[1] = 0x00;
-      char ch = wParam;
-      platformInstance->dispatchEvent(event{eventType::keypress, ch});
-      handled = true;
-    }
-  } break;
-  case WM_LBUTTONDOWN:
-    platformInstance->dispatchEvent(
-        event{eventType::mousedown, static_cast<short>(LOWORD(lParam)),
-              static_cast<short>(HIWORD(lParam)), 1});
-    handled = true;
-    break;
-  case WM_LBUTTONUP:
-    platformInstance->dispatchEvent(
-        event{eventType::mouseup, static_cast<short>(LOWORD(lParam)),
-              static_cast<short>(HIWORD(lParam)), 1});
-    handled = true;
-    break;
-  case WM_MBUTTONDOWN:
-    platformInstance->dispatchEvent(
-        event{eventType::mousedown, static_cast<short>(LOWORD(lParam)),
-              static_cast<short>(HIWORD(lParam)), 2});
-    handled = true;
-    break;
-  case WM_MBUTTONUP:
-    platformInstance->dispatchEvent(
-        event{eventType::mouseup, static_cast<short>(LOWORD(lParam)),
-              static_cast<short>(HIWORD(lParam)), 2});
-    handled = true;
-    break;
-  case WM_RBUTTONDOWN:
-    platformInstance->dispatchEvent(
-        event{eventType::mousedown, static_cast<short>(LOWORD(lParam)),
-              static_cast<short>(HIWORD(lParam)), 3});
-    handled = true;
-    break;
-  case WM_RBUTTONUP:
-    platformInstance->dispatchEvent(
-        event{eventType::mouseup, static_cast<short>(LOWORD(lParam)),
-              static_cast<short>(HIWORD(lParam)), 3});
-    handled = true;
-    break;
-  case WM_MOUSEMOVE:
-    platformInstance->dispatchEvent(event{eventType::mousemove,
-                                          static_cast<short>(LOWORD(lParam)),
-                                          static_cast<short>(HIWORD(lParam))});
-    result = 0;
-    handled = true;
-    break;
-  case WM_MOUSEWHEEL: {
-    platformInstance->dispatchEvent(event{
-        eventType::wheel, static_cast<short>(LOWORD(lParam)),
-        static_cast<short>(HIWORD(lParam)), GET_WHEEL_DELTA_WPARAM(wParam)});
-    handled = true;
-  } break;
-  case WM_DISPLAYCHANGE:
-    InvalidateRect(hwnd, NULL, FALSE);
-    result = 0;
-    handled = true;
-    break;
-  case WM_PAINT: {
-    PAINTSTRUCT ps;
-    HDC hdc = BeginPaint(hwnd, &ps);
-    platformInstance->dispatchEvent(event{eventType::paint});
-    EndPaint(hwnd, &ps);
-    ValidateRect(hwnd, NULL);
-    result = 0;
-    handled = true;
-  } break;
-  case WM_DESTROY:
-    PostQuitMessage(0);
-    result = 1;
-    handled = true;
-    break;
-  }
-  if (!handled)
-    result = DefWindowProc(hwnd, message, wParam, lParam);
-  return result;
-}
-#endif
+  if (error)
+    throw std::runtime_error("Could not retrieve font face.");
+
+  error = FT_Activate_Size(sizeFace);
+  if (error)
+    throw std::runtime_error("Could FT_Activate_Size for font.");
 
-/**
-\internal
-\brief the routine handles the message processing for the specific
-operating system. The function is called from processEvents.
+  FT_Face face = sizeFace->face;
 
-*/
-void viewManager::Visualizer::platform::messageLoop(void) {
-#if defined(__linux__)
-  xcb_generic_event_t *xcbEvent;
+  // get the height of the font
+  int faceHeight = face->size->metrics.height >> 6;
+  int lHeight = faceHeight;
+  int xpos = x1;
+  int ypos = y1;
 
-  while ((xcbEvent = xcb_wait_for_event(m_connection))) {
-    switch (xcbEvent->response_type & ~0x80) {
-    case XCB_MOTION_NOTIFY: {
-      xcb_motion_notify_event_t *motion = (xcb_motion_notify_event_t *)xcbEvent;
-      dispatchEvent(event{
-          eventType::mousemove,
-          motion->event_x,
-          motion->event_y,
-      });
-    } break;
-    case XCB_BUTTON_PRESS: {
-      xcb_button_press_event_t *bp = (xcb_button_press_event_t *)xcbEvent;
-      if (bp->detail == XCB_BUTTON_INDEX_4 ||
-          bp->detail == XCB_BUTTON_INDEX_5) {
-        dispatchEvent(event{eventType::wheel, bp->event_x, bp->event_y,
-                            bp->detail == XCB_BUTTON_INDEX_4 ? 1 : -1});
+  // iterate characters in string
+  for (auto &c : s) {
 
-      } else {
-        dispatchEvent(
-            event{eventType::mousedown, bp->event_x, bp->event_y, bp->detail});
-      }
-    } break;
-    case XCB_BUTTON_RELEASE: {
-      xcb_button_release_event_t *br = (xcb_button_release_event_t *)xcbEvent;
-      // ignore button 4 and 5 which are wheel events.
-      if (br->detail != XCB_BUTTON_INDEX_4 && br->detail != XCB_BUTTON_INDEX_5)
-        dispatchEvent(
-            event{eventType::mouseup, br->event_x, br->event_y, br->detail});
-    } break;
-    case XCB_KEY_PRESS: {
-      xcb_key_press_event_t *kp = (xcb_key_press_event_t *)xcbEvent;
-      xcb_keysym_t sym = xcb_key_press_lookup_keysym(m_syms, kp, 0);
-      if (sym < 0x99) {
-        XKeyEvent keyEvent;
-        keyEvent.display = m_xdisplay;
-        keyEvent.keycode = kp->detail;
-        keyEvent.state = kp->state;
-        std::array<char, 16> buf{};
-        if (XLookupString(&keyEvent, buf.data(), buf.size(), nullptr, nullptr))
-          dispatchEvent(event{eventType::keypress, (char)buf[0]});
-      } else {
-        dispatchEvent(event{eventType::keydown, sym});
+    // exit when rectangle has been filled
+    if (ypos > y2)
+      break;
+
+    // handle special characters
+    // new line
+    if (c == '\n') {
+      xpos = x1;
+      ypos += lHeight;
+      continue;
+      // tab
+    } else if (c == '\t') {
+      xpos += 50;
+      continue;
+    }
+
+    FT_UInt glyph_index = 0;
+
+    // get the index of the glyph
+    glyph_index = FTC_CMapCache_Lookup(m_cmapCache, faceID, 0, c);
+
+    // the kerning of a font depends on the previous character
+    // some proportional fonts provide tighter spacing which improves
+    // rendering characteristics
+    if (FT_HAS_KERNING(face) && bProcessedOnce) {
+      FT_Vector akerning;
+      error = FT_Get_Kerning(face, previous_index, glyph_index,
+                             FT_KERNING_DEFAULT, &akerning);
+      if (!error) {
+        xpos += akerning.x >> 6;
       }
-    } break;
-    case XCB_KEY_RELEASE: {
-      xcb_key_release_event_t *kr = (xcb_key_release_event_t *)xcbEvent;
-      xcb_keysym_t sym = xcb_key_press_lookup_keysym(m_syms, kr, 0);
-      dispatchEvent(event{eventType::keyup, sym});
-    } break;
-    case XCB_EXPOSE: {
-      flip();
-    } break;
     }
-    free(xcbEvent);
-  }
-#elif defined(_WIN64)
-  MSG msg;
-  while (GetMessage(&msg, NULL, 0, 0)) {
-    TranslateMessage(&msg);
-    DispatchMessage(&msg);
+
+    // render the character
+    int xadvance = drawChar(xpos, ypos, x2, y2, c, foregroundColor, glyph_index,
+                            sizeFace, &scaler);
+
+    // move after render
+    xpos += xadvance;
+    // wrap text
+    if (xpos > x2) {
+      xpos = x1;
+      ypos += lHeight;
+    }
+
+    bProcessedOnce = true;
+    previous_index = glyph_index;
   }
-#endif
 }
 
 /**
 \internal
-\brief The faceRequestor is a callback routine that provides
-creation of a face object. The parameter face_id is a pointer
-that is named as user information by the cache system.
+\brief The function provides the rendering of a individual character
+\details
+The routine provides the individual rendering of a character. The function
+is used internally within the drawStrign routine. The parameters are quite
+lengthy yet each are needed for specific purposes. The common ones are self
+explanitory.
 
-\param FTC_FaceID face_id the user generated index
-\param FT_Library library handle to the free type library
-\param FT_Pointer request_data unused
-\param FT_Face *aface the newly ycreated fash object.
+
+\param const int xPos is the left coordinate to start rendering
+\param const int yPos is the top coordinate to start rendering
+\param const int xPos2 is the clipping right position
+\param const int yPos2 is the clipping bottom position
+\param const char c is the individual character
+\param const unsigned int foregroundColor is the forgeound color of the
+text.
+\param FT_UInt glyph_index is the index of the character.
+\param const FT_Size sizeFace The face sized projection
+\param const FTC_Scaler pscaler the scaler record
 */
-FT_Error viewManager::Visualizer::platform::faceRequestor(
-    FTC_FaceID face_id, FT_Library library, FT_Pointer request_data,
-    FT_Face *aface) {
+int viewManager::Visualizer::platform::drawChar(
+    const int xPos, const int yPos, const int xPos2, const int yPos2,
+    const char c, const unsigned int foregroundColor, FT_UInt glyph_index,
+    const FT_Size sizeFace, const FTC_Scaler pscaler) {
   FT_Error error;
-  faceCacheStruct *fID = static_cast<faceCacheStruct *>(face_id);
-  error = FT_New_Face(library, fID->filePath.data(), 0, aface);
+  int x, y;
 
-  // we want to use unicode
-  error = FT_Select_Charmap(*aface, FT_ENCODING_UNICODE);
+  FT_Face face = sizeFace->face;
 
-  return error;
-}
-/**
-\internal
-\brief The function provides the building and location of a textFace name
-The function independently works on linux vs. windows. The linux is much
-more advanced in that it uses the fontconfig api. This api provides for
-family matching as a browser would incorporate. Whereas the windows portion
-uses the registry access and simply compares a string.
+  // get the height of the font
+  int faceHeight = face->size->metrics.height >> 6;
+  int baseline=face->size->metrics.ascender>>6;
 
-The function comes from the following source:
-https://stackoverflow.com/questions/10542832/how-to-use-fontconfig-to-get-font-list-c-c
-https://stackoverflow.com/questions/3954223/platform-independent-way-to-get-font-directory
+  /**
+  \brief use greyscale or color lcd filtering
+\details
+      There are two distinct types of bimap structures that are in use, grey
+      scale or lcd filtered. The buffer format is unique for each, the grey
+  lite one being a value indicating grey luminence while the lcd filter is a
+  rgb one. These values provide the same functionality for the looping and
+      drawing routine. You will notice that within each block of code, after
+      getting the image, these values are set.
+  */
+  int storageSize, pitch, top, left, height, width, xadvance;
+  unsigned char *buffer;
 
-\param sTextFace
+#ifdef USE_GREYSCALE_ANTIALIAS
+  // get the image
+  FTC_SBit bitmap;
+  error = FTC_SBitCache_LookupScaler(m_bitCache, pscaler, FT_LOAD_RENDER,
+                                     glyph_index, &bitmap, nullptr);
 
-*/
-std::string viewManager::Visualizer::platform::getFontFilename(
-    const std::string &sTextFace) {
-  std::string fontFileReturn;
+  if (error)
+    return 0;
 
-#if defined(__linux__)
+  // set the rendering values used for for grey
+  storageSize = 1;
+  pitch = bitmap->pitch;
+  top = bitmap->top;
+  left = bitmap->left;
+  height = bitmap->height;
+  width = bitmap->width;
+  buffer = bitmap->buffer;
+  xadvance = bitmap->xadvance;
 
-  FcConfig *config = FcInitLoadConfigAndFonts();
+#elif defined USE_LCD_FILTER
+  FT_Glyph aglyph;
+  FT_BitmapGlyph bitmap;
 
-  // configure the search pattern,
-  // assume "name" is a std::string with the desired font name in it
-  FcPattern *pat = FcNameParse((const FcChar8 *)(sTextFace.c_str()));
-  FcConfigSubstitute(config, pat, FcMatchPattern);
-  FcDefaultSubstitute(pat);
+  // get the image, however this is just the outline
+  error = FTC_ImageCache_LookupScaler(m_imageCache, pscaler, FT_LOAD_DEFAULT,
+                                      glyph_index, &aglyph, nullptr);
+  if (error)
+    return 0;
 
-  // find the font
-  FcResult ret;
-  FcPattern *font = FcFontMatch(config, pat, &ret);
-  if (font) {
-    FcChar8 *file = NULL;
-    if (FcPatternGetString(font, FC_FILE, 0, &file) == FcResultMatch) {
-      // save the file to another std::string
-      fontFileReturn = (char *)file;
-    }
-    FcPatternDestroy(font);
-  }
+  xadvance = (aglyph->advance.x + 0x8000) >> 16;
+
+  // this converts the outline image to a rgb bitmap
+  error = FT_Glyph_To_Bitmap(&aglyph, FT_RENDER_MODE_LCD, 0, 0);
+  bitmap = reinterpret_cast<FT_BitmapGlyph>(aglyph);
+
+  // set the rendering values used for for grey
+  storageSize = 3;
+  pitch = bitmap->bitmap.pitch;
+  top = bitmap->top;
+  left = bitmap->left;
+  height = bitmap->bitmap.rows;
+  width = bitmap->bitmap.width;
+  buffer = bitmap->bitmap.buffer;
+
+#endif
+
+  x = xPos;
+  y = yPos +  baseline - top;
+
+  // calculate the maximum bounds
+  int xmax = x + width / storageSize + left;
+  int ymax = yPos + (baseline-top) + height;
+
+  // if the maximum bounds are greater than the clipping region, adjust.
+  if (xmax > xPos2)
+    xmax = xPos2;
+  if (ymax > yPos2)
+    ymax = yPos2;
 
-  FcPatternDestroy(pat);
+  // blend the coverage of the glyph with the kernel of the pixel format.
+  blendGlyph(buffer, pitch, storageSize, x + left, y, xmax, ymax,
+             foregroundColor);
 
-#elif defined(_WIN64)
+#ifdef USE_LCD_FILTER
+  // delete the bitmap data
+  FT_Done_Glyph((FT_Glyph)bitmap);
 
-  wstring subKey = L"Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
+#endif
 
-  HKEY regKey = 0;
-  LONG ret;
-  wstring wsName;
-  DWORD dwNameSize;
-  vector<BYTE> vValue;
-  DWORD dwValueSize;
-  DWORD dwType = 0;
-  DWORD index = 0;
-  wstring wsSearch;
+  return xadvance;
+}
 
-  // convert input string to a multibyte wstring.
-  int wsSize =
-      MultiByteToWideChar(CP_ACP, MB_ERR_INVALID_CHARS, sTextFace.data(),
-                          sTextFace.size(), wsSearch.data(), 0);
-  wsSearch.resize(wsSize);
-  MultiByteToWideChar(CP_ACP, MB_ERR_INVALID_CHARS, sTextFace.data(),
-                      sTextFace.size(), wsSearch.data(), wsSize);
+/**
+\brief The routine returns that face ID for the cached font. This is a
+pointer to the record within the unordered_map.
+
+\details The default text face is resolved on first use. Other faces
+are located and read from disk by a background task. Until that task
+completes, the ID of the default face is returned so that text is
+measured and drawn with it. When the task finishes, it wakes the message
+loop, and only the elements measured with the fallback are measured with
+the requested face and placed again.
+*/
+FTC_FaceID viewManager::Visualizer::platform::getFaceID(string sTextFace) {
+  auto it = m_faceCache.find(sTextFace);
+  if (it == m_faceCache.end()) {
+    faceCacheStruct faceCacheRecord{};
+    faceCacheRecord.index = static_cast<int>(m_faceCache.size());
 
-  // open the registry key
-  ret = RegOpenKeyExW(HKEY_LOCAL_MACHINE, subKey.c_str(), 0, KEY_READ, &regKey);
-  if (ret != ERROR_SUCCESS) {
-    string errorCode;
-    errorCode = "Could not open windows registry (" + to_string(ret) + ")";
-    throw std::runtime_error(errorCode);
-  }
+    if (sTextFace == DEFAULT_TEXTFACE) {
+      faceCacheRecord.file = loadFaceFile(sTextFace);
+      faceCacheRecord.bReady = true;
 
-  // get the number of entries
-  DWORD valueCount;
-  DWORD maxValueNameLen;
-  DWORD maxValueLen;
+    } else {
+      auto promise =
+          make_shared<std::promise<std::shared_ptr<const faceFileStruct>>>();
+      faceCacheRecord.pending = promise->get_future();
+      faceCacheRecord.loader =
+          std::async(std::launch::async, [this, promise, sTextFace]() {
+            try {
+              promise->set_value(loadFaceFile(sTextFace));
+            } catch (...) {
+              promise->set_exception(std::current_exception());
+            }
+            wake();
+          });
+    }
 
-  // get the numer of items and the maximum lengths.
-  ret = RegQueryInfoKey(regKey, nullptr, nullptr, nullptr, nullptr, nullptr,
-                        nullptr, &valueCount, &maxValueNameLen, &maxValueLen,
-                        nullptr, nullptr);
-  if (ret != ERROR_SUCCESS) {
-    string errorCode;
-    errorCode = "Could not open windows registry (" + to_string(ret) + ")";
-    throw std::runtime_error(errorCode);
+    // records are never erased and unordered_map does not move them
+    // on rehash, so the address is a stable face ID.
+    it = m_faceCache.insert({sTextFace, std::move(faceCacheRecord)}).first;
   }
 
-  // resize for space and clear
-  maxValueLen++;
-  maxValueNameLen++;
-  wsName.resize(maxValueNameLen);
-  vValue.resize(maxValueLen);
-  bool bFound = false;
+  if (!isFaceLoaded(sTextFace) || !it->second.bReady)
+    return getFaceID(DEFAULT_TEXTFACE);
 
-  // look for a match
-  for (DWORD index = 0; index < valueCount; index++) {
+  return static_cast<FTC_FaceID>(&it->second);
+}
 
-    // get registry value
-    dwNameSize = maxValueNameLen;
-    dwValueSize = maxValueLen;
-    ret = RegEnumValueW(regKey, index, wsName.data(), &dwNameSize, NULL,
-                        &dwType, vValue.data(), &dwValueSize);
-    if (ret != ERROR_SUCCESS) {
-      string errorCode;
-      errorCode = "Could not open windows registry (" + to_string(ret) + ")";
-      throw std::runtime_error(errorCode);
-    }
+/**
+\internal
+\brief returns true when the face has finished loading, or failed to load
+and will permanently use the default face. Starts the load when the face
+has not been requested before.
+*/
+bool viewManager::Visualizer::platform::isFaceLoaded(
+    const std::string &sTextFace) {
+  auto it = m_faceCache.find(sTextFace);
+  if (it == m_faceCache.end()) {
+    getFaceID(sTextFace);
+    it = m_faceCache.find(sTextFace);
+  }
 
-    // match name or file names
-    if (_wcsnicmp(wsName.c_str(), wsSearch.c_str(), wsSearch.size()) == 0) {
-      bFound = true;
-      break;
+  faceCacheStruct &record = it->second;
+  if (record.pending.valid() &&
+      record.pending.wait_for(std::chrono::seconds(0)) ==
+          std::future_status::ready) {
+    try {
+      record.file = record.pending.get();
+      record.bReady = true;
+    } catch (const std::exception &e) {
+      // the face could not be located, the default is used in its place.
     }
   }
 
-  // close the registry key
-  RegCloseKey(regKey);
+  return !record.pending.valid();
+}
 
-  /**
-    Some font filenames within the registry have the path built in
-    while most windows fonts do not. This provides the full path.
-    For simplicity, check the second and third characters of the
-    file name to determine if it has a drive specifier.
-  */
-  LPWSTR lpwData = reinterpret_cast<LPWSTR>(vValue.data());
-  wstring wsfontFileReturn;
+/**
+\internal
+\brief notes an element measured with the default face while its own
+face loads, so that only it is placed again when the face arrives.
+*/
+void viewManager::Visualizer::platform::waitForFace(
+    const std::string &sTextFace, const std::size_t key) {
+  m_faceWaiters[sTextFace].push_back(key);
+}
 
-  // if (!bFound)
-  // wcscpy_s(lpwData, L"arial.ttf");
+/**
+\internal
+\brief returns the keys of the elements waiting for the faces that have
+loaded since the last call, and forgets them. An element may have been
+removed since it was noted.
+*/
+std::vector<std::size_t> viewManager::Visualizer::platform::takeFaceWaiters(
+    void) {
+  std::vector<std::size_t> keys;
+  for (auto it = m_faceWaiters.begin(); it != m_faceWaiters.end();) {
+    if (!isFaceLoaded(it->first)) {
+      it++;
+      continue;
+    }
+    keys.insert(keys.end(), it->second.begin(), it->second.end());
+    it = m_faceWaiters.erase(it);
+  }
+  return keys;
+}
 
-  if (_wcsnicmp(lpwData + 1, L":\\", 2) == 0) {
-    wsfontFileReturn = lpwData;
+/**
+\internal
+\brief locates the font file for the face and reads its contents. The
+function is called from the background loading tasks and so only uses
+fontconfig and the file system.
 
-  } else {
-    wsfontFileReturn.resize(MAX_PATH);
-    int lLen = GetSystemWindowsDirectoryW(wsfontFileReturn.data(), MAX_PATH);
-    wsfontFileReturn.resize(lLen);
-    wsfontFileReturn.append(L"\\Fonts\\");
-    wsfontFileReturn.append(lpwData);
+\details The contents are shared by every platform of the process, so
+viewers rendering upon several threads read each font once. FreeType only
+reads the bytes, and each platform creates its own faces from them.
+*/
+std::shared_ptr<const viewManager::Visualizer::platform::faceFileStruct>
+viewManager::Visualizer::platform::loadFaceFile(const std::string &sTextFace) {
+  static std::mutex cacheMutex;
+  static std::unordered_map<std::string, std::shared_ptr<const faceFileStruct>>
+      sharedFiles;
+
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = sharedFiles.find(sTextFace);
+    if (it != sharedFiles.end())
+      return it->second;
   }
 
-  // convert the widestring to an utf8 or default character representation
-  fontFileReturn.resize(MAX_PATH);
-  DWORD dw =
-      WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS,
-                          wsfontFileReturn.data(), wsfontFileReturn.size(),
-                          fontFileReturn.data(), MAX_PATH, nullptr, nullptr);
-  fontFileReturn.resize(dw);
-#endif
+  auto file = std::make_shared<faceFileStruct>();
+  file->filePath = getFontFilename(sTextFace);
+
+  std::ifstream fontFile(file->filePath, std::ios::binary | std::ios::ate);
+  if (fontFile) {
+    std::streamsize size = fontFile.tellg();
+    if (size > 0) {
+      file->fileData.resize(static_cast<std::size_t>(size));
+      fontFile.seekg(0);
+      if (!fontFile.read(reinterpret_cast<char *>(file->fileData.data()),
+                         size))
+        file->fileData.clear();
+    }
+  }
 
-  return fontFileReturn;
+  // a face read by two threads at once keeps the first copy.
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  return sharedFiles.emplace(sTextFace, std::move(file)).first->second;
 }
 
 /**
 \internal
-\brief The drawText function provides textual character rendering.
-
-\param std::string
-Optimized Blend
-https://www.codeguru.com/cpp/cpp/algorithms/general/article.php/c15989/Tip-An-Optimized-Formula-for-Alpha-Blending-Pixels.htm
-
+\brief The function returns the width of the string according to the font
+size.
 */
-void viewManager::Visualizer::platform::drawText(
-    const std::string &sTextFace, const int pointSize, const std::string &s,
-    const unsigned int foregroundColor, int x1, int y1, int x2, int y2,
-    textAlignment tAlign) {
+double viewManager::Visualizer::platform::measureTextWidth(
+    const std::string &sTextFace, const int pointSize,
+    const std::string_view &s) {
   bool bProcessedOnce = false;
   FT_Error error;
   FTC_ScalerRec scaler;
   FT_Size sizeFace;
   FT_UInt glyph_index = 0;
   FT_UInt previous_index = 0;
+  double ret = 0;
 
   // store a cache record for loaded fonts.
   FTC_FaceID faceID = getFaceID(sTextFace);
@@ -4172,6 +10086,7 @@ void viewManager::Visualizer::platform::drawText(
   scaler.y_res = 96;
 
   // get the face
+  m_bGlyphsCached = true;
   error = FTC_Manager_LookupSize(m_cacheManager, &scaler, &sizeFace);
 
   if (error)
@@ -4183,28 +10098,12 @@ void viewManager::Visualizer::platform::drawText(
 
   FT_Face face = sizeFace->face;
 
-  // get the height of the font
-  int faceHeight = face->size->metrics.height >> 6;
-  int lHeight = faceHeight;
-  int xpos = x1;
-  int ypos = y1;
-
   // iterate characters in string
   for (auto &c : s) {
 
-    // exit when rectangle has been filled
-    if (ypos > y2)
-      break;
-
     // handle special characters
-    // new line
-    if (c == '\n') {
-      xpos = x1;
-      ypos += lHeight;
-      continue;
-      // tab
-    } else if (c == '\t') {
-      xpos += 50;
+    if (c == '\t') {
+      m_xpos += 50;
       continue;
     }
 
@@ -4221,391 +10120,878 @@ void viewManager::Visualizer::platform::drawText(
       error = FT_Get_Kerning(face, previous_index, glyph_index,
                              FT_KERNING_DEFAULT, &akerning);
       if (!error) {
-        xpos += akerning.x >> 6;
+        m_xpos += akerning.x >> 6;
       }
     }
 
     // render the character
-    int xadvance = drawChar(xpos, ypos, x2, y2, c, foregroundColor, glyph_index,
-                            sizeFace, &scaler);
+    /**
+    \brief use greyscale or color lcd filtering
+  \details
+        There are two distinct types of bimap structures that are in use,
+  grey scale or lcd filtered. The buffer format is unique for each, the grey
+    lite one being a value indicating grey luminence while the lcd filter is
+  a rgb one. These values provide the same functionality for the looping and
+        drawing routine. You will notice that within each block of code,
+  after getting the image, these values are set.
+    */
+    int xadvance;
+
+#ifdef USE_GREYSCALE_ANTIALIAS
+    // get the image
+    FTC_SBit bitmap;
+    error = FTC_SBitCache_LookupScaler(m_bitCache, &scaler, FT_LOAD_RENDER,
+                                       glyph_index, &bitmap, nullptr);
+
+    if (error)
+      continue;
+
+    xadvance = bitmap->xadvance;
+
+#elif defined USE_LCD_FILTER
+    FT_Glyph aglyph;
+    FT_BitmapGlyph bitmap;
+
+    // get the image, however this is just the outline
+    error = FTC_ImageCache_LookupScaler(m_imageCache, &scaler, FT_LOAD_DEFAULT,
+                                        glyph_index, &aglyph, nullptr);
+    if (error)
+      continue;
+
+    xadvance = (aglyph->advance.x + 0x8000) >> 16;
+
+#endif
 
     // move after render
-    xpos += xadvance;
-    // wrap text
-    if (xpos > x2) {
-      xpos = x1;
-      ypos += lHeight;
-    }
+    ret += xadvance;
+    bProcessedOnce = true;
+    previous_index = glyph_index;
+  }
+  return ret;
+}
+
+/**
+\internal
+\brief the function measures the height of the textFace
+\param const std::string &sTextFace the face name
+\param const int pointSize the size in point of the font
+
+*/
+double viewManager::Visualizer::platform::measureFaceHeight(
+    const std::string &sTextFace, const int pointSize) {
+  FT_Error error;
+  FTC_ScalerRec scaler;
+  FT_Size sizeFace;
+
+  // store a cache record for loaded fonts.
+  FTC_FaceID faceID = getFaceID(sTextFace);
+
+  // having this as a local variable
+  scaler.face_id = faceID;
+  scaler.pixel = 0;
+  scaler.height = (pointSize + fontScale) * 64;
+  scaler.width = (pointSize + fontScale) * 64;
+
+  scaler.x_res = 96;
+  scaler.y_res = 96;
+
+  // get the face
+  m_bGlyphsCached = true;
+  error = FTC_Manager_LookupSize(m_cacheManager, &scaler, &sizeFace);
+
+  if (error)
+    throw std::runtime_error("Could not retrieve font face.");
+
+  error = FT_Activate_Size(sizeFace);
+  if (error)
+    throw std::runtime_error("Could FT_Activate_Size for font.");
+
+  FT_Face face = sizeFace->face;
+
+  // get the height of the font
+  int faceHeight = face->size->metrics.height >> 6;
+  return static_cast<double>(faceHeight);
+}
 
-    bProcessedOnce = true;
-    previous_index = glyph_index;
-  }
+/**
+  \internal
+  \brief the function draws the cursor.
+  */
+void viewManager::Visualizer::platform::drawCaret(const int x, const int y,
+                                                  const int h) {
+  for (int j = y; j < y + h; j++)
+    putPixel(x, j, 0x00);
 }
 
 /**
 \internal
-\brief The function provides the rendering of a individual character
-\details
-The routine provides the individual rendering of a character. The function
-is used internally within the drawStrign routine. The parameters are quite
-lengthy yet each are needed for specific purposes. The common ones are self
-explanitory.
+\brief the function copies an image to the offscreen buffer at the given
+size. The scaled copy is cached within the image so later frames at the
+same size only copy rows.
+*/
+void viewManager::Visualizer::platform::drawImage(imageSurface &image,
+                                                  const int x, const int y,
+                                                  const int w, const int h) {
+  if (image.empty() || w <= 0 || h <= 0)
+    return;
 
+  // nothing is scaled when the image is entirely clipped
+  if (x >= m_clipX2 || y >= m_clipY2 || x + w <= m_clipX1 ||
+      y + h <= m_clipY1)
+    return;
 
-\param const int xPos is the left coordinate to start rendering
-\param const int yPos is the top coordinate to start rendering
-\param const int xPos2 is the clipping right position
-\param const int yPos2 is the clipping bottom position
-\param const char c is the individual character
-\param const unsigned int foregroundColor is the forgeound color of the
-text.
-\param FT_UInt glyph_index is the index of the character.
-\param const FT_Size sizeFace The face sized projection
-\param const FTC_Scaler pscaler the scaler record
+  blit(image.scaled(w, h), x, y);
+}
+
+/**
+\internal
+\brief limits drawing to the rectangle. The rectangle is intersected with
+the offscreen buffer.
 */
-int viewManager::Visualizer::platform::drawChar(
-    const int xPos, const int yPos, const int xPos2, const int yPos2,
-    const char c, const unsigned int foregroundColor, FT_UInt glyph_index,
-    const FT_Size sizeFace, const FTC_Scaler pscaler) {
-  FT_Error error;
-  unsigned int color = 0x00; // computed color
-  int x, y;
+void viewManager::Visualizer::platform::setClip(const int x, const int y,
+                                                const int w, const int h) {
+  m_clipX1 = std::max(0, x);
+  m_clipY1 = std::max(0, y);
+  m_clipX2 = std::max(m_clipX1, std::min(static_cast<int>(_w), x + w));
+  m_clipY2 = std::max(m_clipY1, std::min(static_cast<int>(_h), y + h));
+}
 
-  // get color components of the foreground color used later.
-  unsigned char foregroundR = foregroundColor >> 16;
-  unsigned char foregroundG = foregroundColor >> 8;
-  unsigned char foregroundB = foregroundColor;
+/**
+\internal
+\brief sets the clip rectangle to the whole offscreen buffer. Clips that
+were pushed are discarded.
+*/
+void viewManager::Visualizer::platform::resetClip(void) {
+  m_clipX1 = 0;
+  m_clipY1 = 0;
+  m_clipX2 = _w;
+  m_clipY2 = _h;
+  m_clipStack.clear();
+}
 
-  FT_Face face = sizeFace->face;
+/**
+\internal
+\brief keeps the clip rectangle and limits drawing to its intersection
+with the rectangle, so that an element drawn within another stays within
+the clip of its parent. Each call is matched by popClip.
+*/
+void viewManager::Visualizer::platform::pushClip(const int x, const int y,
+                                                 const int w, const int h) {
+  m_clipStack.push_back({m_clipX1, m_clipY1, m_clipX2, m_clipY2});
+
+  m_clipX1 = std::max(m_clipX1, x);
+  m_clipY1 = std::max(m_clipY1, y);
+  m_clipX2 = std::max(m_clipX1, std::min(m_clipX2, x + w));
+  m_clipY2 = std::max(m_clipY1, std::min(m_clipY2, y + h));
+}
 
-  // get the height of the font
-  int faceHeight = face->size->metrics.height >> 6;
-  int baseline=face->size->metrics.ascender>>6;
+/**
+\internal
+\brief restores the clip rectangle kept by the last pushClip. Without one,
+the clip becomes the whole buffer.
+*/
+void viewManager::Visualizer::platform::popClip(void) {
+  if (m_clipStack.empty()) {
+    resetClip();
+    return;
+  }
 
-  /**
-  \brief use greyscale or color lcd filtering
-\details
-      There are two distinct types of bimap structures that are in use, grey
-      scale or lcd filtered. The buffer format is unique for each, the grey
-  lite one being a value indicating grey luminence while the lcd filter is a
-  rgb one. These values provide the same functionality for the looping and
-      drawing routine. You will notice that within each block of code, after
-      getting the image, these values are set.
-  */
-  int storageSize, pitch, top, left, height, width, xadvance;
-  unsigned char *buffer;
+  const std::array<int, 4> &clip = m_clipStack.back();
+  m_clipX1 = clip[0];
+  m_clipY1 = clip[1];
+  m_clipX2 = clip[2];
+  m_clipY2 = clip[3];
+  m_clipStack.pop_back();
+}
 
-#ifdef USE_GREYSCALE_ANTIALIAS
-  // get the image
-  FTC_SBit bitmap;
-  error = FTC_SBitCache_LookupScaler(m_bitCache, pscaler, FT_LOAD_RENDER,
-                                     glyph_index, &bitmap, nullptr);
+/**
+\internal
+\brief fills the pixels x1 up to x2 of row y. The span is clipped.
+*/
+void viewManager::Visualizer::platform::fillSpan(const int x1, const int x2,
+                                                 const int y,
+                                                 const unsigned int color) {
+  if (y < m_clipY1 || y >= m_clipY2)
+    return;
 
-  if (error)
-    return 0;
+  int xBegin = std::max(x1, m_clipX1);
+  int xEnd = std::min(x2, m_clipX2);
+  if (xBegin >= xEnd)
+    return;
 
-  // set the rendering values used for for grey
-  storageSize = 1;
-  pitch = bitmap->pitch;
-  top = bitmap->top;
-  left = bitmap->left;
-  height = bitmap->height;
-  width = bitmap->width;
-  buffer = bitmap->buffer;
-  xadvance = bitmap->xadvance;
+  switch (m_format) {
+  case pixelFormat::xrgb8888:
+    fillSpanKernel<pixelFormat::xrgb8888>(xBegin, xEnd, y, color);
+    break;
+  case pixelFormat::rgb565:
+    fillSpanKernel<pixelFormat::rgb565>(xBegin, xEnd, y, color);
+    break;
+  case pixelFormat::gray8:
+    fillSpanKernel<pixelFormat::gray8>(xBegin, xEnd, y, color);
+    break;
+  }
+}
 
-#elif defined USE_LCD_FILTER
-  FT_Glyph aglyph;
-  FT_BitmapGlyph bitmap;
+/**
+\internal
+\brief returns the first pixel of row y of the offscreen buffer.
+*/
+template <viewManager::pixelFormat::optionEnum F>
+typename viewManager::Visualizer::pixelTraits<F>::pixel *
+viewManager::Visualizer::platform::pixelRow(const int y) {
+  typedef typename pixelTraits<F>::pixel pixel;
+  return reinterpret_cast<pixel *>(
+      &m_offscreenBuffer[static_cast<std::size_t>(y) * _w * sizeof(pixel)]);
+}
 
-  // get the image, however this is just the outline
-  error = FTC_ImageCache_LookupScaler(m_imageCache, pscaler, FT_LOAD_DEFAULT,
-                                      glyph_index, &aglyph, nullptr);
-  if (error)
-    return 0;
+/**
+\internal
+\brief fills a span of a row that is within the clip rectangle.
+*/
+template <viewManager::pixelFormat::optionEnum F>
+void viewManager::Visualizer::platform::fillSpanKernel(
+    const int xBegin, const int xEnd, const int y, const unsigned int color) {
+  auto p = pixelRow<F>(y);
+  auto value = pixelTraits<F>::encode(color);
+  int i = xBegin;
+
+#if defined(USE_SSE2)
+  if constexpr (F == pixelFormat::xrgb8888) {
+    const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+    for (; i + 4 <= xEnd; i += 4)
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(p + i), v);
+  }
+#endif
 
-  xadvance = (aglyph->advance.x + 0x8000) >> 16;
+  std::fill(p + i, p + xEnd, value);
+}
 
-  // this converts the outline image to a rgb bitmap
-  error = FT_Glyph_To_Bitmap(&aglyph, FT_RENDER_MODE_LCD, 0, 0);
-  bitmap = reinterpret_cast<FT_BitmapGlyph>(aglyph);
+/**
+\internal
+\brief blends the color over a pixel within the clip rectangle.
+*/
+template <viewManager::pixelFormat::optionEnum F>
+void viewManager::Visualizer::platform::blendKernel(
+    const int x, const int y, const unsigned int color,
+    const unsigned int coverage) {
+  auto p = pixelRow<F>(y) + x;
+  auto source = pixelTraits<F>::encode(color);
+  *p = coverage >= 256 ? source : pixelTraits<F>::blend(*p, source, coverage);
+}
 
-  // set the rendering values used for for grey
-  storageSize = 3;
-  pitch = bitmap->bitmap.pitch;
-  top = bitmap->top;
-  left = bitmap->left;
-  height = bitmap->bitmap.rows;
-  width = bitmap->bitmap.width;
-  buffer = bitmap->bitmap.buffer;
+/**
+\internal
+\brief copies the visible part of an image. The offscreen buffer in the
+format of the image is copied by rows.
+*/
+template <viewManager::pixelFormat::optionEnum F>
+void viewManager::Visualizer::platform::blitKernel(
+    const imageSurface &image, const int x, const int y, const int xBegin,
+    const int xEnd, const int yBegin, const int yEnd) {
+  for (int j = yBegin; j < yEnd; j++) {
+    auto p = pixelRow<F>(y + j) + x;
+    const uint32_t *source = image.row(j);
+    if constexpr (F == pixelFormat::xrgb8888)
+      std::memcpy(p + xBegin, source + xBegin,
+                  static_cast<std::size_t>(xEnd - xBegin) * 4);
+    else
+      for (int i = xBegin; i < xEnd; i++)
+        p[i] = pixelTraits<F>::encode(source[i]);
+  }
+}
 
-#endif
+/**
+\internal
+\brief blends a glyph bitmap whose top left is x1, y1 over the offscreen
+buffer. The bitmap is one byte of coverage for each pixel, or three for
+the lcd filter where red, green and blue are covered separately.
+*/
+template <viewManager::pixelFormat::optionEnum F>
+void viewManager::Visualizer::platform::glyphKernel(
+    const unsigned char *buffer, const int pitch, const int storageSize,
+    const int x1, const int y1, const int x2, const int y2,
+    const unsigned int color) {
+  typedef pixelTraits<F> traits;
+  const auto source = traits::encode(color);
+
+  const int iBegin = std::max(x1, m_clipX1);
+  const int iEnd = std::min(x2, m_clipX2);
+  const int jBegin = std::max(y1, m_clipY1);
+  const int jEnd = std::min(y2, m_clipY2);
+
+  for (int j = jBegin; j < jEnd; j++) {
+    const unsigned char *coverage = buffer + (j - y1) * pitch;
+    auto p = pixelRow<F>(j);
+
+    for (int i = iBegin; i < iEnd; i++) {
+      const unsigned char *c = coverage + (i - x1) * storageSize;
+
+      if (storageSize == 1) {
+        if (*c)
+          p[i] = traits::blend(p[i], source, *c + (*c >> 7));
+        continue;
+      }
 
-  x = xPos;
-  y = yPos +  baseline - top;
+      if (!(c[0] | c[1] | c[2]))
+        continue;
 
-  // calculate the maximum bounds
-  int xmax = x + width / storageSize + left;
-  int ymax = yPos + (baseline-top) + height;
+      uint32_t destination = traits::decode(p[i]);
+      uint32_t target = 0;
+      for (int channel = 0; channel < 3; channel++) {
+        int shift = 16 - channel * 8;
+        unsigned int a = c[channel] + (c[channel] >> 7);
+        target |= ((((color >> shift) & 0xFF) * a +
+                    ((destination >> shift) & 0xFF) * (256 - a)) >>
+                   8)
+                  << shift;
+      }
+      p[i] = traits::encode(target);
+    }
+  }
+}
 
-  // if the maximum bounds are greater than the clipping region, adjust.
-  if (xmax > xPos2)
-    xmax = xPos2;
-  if (ymax > yPos2)
-    ymax = yPos2;
+/**
+\internal
+\brief converts the offscreen buffer to xrgb8888 within m_pixels32.
+*/
+template <viewManager::pixelFormat::optionEnum F>
+void viewManager::Visualizer::platform::convertKernel(void) {
+  std::size_t count = static_cast<std::size_t>(_w) * _h;
+  m_pixels32.resize(count * 4);
+  auto p = pixelRow<F>(0);
+  uint32_t *out = reinterpret_cast<uint32_t *>(m_pixels32.data());
+  for (std::size_t i = 0; i < count; i++)
+    out[i] = pixelTraits<F>::decode(p[i]);
+}
 
-  // loop through the pixels
-  for (int i = x + left, p = 0; i < xmax; i++, p += storageSize) {
-    for (int j = y, q = 0; j < ymax; j++, q++) {
-      int bufferPosition = q * pitch + p;
+/**
+\brief selects the format of the offscreen buffer. It is selected before
+the window or offscreen buffer is opened.
+*/
+void viewManager::Visualizer::platform::setPixelFormat(
+    const pixelFormat::optionEnum format) {
+  m_format = format;
+}
 
-      /* only plot active pixels, the term
-       luminance is used because it is not actually a color
-       but a brightness of the pixel. Zero being off for the
-       glyph bitmap. */
-      if (buffer[bufferPosition]) {
+/**
+\brief returns the size of a pixel of the offscreen buffer.
+*/
+unsigned int viewManager::Visualizer::platform::bytesPerPixel(void) const {
+  switch (m_format) {
+  case pixelFormat::rgb565:
+    return 2;
+  case pixelFormat::gray8:
+    return 1;
+  default:
+    return 4;
+  }
+}
 
-        unsigned int destinationC = getPixel(i, j);
+/**
+\brief returns the offscreen buffer as xrgb8888, the format of the window,
+the frame server and saved images. Other formats are converted.
+*/
+const std::vector<u_int8_t> &viewManager::Visualizer::platform::pixels32(void) {
+  switch (m_format) {
+  case pixelFormat::rgb565:
+    convertKernel<pixelFormat::rgb565>();
+    return m_pixels32;
+  case pixelFormat::gray8:
+    convertKernel<pixelFormat::gray8>();
+    return m_pixels32;
+  default:
+    return m_offscreenBuffer;
+  }
+}
 
-        unsigned char destinationR = destinationC >> 16;
-        unsigned char destinationG = destinationC >> 8;
-        unsigned char destinationB = destinationC;
+/**
+\internal
+\brief returns the bytes of the pixel buffers that trimSurfaces can free,
+the xrgb8888 copy of other formats and the offscreen buffer beyond the
+current size.
+*/
+std::size_t viewManager::Visualizer::platform::surfaceBytes(void) const {
+  std::size_t used = static_cast<std::size_t>(_w) * _h * bytesPerPixel();
+  std::size_t spare =
+      m_offscreenBuffer.capacity() > used ? m_offscreenBuffer.capacity() - used
+                                          : 0;
+  return m_pixels32.capacity() + spare;
+}
 
-#ifdef USE_GREYSCALE_ANTIALIAS
-        // luminance is expressed in greyscal using one byte
-        unsigned char freetypeColor = buffer[bufferPosition];
-        unsigned char freetypeR = freetypeColor;
-        unsigned char freetypeG = freetypeColor;
-        unsigned char freetypeB = freetypeColor;
+/**
+\internal
+\brief frees the xrgb8888 copy, which the next flip makes again, and
+shrinks the offscreen buffer to the window. Returns the bytes freed.
+*/
+std::size_t viewManager::Visualizer::platform::trimSurfaces(void) {
+  std::size_t freed = surfaceBytes();
 
-#elif defined USE_LCD_FILTER
-        // luminance is expressed within the LCD format as three bytes.
-        unsigned char freetypeR = buffer[bufferPosition];
-        unsigned char freetypeG = buffer[bufferPosition + 1];
-        unsigned char freetypeB = buffer[bufferPosition + 2];
-#endif
+  std::vector<u_int8_t>().swap(m_pixels32);
 
-       /*
-      The following code was adopted from an article that needs more research to find. The implementation of the shifting to divide or otherwise 
-      blend two pixels together based upon a lumenence value. I adopted the format and added the values locally. Orginally, my formula was longer.
-
-      Here are some references on pixel blending in the mean time:
-         https://gamedev.stackexchange.com/questions/115721/c-additive-blending-algorithm-2d-game
-         
-
-       */
-        unsigned char targetR =
-            ((foregroundR * freetypeR) + (destinationR * (255 - freetypeR))) >>
-            8;
-        unsigned char targetG =
-            ((foregroundG * freetypeG) + (destinationG * (255 - freetypeG))) >>
-            8;
-        unsigned char targetB =
-            ((foregroundB * freetypeB) + (destinationB * (255 - freetypeB))) >>
-            8;
-
-        color = ((targetR) << 16) | ((targetG) << 8) | (targetB);
-
-        // place the computed color into pixel buffer
-        putPixel(i, j, color);
-      }
-    }
+  std::size_t used = static_cast<std::size_t>(_w) * _h * bytesPerPixel();
+  if (m_offscreenBuffer.capacity() > used) {
+    m_offscreenBuffer.resize(used);
+    m_offscreenBuffer.shrink_to_fit();
   }
 
-#ifdef USE_LCD_FILTER
-  // delete the bitmap data
-  FT_Done_Glyph((FT_Glyph)bitmap);
+  return freed;
+}
 
+/**
+\internal
+\brief returns the bytes the glyph cache is counted as. FreeType keeps up
+to GLYPH_CACHE_BYTES once text is measured or drawn.
+*/
+std::size_t viewManager::Visualizer::platform::glyphBytes(void) const {
+#ifdef USE_INLINE_RENDERER
+  return m_bGlyphsCached ? GLYPH_CACHE_BYTES : 0;
+#else
+  return 0;
 #endif
-
-  return xadvance;
 }
 
 /**
-\brief The routine returns that face ID for the cached font. This is a
-pointer to the record within the vector.
+\internal
+\brief empties the FreeType cache of faces, sizes and glyphs. The faces
+are created again from the font files already read. Returns the bytes
+freed.
 */
-FTC_FaceID viewManager::Visualizer::platform::getFaceID(string sTextFace) {
-  FTC_FaceID faceID = nullptr;
+std::size_t viewManager::Visualizer::platform::trimGlyphs(void) {
+  std::size_t freed = glyphBytes();
+#ifdef USE_INLINE_RENDERER
+  if (m_cacheManager)
+    FTC_Manager_Reset(m_cacheManager);
+  m_bGlyphsCached = false;
+#endif
+  return freed;
+}
 
-  auto it = m_faceCache.find(sTextFace);
-  if (it != m_faceCache.end()) {
-    faceID = static_cast<FTC_FaceID>(&it->second);
-  } else {
-    string sFullFontPath = getFontFilename(sTextFace);
-    faceCacheStruct faceCacheRecord{sFullFontPath,
-                                    static_cast<int>(m_faceCache.size())};
-    pair<faceCacheIterator, bool> result =
-        m_faceCache.insert({sTextFace, faceCacheRecord});
-    // A potential bug may exist when items are added while the faceID is
-    // waiting to be used.
-    if (result.second)
-      faceID = static_cast<FTC_FaceID>(&(result.first->second));
+/**
+\internal
+\brief blends a glyph bitmap using the kernel of the pixel format.
+*/
+void viewManager::Visualizer::platform::blendGlyph(
+    const unsigned char *buffer, const int pitch, const int storageSize,
+    const int x1, const int y1, const int x2, const int y2,
+    const unsigned int color) {
+  switch (m_format) {
+  case pixelFormat::xrgb8888:
+    glyphKernel<pixelFormat::xrgb8888>(buffer, pitch, storageSize, x1, y1, x2,
+                                       y2, color);
+    break;
+  case pixelFormat::rgb565:
+    glyphKernel<pixelFormat::rgb565>(buffer, pitch, storageSize, x1, y1, x2,
+                                     y2, color);
+    break;
+  case pixelFormat::gray8:
+    glyphKernel<pixelFormat::gray8>(buffer, pitch, storageSize, x1, y1, x2,
+                                    y2, color);
+    break;
   }
-  return faceID;
 }
 
 /**
 \internal
-\brief The function returns the width of the string according to the font
-size.
+\brief blends the color over the pixel. Coverage is 0 to 256, 256 being
+opaque.
 */
-double viewManager::Visualizer::platform::measureTextWidth(
-    const std::string &sTextFace, const int pointSize, const std::string &s) {
-  bool bProcessedOnce = false;
-  FT_Error error;
-  FTC_ScalerRec scaler;
-  FT_Size sizeFace;
-  FT_UInt glyph_index = 0;
-  FT_UInt previous_index = 0;
-  double ret = 0;
+void viewManager::Visualizer::platform::blendPixel(
+    const int x, const int y, const unsigned int color,
+    const unsigned int coverage) {
+  if (x < m_clipX1 || y < m_clipY1 || x >= m_clipX2 || y >= m_clipY2 ||
+      coverage == 0)
+    return;
 
-  // store a cache record for loaded fonts.
-  FTC_FaceID faceID = getFaceID(sTextFace);
+  switch (m_format) {
+  case pixelFormat::xrgb8888:
+    blendKernel<pixelFormat::xrgb8888>(x, y, color, coverage);
+    break;
+  case pixelFormat::rgb565:
+    blendKernel<pixelFormat::rgb565>(x, y, color, coverage);
+    break;
+  case pixelFormat::gray8:
+    blendKernel<pixelFormat::gray8>(x, y, color, coverage);
+    break;
+  }
+}
 
-  // having this as a local variable
-  scaler.face_id = faceID;
-  scaler.pixel = 0;
-  scaler.height = (pointSize + fontScale) * 64;
-  scaler.width = (pointSize + fontScale) * 64;
+/**
+\internal
+\brief draws a one pixel line. The line is clipped to the clip rectangle
+before it is stepped so long lines that leave the buffer cost little.
+Horizontal and vertical lines are filled as rectangles, and the pixels of
+each row of other lines are filled as one span by the vectorized span fill.
+*/
+void viewManager::Visualizer::platform::drawLine(int x1, int y1, int x2,
+                                                 int y2,
+                                                 const unsigned int color) {
+  if (y1 == y2) {
+    fillSpan(std::min(x1, x2), std::max(x1, x2) + 1, y1, color);
+    return;
+  }
+  if (x1 == x2) {
+    fillRect(x1, std::min(y1, y2), 1, std::abs(y2 - y1) + 1, color);
+    return;
+  }
 
-  scaler.x_res = 96;
-  scaler.y_res = 96;
+  // Liang-Barsky clip of the segment against the clip rectangle
+  double t0 = 0, t1 = 1;
+  double dx = x2 - x1, dy = y2 - y1;
+  auto clipEdge = [&](double p, double q) {
+    if (p == 0)
+      return q >= 0;
+    double r = q / p;
+    if (p < 0) {
+      if (r > t1)
+        return false;
+      t0 = std::max(t0, r);
+    } else {
+      if (r < t0)
+        return false;
+      t1 = std::min(t1, r);
+    }
+    return true;
+  };
 
-  // get the face
-  error = FTC_Manager_LookupSize(m_cacheManager, &scaler, &sizeFace);
+  if (!clipEdge(-dx, x1 - m_clipX1) || !clipEdge(dx, m_clipX2 - 1 - x1) ||
+      !clipEdge(-dy, y1 - m_clipY1) || !clipEdge(dy, m_clipY2 - 1 - y1))
+    return;
 
-  if (error)
-    throw std::runtime_error("Could not retrieve font face.");
+  int xa = static_cast<int>(std::lround(x1 + t0 * dx));
+  int ya = static_cast<int>(std::lround(y1 + t0 * dy));
+  int xb = static_cast<int>(std::lround(x1 + t1 * dx));
+  int yb = static_cast<int>(std::lround(y1 + t1 * dy));
+
+  // Bresenham
+  int sx = xa < xb ? 1 : -1;
+  int sy = ya < yb ? 1 : -1;
+  int ex = std::abs(xb - xa);
+  int ey = -std::abs(yb - ya);
+  int err = ex + ey;
+
+  // the run of the row begins at runX and ends where the row is left.
+  int runX = xa;
+  while (true) {
+    if (xa == xb && ya == yb) {
+      fillSpan(std::min(runX, xa), std::max(runX, xa) + 1, ya, color);
+      break;
+    }
+    int e2 = 2 * err;
+    bool bStepY = e2 <= ex;
+    if (bStepY)
+      fillSpan(std::min(runX, xa), std::max(runX, xa) + 1, ya, color);
+    if (e2 >= ey) {
+      err += ey;
+      xa += sx;
+    }
+    if (bStepY) {
+      err += ex;
+      ya += sy;
+      runX = xa;
+    }
+  }
+}
 
-  error = FT_Activate_Size(sizeFace);
-  if (error)
-    throw std::runtime_error("Could FT_Activate_Size for font.");
+/**
+\internal
+\brief draws lines joining the points. When closed, the last point is
+joined to the first.
+*/
+void viewManager::Visualizer::platform::drawPolyline(
+    const std::vector<std::pair<int, int>> &points, const unsigned int color,
+    const bool bClosed) {
+  if (points.size() < 2)
+    return;
 
-  FT_Face face = sizeFace->face;
+  for (std::size_t i = 1; i < points.size(); i++)
+    drawLine(points[i - 1].first, points[i - 1].second, points[i].first,
+             points[i].second, color);
 
-  // iterate characters in string
-  for (auto &c : s) {
+  if (bClosed)
+    drawLine(points.back().first, points.back().second,
+             points.front().first, points.front().second, color);
+}
 
-    // handle special characters
-    if (c == '\t') {
-      m_xpos += 50;
-      continue;
-    }
+/**
+\internal
+\brief fills a rectangle.
+*/
+void viewManager::Visualizer::platform::fillRect(const int x, const int y,
+                                                 const int w, const int h,
+                                                 const unsigned int color) {
+  int yEnd = std::min(y + h, m_clipY2);
+  for (int j = std::max(y, m_clipY1); j < yEnd; j++)
+    fillSpan(x, x + w, j, color);
+}
 
-    FT_UInt glyph_index = 0;
+/**
+\internal
+\brief outlines a rectangle. The border is drawn inside the rectangle.
+*/
+void viewManager::Visualizer::platform::strokeRect(const int x, const int y,
+                                                   const int w, const int h,
+                                                   const unsigned int color,
+                                                   const int thickness) {
+  if (w <= 0 || h <= 0 || thickness <= 0)
+    return;
 
-    // get the index of the glyph
-    glyph_index = FTC_CMapCache_Lookup(m_cmapCache, faceID, 0, c);
+  if (thickness * 2 >= w || thickness * 2 >= h) {
+    fillRect(x, y, w, h, color);
+    return;
+  }
 
-    // the kerning of a font depends on the previous character
-    // some proportional fonts provide tighter spacing which improves
-    // rendering characteristics
-    if (FT_HAS_KERNING(face) && bProcessedOnce) {
-      FT_Vector akerning;
-      error = FT_Get_Kerning(face, previous_index, glyph_index,
-                             FT_KERNING_DEFAULT, &akerning);
-      if (!error) {
-        m_xpos += akerning.x >> 6;
-      }
-    }
+  fillRect(x, y, w, thickness, color);
+  fillRect(x, y + h - thickness, w, thickness, color);
+  fillRect(x, y + thickness, thickness, h - thickness * 2, color);
+  fillRect(x + w - thickness, y + thickness, thickness, h - thickness * 2,
+           color);
+}
 
-    // render the character
-    /**
-    \brief use greyscale or color lcd filtering
-  \details
-        There are two distinct types of bimap structures that are in use,
-  grey scale or lcd filtered. The buffer format is unique for each, the grey
-    lite one being a value indicating grey luminence while the lcd filter is
-  a rgb one. These values provide the same functionality for the looping and
-        drawing routine. You will notice that within each block of code,
-  after getting the image, these values are set.
-    */
-    int xadvance;
+/**
+\internal
+\brief fills an anti-aliased circle. Within each row, the pixels wholly
+inside the circle are filled as a span and only the edge pixels are
+blended.
+*/
+void viewManager::Visualizer::platform::fillCircle(const double cx,
+                                                   const double cy,
+                                                   const double radius,
+                                                   const unsigned int color) {
+  if (radius <= 0)
+    return;
 
-#ifdef USE_GREYSCALE_ANTIALIAS
-    // get the image
-    FTC_SBit bitmap;
-    error = FTC_SBitCache_LookupScaler(m_bitCache, &scaler, FT_LOAD_RENDER,
-                                       glyph_index, &bitmap, nullptr);
+  double outer = radius + 0.5;
+  double inner = radius - 0.5;
+  int yBegin = std::max(static_cast<int>(std::floor(cy - outer)), m_clipY1);
+  int yEnd = std::min(static_cast<int>(std::ceil(cy + outer)), m_clipY2);
 
-    if (error)
+  for (int j = yBegin; j < yEnd; j++) {
+    double dy = j + 0.5 - cy;
+    double outerSq = outer * outer - dy * dy;
+    if (outerSq <= 0)
       continue;
 
-    xadvance = bitmap->xadvance;
-
-#elif defined USE_LCD_FILTER
-    FT_Glyph aglyph;
-    FT_BitmapGlyph bitmap;
+    double outerHalf = std::sqrt(outerSq);
+    int xBegin = static_cast<int>(std::floor(cx - outerHalf));
+    int xEnd = static_cast<int>(std::ceil(cx + outerHalf));
+
+    // pixel centers within this half width are at most inner from the
+    // center, so they are fully covered.
+    int spanBegin = xEnd, spanEnd = xEnd;
+    double innerSq = inner * inner - dy * dy;
+    if (inner > 0 && innerSq > 0) {
+      double innerHalf = std::sqrt(innerSq);
+      spanBegin = static_cast<int>(std::ceil(cx - innerHalf - 0.5));
+      spanEnd = static_cast<int>(std::floor(cx + innerHalf - 0.5)) + 1;
+      fillSpan(spanBegin, spanEnd, j, color);
+    }
 
-    // get the image, however this is just the outline
-    error = FTC_ImageCache_LookupScaler(m_imageCache, &scaler, FT_LOAD_DEFAULT,
-                                        glyph_index, &aglyph, nullptr);
-    if (error)
-      continue;
+    for (int i = xBegin; i < xEnd; i++) {
+      if (i == spanBegin && spanEnd > spanBegin) {
+        i = spanEnd - 1;
+        continue;
+      }
+      double dx = i + 0.5 - cx;
+      double coverage = outer - std::sqrt(dx * dx + dy * dy);
+      if (coverage > 0)
+        blendPixel(i, j, color,
+                   static_cast<unsigned int>(std::min(coverage, 1.0) * 256));
+    }
+  }
+}
 
-    xadvance = (aglyph->advance.x + 0x8000) >> 16;
+/**
+\internal
+\brief outlines an anti-aliased circle. The stroke is centered on the
+radius.
+*/
+void viewManager::Visualizer::platform::strokeCircle(const double cx,
+                                                     const double cy,
+                                                     const double radius,
+                                                     const unsigned int color,
+                                                     const double thickness) {
+  drawRing(cx, cy, radius, thickness, 0, 2 * M_PI, color);
+}
 
-#endif
+/**
+\internal
+\brief draws an anti-aliased arc. Angles are in radians, measured
+clockwise from the positive x axis as y increases downward. The arc runs
+from startAngle to endAngle.
+*/
+void viewManager::Visualizer::platform::drawArc(
+    const double cx, const double cy, const double radius,
+    const double startAngle, const double endAngle, const unsigned int color,
+    const double thickness) {
+  double sweep = endAngle - startAngle;
+  if (sweep == 0)
+    return;
 
-    // move after render
-    ret += xadvance;
-    bProcessedOnce = true;
-    previous_index = glyph_index;
+  double start = startAngle;
+  if (sweep < 0) {
+    start = endAngle;
+    sweep = -sweep;
   }
-  return ret;
+
+  drawRing(cx, cy, radius, thickness, start, sweep, color);
 }
 
 /**
 \internal
-\brief the function measures the height of the textFace
-\param const std::string &sTextFace the face name
-\param const int pointSize the size in point of the font
-
+\brief gives the pixels of a row whose centers lie between the radii lo
+and hi from cx, where dy is the distance of the row from the center. The
+spans left and right of the center are stored as begin and end pairs, and
+joined when they meet. The return is the number of spans.
 */
-double viewManager::Visualizer::platform::measureFaceHeight(
-    const std::string &sTextFace, const int pointSize) {
-  FT_Error error;
-  FTC_ScalerRec scaler;
-  FT_Size sizeFace;
+static int ringRowSpans(const double cx, const double dy, const double lo,
+                        const double hi, int spans[4]) {
+  double hiSq = hi * hi - dy * dy;
+  if (hi <= 0 || hiSq <= 0)
+    return 0;
 
-  // store a cache record for loaded fonts.
-  FTC_FaceID faceID = getFaceID(sTextFace);
+  double hiHalf = std::sqrt(hiSq);
+  double loSq = lo * lo - dy * dy;
+  double loHalf = lo > 0 && loSq > 0 ? std::sqrt(loSq) : 0;
+
+  spans[0] = static_cast<int>(std::ceil(cx - hiHalf - 0.5));
+  spans[1] = static_cast<int>(std::floor(cx - loHalf - 0.5)) + 1;
+  spans[2] = static_cast<int>(std::ceil(cx + loHalf - 0.5));
+  spans[3] = static_cast<int>(std::floor(cx + hiHalf - 0.5)) + 1;
+  if (spans[1] >= spans[2]) {
+    spans[1] = spans[3];
+    return spans[0] < spans[1] ? 1 : 0;
+  }
 
-  // having this as a local variable
-  scaler.face_id = faceID;
-  scaler.pixel = 0;
-  scaler.height = (pointSize + fontScale) * 64;
-  scaler.width = (pointSize + fontScale) * 64;
+  int count = 0;
+  for (int s = 0; s < 2; s++)
+    if (spans[s * 2] < spans[s * 2 + 1]) {
+      spans[count * 2] = spans[s * 2];
+      spans[count * 2 + 1] = spans[s * 2 + 1];
+      count++;
+    }
+  return count;
+}
 
-  scaler.x_res = 96;
-  scaler.y_res = 96;
+/**
+\internal
+\brief rasterizes the portion of a ring within the sweep. Coverage is
+taken from the distance of each pixel center to the center line of the
+ring. Each row visits only the spans of the annulus, and for a whole ring
+the pixels wholly covered are filled as spans. The sweep is tested with
+the cross products of the pixel offset and the directions of its ends.
+*/
+void viewManager::Visualizer::platform::drawRing(
+    const double cx, const double cy, const double radius,
+    const double thickness, const double startAngle, const double sweep,
+    const unsigned int color) {
+  if (radius <= 0 || thickness <= 0)
+    return;
 
-  // get the face
-  error = FTC_Manager_LookupSize(m_cacheManager, &scaler, &sizeFace);
+  bool bFull = sweep >= 2 * M_PI;
+  double startX = std::cos(startAngle), startY = std::sin(startAngle);
+  double endX = std::cos(startAngle + sweep);
+  double endY = std::sin(startAngle + sweep);
+  // a sweep beyond a half turn holds the points after the start or before
+  // the end, a smaller one those after the start and before the end.
+  bool bLarge = sweep > M_PI;
+
+  double halfWidth = thickness / 2 + 0.5;
+  double outer = radius + halfWidth;
+  double inner = radius - halfWidth;
+  bool bSolid = bFull && halfWidth > 1;
+  int yBegin = std::max(static_cast<int>(std::floor(cy - outer)), m_clipY1);
+  int yEnd = std::min(static_cast<int>(std::ceil(cy + outer)), m_clipY2);
+
+  for (int j = yBegin; j < yEnd; j++) {
+    double dy = j + 0.5 - cy;
+    int covered[4], solid[4];
+    int coveredCount = ringRowSpans(cx, dy, inner, outer, covered);
+    int solidCount = bSolid ? ringRowSpans(cx, dy, inner + 1, outer - 1,
+                                           solid)
+                            : 0;
+    for (int s = 0; s < solidCount; s++)
+      fillSpan(solid[s * 2], solid[s * 2 + 1], j, color);
+
+    for (int s = 0; s < coveredCount; s++) {
+      int xEnd = std::min(covered[s * 2 + 1], m_clipX2);
+      for (int i = std::max(covered[s * 2], m_clipX1); i < xEnd; i++) {
+        int t = 0;
+        while (t < solidCount && (i < solid[t * 2] || i >= solid[t * 2 + 1]))
+          t++;
+        if (t < solidCount) {
+          i = solid[t * 2 + 1] - 1;
+          continue;
+        }
 
-  if (error)
-    throw std::runtime_error("Could not retrieve font face.");
+        double dx = i + 0.5 - cx;
+        double coverage =
+            halfWidth - std::abs(std::sqrt(dx * dx + dy * dy) - radius);
+        if (coverage <= 0)
+          continue;
 
-  error = FT_Activate_Size(sizeFace);
-  if (error)
-    throw std::runtime_error("Could FT_Activate_Size for font.");
+        if (!bFull) {
+          bool bAfterStart = startX * dy - startY * dx >= 0;
+          bool bBeforeEnd = endX * dy - endY * dx <= 0;
+          if (bLarge ? !(bAfterStart || bBeforeEnd)
+                     : !(bAfterStart && bBeforeEnd))
+            continue;
+        }
 
-  FT_Face face = sizeFace->face;
+        blendPixel(i, j, color,
+                   static_cast<unsigned int>(std::min(coverage, 1.0) * 256));
+      }
+    }
+  }
+}
 
-  // get the height of the font
-  int faceHeight = face->size->metrics.height >> 6;
-  return static_cast<double>(faceHeight);
+/**
+\internal
+\brief copies an image to the offscreen buffer without scaling.
+*/
+void viewManager::Visualizer::platform::blit(const imageSurface &image,
+                                             const int x, const int y) {
+  int w = static_cast<int>(image.width());
+  int h = static_cast<int>(image.height());
+
+  int xBegin = std::max(m_clipX1 - x, 0);
+  int xEnd = std::min(m_clipX2 - x, w);
+  int yBegin = std::max(m_clipY1 - y, 0);
+  int yEnd = std::min(m_clipY2 - y, h);
+  if (xBegin >= xEnd || yBegin >= yEnd)
+    return;
+
+  switch (m_format) {
+  case pixelFormat::xrgb8888:
+    blitKernel<pixelFormat::xrgb8888>(image, x, y, xBegin, xEnd, yBegin, yEnd);
+    break;
+  case pixelFormat::rgb565:
+    blitKernel<pixelFormat::rgb565>(image, x, y, xBegin, xEnd, yBegin, yEnd);
+    break;
+  case pixelFormat::gray8:
+    blitKernel<pixelFormat::gray8>(image, x, y, xBegin, xEnd, yBegin, yEnd);
+    break;
+  }
 }
 
 /**
-  \internal
-  \brief the function draws the cursor.
-  */
-void viewManager::Visualizer::platform::drawCaret(const int x, const int y,
-                                                  const int h) {
-  for (int j = y; j < y + h; j++)
-    putPixel(x, j, 0x00);
+\internal
+\brief draws a single line of text with its top left at x, y. The text
+is not wrapped. The return is the width of the run so that callers may
+continue drawing after it.
+*/
+double viewManager::Visualizer::platform::drawTextRun(
+    const std::string &sTextFace, const int pointSize,
+    const std::string_view &s, const unsigned int color, const int x,
+    const int y) {
+  double dWidth = measureTextWidth(sTextFace, pointSize, s);
+  int xEnd = x + static_cast<int>(std::ceil(dWidth)) + 1;
+  int yEnd = y + static_cast<int>(measureFaceHeight(sTextFace, pointSize));
+
+  if (x < m_clipX2 && y < m_clipY2 && xEnd > m_clipX1 && yEnd > m_clipY1)
+    drawText(sTextFace, pointSize, s, color, x, y, xEnd, yEnd,
+             textAlignment(textAlignment::left));
+
+  return dWidth;
 }
 
 /**
@@ -4628,20 +11014,24 @@ void viewManager::Visualizer::platform::clear(void) {
 */
 void viewManager::Visualizer::platform::putPixel(const int x, const int y,
                                                  const unsigned int color) {
-  if (x < 0 || y < 0)
-    return;
-
   // clip coordinates
-  if (x >= _w || y >= _h)
+  if (x < m_clipX1 || y < m_clipY1 || x >= m_clipX2 || y >= m_clipY2)
     return;
 
-  // calculate offset
-  unsigned int offset = x * 4 + y * 4 * _w;
-
-  // put rgba color
-  unsigned int *p =
-      reinterpret_cast<unsigned int *>(&m_offscreenBuffer[offset]);
-  *p = color;
+  switch (m_format) {
+  case pixelFormat::xrgb8888:
+    pixelRow<pixelFormat::xrgb8888>(y)[x] =
+        pixelTraits<pixelFormat::xrgb8888>::encode(color);
+    break;
+  case pixelFormat::rgb565:
+    pixelRow<pixelFormat::rgb565>(y)[x] =
+        pixelTraits<pixelFormat::rgb565>::encode(color);
+    break;
+  case pixelFormat::gray8:
+    pixelRow<pixelFormat::gray8>(y)[x] =
+        pixelTraits<pixelFormat::gray8>::encode(color);
+    break;
+  }
 }
 
 /**
@@ -4659,13 +11049,16 @@ unsigned int viewManager::Visualizer::platform::getPixel(const int x,
   if (x >= _w || y >= _h)
     return 0;
 
-  // calculate offset
-  unsigned int offset = x * 4 + y * 4 * _w;
-
-  // put rgba color
-  unsigned int *p =
-      reinterpret_cast<unsigned int *>(&m_offscreenBuffer[offset]);
-  return *p;
+  switch (m_format) {
+  case pixelFormat::rgb565:
+    return pixelTraits<pixelFormat::rgb565>::decode(
+        pixelRow<pixelFormat::rgb565>(y)[x]);
+  case pixelFormat::gray8:
+    return pixelTraits<pixelFormat::gray8>::decode(
+        pixelRow<pixelFormat::gray8>(y)[x]);
+  default:
+    return pixelRow<pixelFormat::xrgb8888>(y)[x];
+  }
 }
 
 /**
@@ -4677,6 +11070,16 @@ void viewManager::Visualizer::platform::resize(const int w, const int h) {
   _w = w;
   _h = h;
 
+  // without a window the offscreen buffer is the image itself, so it is
+  // kept at exactly the requested size.
+  if (m_bHeadless) {
+    m_offscreenBuffer.assign(
+        static_cast<std::size_t>(_w) * _h * bytesPerPixel(), 0);
+    clear();
+    resetClip();
+    return;
+  }
+
 #if defined(__linux__)
 
   // free old one if it exists
@@ -4712,7 +11115,8 @@ void viewManager::Visualizer::platform::resize(const int w, const int h) {
   xcb_shm_create_pixmap(m_connection, m_pix, m_window, _w, _h,
                         m_screen->root_depth, m_info.shmseg, 0);
 
-  int _bufferSize = _w * _h * 4;
+  std::size_t _bufferSize =
+      static_cast<std::size_t>(_w) * _h * bytesPerPixel();
 
   if (m_offscreenBuffer.size() < _bufferSize)
     m_offscreenBuffer.resize(_bufferSize);
@@ -4729,7 +11133,8 @@ void viewManager::Visualizer::platform::resize(const int w, const int h) {
   _w = rc.right - rc.left;
   _h = rc.bottom - rc.top;
 
-  int _bufferSize = _w * _h * 4;
+  std::size_t _bufferSize =
+      static_cast<std::size_t>(_w) * _h * bytesPerPixel();
   if (m_offscreenBuffer.size() < _bufferSize)
     m_offscreenBuffer.resize(_bufferSize);
 
@@ -4751,19 +11156,180 @@ void viewManager::Visualizer::platform::resize(const int w, const int h) {
       return;
   }
 #endif
+
+  resetClip();
 }
 
 bool viewManager::Visualizer::platform::filled() { return m_ypos > _h; }
 
+/**
+\brief prepares the platform to render without a window. The pixels
+remain in the offscreen buffer where the caller reads them, and no display
+connection is required.
+*/
+void viewManager::Visualizer::platform::openOffscreen(void) {
+  m_bHeadless = true;
+  resize(_w, _h);
+}
+
+/**
+\brief shows the document upon a DRM card, a fbdev device or a file
+rather than a window, reading input from /dev/input. The name is given to
+framebufferOutput. The size and pixel format become those of the device,
+and a resize event is dispatched so the document is laid out for it.
+*/
+void viewManager::Visualizer::platform::openFramebuffer(
+    [[maybe_unused]] const std::string &sDevice) {
+#if defined(__linux__) && defined(USE_LINUX_FRAMEBUFFER)
+  m_framebuffer =
+      std::make_unique<framebufferOutput>(sDevice, _w, _h, m_format);
+  m_format = m_framebuffer->format();
+  m_bHeadless = true;
+
+  m_wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeEvent < 0)
+    throw std::runtime_error("The wake event could not be created.");
+
+  m_input = std::make_unique<evdevInput>(dispatchEvent,
+                                         m_framebuffer->width(),
+                                         m_framebuffer->height());
+  m_bWakeable = true;
+
+  // the handler of the viewer resizes the offscreen buffer.
+  dispatchEvent(event{eventType::resize,
+                      static_cast<short>(m_framebuffer->width()),
+                      static_cast<short>(m_framebuffer->height())});
+#else
+  throw std::runtime_error("The framebuffer is not available. Define "
+                           "USE_LINUX_FRAMEBUFFER to build it.");
+#endif
+}
+
+#if defined(__linux__) && defined(USE_LINUX_FRAMEBUFFER)
+/**
+\internal
+\brief the message loop of the framebuffer. The input devices and the wake
+event are polled together. A wake is a request for a frame.
+*/
+void viewManager::Visualizer::platform::framebufferLoop(void) {
+  std::vector<pollfd> fds;
+  fds.push_back(pollfd{m_wakeEvent, POLLIN, 0});
+  m_input->descriptors(fds);
+
+  dispatchEvent(event{eventType::paint});
+
+  while (true) {
+    int ready = poll(fds.data(), fds.size(), m_bIdleRequested ? 0 : -1);
+    if (ready < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (ready == 0) {
+      m_bIdleRequested = false;
+      dispatchEvent(event{eventType::idle});
+      continue;
+    }
+
+    for (std::size_t i = 1; i < fds.size(); i++)
+      if (fds[i].revents & POLLIN)
+        m_input->read(fds[i].fd);
+
+    if (fds[0].revents & POLLIN) {
+      uint64_t count;
+      ::read(m_wakeEvent, &count, sizeof(count));
+      dispatchEvent(event{eventType::wake});
+    }
+  }
+}
+#endif
+
+/**
+\brief starts sending each frame given to flip to the clients of a frame
+server. A server already started is replaced.
+*/
+void viewManager::Visualizer::platform::serveFrames(
+    const std::string &sAddress) {
+#if defined(__linux__)
+  m_frameServer.reset();
+  m_frameServer = std::make_unique<frameServer>(sAddress);
+#elif defined(_WIN64)
+  throw std::runtime_error("The frame server is not available upon this "
+                           "platform.");
+#endif
+}
+
+/**
+\brief starts publishing each frame given to flip into a shared memory
+ring of FRAME_EXPORT_SLOTS frames. The frames may be as large as the
+screen, or the window when larger. When the window is not yet open, the
+ring is created with the first frame.
+*/
+void viewManager::Visualizer::platform::exportFrames(const std::string &sName) {
+#if defined(__linux__)
+  m_frameExport.reset();
+  m_sFrameExport = sName;
+  if (_w && _h)
+    openFrameExport();
+#elif defined(_WIN64)
+  throw std::runtime_error("The frame export is not available upon this "
+                           "platform.");
+#endif
+}
+
+#if defined(__linux__)
+/**
+\internal
+\brief creates the shared memory ring named by exportFrames.
+*/
+void viewManager::Visualizer::platform::openFrameExport(void) {
+  unsigned short maxWidth = _w;
+  unsigned short maxHeight = _h;
+  if (m_screen) {
+    maxWidth = std::max(maxWidth, m_screen->width_in_pixels);
+    maxHeight = std::max(maxHeight, m_screen->height_in_pixels);
+  }
+
+  m_frameExport = std::make_unique<frameExport>(
+      m_sFrameExport, FRAME_EXPORT_SLOTS, maxWidth, maxHeight);
+}
+#endif
+
 /**
 \brief The function copies the pixel buffer to the screen
 
 */
 void viewManager::Visualizer::platform::flip() {
+#if defined(__linux__) && defined(USE_LINUX_FRAMEBUFFER)
+  // the offscreen buffer is already in the format of the device.
+  if (m_framebuffer) {
+    m_framebuffer->present(m_offscreenBuffer.data(), _w, _h);
+    if (!m_frameServer && m_sFrameExport.empty())
+      return;
+  }
+#endif
+
+  // formats other than xrgb8888 are converted once for all of the outputs.
+  const std::vector<u_int8_t> &pixels = pixels32();
+
+#if defined(__linux__)
+  if (m_frameServer)
+    m_frameServer->submit(pixels, _w, _h);
+  if (!m_sFrameExport.empty()) {
+    if (!m_frameExport)
+      openFrameExport();
+    m_frameExport->publish(pixels, _w, _h);
+  }
+#endif
+
+  if (m_bHeadless)
+    return;
+
 #if defined(__linux__)
   // copy offscreen data to the shared memory video buffer
-  memcpy(m_screenMemoryBuffer, m_offscreenBuffer.data(),
-         m_offscreenBuffer.size());
+  memcpy(m_screenMemoryBuffer, pixels.data(),
+         static_cast<std::size_t>(_w) * _h * 4);
 
   // blit the shared memory buffer
   xcb_copy_area(m_connection, m_pix, m_window, m_graphics, 0, 0, 0, 0, _w, _h);
@@ -4790,7 +11356,7 @@ void viewManager::Visualizer::platform::flip() {
 
   D2D1_SIZE_U size = D2D1::SizeU(_w, _h);
   HRESULT hr = m_pRenderTarget->CreateBitmap(
-      size, m_offscreenBuffer.data(), _w * 4, &bmpProperties, &m_pBitmap);
+      size, pixels.data(), _w * 4, &bmpProperties, &m_pBitmap);
 
   // render bitmap to screen
   D2D1_RECT_F rectf;
@@ -4807,3 +11373,41 @@ void viewManager::Visualizer::platform::flip() {
 
 #endif
 }
+
+/**
+\internal
+\brief The function may be called from any thread to have the message loop
+process a wake event. It is used by background tasks, such as font
+loading, to signal that their results are available. Calls made before the
+window is open or after closeWindow are ignored.
+*/
+void viewManager::Visualizer::platform::wake(void) {
+  std::lock_guard<std::mutex> lock(m_wakeLock);
+  if (!m_bWakeable)
+    return;
+
+#if defined(__linux__)
+#if defined(USE_LINUX_FRAMEBUFFER)
+  if (m_framebuffer) {
+    uint64_t one = 1;
+    ::write(m_wakeEvent, &one, sizeof(one));
+    return;
+  }
+#endif
+
+  // xcb connections are thread safe, unlike the xlib display.
+  xcb_client_message_event_t clientMessage{};
+  clientMessage.response_type = XCB_CLIENT_MESSAGE;
+  clientMessage.format = 32;
+  clientMessage.window = m_window;
+  clientMessage.type = XCB_ATOM_NONE;
+
+  xcb_send_event(m_connection, 0, m_window, XCB_EVENT_MASK_NO_EVENT,
+                 reinterpret_cast<const char *>(&clientMessage));
+  xcb_flush(m_connection);
+
+#elif defined(_WIN64)
+  PostMessage(m_hwnd, WM_APP, 0, 0);
+
+#endif
+}
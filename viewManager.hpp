@@ -60,11 +60,216 @@ controls.
 */
 #define INCLUDE_UX
 
+/**
+\def USE_PROGRESSIVE_LAYOUT
+\brief The first frame measures only the text that falls within the
+viewport. Content below it receives an estimated size and is measured in
+idle slices between input events. The final frame is exact.
+*/
+#define USE_PROGRESSIVE_LAYOUT
+
+/**
+\def PROGRESSIVE_LAYOUT_SLICE
+\brief The number of milliseconds of idle time spent measuring deferred
+content before the message loop checks for input again.
+*/
+#define PROGRESSIVE_LAYOUT_SLICE 4
+
+/**
+\def LAYOUT_TIME_SLICE
+\brief The number of milliseconds a layout runs before yielding to the
+message loop. The layout resumes in the next slice and the last complete
+frame is shown meanwhile.
+*/
+#define LAYOUT_TIME_SLICE 8
+
+/**
+\def USE_PARALLEL_PARSE
+\brief Markup larger than PARALLEL_PARSE_THRESHOLD bytes is divided at top
+level tags and the pieces are parsed on several threads. The elements of
+each piece are built by its thread and appended to the document in order
+by the calling thread.
+*/
+#define USE_PARALLEL_PARSE
+
+/**
+\def PARALLEL_PARSE_THRESHOLD
+\brief The size in bytes at which markup is parsed in parallel.
+*/
+#define PARALLEL_PARSE_THRESHOLD (1 << 20)
+
+/**
+\def USE_ZSTD
+\brief Markup files compressed with zstd may be given to Element::load. The
+program must be linked with -lzstd, which make ZSTD=1 does along with
+defining it. gzip files are always accepted.
+
+Example
+-------
+\snippet examples.cpp loadZstd
+*/
+//#define USE_ZSTD
+
+/**
+\def MARKUP_BLOCK_SIZE
+\brief The number of bytes Element::load reads from the file at a time.
+*/
+#define MARKUP_BLOCK_SIZE (1 << 18)
+
+/**
+\def USE_SSE2
+\brief Image scaling and canvas fills use SSE2 instructions when the
+target supports them. Otherwise a portable version of the same arithmetic
+is used.
+*/
+#if defined(__SSE2__) || defined(_M_X64)
+#define USE_SSE2
+#endif
+
+/**
+\def IMAGE_SCALE_CACHE_SIZE
+\brief The number of scaled copies of an image that are kept. The least
+recently drawn size is discarded first.
+*/
+#define IMAGE_SCALE_CACHE_SIZE 4
+
+/**
+\def MEMORY_BUDGET
+\brief The number of bytes the caches of a Viewer may hold before the
+images and surfaces are trimmed after a frame. Zero leaves them unlimited.
+Viewer::setMemoryBudget changes it for one viewer.
+*/
+#define MEMORY_BUDGET 0
+
+/**
+\def GLYPH_CACHE_BYTES
+\brief The most bytes of glyph bitmaps and sizes the FreeType cache
+manager keeps, evicting the least recently used itself. The value is
+FreeType's own default. FreeType does not report the bytes it holds, so
+once text has been drawn the glyph cache is counted as this limit. The
+memory budget does not discard the glyph cache, this limit bounds it.
+*/
+#define GLYPH_CACHE_BYTES 200000
+
+/**
+\def MEMORY_PRESSURE_TRIGGER
+\brief The Linux pressure stall trigger given to
+/proc/pressure/memory by Viewer::watchMemoryPressure, a stall of 150 ms
+within two seconds. Unprivileged processes must use windows of two seconds
+or more.
+*/
+#define MEMORY_PRESSURE_TRIGGER "some 150000 2000000"
+
+/**
+\def SERIES_SUMMARY_BLOCK
+\brief The number of chart points summarized by each leaf of the min/max
+tree. Queries scan at most two partial blocks of raw points.
+*/
+#define SERIES_SUMMARY_BLOCK 64
+
+/**
+\def USE_LAZY_MARKUP
+\brief Elements parsed from markup are recorded upon a compact tape and
+only created when their part of the document is laid out near the
+viewport, or when they are sought with getElement, query or the tree
+traversal functions. This lowers the memory used by large documents given
+to Element::load. make LAZY_MARKUP=1 defines it.
+
+Example
+-------
+\snippet examples.cpp lazyMarkup
+*/
+//#define USE_LAZY_MARKUP
+
+/**
+\def LAZY_MARKUP_GROUP
+\brief The number of tape nodes after which a deferred group of top level
+elements is closed. Each group is created as a whole.
+*/
+#define LAZY_MARKUP_GROUP 4096
+
+/**
+\def TEXT_ARENA_CHUNK
+\brief The size in bytes of each block of storage used by textArena. A row
+longer than this receives a block of its own.
+*/
+#define TEXT_ARENA_CHUNK 65536
+
+/**
+\def PARALLEL_SORT_THRESHOLD
+\brief The number of rows from which a dataView is sorted on several
+threads. Fewer rows are sorted on the calling thread.
+*/
+#define PARALLEL_SORT_THRESHOLD 65536
+
+/**
+\def FRAME_SERVER_TILE
+\brief The width and height in pixels of the tiles that the frame server
+compares with the last frame sent. Only the tiles that differ are sent.
+*/
+#define FRAME_SERVER_TILE 64
+
+/**
+\def FRAME_SERVER_QUEUE
+\brief The number of encoded frames that may wait for the clients. When
+the queue is full the encoder waits, while the frames given by the
+platform meanwhile are combined into the latest.
+*/
+#define FRAME_SERVER_QUEUE 2
+
+/**
+\def FRAME_SERVER_SEND_TIMEOUT
+\brief The number of milliseconds a write to one client of the frame server
+may wait. A client that does not read within it is dropped, so the other
+clients are held back by no more than this.
+*/
+#define FRAME_SERVER_SEND_TIMEOUT 250
+
+/**
+\def FRAME_EXPORT_SLOTS
+\brief The number of frames held by the shared memory ring of
+Viewer::exportFrames. A consumer that falls further behind skips frames.
+*/
+#define FRAME_EXPORT_SLOTS 3
+
+/**
+\def FRAME_EXPORT_DAMAGE
+\brief The number of damage rectangles a frame of the shared memory ring
+may describe. A frame with more changes is damaged as a whole.
+*/
+#define FRAME_EXPORT_DAMAGE 16
+
+/**
+\def USE_LINUX_FRAMEBUFFER
+\brief A Viewer created with viewerMode::framebuffer renders without an X
+server, to a DRM dumb buffer with page flipping, to /dev/fbN, or to a file
+when neither is available. Input is read from the evdev devices. The kernel
+drm headers are required. make FRAMEBUFFER=1 defines it.
+*/
+//#define USE_LINUX_FRAMEBUFFER
+
+/**
+\def FRAMEBUFFER_FILE
+\brief The file used as the framebuffer when no display device can be
+opened.
+*/
+#define FRAMEBUFFER_FILE "guidom.fb"
+
+/**
+\def EXECUTOR_THREADS
+\brief The number of worker threads of the task executor of a Viewer. Zero
+starts one per hardware thread. Viewer::configureExecutor overrides it.
+*/
+#define EXECUTOR_THREADS 0
+
 /** @} */
 
 #include <algorithm>
 #include <any>
 #include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 #include <cstdint>
 
 #if defined(_WIN64)
@@ -74,29 +279,38 @@ typedef unsigned char u_int8_t;
 #include <cctype>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <functional>
 #include <future>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <regex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -106,8 +320,31 @@ OS SPECIFIC HEADERS
 *************************************/
 
 #if defined(__linux__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
 #include <sys/ipc.h>
+#include <sys/mman.h>
 #include <sys/shm.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#if defined(USE_LINUX_FRAMEBUFFER)
+#include <dirent.h>
+#include <drm/drm.h>
+#include <drm/drm_mode.h>
+#include <linux/fb.h>
+#include <linux/input.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#endif
 
 #include <X11/Xlib-xcb.h>
 #include <X11/Xutil.h>
@@ -146,6 +383,15 @@ EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 #include FT_SIZES_H
 #endif
 
+#include <zlib.h>
+#if defined(USE_ZSTD)
+#include <zstd.h>
+#endif
+
+#if defined(USE_SSE2)
+#include <emmintrin.h>
+#endif
+
 /**
 \namespace viewManager
 
@@ -184,8 +430,12 @@ using dataTransformMap =
 \internal
 \brief Contains all elements allocated using the system api. They are
 contained here as smart pointers and are automatically memory managed.
+The document containers are held per thread, so separate documents may be
+built and rendered upon several threads at once. A document is used from
+the thread that created it.
 */
-extern std::unordered_map<std::size_t, std::unique_ptr<Element>> elements;
+extern thread_local std::unordered_map<std::size_t, std::unique_ptr<Element>>
+    elements;
 typedef std::unordered_map<std::size_t, std::unique_ptr<Element>>::iterator
     elementsIterator;
 
@@ -195,15 +445,68 @@ typedef std::unordered_map<std::size_t, std::unique_ptr<Element>>::iterator
 specifies the string to use when placing items into the map. The name is case
 sensitive.
 */
-extern std::unordered_map<std::string, std::reference_wrapper<Element>>
+extern thread_local std::unordered_map<std::string,
+                                       std::reference_wrapper<Element>>
     indexedElements;
 
+#if defined(USE_LAZY_MARKUP)
+/**
+\internal
+\brief Contains the ids of elements that are recorded upon a deferred
+markup tape and not yet created. The value is the key of the deferredMarkup
+element within the elements map.
+*/
+extern thread_local std::unordered_map<std::string, std::size_t>
+    deferredIndex;
+#endif
+
+/**
+\internal
+\brief Contains the elements holding a partial line of output. The lines
+are committed before the next frame is laid out. An element removes itself
+when destroyed.
+*/
+extern thread_local std::vector<Element *> pendingOutput;
+std::vector<std::size_t> flushPendingOutput(void);
+
 /**
 \internal
 \brief Contains all elements allocated using the system api. They are
 contained here as smart pointers and are automatically memory managed.
 */
-extern std::vector<std::unique_ptr<StyleClass>> styles;
+extern thread_local std::vector<std::unique_ptr<StyleClass>> styles;
+
+void releaseElements(void);
+
+/**
+\internal
+\brief the bytes held by the caches of the documents of the thread that
+can be made again, the scaled copies of images and the measured words of
+elements. They are counted as they change so the memory budget is checked
+without visiting the elements.
+*/
+typedef struct {
+  std::size_t images;
+  std::size_t metrics;
+} documentCacheBytes;
+extern thread_local documentCacheBytes cacheBytes;
+
+/**
+\internal
+\brief counts the changes to the trees of the thread. Elements linked,
+unlinked or destroyed raise it, so that a layout in progress or a display
+list holding their addresses is known to be stale.
+*/
+extern thread_local std::size_t treeGeneration;
+
+/**
+\internal
+\brief counts the changes on the thread that require elements to be
+measured or placed again, such as data and layout attributes. A layout
+records the count it has accounted for, so input that only repaints does
+not restart it.
+*/
+extern thread_local std::size_t layoutGeneration;
 
 /**
 \enum eventType
@@ -226,7 +529,9 @@ enum class eventType : uint8_t {
   dblclick,
   contextmenu,
   wheel,
-  mouseleave
+  mouseleave,
+  idle,
+  wake
 };
 
 /// \typedef eventHandler is used to note and declare a lambda function for
@@ -296,6 +601,83 @@ public:
   short wheelDistance;
 };
 
+/**
+\internal
+\struct tableEntry
+\brief a key and value of a staticTable.
+*/
+template <typename V> struct tableEntry {
+  std::string_view first;
+  V second;
+};
+
+/**
+\internal
+\brief The sortTable function orders the entries of a lookup table by key
+when the program is compiled. A duplicated key stops the compilation.
+*/
+template <typename V, std::size_t N, std::size_t... I>
+constexpr std::array<tableEntry<V>, N>
+sortTableEntries(const tableEntry<V> (&entries)[N],
+                 std::index_sequence<I...>) {
+  std::array<std::size_t, N> order = {I...};
+
+  for (std::size_t i = 1; i < N; i++)
+    for (std::size_t j = i;
+         j > 0 && entries[order[j]].first < entries[order[j - 1]].first;
+         j--) {
+      std::size_t n = order[j];
+      order[j] = order[j - 1];
+      order[j - 1] = n;
+    }
+
+  for (std::size_t i = 1; i < N; i++)
+    if (entries[order[i]].first == entries[order[i - 1]].first)
+      throw std::logic_error("lookup table key is duplicated.");
+
+  return {{entries[order[I]]...}};
+}
+
+template <typename V, std::size_t N>
+constexpr std::array<tableEntry<V>, N>
+sortTable(const tableEntry<V> (&entries)[N]) {
+  return sortTableEntries(entries, std::make_index_sequence<N>{});
+}
+
+/**
+\internal
+\class staticTable
+\brief a read only lookup table of string keys built by sortTable. The
+entries are searched with a binary search, and the table requires no
+allocation or initialization when the program loads.
+*/
+template <typename V> class staticTable {
+public:
+  typedef tableEntry<V> value_type;
+  typedef const value_type *const_iterator;
+
+  template <std::size_t N>
+  constexpr staticTable(const std::array<value_type, N> &entries)
+      : m_entries(entries.data()), m_size(N) {}
+
+  const_iterator begin(void) const { return m_entries; }
+  const_iterator end(void) const { return m_entries + m_size; }
+  std::size_t size(void) const { return m_size; }
+
+  const_iterator find(const std::string_view &key) const {
+    auto it = std::lower_bound(
+        begin(), end(), key,
+        [](const value_type &e, const std::string_view &k) {
+          return e.first < k;
+        });
+    return it != end() && it->first == key ? it : end();
+  }
+
+private:
+  const value_type *m_entries;
+  std::size_t m_size;
+};
+
 /**
 \enum numericFormat
 \brief numericFormat provides a mode measurement for each of the numeric
@@ -328,6 +710,9 @@ public:
   doubleNF(const std::string &_str);
   double toPx(void);
   double toPt(void);
+  bool operator==(const doubleNF &_val) const {
+    return value == _val.value && option == _val.option;
+  }
 };
 
 /**
@@ -336,7 +721,7 @@ public:
 \brief the colorMap typedef provides the type for translating a textual name
 to a numerical color
 */
-typedef std::unordered_map<std::string, unsigned long> colorMap;
+typedef staticTable<unsigned long> colorMap;
 
 /**
 \class colorNF
@@ -367,15 +752,18 @@ public:
   void neutralWarmer(void);    /* hsl rotate 30 */
   void complementary(void);    /* hsl rotate 180*/
   void splitComplements(void); /*hsl rotate 150 */
+  bool operator==(const colorNF &_val) const {
+    return option == _val.option && value == _val.value;
+  }
 };
 
 uint8_t strToEnum(const std::string_view &sListName,
-                  const std::unordered_map<std::string, uint8_t> &optionMap,
+                  const staticTable<uint8_t> &optionMap,
                   const std::string &sOption);
 
 std::tuple<double, uint8_t>
 strToNumericAndEnum(const std::string_view &sListName,
-                    const std::unordered_map<std::string, uint8_t> &optionMap,
+                    const staticTable<uint8_t> &optionMap,
                     const std::string &_sOption);
 
 std::tuple<doubleNF, doubleNF, doubleNF, doubleNF>
@@ -403,6 +791,7 @@ developed.
     NAME(const double &_val) : value(_val) {}                                  \
     NAME(const NAME &_val) : value(_val.value) {}                              \
     NAME(const std::string &_str) { value = std::stod(_str, NULL); }           \
+    bool operator==(const NAME &_val) const { return value == _val.value; }    \
   }
 /**
 \internal
@@ -416,6 +805,7 @@ developed.
     std::string value;                                                         \
     NAME(const std::string &_val) : value(_val) {}                             \
     NAME(const NAME &_val) : value(_val.value) {}                              \
+    bool operator==(const NAME &_val) const { return value == _val.value; }    \
   }
 
 /**
@@ -451,6 +841,7 @@ developed.
     NAME(const optionEnum &val) : value(val) {}                                \
     NAME(const NAME &val) : value(val.value) {}                                \
     NAME(const std::string &_opt);                                             \
+    bool operator==(const NAME &val) const { return value == val.value; }      \
   }
 
 /**
@@ -471,6 +862,9 @@ enumerated constant
         : value(_val), option(_opt) {}                                         \
     NAME(const NAME &_val) : value(_val.value), option(_val.option) {}         \
     NAME(const std::string &_str);                                             \
+    bool operator==(const NAME &_val) const {                                  \
+      return value == _val.value && option == _val.option;                     \
+    }                                                                          \
   }
 
 /**
@@ -508,6 +902,7 @@ enumerated constant
   public:                                                                      \
     std::vector<std::string> value;                                            \
     NAME(std::vector<std::string> _val) : value(std::move(_val)) {}            \
+    bool operator==(const NAME &_val) const { return value == _val.value; }    \
   }
 
 #define _STRUCT_ATTRIBUTE(NAME, NAME2) using NAME = NAME2
@@ -597,6 +992,20 @@ _ENUMERATED_ATTRIBUTE(listStyleType, none, disc, circle, square, decimal, alpha,
 /// viewManagerApp always.
 _STRING_ATTRIBUTE(windowTitle);
 
+/// \class framebufferDevice names the device of viewerMode::framebuffer,
+/// /dev/dri/cardN, /dev/fbN or file:path. When not given, the first card,
+/// then /dev/fb0, then FRAMEBUFFER_FILE are tried.
+_STRING_ATTRIBUTE(framebufferDevice);
+
+/// \class viewerMode selects whether the Viewer opens a window, renders
+/// headless to an image with renderImage, or renders to the display
+/// device without a window system.
+_ENUMERATED_ATTRIBUTE(viewerMode, window, headless, framebuffer);
+
+/// \class pixelFormat selects the format of the pixels the Viewer renders,
+/// four, two or one byte each. The window receives them as xrgb8888.
+_ENUMERATED_ATTRIBUTE(pixelFormat, xrgb8888, rgb565, gray8);
+
 /// \class documentState holds the document state. The stateStructure applies
 /// the structure which holds the information.
 using documentState = class documentState {
@@ -607,6 +1016,109 @@ public:
 
 /** @}*/
 
+/**
+\internal
+\def STYLE_PROPERTIES
+\brief lists the attributes held within the computed style of an element
+rather than its own attributes. Elements with equal values of these share
+one record. The position, size and ordering attributes usually differ
+between elements and so remain their own.
+*/
+#define STYLE_PROPERTIES(X)                                                    \
+  X(display)                                                                   \
+  X(position)                                                                  \
+  X(background)                                                                \
+  X(opacity)                                                                   \
+  X(textFace)                                                                  \
+  X(textSize)                                                                  \
+  X(textWeight)                                                                \
+  X(textColor)                                                                 \
+  X(textAlignment)                                                             \
+  X(textIndent)                                                                \
+  X(tabSize)                                                                   \
+  X(lineHeight)                                                                \
+  X(marginTop)                                                                 \
+  X(marginLeft)                                                                \
+  X(marginBottom)                                                              \
+  X(marginRight)                                                               \
+  X(paddingTop)                                                                \
+  X(paddingLeft)                                                               \
+  X(paddingBottom)                                                             \
+  X(paddingRight)                                                              \
+  X(borderStyle)                                                               \
+  X(borderWidth)                                                               \
+  X(borderColor)                                                               \
+  X(borderRadius)                                                              \
+  X(listStyleType)
+
+/**
+\internal
+\brief true for the attribute types listed by STYLE_PROPERTIES.
+*/
+template <typename T> inline constexpr bool isStyleProperty = false;
+#define _STYLE_PROPERTY_TRAIT(NAME)                                            \
+  template <> inline constexpr bool isStyleProperty<NAME> = true;
+STYLE_PROPERTIES(_STYLE_PROPERTY_TRAIT)
+#undef _STYLE_PROPERTY_TRAIT
+
+/**
+\internal
+\brief the text properties of a computed style with the defaults applied.
+*/
+typedef struct {
+  std::string sTextFace;
+  double dTextSize;
+  double dLineHeight;
+  int textColor;
+  textAlignment::optionEnum alignment;
+} resolvedTextStyle;
+
+/**
+\class computedStyle
+\brief the style properties of an element.
+
+\details Elements whose properties are equal share one record, found by
+its hash among the records of the thread when the element is laid out. A
+list of thousands of items therefore holds one record and a pointer within
+each item, and values derived from the properties, such as the resolved
+text style, are computed once for all of them. A shared record is not
+changed. Setting a property gives the element its own copy, which is
+shared again at the next layout.
+*/
+class computedStyle {
+public:
+  computedStyle(void) {}
+  computedStyle(const computedStyle &other)
+      : m_properties(other.m_properties) {}
+
+  template <typename T> const T *find(void) const {
+    auto it = m_properties.find(std::type_index(typeid(T)));
+    return it == m_properties.end() ? nullptr
+                                    : &std::any_cast<const T &>(it->second);
+  }
+  template <typename T> T *edit(void) {
+    auto it = m_properties.find(std::type_index(typeid(T)));
+    if (it == m_properties.end())
+      return nullptr;
+    m_text.reset();
+    return &std::any_cast<T &>(it->second);
+  }
+  void set(const std::any &setting);
+  bool empty(void) const { return m_properties.empty(); }
+
+  std::size_t hash(void) const;
+  bool operator==(const computedStyle &other) const;
+  const resolvedTextStyle &text(void) const;
+  static bool isProperty(const std::type_index &tIndex);
+
+private:
+  std::unordered_map<std::type_index, std::any> m_properties;
+  mutable std::optional<resolvedTextStyle> m_text;
+};
+
+std::shared_ptr<computedStyle>
+internStyle(const std::shared_ptr<computedStyle> &style);
+
 /**
  \brief StyleClass provides a way to collect several attributes
  that have a style organized. The name can be applied to an
@@ -654,6 +1166,488 @@ extern std::vector<rectangle> items;
 std::size_t allocate(Element &e);
 void deallocate(const std::size_t &token);
 
+/**
+\internal
+\brief the storage and arithmetic of a pixel format of the offscreen
+buffer. Colors are given as 0xRRGGBB and are encoded once for each
+operation. Coverage is 0 to 256, 256 being opaque.
+*/
+template <pixelFormat::optionEnum F> struct pixelTraits;
+
+template <> struct pixelTraits<pixelFormat::xrgb8888> {
+  typedef uint32_t pixel;
+  static pixel encode(const uint32_t color) { return color; }
+  static uint32_t decode(const pixel p) { return p & 0xFFFFFF; }
+  static pixel blend(const pixel destination, const pixel source,
+                     const unsigned int coverage) {
+    // red and blue are blended together, green separately
+    uint32_t rb = ((source & 0xFF00FF) * coverage +
+                   (destination & 0xFF00FF) * (256 - coverage)) >>
+                  8;
+    uint32_t g = ((source & 0x00FF00) * coverage +
+                  (destination & 0x00FF00) * (256 - coverage)) >>
+                 8;
+    return (rb & 0xFF00FF) | (g & 0x00FF00);
+  }
+};
+
+template <> struct pixelTraits<pixelFormat::rgb565> {
+  typedef uint16_t pixel;
+  static pixel encode(const uint32_t color) {
+    return static_cast<pixel>(((color >> 8) & 0xF800) |
+                              ((color >> 5) & 0x07E0) | ((color >> 3) & 0x1F));
+  }
+  static uint32_t decode(const pixel p) {
+    uint32_t r = (p >> 11) & 0x1F;
+    uint32_t g = (p >> 5) & 0x3F;
+    uint32_t b = p & 0x1F;
+    return ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) |
+           (b << 3 | b >> 2);
+  }
+  static pixel blend(const pixel destination, const pixel source,
+                     const unsigned int coverage) {
+    // green is moved to the upper half so the three fields are blended
+    // with one multiply each, at 5 bits of coverage.
+    uint32_t a = coverage >> 3;
+    uint32_t s = (source | (static_cast<uint32_t>(source) << 16)) & 0x07E0F81F;
+    uint32_t d = (destination | (static_cast<uint32_t>(destination) << 16)) &
+                 0x07E0F81F;
+    uint32_t ret = ((s * a + d * (32 - a)) >> 5) & 0x07E0F81F;
+    return static_cast<pixel>(ret | (ret >> 16));
+  }
+};
+
+template <> struct pixelTraits<pixelFormat::gray8> {
+  typedef uint8_t pixel;
+  static pixel encode(const uint32_t color) {
+    return static_cast<pixel>((((color >> 16) & 0xFF) * 77 +
+                               ((color >> 8) & 0xFF) * 150 +
+                               (color & 0xFF) * 29) >>
+                              8);
+  }
+  static uint32_t decode(const pixel p) { return p * 0x010101u; }
+  static pixel blend(const pixel destination, const pixel source,
+                     const unsigned int coverage) {
+    return static_cast<pixel>(
+        (source * coverage + destination * (256 - coverage)) >> 8);
+  }
+};
+
+/**
+\internal
+\class imageSurface
+\brief holds the pixels of an image in the same 32 bit format as the
+offscreen buffer.
+
+\details Copies scaled to a destination size are kept so that an image
+drawn at the same size on successive frames is scaled once. Downscaling
+begins from a mip level, each level being a 2x2 box filtered half of the
+previous, and finishes with a bilinear resample. The mip chain and the
+scaled copies are discarded when the pixels change.
+*/
+class imageSurface {
+public:
+  imageSurface(void) : m_width(0), m_height(0), m_cachedBytes(0) {}
+  imageSurface(const unsigned int w, const unsigned int h);
+  imageSurface(const imageSurface &other);
+  imageSurface &operator=(const imageSurface &other);
+  ~imageSurface() { invalidate(); }
+
+  void resize(const unsigned int w, const unsigned int h);
+  void setPixels(const unsigned int w, const unsigned int h,
+                 const uint32_t *pixels);
+  void putPixel(const unsigned int x, const unsigned int y,
+                const uint32_t color);
+  void invalidate(void);
+
+  unsigned int width(void) const { return m_width; }
+  unsigned int height(void) const { return m_height; }
+  bool empty(void) const { return m_pixels.empty(); }
+  const uint32_t *row(const unsigned int y) const {
+    return m_pixels.data() + y * m_width;
+  }
+  uint32_t *row(const unsigned int y) { return m_pixels.data() + y * m_width; }
+
+  const imageSurface &scaled(const unsigned int w, const unsigned int h);
+  std::size_t cachedBytes(void) const { return m_cachedBytes; }
+  std::size_t trim(void);
+
+  static uint32_t boxAverage(const uint32_t a, const uint32_t b,
+                             const uint32_t c, const uint32_t d);
+  static void halve(const imageSurface &src, imageSurface &dst);
+
+private:
+  unsigned int m_width;
+  unsigned int m_height;
+  std::vector<uint32_t> m_pixels;
+  // the bytes of the mip chain and the scaled copies.
+  std::size_t m_cachedBytes;
+
+  std::vector<std::unique_ptr<imageSurface>> m_mipChain;
+  typedef struct {
+    unsigned int w;
+    unsigned int h;
+    std::unique_ptr<imageSurface> surface;
+  } scaledCopy;
+  std::list<scaledCopy> m_scaledCache;
+
+  const imageSurface &mipLevel(const unsigned int w, const unsigned int h);
+  static void resample(const imageSurface &src, imageSurface &dst);
+};
+
+void writePixmap(const std::string &sFilename, const u_int8_t *pixels,
+                 const unsigned short w, const unsigned short h);
+
+#if defined(__linux__)
+/**
+\internal
+\enum tileEncoding
+\brief the forms of the pixels of a tile within the frame stream.
+*/
+enum class tileEncoding : uint8_t { raw, rle, zlib };
+
+/**
+\def FRAME_STREAM_MAGIC
+\brief begins each frame of the stream, "GDFB".
+*/
+#define FRAME_STREAM_MAGIC 0x42464447
+
+int frameSocket(const std::string &sAddress, const bool bListen);
+bool regionChanged(const u_int8_t *a, const std::size_t strideA,
+                   const u_int8_t *b, const std::size_t strideB,
+                   const std::size_t bytes, const unsigned int rows);
+
+/**
+\internal
+\class frameServer
+\brief sends the frames shown by a platform to clients connected upon a
+local socket. The address is "unix:path", "tcp:port" which listens upon
+the loopback interface, or "tcp:host:port".
+
+\details Each frame is compared with the last one sent in tiles of
+FRAME_SERVER_TILE pixels, and only the tiles that differ are encoded, so
+the bandwidth and the work follow the amount of the screen that changes.
+The UI thread only copies the frame. An encoder thread compares and
+encodes it while a sender thread writes the frames before it to the
+clients. Frames given while the encoder is busy replace one another. A
+client that connects receives every tile of the next frame, and a client
+that stops reading for FRAME_SERVER_SEND_TIMEOUT is dropped.
+
+The stream is a sequence of frames. A frame is FRAME_STREAM_MAGIC, the
+width, the height and the number of tiles. Each tile is its x, y, width
+and height, the tileEncoding and the length of the data that follows. The
+numbers are little endian, the magic, the tile count and the length are
+32 bit and the others 16 bit. The data are the rows of the tile in the
+pixel format of the offscreen buffer, either raw, as runs of a 16 bit count
+followed by the pixel, or raw compressed with zlib.
+*/
+class frameServer {
+public:
+  frameServer(const std::string &sAddress);
+  ~frameServer();
+  void submit(const std::vector<u_int8_t> &pixels, const unsigned short w,
+              const unsigned short h);
+
+private:
+  typedef struct {
+    std::vector<u_int8_t> bytes;
+    std::vector<int> joining;
+  } encodedFrame;
+
+  int m_listen;
+  std::string m_sPath;
+  std::atomic<bool> m_bStop;
+
+  // given by the UI thread
+  std::mutex m_frameMutex;
+  std::condition_variable m_frameReady;
+  std::vector<u_int8_t> m_next;
+  unsigned short m_nextW;
+  unsigned short m_nextH;
+  bool m_bFrameReady;
+  std::vector<int> m_joining;
+
+  // used by the encoder thread. The size is changed with m_frameMutex held.
+  std::vector<u_int8_t> m_current;
+  std::vector<u_int8_t> m_previous;
+  unsigned short m_w;
+  unsigned short m_h;
+  std::vector<u_int8_t> m_tile;
+  std::vector<u_int8_t> m_encoded;
+
+  std::mutex m_sendMutex;
+  std::condition_variable m_sendReady;
+  std::condition_variable m_sendSpace;
+  std::deque<encodedFrame> m_sendQueue;
+  // written by the sender thread with m_sendMutex held.
+  std::vector<int> m_clients;
+
+  std::thread m_acceptor;
+  std::thread m_encoder;
+  std::thread m_sender;
+
+  void acceptClients(void);
+  void encodeFrames(void);
+  void sendFrames(void);
+  void encodeTile(const u_int8_t *pixels, const unsigned short x,
+                  const unsigned short y, const unsigned short tw,
+                  const unsigned short th, std::vector<u_int8_t> &out);
+};
+
+/**
+\internal
+\class frameDecoder
+\brief receives the frames of a frameServer and applies their tiles to a
+copy of the screen.
+*/
+class frameDecoder {
+public:
+  frameDecoder(void) : m_width(0), m_height(0), m_frameBytes(0), m_tiles(0) {}
+  bool receive(const int fd);
+
+  unsigned short width(void) const { return m_width; }
+  unsigned short height(void) const { return m_height; }
+  const std::vector<u_int8_t> &pixels(void) const { return m_pixels; }
+  std::size_t frameBytes(void) const { return m_frameBytes; }
+  std::size_t tiles(void) const { return m_tiles; }
+
+private:
+  unsigned short m_width;
+  unsigned short m_height;
+  std::size_t m_frameBytes;
+  std::size_t m_tiles;
+  std::vector<u_int8_t> m_pixels;
+  std::vector<u_int8_t> m_data;
+  std::vector<u_int8_t> m_tile;
+};
+
+/**
+\def FRAME_EXPORT_MAGIC
+\brief begins the shared memory of a frame export, "GDFX".
+*/
+#define FRAME_EXPORT_MAGIC 0x58464447
+
+/**
+\internal
+\brief a rectangle of an exported frame that differs from the frame
+before it.
+*/
+typedef struct {
+  uint32_t x;
+  uint32_t y;
+  uint32_t w;
+  uint32_t h;
+} frameDamage;
+
+/**
+\internal
+\brief the header of each slot of the frame export ring. The pixels follow
+it. The sequence is zero while the slot is written and otherwise the
+number of the frame it holds. The pixels are in the format of the
+offscreen buffer, stride bytes for each row.
+*/
+typedef struct {
+  std::atomic<uint64_t> sequence;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  uint32_t damageCount;
+  frameDamage damage[FRAME_EXPORT_DAMAGE];
+} frameSlotHeader;
+
+/**
+\internal
+\brief the header of the shared memory of a frame export. The sequence is
+the number of the latest complete frame, held in slot sequence modulo
+slots. The notify word is incremented with each frame and is the futex
+that consumers wait upon.
+*/
+typedef struct {
+  uint32_t magic;
+  uint32_t slots;
+  uint64_t slotBytes;
+  uint32_t maxWidth;
+  uint32_t maxHeight;
+  std::atomic<uint32_t> notify;
+  std::atomic<uint64_t> sequence;
+} frameRingHeader;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "The frame export requires lock free atomics in shared memory.");
+
+/**
+\internal
+\class frameExport
+\brief publishes the frames shown by a platform into a POSIX shared memory
+ring for recorders and compositors of other processes.
+
+\details The producer never waits upon the consumers. Each frame is written
+to the next slot, which a consumer still reading notices by its sequence,
+and consumers that fall behind continue from the latest frame. Frames
+identical to the one before are not published. The damage of a frame is
+found by comparing tiles of FRAME_SERVER_TILE pixels with the previous
+slot. Frames larger than the size given at creation are clipped.
+*/
+class frameExport {
+public:
+  frameExport(const std::string &sName, const unsigned int slots,
+              const unsigned short maxWidth, const unsigned short maxHeight);
+  ~frameExport();
+  void publish(const std::vector<u_int8_t> &pixels, const unsigned short w,
+               const unsigned short h);
+
+private:
+  std::string m_sName;
+  u_int8_t *m_memory;
+  std::size_t m_size;
+  frameRingHeader *m_ring;
+  uint64_t m_sequence;
+
+  frameSlotHeader *slot(const uint64_t sequence);
+};
+
+/**
+\internal
+\class frameExportReader
+\brief reads the frames of a frameExport from another process. The pixels
+are read in place. A frame is checked with intact after it is used, since
+the producer may have written over it meanwhile.
+
+\details The damage of a slot is relative to the frame published just
+before it. When acquire skips frames, or gives the first frame, that is not
+the frame the consumer holds, so bWhole is set and the whole frame is to be
+taken as damaged.
+*/
+class frameExportReader {
+public:
+  typedef struct {
+    uint64_t sequence;
+    const frameSlotHeader *header;
+    const u_int8_t *pixels;
+    bool bWhole;
+  } frame;
+
+  frameExportReader(const std::string &sName);
+  ~frameExportReader();
+  bool wait(const std::chrono::milliseconds timeout);
+  bool acquire(frame &f);
+  bool intact(const frame &f) const;
+  uint64_t skipped(void) const { return m_skipped; }
+
+private:
+  u_int8_t *m_memory;
+  std::size_t m_size;
+  const frameRingHeader *m_ring;
+  uint64_t m_lastSequence;
+  uint64_t m_skipped;
+};
+#endif
+
+#if defined(__linux__) && defined(USE_LINUX_FRAMEBUFFER)
+/**
+\internal
+\class framebufferOutput
+\brief shows the offscreen buffer upon a display device without a window
+system.
+
+\details A DRM card is driven through its dumb buffer interface, two
+buffers being flipped at vertical blank. A card that cannot be used, for
+instance while another process is the DRM master, is passed over for the
+fbdev device. When neither opens, the frames are written to a mapped file
+of the requested size and format so the program runs without the
+hardware. The offscreen buffer is rendered in the format of the device so
+the frame is only copied.
+*/
+class framebufferOutput {
+public:
+  framebufferOutput(const std::string &sDevice, const unsigned short w,
+                    const unsigned short h,
+                    const pixelFormat::optionEnum format);
+  ~framebufferOutput();
+
+  unsigned short width(void) const { return m_width; }
+  unsigned short height(void) const { return m_height; }
+  pixelFormat::optionEnum format(void) const { return m_format; }
+  const std::string &description(void) const { return m_sDescription; }
+  void present(const u_int8_t *pixels, const unsigned short w,
+               const unsigned short h);
+
+private:
+  enum class outputKind : uint8_t { drm, fbdev, file };
+  typedef struct {
+    uint32_t handle;
+    uint32_t fb;
+    uint32_t pitch;
+    uint64_t size;
+    u_int8_t *map;
+  } dumbBuffer;
+
+  outputKind m_kind;
+  int m_fd;
+  unsigned short m_width;
+  unsigned short m_height;
+  std::size_t m_stride;
+  pixelFormat::optionEnum m_format;
+  std::string m_sDescription;
+
+  // fbdev and file
+  u_int8_t *m_map;
+  std::size_t m_mapSize;
+
+  // drm
+  dumbBuffer m_buffers[2];
+  int m_back;
+  uint32_t m_crtc;
+  uint32_t m_connector;
+  drm_mode_crtc m_savedCrtc;
+  bool m_bFlipPending;
+
+  bool openDrm(const std::string &sPath,
+               const pixelFormat::optionEnum format);
+  bool openFbdev(const std::string &sPath);
+  void openFile(const std::string &sPath, const unsigned short w,
+                const unsigned short h, const pixelFormat::optionEnum format);
+  void close(void);
+};
+
+/**
+\internal
+\class evdevInput
+\brief reads the keyboards, mice and touch screens of /dev/input and
+dispatches them as the events of a window. Keys are given the X keysyms
+and the characters of a US layout.
+*/
+class evdevInput {
+public:
+  evdevInput(const eventHandler &evtDispatcher, const unsigned short w,
+             const unsigned short h);
+  ~evdevInput();
+  void descriptors(std::vector<pollfd> &fds) const;
+  void read(const int fd);
+
+private:
+  typedef struct {
+    int fd;
+    bool bAbsolute;
+    input_absinfo absX;
+    input_absinfo absY;
+  } inputDevice;
+
+  eventHandler dispatchEvent;
+  std::vector<inputDevice> m_devices;
+  unsigned short m_width;
+  unsigned short m_height;
+  int m_x;
+  int m_y;
+  bool m_bMoved;
+  bool m_bShift;
+
+  void key(const unsigned short code, const int value);
+  static unsigned int keysym(const unsigned short code);
+};
+#endif
+
 /**
 \internal
 \class platform
@@ -665,30 +1659,88 @@ public:
   platform(const eventHandler &evtDispatcher, const unsigned short width,
            const unsigned short height);
   ~platform();
+  void initializeText(void);
+  void preloadFaces(const std::vector<std::string> &faces);
+  void connect(void);
+  void windowSize(const unsigned short width, const unsigned short height) {
+    _w = width;
+    _h = height;
+  }
   void openWindow(const std::string &sWindowTitle);
+  void openOffscreen(void);
+  void openFramebuffer(const std::string &sDevice);
+  void setPixelFormat(const pixelFormat::optionEnum format);
+  pixelFormat::optionEnum format(void) const { return m_format; }
+  unsigned int bytesPerPixel(void) const;
+  const std::vector<u_int8_t> &pixels32(void);
+  void serveFrames(const std::string &sAddress);
+  void exportFrames(const std::string &sName);
+  std::size_t surfaceBytes(void) const;
+  std::size_t glyphBytes(void) const;
+  std::size_t trimSurfaces(void);
+  std::size_t trimGlyphs(void);
+  unsigned short width(void) { return _w; }
+  unsigned short height(void) { return _h; }
   void closeWindow(void);
   void messageLoop(void);
   inline FTC_FaceID getFaceID(std::string sTextFace);
+  bool isFaceLoaded(const std::string &sTextFace);
+  void waitForFace(const std::string &sTextFace, const std::size_t key);
+  std::vector<std::size_t> takeFaceWaiters(void);
   void drawText(const std::string &sTextFace, const int pointSize,
-                const std::string &s, const unsigned int foreground, int x1,
-                int y1, int x2, int y2, textAlignment tAlign);
+                const std::string_view &s, const unsigned int foreground,
+                int x1, int y1, int x2, int y2, textAlignment tAlign);
   inline int drawChar(const int xPos, const int yPos, const int xPos2,
                       const int yPos2, const char c,
                       const unsigned int foreground, const FT_UInt glyph_index,
                       const FT_Size sizeFace, const FTC_Scaler scaler);
   double measureTextWidth(const std::string &sTextFace, const int pointSize,
-                          const std::string &s);
+                          const std::string_view &s);
   double measureFaceHeight(const std::string &sTextFace, const int pointSize);
 
   void drawCaret(const int x, const int y, const int h);
+  void drawImage(imageSurface &image, const int x, const int y, const int w,
+                 const int h);
   inline void putPixel(const int x, const int y, const unsigned int color);
   inline unsigned int getPixel(const int x, const int y);
 
+  /**
+  \brief canvas drawing. The functions draw to the offscreen buffer and
+  are clipped to the clip rectangle, which is the whole buffer unless set.
+  pushClip narrows the clip for nested drawing and popClip restores the
+  one before it. Colors are 0xRRGGBB. Custom elements call these from
+  their render override.
+  */
+  void setClip(const int x, const int y, const int w, const int h);
+  void resetClip(void);
+  void pushClip(const int x, const int y, const int w, const int h);
+  void popClip(void);
+  void drawLine(int x1, int y1, int x2, int y2, const unsigned int color);
+  void drawPolyline(const std::vector<std::pair<int, int>> &points,
+                    const unsigned int color, const bool bClosed = false);
+  void fillRect(const int x, const int y, const int w, const int h,
+                const unsigned int color);
+  void strokeRect(const int x, const int y, const int w, const int h,
+                  const unsigned int color, const int thickness = 1);
+  void fillCircle(const double cx, const double cy, const double radius,
+                  const unsigned int color);
+  void strokeCircle(const double cx, const double cy, const double radius,
+                    const unsigned int color, const double thickness = 1);
+  void drawArc(const double cx, const double cy, const double radius,
+               const double startAngle, const double endAngle,
+               const unsigned int color, const double thickness = 1);
+  void blit(const imageSurface &image, const int x, const int y);
+  double drawTextRun(const std::string &sTextFace, const int pointSize,
+                     const std::string_view &s, const unsigned int color,
+                     const int x, const int y);
+
   void flip(void);
   void resize(const int w, const int h);
   void clear(void);
   bool filled(void);
-  std::string getFontFilename(const std::string &sTextFace);
+  void wake(void);
+  void requestIdle(void);
+  static std::string getFontFilename(const std::string &sTextFace);
 
 #if defined(__linux__)
 
@@ -700,11 +1752,33 @@ public:
 #endif
 
 #if defined(USE_INLINE_RENDERER)
+  /**
+  \internal
+  \brief the resolved font file and its contents. The contents are read
+  by a background task so that FT_New_Memory_Face does not touch the disk.
+  */
   typedef struct {
     std::string filePath;
+    std::vector<FT_Byte> fileData;
+  } faceFileStruct;
+
+  /**
+  \internal
+  \brief a face cache record. Faces other than the default are resolved on
+  a background task. While the task is pending, the record is not ready and
+  the default face is substituted for measuring and drawing.
+  */
+  typedef struct {
+    std::shared_ptr<const faceFileStruct> file;
     int index;
+    bool bReady;
+    std::future<std::shared_ptr<const faceFileStruct>> pending;
+    std::future<void> loader;
   } faceCacheStruct;
 
+  static std::shared_ptr<const faceFileStruct>
+  loadFaceFile(const std::string &sTextFace);
+
   static FT_Error faceRequestor(FTC_FaceID face_id, FT_Library library,
                                 FT_Pointer request_data, FT_Face *aface);
 
@@ -737,14 +1811,74 @@ public:
   int m_xpos;
   int m_ypos;
   int fontScale;
+  std::atomic<bool> m_bWakeable;
+  // held by wake so closeWindow does not release the connection under it.
+  std::mutex m_wakeLock;
   std::vector<u_int8_t> m_offscreenBuffer;
 
 private:
   eventHandler dispatchEvent;
+  bool m_bIdleRequested;
+  // rendering to the offscreen buffer only, without a display connection.
+  bool m_bHeadless;
+#if defined(__linux__) && defined(USE_LINUX_FRAMEBUFFER)
+  std::unique_ptr<framebufferOutput> m_framebuffer;
+  std::unique_ptr<evdevInput> m_input;
+  int m_wakeEvent;
+  void framebufferLoop(void);
+#endif
+#if defined(__linux__)
+  std::unique_ptr<frameServer> m_frameServer;
+  std::unique_ptr<frameExport> m_frameExport;
+  std::string m_sFrameExport;
+  void openFrameExport(void);
+#endif
 
   unsigned short _w;
   unsigned short _h;
 
+  // clip rectangle, right and bottom are exclusive
+  int m_clipX1;
+  int m_clipY1;
+  int m_clipX2;
+  int m_clipY2;
+  // the clip rectangles replaced by pushClip, x1 y1 x2 y2.
+  std::vector<std::array<int, 4>> m_clipStack;
+
+  void fillSpan(const int x1, const int x2, const int y,
+                const unsigned int color);
+  void blendPixel(const int x, const int y, const unsigned int color,
+                  const unsigned int coverage);
+  void blendGlyph(const unsigned char *buffer, const int pitch,
+                  const int storageSize, const int x1, const int y1,
+                  const int x2, const int y2, const unsigned int color);
+
+  // the raster kernels of each pixel format. The callers clip.
+  pixelFormat::optionEnum m_format;
+  std::vector<u_int8_t> m_pixels32;
+
+  template <pixelFormat::optionEnum F>
+  typename pixelTraits<F>::pixel *pixelRow(const int y);
+  template <pixelFormat::optionEnum F>
+  void fillSpanKernel(const int xBegin, const int xEnd, const int y,
+                      const unsigned int color);
+  template <pixelFormat::optionEnum F>
+  void blendKernel(const int x, const int y, const unsigned int color,
+                   const unsigned int coverage);
+  template <pixelFormat::optionEnum F>
+  void blitKernel(const imageSurface &image, const int x, const int y,
+                  const int xBegin, const int xEnd, const int yBegin,
+                  const int yEnd);
+  template <pixelFormat::optionEnum F>
+  void glyphKernel(const unsigned char *buffer, const int pitch,
+                   const int storageSize, const int x1, const int y1,
+                   const int x2, const int y2, const unsigned int color);
+  template <pixelFormat::optionEnum F> void convertKernel(void);
+
+  void drawRing(const double cx, const double cy, const double radius,
+                const double thickness, const double startAngle,
+                const double sweep, const unsigned int color);
+
 #ifdef USE_INLINE_RENDERER
   FT_Library m_freeType;
   FTC_Manager m_cacheManager;
@@ -758,9 +1892,14 @@ private:
 #endif
 
   FTC_CMapCache m_cmapCache;
+  // true when glyphs may be held by the cache manager.
+  bool m_bGlyphsCached;
   std::unordered_map<std::string, faceCacheStruct> m_faceCache;
   typedef std::unordered_map<std::string, faceCacheStruct>::iterator
       faceCacheIterator;
+  // the keys of the elements measured with the default face in place of
+  // each face still loading. Used upon the thread of the message loop.
+  std::unordered_map<std::string, std::vector<std::size_t>> m_faceWaiters;
 
   //  std::unordered_map<std::pair<unsigned int, unsigned int>, unsigned int>
   //  m_blend;
@@ -778,23 +1917,33 @@ private:
 template <typename TYPE>
 auto &_createElement(const std::vector<std::any> &attr);
 
+/**
+  \internal
+  \brief Internal function that copies an element as its own type into
+  the element storage. Elements keep a pointer to the version for their
+  type so that clone copies derived members. The Viewer owns the window
+  and its device, so it is never given one.
+*/
+template <typename TYPE> Element &_cloneElement(const Element &source);
+class Viewer;
+
 /**
 \internal
 \typedef factoryLambda is used by the document element factory as a
-data type for the factory function within the unordered_map.
+data type for the factory function within the table. The lambdas of the
+table do not capture, so they are held as function pointers.
 */
-typedef std::function<Element &(const std::vector<std::any> &attr)>
-    factoryLambda;
+typedef Element &(*factoryLambda)(const std::vector<std::any> &attr);
 /**
 \internal
 \typedef factoryMap is a definition of strings and lambda creation functions.
 The document element is referenced by textual tag name wher the function
 returns the creation of the object.
 */
-typedef std::unordered_map<std::string, factoryLambda> factoryMap;
+typedef staticTable<factoryLambda> factoryMap;
 /**
 \internal
-\var objectFactoryMap is a constant unordered_map which contains the table.
+\var objectFactoryMap is a constant sorted table of the element names.
 */
 extern const factoryMap objectFactoryMap;
 /**
@@ -802,16 +1951,14 @@ extern const factoryMap objectFactoryMap;
 \typedef attributeLambda is a function that sets the specific attribute upon
 the pased element object.
 */
-typedef std::function<void(Element &e, const std::string &param)>
-    attributeLambda;
+typedef void (*attributeLambda)(Element &e, const std::string &param);
 /**
 \internal
-\typedef attributeStringMap defines the unordered_map that is searched for
+\typedef attributeStringMap defines the table that is searched for
 an attribute text name. The storage provides an information of the expected
 number of parameters. 0 or 1.
 */
-typedef std::unordered_map<std::string, std::pair<bool, attributeLambda>>
-    attributeStringMap;
+typedef staticTable<std::pair<bool, attributeLambda>> attributeStringMap;
 /**
 \internal
 \var attributeFactory is a const variable which holds the collection of
@@ -819,6 +1966,370 @@ attribute strings, numer of parameters and attribute setting lambda.
 */
 extern const attributeStringMap attributeFactory;
 
+/**
+\internal
+\class markupBlockQueue
+\brief a bounded queue of markup blocks passed from the thread reading
+and decompressing a file to the thread parsing it. The reader blocks when
+the queue is full so memory use stays bounded. An error raised by the
+reader is delivered to the parser once the queued blocks are consumed.
+*/
+class markupBlockQueue {
+public:
+  void push(std::string &&block);
+  bool pop(std::string &block);
+  void finish(std::exception_ptr error = nullptr);
+  void cancel(void);
+  bool cancelled(void);
+
+private:
+  static const std::size_t capacity = 8;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<std::string> m_blocks;
+  bool m_bFinished = false;
+  bool m_bCancelled = false;
+  std::exception_ptr m_error;
+};
+
+/**
+\internal
+\class outputBuffer
+\brief the text written to an element by the stream insertion operator
+and printf. Values are formatted in place at the end of one growable
+buffer, so the storage is reused between writes. Complete lines are
+taken from the front while a partial line waits for more text.
+*/
+class outputBuffer {
+public:
+  void append(const char *s, const std::size_t len) { m_text.append(s, len); }
+  void append(const std::string_view &s) { m_text.append(s); }
+  void append(const char c) { m_text.push_back(c); }
+
+  /// \brief formats the number as the stream insertion operator does.
+  template <typename T> void appendNumber(const T value) {
+    char sz[64];
+    std::to_chars_result res;
+    if constexpr (std::is_floating_point<T>::value)
+      res = std::to_chars(sz, sz + sizeof(sz), value,
+                          std::chars_format::general, 6);
+    else
+      res = std::to_chars(sz, sz + sizeof(sz), value);
+    m_text.append(sz, static_cast<std::size_t>(res.ptr - sz));
+  }
+
+  void appendFormatted(const char *fmt, va_list ap);
+  bool hasLine(void) const { return m_text.find('\n') != std::string::npos; }
+  std::size_t takeLines(const std::function<void(std::string_view)> &fn,
+                        const bool bPartial);
+  const std::string &text(void) const { return m_text; }
+  bool empty(void) const { return m_text.empty(); }
+  void clear(void) { m_text.clear(); }
+
+private:
+  std::string m_text;
+};
+
+/**
+\class textArena
+\brief row storage for large text documents. The characters of all rows
+are kept within a few large blocks and each row is an offset and length,
+so there is no allocation per row and neighbouring rows share cache lines
+while being measured and drawn. Rows are read as std::string_view.
+
+\details
+Replacing or erasing a row leaves its characters unused within the block.
+Once the unused bytes exceed both the rows in use and one block, the rows
+are copied in order into new blocks. Views obtained earlier are invalid
+after any erase or assign.
+
+Access the storage of an element with Element::textRows().
+*/
+class textArena {
+public:
+  class const_iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::string_view;
+
+    const_iterator(const textArena *arena, std::size_t idx)
+        : m_arena(arena), m_idx(idx) {}
+    std::string_view operator*() const { return (*m_arena)[m_idx]; }
+    const_iterator &operator++() {
+      m_idx++;
+      return *this;
+    }
+    bool operator==(const const_iterator &other) const {
+      return m_idx == other.m_idx;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return m_idx != other.m_idx;
+    }
+
+  private:
+    const textArena *m_arena;
+    std::size_t m_idx;
+  };
+
+  std::size_t size(void) const { return m_rows.size(); }
+  bool empty(void) const { return m_rows.empty(); }
+  std::string_view operator[](const std::size_t idx) const {
+    const row &r = m_rows[idx];
+    return std::string_view(m_chunks[r.chunk].data() + r.offset, r.length);
+  }
+  std::string_view at(const std::size_t idx) const;
+  const_iterator begin(void) const { return const_iterator(this, 0); }
+  const_iterator end(void) const { return const_iterator(this, size()); }
+
+  void push_back(const std::string_view &s);
+  void insert(const std::size_t idx, const std::string_view &s);
+  void assign(const std::size_t idx, const std::string_view &s);
+  void erase(const std::size_t first, const std::size_t last);
+  void erase(const std::size_t idx) { erase(idx, idx + 1); }
+  void clear(void);
+  void reserve(const std::size_t rows) { m_rows.reserve(rows); }
+  void compact(void);
+
+  /// \brief the bytes held by rows, and those left unused by edits.
+  std::size_t bytes(void) const { return m_bytes; }
+  std::size_t unusedBytes(void) const { return m_unused; }
+
+  bool operator==(const textArena &other) const;
+
+private:
+  typedef struct {
+    uint32_t chunk;
+    uint32_t offset;
+    uint32_t length;
+  } row;
+
+  row store(const std::string_view &s);
+  void release(const row &r);
+
+  std::vector<std::string> m_chunks;
+  std::vector<row> m_rows;
+  std::size_t m_bytes = 0;
+  std::size_t m_unused = 0;
+};
+
+/**
+\class dataView
+\brief the order and selection in which the rows of an element's data are
+displayed. The data is not moved, so the word metrics of each row, which
+are kept by its position within the data, stay valid when the view is
+sorted or filtered.
+
+\details The view holds a permutation of the row positions for sorting and
+a selection bitmap for filtering. rows() holds the positions of the
+displayed rows in order. Rows appended to the data after the view was
+arranged are displayed at its end.
+
+Views are arranged with Element::sortData and Element::filterData.
+*/
+class dataView {
+public:
+  /// \brief the number of rows displayed.
+  std::size_t size(void) const { return rows().size(); }
+  /// \brief the position within the data of the nth displayed row.
+  std::size_t operator[](const std::size_t n) const { return rows()[n]; }
+  const std::vector<std::size_t> &rows(void) const {
+    return m_selected.empty() ? m_order : m_rows;
+  }
+  bool selected(const std::size_t idx) const {
+    return m_selected.empty() || m_selected[idx];
+  }
+
+  template <typename CONTAINER, typename COMPARE>
+  void sort(const CONTAINER &data, COMPARE fnLess);
+  template <typename CONTAINER, typename PREDICATE>
+  void filter(const CONTAINER &data, PREDICATE fnKeep);
+  void unsort(void);
+  void unfilter(void);
+  void fit(const std::size_t nRows);
+
+private:
+  std::vector<std::size_t> m_order;
+  std::vector<bool> m_selected;
+  std::vector<std::size_t> m_rows;
+  std::size_t m_dataSize = 0;
+
+  void select(void);
+  template <typename COMPARE>
+  static void parallelSort(std::vector<std::size_t> &order, COMPARE fnLess);
+};
+
+/**
+\brief orders the displayed rows by fnLess applied to the data of the rows.
+The sort is stable, so rows equal by one column keep the order given by an
+earlier sort on another.
+\param CONTAINER& data the rows, indexed by position.
+\param COMPARE fnLess compares two rows of the data.
+*/
+template <typename CONTAINER, typename COMPARE>
+void dataView::sort(const CONTAINER &data, COMPARE fnLess) {
+  fit(data.size());
+  auto fnRowLess = [&data, &fnLess](const std::size_t a, const std::size_t b) {
+    return fnLess(data[a], data[b]);
+  };
+  if (m_order.size() >= PARALLEL_SORT_THRESHOLD)
+    parallelSort(m_order, fnRowLess);
+  else
+    std::stable_sort(m_order.begin(), m_order.end(), fnRowLess);
+  select();
+}
+
+/**
+\brief displays only the rows for which fnKeep returns true. The order of
+the view is kept.
+\param CONTAINER& data the rows, indexed by position.
+\param PREDICATE fnKeep tests a row of the data.
+*/
+template <typename CONTAINER, typename PREDICATE>
+void dataView::filter(const CONTAINER &data, PREDICATE fnKeep) {
+  fit(data.size());
+  m_selected.assign(data.size(), false);
+  for (std::size_t idx = 0; idx < data.size(); idx++)
+    m_selected[idx] = fnKeep(data[idx]);
+  select();
+}
+
+/**
+\internal
+\brief sorts one run of the order per hardware thread, then merges
+neighbouring runs in pairs, each round of merges also in parallel.
+*/
+template <typename COMPARE>
+void dataView::parallelSort(std::vector<std::size_t> &order, COMPARE fnLess) {
+  std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::size_t runLength = (order.size() + threads - 1) / threads;
+  std::vector<std::size_t> bounds;
+  for (std::size_t i = 0; i < order.size(); i += runLength)
+    bounds.push_back(i);
+  bounds.push_back(order.size());
+
+  auto at = [&order](const std::size_t n) { return order.begin() + n; };
+  std::vector<std::future<void>> tasks;
+  for (std::size_t i = 0; i + 1 < bounds.size(); i++)
+    tasks.emplace_back(std::async(std::launch::async, [&, i]() {
+      std::stable_sort(at(bounds[i]), at(bounds[i + 1]), fnLess);
+    }));
+  for (auto &task : tasks)
+    task.get();
+
+  while (bounds.size() > 2) {
+    std::vector<std::size_t> merged;
+    tasks.clear();
+    for (std::size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      merged.push_back(bounds[i]);
+      // a last run without a partner is carried to the next round.
+      if (i + 2 < bounds.size())
+        tasks.emplace_back(std::async(std::launch::async, [&, i]() {
+          std::inplace_merge(at(bounds[i]), at(bounds[i + 1]),
+                             at(bounds[i + 2]), fnLess);
+        }));
+    }
+    merged.push_back(order.size());
+    for (auto &task : tasks)
+      task.get();
+    bounds = std::move(merged);
+  }
+}
+
+/**
+\enum taskPriority
+\brief the lanes of the task executor. Workers take input tasks before
+visible ones, and visible ones before background ones. input is work that
+an interaction waits upon, visible is content within the viewport and
+background is loading ahead and warming caches.
+*/
+enum class taskPriority : uint8_t { input, visible, background };
+
+/**
+\class cancellationToken
+\brief marks the tasks it is given to as no longer wanted. Queued tasks are
+dropped once it is cancelled, and a running task may test cancelled() to
+stop early. Copies share the state. A default constructed token is never
+cancelled, create() makes one that can be.
+
+Element::taskToken returns a token cancelled when the element is removed.
+*/
+class cancellationToken {
+public:
+  cancellationToken(void) {}
+  static cancellationToken create(void) {
+    cancellationToken token;
+    token.m_flag = std::make_shared<std::atomic<bool>>(false);
+    return token;
+  }
+  void cancel(void) {
+    if (m_flag)
+      m_flag->store(true, std::memory_order_relaxed);
+  }
+  bool cancelled(void) const {
+    return m_flag && m_flag->load(std::memory_order_relaxed);
+  }
+  bool cancellable(void) const { return m_flag != nullptr; }
+
+private:
+  std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+#if defined(USE_LAZY_MARKUP)
+/**
+\internal
+\class markupTape
+\brief a compact record of parsed markup. Each node is the type of a token
+and a span within one arena of text, or a pointer to the factory entry of
+an element or attribute. Elements are created from the tape by build.
+*/
+class markupTape {
+public:
+  enum class nodeType : uint8_t {
+    element,
+    elementTerminal,
+    attribute,
+    color,
+    textData
+  };
+
+  void pushElement(const factoryMap::value_type *entry);
+  void pushTerminal(void);
+  void pushAttribute(const attributeStringMap::value_type *entry,
+                     const std::string &value);
+  void pushColor(const colorNF &color);
+  void pushText(const std::string &text);
+  void clear(void);
+
+  std::size_t size(void) const { return m_nodes.size(); }
+  std::size_t elementCount(void) const { return m_elementCount; }
+  std::size_t textSize(void) const { return m_arena.size(); }
+  std::vector<std::string> indexKeys(void) const;
+  ElementList build(Element &parent, Element &before) const;
+  static bool isIndexAttribute(const attributeStringMap::value_type *entry);
+
+private:
+  typedef struct {
+    nodeType type;
+    uint32_t offset;
+    uint32_t length;
+    union {
+      const factoryMap::value_type *element;
+      const attributeStringMap::value_type *attribute;
+    };
+  } node;
+
+  std::string m_arena;
+  std::vector<node> m_nodes;
+  std::vector<colorNF> m_colors;
+  std::size_t m_elementCount = 0;
+};
+
+class deferredMarkup;
+#endif
+
 /**
    \details The class holds the cached results of the layout calculations.
    the coordinates include the margin and padding values.
@@ -855,6 +2366,12 @@ public:
   position::optionEnum pos;
   double zIndex;
 
+  // the pen of the parent and the bottom of its line when the element was
+  // placed, so that the element may be placed again by itself.
+  double entryPenX;
+  double entryPenY;
+  double entryParentMaxY;
+
   Element *ptr;
 
 public:
@@ -887,7 +2404,16 @@ public:
         m_previousSibling(nullptr), m_childCount(0), ingestStream(false) {
     setAttribute(attribs);
   }
-  ~Element() { Visualizer::deallocate(surface); }
+  ~Element() {
+    treeGeneration++;
+    m_tasks.cancel();
+    Visualizer::deallocate(surface);
+    cacheBytes.metrics -= m_metricBytes;
+    if (m_bOutputPending)
+      pendingOutput.erase(
+          std::remove(pendingOutput.begin(), pendingOutput.end(), this),
+          pendingOutput.end());
+  }
   Element(const Element &other);
   Element(Element &&other) noexcept;
   Element &operator=(const Element &other);
@@ -962,6 +2488,17 @@ private:
       return ss.str();
     }
 
+    /// \brief a view of the row as text. Strings are not copied, other
+    /// types are formatted within scratch.
+    std::string_view textView(std::size_t index, std::string &scratch) {
+      if constexpr (std::is_same<T, std::string>::value) {
+        return _data[index];
+      } else {
+        scratch = textData(static_cast<int>(index));
+        return scratch;
+      }
+    }
+
     std::function<Element &(T &)> &transform(void) { return fnTransform; }
 
     // analyze hint data and deduce states
@@ -1118,6 +2655,9 @@ public:
     // create its position within the adaptor member vector
     // return this to the caller.
     auto it = m_usageAdaptorMap.find(tIndex);
+    // the caller receives a mutable reference, so the measured
+    // text may change.
+    invalidateMetrics();
     if (it == m_usageAdaptorMap.end()) {
       // create a default data display for the type here.
       std::function<Element &(T &)> fnDefault;
@@ -1129,6 +2669,103 @@ public:
     }
   }
 
+  /**
+    \brief the text rows of the element held within a textArena. For large
+    documents this is preferred to data<std::string>() since the rows are
+    not allocated separately. Once created, lines written with operator<<
+    and printf are committed here.
+  */
+  textArena &textRows(void) {
+    auto tIndex = std::type_index(typeid(textArena));
+    invalidateMetrics();
+    auto it = m_usageAdaptorMap.find(tIndex);
+    if (it == m_usageAdaptorMap.end())
+      it = m_usageAdaptorMap.emplace(tIndex, textArena{}).first;
+    return std::any_cast<textArena &>(it->second);
+  }
+
+  /**
+    \brief sorts the displayed rows of data<T>(), or of textRows() when T is
+    textArena, by comparing their values with fnLess. Only the dataView of
+    the element is arranged, the data keeps its order, so the rows are not
+    measured again. Large data is sorted on several threads, fnLess should
+    not change shared state.
+    \tparam T the type of the data, defaulted to std::string.
+    \param COMPARE fnLess compares two values of the data.
+
+    Example
+    -------
+    \snippet examples.cpp sortData
+  */
+  template <typename T = std::string, typename COMPARE = std::less<>>
+  Element &sortData(COMPARE fnLess = COMPARE()) {
+    if (auto pData = viewData<T>())
+      m_dataViews[adaptorIndex<T>()].sort(*pData, fnLess);
+    return *this;
+  }
+
+  /**
+    \brief displays only the rows of data<T>(), or of textRows() when T is
+    textArena, for which fnKeep returns true. The order given by sortData is
+    kept.
+    \tparam T the type of the data, defaulted to std::string.
+    \param PREDICATE fnKeep tests a value of the data.
+  */
+  template <typename T = std::string, typename PREDICATE>
+  Element &filterData(PREDICATE fnKeep) {
+    if (auto pData = viewData<T>())
+      m_dataViews[adaptorIndex<T>()].filter(*pData, fnKeep);
+    return *this;
+  }
+
+  /**
+    \brief displays the rows of the data in their own order again.
+    \tparam T the type of the data, defaulted to std::string.
+  */
+  template <typename T = std::string> Element &resetDataView(void) {
+    m_dataViews.erase(adaptorIndex<T>());
+    return *this;
+  }
+
+  /**
+    \brief the displayed rows of data<T>(). The view maps a displayed row,
+    such as one found by a pointer position, to its position within the
+    data.
+    \tparam T the type of the data, defaulted to std::string.
+  */
+  template <typename T = std::string> const dataView &view(void) {
+    auto pData = viewData<T>();
+    dataView &v = m_dataViews[adaptorIndex<T>()];
+    v.fit(pData ? pData->size() : 0);
+    return v;
+  }
+
+private:
+  template <typename T> static std::type_index adaptorIndex(void) {
+    if constexpr (std::is_same<T, textArena>::value)
+      return std::type_index(typeid(textArena));
+    else
+      return std::type_index(typeid(std::vector<T>));
+  }
+
+  // the rows that a view of T arranges, without marking the metrics stale.
+  template <typename T> auto *viewData(void) {
+    auto it = m_usageAdaptorMap.find(adaptorIndex<T>());
+    if constexpr (std::is_same<T, textArena>::value)
+      return it == m_usageAdaptorMap.end()
+                 ? nullptr
+                 : std::any_cast<textArena>(&it->second);
+    else
+      return it == m_usageAdaptorMap.end()
+                 ? nullptr
+                 : &std::any_cast<usageAdaptor<T> &>(it->second).data();
+  }
+
+  const dataView *displayedRows(const std::type_index &tIndex,
+                                const std::size_t nRows);
+
+public:
+
   /**
   \brief the dataHint function provides the mechanism to inform the rendering
   system of changes to the underlying data within the buffers.
@@ -1163,9 +2800,11 @@ public:
   \brief overload of the stream insertion operator.
 
   \details
-  Simply puts the data into the stream. It should be
-  noted that flush should be called. By default the contents
-  of the stream are directly inserted into the data<std::string>() vector.
+  Formats the data at the end of the output buffer of the element. By
+  default the text is committed to the data<std::string>() vector one row
+  per line, when a new line character arrives. So that
+  e << "Hello " << name << "\n" produces a single row. A partial line is
+  committed by flush, std::endl or when the next frame is drawn.
   When the ingestStream flag is set to true, the stream is parsed for markup
   and appended to the named element.
 
@@ -1177,20 +2816,31 @@ public:
   \ref markupInputFormat
   */
   template <typename T> Element &operator<<(const T &data) {
-    std::ostringstream s;
-    s << data;
-    std::string sData = s.str();
-
-    if (this->ingestStream) {
-      ingestMarkup(*this, sData);
+    if constexpr (std::is_same<T, bool>::value) {
+      m_output.append(data ? '1' : '0');
+    } else if constexpr (std::is_same<T, char>::value ||
+                         std::is_same<T, signed char>::value ||
+                         std::is_same<T, unsigned char>::value) {
+      m_output.append(static_cast<char>(data));
+    } else if constexpr (std::is_arithmetic<T>::value) {
+      m_output.appendNumber(data);
+    } else if constexpr (std::is_convertible<const T &,
+                                             std::string_view>::value) {
+      m_output.append(std::string_view(data));
     } else {
-      // append the information to the end of the data vector.
-      this->data().push_back(sData);
+      std::ostringstream s;
+      s << data;
+      m_output.append(s.str());
     }
 
+    writeOutput(false);
     return *this;
   }
 
+  /// \brief std::endl and std::flush commit the partial line.
+  Element &operator<<(std::ostream &(*manip)(std::ostream &));
+  void flush(void);
+
   auto query(const std::string &queryString) -> ElementList{};
   auto query(const ElementQuery &queryFunction) -> ElementList{};
 
@@ -1204,6 +2854,15 @@ private:
   Element *m_nextSibling;
   Element *m_previousSibling;
   std::size_t m_childCount;
+#if defined(USE_LAZY_MARKUP)
+  // the number of deferredMarkup placeholders among the children.
+  std::size_t m_deferredChildren = 0;
+  void materializeChildren(void);
+  friend class deferredMarkup;
+#endif
+  Element *treeLink(Element *Element::*link);
+  // the layout walks the tree without creating deferred markup.
+  friend class Viewer;
 
   // interface access points for the tree traversal functions
 public:
@@ -1221,6 +2880,19 @@ public:
     return (xNAME ? std::optional<std::reference_wrapper<Element>>{*xNAME}     \
                   : std::nullopt);                                             \
   }
+
+/**
+  \internal
+  \def _LINK_INTERFACE
+  \brief as _REF_INTERFACE for the child and sibling links, which are
+  followed by treeLink so that deferred markup is not exposed.
+*/
+#define _LINK_INTERFACE(NAME, xNAME)                                           \
+  std::optional<std::reference_wrapper<Element>> NAME(void) {                  \
+    Element *p = treeLink(&Element::xNAME);                                    \
+    return (p ? std::optional<std::reference_wrapper<Element>>{*p}             \
+              : std::nullopt);                                                 \
+  }
   /**
    \fn parent
    \brief contains the parent element within the document traversal hierarchy
@@ -1240,7 +2912,7 @@ public:
    -------
    \snippet examples.cpp firstChild
   */
-  _REF_INTERFACE(firstChild, m_firstChild);
+  _LINK_INTERFACE(firstChild, m_firstChild);
 
   /**
     \fn lastChild
@@ -1251,7 +2923,7 @@ public:
     -------
     \snippet examples.cpp lastChild
   */
-  _REF_INTERFACE(lastChild, m_lastChild);
+  _LINK_INTERFACE(lastChild, m_lastChild);
 
   /**
     \fn nextChild
@@ -1284,7 +2956,7 @@ public:
     -------
     \snippet examples.cpp nextSibling
   */
-  _REF_INTERFACE(nextSibling, m_nextSibling);
+  _LINK_INTERFACE(nextSibling, m_nextSibling);
 
   /**
     \fn previousSibling
@@ -1295,7 +2967,7 @@ public:
     -------
     \snippet examples.cpp previousSibling
   */
-  _REF_INTERFACE(previousSibling, m_previousSibling);
+  _LINK_INTERFACE(previousSibling, m_previousSibling);
 
   /**
     \fn childCount
@@ -1305,7 +2977,7 @@ public:
     -------
     \snippet examples.cpp childCount
   */
-  inline std::size_t &childCount(void) { return m_childCount; }
+  std::size_t childCount(void);
 
   /**
   \internal
@@ -1353,6 +3025,8 @@ public:
 private:
   std::unordered_map<std::type_index, std::any> attributes;
   std::unordered_map<std::type_index, std::any> m_usageAdaptorMap;
+  // the sorted and filtered views of the adaptors, by the same key.
+  std::unordered_map<std::type_index, dataView> m_dataViews;
   std::size_t surface;
 
 public:
@@ -1366,6 +3040,8 @@ public:
   double computeWrappedTextDataHeight(Visualizer::platform &device,
                                       double dWrappingWidth);
   double computeWidestTextData(Visualizer::platform &device);
+  void estimateTextDataExtent(double dWrappingWidth, double &dWidth,
+                              double &dHeight);
   typedef struct {
     double totalWidth;
     double wordWidth;
@@ -1378,8 +3054,38 @@ public:
       wordMetricsIterator;
   displayListItem displayList;
 
+  /**
+  \internal
+  \brief marks the word metrics as stale so that the next layout pass
+  measures the element again. Changes to data, attributes or the font
+  scale call this.
+  */
+  void invalidateMetrics(void) {
+    m_bMetricsValid = false;
+    layoutGeneration++;
+  }
+  bool hasMetrics(void) { return m_bMetricsValid; }
+  std::size_t releaseMetrics(void);
+
+private:
+  // true when indexedWordMetrics reflects the current data and attributes.
+  bool m_bMetricsValid = false;
+  // the bytes of indexedWordMetrics, as counted within cacheBytes.
+  std::size_t m_metricBytes = 0;
+  // text from operator<< and printf not yet committed to data().
+  outputBuffer m_output;
+  // true while the element is listed in pendingOutput.
+  bool m_bOutputPending = false;
+  void writeOutput(const bool bFlush);
+  void takeOutput(Element &other);
+  friend std::vector<std::size_t> flushPendingOutput(void);
+  // true when the metrics were measured with the fallback face because the
+  // requested face was still loading.
+  bool m_bMetricsFallback = false;
+
 public:
   auto appendChild(const std::string &sMarkup) -> Element &;
+  auto load(const std::string &sFilename) -> Element &;
   auto appendChild(Element &newChild) -> Element &;
   auto appendChild(const ElementList &elementCollection) -> Element &;
   /**
@@ -1455,6 +3161,11 @@ public:
     \exception std::invalid_argument When an element does not contain
     an element, an exception is thrown.
 
+    Style properties are shared with the elements of the same style, so the
+    reference is to a copy the element is given. The copy is shared again
+    at the next layout, the reference should not be kept past it.
+    readAttribute reads a value without copying.
+
     Example
     -------
     \snippet examples.cpp getAttribute
@@ -1462,11 +3173,19 @@ public:
   */
   template <typename ATTR_TYPE> ATTR_TYPE &getAttribute(void) {
     ATTR_TYPE *ret = nullptr;
-    auto it = attributes.find(std::type_index(typeid(ATTR_TYPE)));
-    if (it != attributes.end()) {
-      ret = &std::any_cast<ATTR_TYPE &>(it->second);
-
+    if constexpr (isStyleProperty<ATTR_TYPE>) {
+      // the caller may change the value, so a shared style is copied.
+      if (m_style && m_style->find<ATTR_TYPE>()) {
+        detachStyle();
+        ret = m_style->edit<ATTR_TYPE>();
+      }
     } else {
+      auto it = attributes.find(std::type_index(typeid(ATTR_TYPE)));
+      if (it != attributes.end())
+        ret = &std::any_cast<ATTR_TYPE &>(it->second);
+    }
+
+    if (!ret) {
       std::string info = typeid(ret).name();
       info += " attribute not found";
 
@@ -1475,6 +3194,37 @@ public:
     return *ret;
   }
 
+  /**
+    \brief returns the attribute for reading.
+    \exception std::invalid_argument the element does not have the
+    attribute.
+  */
+  template <typename ATTR_TYPE> const ATTR_TYPE &readAttribute(void) const {
+    const ATTR_TYPE *ret = nullptr;
+    if constexpr (isStyleProperty<ATTR_TYPE>) {
+      if (m_style)
+        ret = m_style->find<ATTR_TYPE>();
+    } else {
+      auto it = attributes.find(std::type_index(typeid(ATTR_TYPE)));
+      if (it != attributes.end())
+        ret = &std::any_cast<const ATTR_TYPE &>(it->second);
+    }
+
+    if (!ret)
+      throw std::invalid_argument(std::string(typeid(ATTR_TYPE).name()) +
+                                  " attribute not found");
+    return *ret;
+  }
+
+  const computedStyle &style(void);
+  void resolveStyle(void);
+
+private:
+  // the style properties, shared with other elements once resolved.
+  std::shared_ptr<computedStyle> m_style;
+  bool m_bStyleShared = false;
+  void detachStyle(void);
+
 private:
   std::vector<eventHandler> onfocus;
   std::vector<eventHandler> onblur;
@@ -1492,6 +3242,9 @@ private:
   std::vector<eventHandler> oncontextmenu;
   std::vector<eventHandler> onwheel;
 
+  // the token of tasks working for the element, cancelled with it.
+  cancellationToken m_tasks;
+
 private:
   std::vector<eventHandler> &getEventVector(eventType evtType);
 
@@ -1513,6 +3266,10 @@ public:
   auto clear(void) -> Element &;
   auto replaceChild(Element &newChild, Element &oldChild) -> Element &;
   auto replaceChild(Element &newChild, std::string &sID) -> Element &;
+  auto patch(Element &newFragment) -> Element &;
+  auto clone(const bool bDeep = true, const std::string &sIdSuffix = "")
+      -> Element &;
+  cancellationToken taskToken(void);
 
 #if defined(__clang__)
   void printf(const char *fmt, ...)
@@ -1533,8 +3290,10 @@ private:
     textData
   };
 
-  /// \typedef the variant holds the payload from the tokenizer
-  typedef std::variant<std::string, factoryLambda, attributeLambda, colorNF>
+  /// \typedef the variant holds the payload from the tokenizer. Factory
+  /// entries are referenced within their const maps rather than copied.
+  typedef std::variant<std::string, const factoryMap::value_type *,
+                       const attributeStringMap::value_type *, colorNF>
       parserOperator;
 
   /// \typedef the structure that holds the parser context.
@@ -1565,12 +3324,67 @@ private:
     std::string sCapture;
     // text information that will be added to the elements data
     std::string sText;
+#if defined(USE_LAZY_MARKUP)
+    // the group of top level elements being recorded and the depth of the
+    // recording within it.
+    deferredMarkup *deferred;
+    int deferredDepth;
+#endif
 
   } parserContext;
 
   void processParseContext(parserContext &pc);
+  static void readMarkupFile(std::istream &input, markupBlockQueue &queue);
   auto ingestMarkup(Element &node, const std::string &markup) -> Element &;
+  void tokenizeMarkup(parserContext &pc, std::string_view markup);
+  auto buildMarkup(Element &node, parserContext &pc) -> Element &;
+#if defined(USE_PARALLEL_PARSE)
+  /**
+  \internal
+  \brief the elements built from a piece of markup upon a worker thread.
+  Their ownership and ids pass to the thread of the document, which appends
+  the roots and the text of the top level in order.
+  */
+  typedef struct {
+    std::vector<std::unique_ptr<Element>> owned;
+    std::vector<Element *> roots;
+    std::vector<std::string> text;
+    std::vector<std::pair<std::string, Element *>> index;
+#if defined(USE_LAZY_MARKUP)
+    std::vector<std::pair<std::string, std::size_t>> deferred;
+    std::size_t deferredChildren;
+#endif
+  } markupFragment;
+
+  std::vector<std::size_t> markupSplitPoints(const std::string &markup,
+                                             std::size_t chunkSize);
+  static markupFragment buildMarkupFragment(std::string_view markup);
+  static void adoptMarkupFragment(Element &parent, markupFragment &fragment);
+  auto ingestMarkupParallel(Element &node, parserContext &pc,
+                            const std::string &markup) -> Element &;
+#endif
+  void patchAttributes(Element &fresh);
+  void patchData(Element &fresh);
+  template <typename T> bool patchDataAdaptor(Element &fresh);
+  bool patchTextRows(Element &fresh);
+  void patchChildren(Element &fresh);
+  static void releasePatched(Element &e, bool bSubtree);
+  static void indexSubtree(Element &e);
+#if defined(USE_LAZY_MARKUP)
+  void deferMarkup(parserContext &pc,
+                   std::vector<std::tuple<itemType, bool, parserOperator>>::
+                       iterator &item);
+  void closeDeferredMarkup(parserContext &pc);
+#endif
   void updateIndexBy(const indexBy &setting);
+  void cloneIndexBy(const std::string &sIdSuffix);
+
+  // copies the element as its created type, set by _createElement.
+  Element &(*m_fnClone)(const Element &) = nullptr;
+  template <typename TYPE>
+  friend auto &_createElement(const std::vector<std::any> &attrs);
+  template <typename TYPE>
+  friend Element &_cloneElement(const Element &source);
 }; // class Element
 
 // prototypes for the user defined literals
@@ -1908,7 +3722,138 @@ public:
       : Element("image", {display::in_line}) {
     setAttribute(attribs);
   }
+  void render(Visualizer::platform &device) override;
+
+  /**
+  \brief the decoded pixels of the image. When given, they are drawn
+  scaled to the layout size of the element in place of the data.
+  */
+  Visualizer::imageSurface bitmap;
+};
+
+/**
+\class seriesSummary
+\brief a numeric series with a multi-resolution min/max summary.
+\details The points are grouped into blocks of SERIES_SUMMARY_BLOCK. Each
+level of the summary holds the minimum and maximum of pairs of nodes of the
+level below, so the extent of any range of points is found in logarithmic
+time. Appending updates one node per level.
+*/
+class seriesSummary {
+public:
+  typedef struct {
+    double min;
+    double max;
+  } extent;
+
+  void append(const double value);
+  void append(const std::vector<double> &values);
+  void assign(std::vector<double> &&values);
+  void changed(const std::size_t first = 0);
+  void clear(void);
+  extent query(std::size_t first, std::size_t last) const;
+
+  std::size_t size(void) const { return m_values.size(); }
+  const std::vector<double> &values(void) const { return m_values; }
+  std::vector<double> &values(void) { return m_values; }
+
+private:
+  std::vector<double> m_values;
+  std::vector<std::vector<extent>> m_levels;
+
+  void rebuild(const std::size_t firstBlock);
+};
+
+/**
+\class CHART
+\brief a line or area chart of a numeric series.
+\extends Element
+\details The chart draws the visible range of the series within its layout
+rectangle. When there are more points than pixel columns, each column
+draws the minimum and maximum of its points, taken from the series
+summary, so drawing costs the same for any length of series. Points are
+added with series.append. When existing points are modified through
+series.values(), series.changed must be called with the first index
+changed.
+
+The points are not kept within data<double>(). Rows of the data adaptor
+are text of the element, each measured and laid out as words, and the
+mutable reference it returns gives no notice of which points changed,
+so the summary could not be kept current without rescanning the series.
+
+Example
+-------
+\snippet examples.cpp CHART
+
+*/
+using CHART = class CHART : public Element {
+public:
+  enum class chartStyle { line, area };
+
+  CHART(const std::vector<std::any> &attribs)
+      : Element("chart", {display::block}) {
+    setAttribute(attribs);
+  }
+  void render(Visualizer::platform &device) override;
+
+  /// \brief the points of the chart
+  seriesSummary series;
+
+  chartStyle style = chartStyle::line;
+  unsigned int lineColor = 0x1F77B4;
+  unsigned int fillColor = 0xAEC7E8;
+
+  /**
+  \brief the visible range of points. A count of zero shows through to
+  the end of the series. Zooming and panning change these values.
+  */
+  std::size_t viewFirst = 0;
+  std::size_t viewCount = 0;
+
+  /**
+  \brief the vertical range. When bAutoRange is set, the range is the
+  extent of the visible points.
+  */
+  bool bAutoRange = true;
+  double rangeMin = 0;
+  double rangeMax = 1;
+};
+
+#if defined(USE_LAZY_MARKUP)
+/**
+\class deferredMarkup
+\brief a placeholder for elements parsed from markup that are not yet
+created.
+\extends Element
+\details The placeholder holds a group of top level elements upon its
+tape. Until created, it takes the estimated height of its contents within
+the layout. When materialized, the elements are inserted before it and the
+placeholder is removed. The tree traversal functions, childCount and
+children() create the placeholders of an element before visiting its
+children, and pass over those whose markup is still being parsed.
+*/
+class deferredMarkup : public Element {
+public:
+  deferredMarkup(const std::vector<std::any> &attribs)
+      : Element("deferred", {display::block}) {
+    setAttribute(attribs);
+  }
+  ElementList materialize(void);
+  void complete(void);
+  bool completed(void) { return m_bCompleted; }
+  bool materialized(void) { return m_bMaterialized; }
+
+  markupTape tape;
+
+private:
+  bool m_bCompleted = false;
+  bool m_bMaterialized = false;
 };
+
+bool materializeDeferred(const std::string &key);
+void materializeDeferred(void);
+#endif
+
 /**
 \class textNode
 \brief a node of textual information
@@ -1952,6 +3897,7 @@ using ul = UL;
 using ol = OL;
 using li = LI;
 using image = IMAGE;
+using chart = CHART;
 using textnode = textNode;
 #endif
 
@@ -1974,9 +3920,29 @@ auto &_createElement(const std::vector<std::any> &attrs) {
       elements.insert({storageKey, std::move(e)});
 
   TYPE *typedReturn = static_cast<TYPE *>(ret.first->second.get());
+  if constexpr (!std::is_same<TYPE, Viewer>::value)
+    typedReturn->m_fnClone = &_cloneElement<TYPE>;
   return static_cast<TYPE &>(*typedReturn);
 }
 
+/**
+\internal
+\brief copies the element with the copy constructor of its type. The copy
+is stored like a created element.
+\tparam TYPE is the type the source was created as.
+*/
+template <typename TYPE> Element &_cloneElement(const Element &source) {
+  static_assert(!std::is_same<TYPE, Viewer>::value,
+                "the Viewer cannot be cloned");
+  std::unique_ptr<TYPE> e =
+      std::make_unique<TYPE>(static_cast<const TYPE &>(source));
+  e->m_fnClone = source.m_fnClone;
+  std::size_t storageKey = (std::size_t)e.get();
+  std::pair<elementsIterator, bool> ret =
+      elements.insert({storageKey, std::move(e)});
+  return *ret.first->second;
+}
+
 /**
 \addtogroup API Global Document API
 
@@ -2037,6 +4003,11 @@ template <class T = Element &> auto getElement(const std::string &key) -> T & {
     T &ret = reinterpret_cast<T &>(it->second.get());
     return ret;
 
+#if defined(USE_LAZY_MARKUP)
+  } else if (materializeDeferred(key)) {
+    return getElement<T>(key);
+#endif
+
   } else {
     std::string info = key;
     info += " element not found by ID ";
@@ -2046,8 +4017,267 @@ template <class T = Element &> auto getElement(const std::string &key) -> T & {
 }
 
 bool hasElement(const std::string &key);
+auto patch(Element &existingElement, Element &newFragment) -> Element &;
 /** @}*/
 
+/**
+\enum invalidation
+\brief the work a change to an element requires. Changes of the paint class
+need the element drawn again, the layout class also positions the document
+again, and the metrics class also measures the text of the element again.
+*/
+enum class invalidation : uint8_t { paint, layout, metrics };
+invalidation attributeInvalidation(const std::type_index &tIndex);
+
+class observableBase;
+class bindingQueue;
+
+/**
+\class bindingBase
+\brief a link from an observable value to an element. The element is
+referenced by its key within the elements map, so a binding whose element
+has been removed is dropped when it is next applied.
+*/
+class bindingBase {
+public:
+  bindingBase(Element &e, observableBase &source, invalidation level);
+  virtual ~bindingBase();
+  /// \brief the work of applying the value, run without observableLock.
+  typedef std::function<void(Element &)> applyStep;
+  virtual bool prepare(applyStep &step) = 0;
+  invalidation level(void) { return m_level; }
+
+protected:
+  Element *element(void);
+
+private:
+  friend class bindingQueue;
+  friend class observableBase;
+  void queue(void);
+
+  std::size_t m_elementKey;
+  std::weak_ptr<bindingQueue> m_queue;
+  observableBase &m_source;
+  invalidation m_level;
+  bool m_bPending = false;
+};
+
+/**
+\class bindingQueue
+\brief holds the bindings whose values changed since the last frame. A
+binding is queued once no matter how often its value changes, and the
+first one queued requests a frame. The queue is applied on the user
+interface thread before the document is laid out. Each thread holding a
+document has its own queue.
+*/
+class bindingQueue {
+public:
+  /**
+  \internal
+  \brief what a flush changed. The level is the strongest among the
+  bindings applied, and keys are the elements whose bindings need more
+  than a paint.
+  */
+  typedef struct {
+    bool bApplied;
+    invalidation level;
+    std::vector<std::size_t> keys;
+  } flushResult;
+
+  void schedule(bindingBase *b);
+  void cancel(bindingBase *b);
+  flushResult flush(void);
+  void setFrameRequest(const std::function<void(void)> &fn);
+
+private:
+  std::mutex m_mutex;
+  std::vector<bindingBase *> m_pending;
+  std::function<void(void)> m_fnRequestFrame;
+  bool m_bFrameRequested = false;
+};
+
+/**
+\internal
+\var pendingBindings is the queue of changed bindings for the document of
+the thread. A binding keeps the queue of the thread that made it, so values
+changed from other threads are applied by the document they are bound to.
+*/
+extern thread_local std::shared_ptr<bindingQueue> pendingBindings;
+
+/**
+\internal
+\var observableLock guards the values and the dependency graph, which may
+be shared by the documents of several threads.
+*/
+extern std::recursive_mutex observableLock;
+
+/**
+\class observableBase
+\brief a node of the dependency graph of observable values. When a value
+changes, the computed values depending upon it are marked stale and the
+bindings of each are queued. Values may be changed from any thread.
+*/
+class observableBase {
+public:
+  observableBase() {}
+  observableBase(const observableBase &) = delete;
+  observableBase &operator=(const observableBase &) = delete;
+  virtual ~observableBase();
+
+protected:
+  void changed(void);
+  void dependsOn(observableBase &dependency);
+  void addBinding(std::unique_ptr<bindingBase> b);
+  virtual bool markStale(void) { return true; }
+
+private:
+  friend class bindingQueue;
+  void removeBinding(bindingBase *b);
+
+  std::vector<observableBase *> m_dependents;
+  std::vector<observableBase *> m_dependencies;
+  std::vector<std::unique_ptr<bindingBase>> m_bindings;
+};
+
+/**
+\class observableValue
+\brief the interface shared by observable and computed values of type T.
+Values are bound to an attribute, a row of data, or a function.
+
+Example
+-------
+\snippet examples.cpp observable
+*/
+template <typename T> class observableValue : public observableBase {
+public:
+  virtual T get(void) = 0;
+
+  /// \brief sets the attribute ATTR, constructed from the value.
+  template <typename ATTR> void bindAttribute(Element &e) {
+    bind(e, [](Element &eBound, const T &v) { eBound.setAttribute(ATTR{v}); },
+         attributeInvalidation(std::type_index(typeid(ATTR))));
+  }
+
+  /// \brief sets the row of data<T>(), extending the data when needed.
+  void bindData(Element &e, const std::size_t row) {
+    bind(e,
+         [row](Element &eBound, const T &v) {
+           auto &d = eBound.data<T>();
+           if (d.size() <= row)
+             d.resize(row + 1);
+           d[row] = v;
+         },
+         invalidation::metrics);
+  }
+
+  /// \brief calls the function with the element and the value.
+  void bind(Element &e, const std::function<void(Element &, const T &)> &fn,
+            invalidation level = invalidation::layout) {
+    std::lock_guard<std::recursive_mutex> lock(observableLock);
+    addBinding(std::make_unique<valueBinding>(e, *this, fn, level));
+  }
+
+private:
+  /**
+  \internal
+  \brief gives the step applying the value through the function when it
+  differs from the value last applied. The step holds a copy of the value.
+  */
+  class valueBinding : public bindingBase {
+  public:
+    valueBinding(Element &e, observableValue<T> &source,
+                 const std::function<void(Element &, const T &)> &fn,
+                 invalidation level)
+        : bindingBase(e, source, level), m_value(source), m_fn(fn) {}
+
+    bool prepare(applyStep &step) override {
+      if (!element())
+        return false;
+
+      T v = m_value.get();
+      if (m_last && *m_last == v)
+        return true;
+
+      m_last = v;
+      step = [fn = m_fn, v](Element &e) { fn(e, v); };
+      return true;
+    }
+
+  private:
+    observableValue<T> &m_value;
+    std::function<void(Element &, const T &)> m_fn;
+    std::optional<T> m_last;
+  };
+};
+
+/**
+\class observable
+\brief a value of the model. Setting a different value queues the
+bindings of the value and of the computed values that depend upon it.
+*/
+template <typename T> class observable : public observableValue<T> {
+public:
+  observable(const T &value = T{}) : m_value(value) {}
+
+  T get(void) override {
+    std::lock_guard<std::recursive_mutex> lock(observableLock);
+    return m_value;
+  }
+
+  void set(const T &value) {
+    std::lock_guard<std::recursive_mutex> lock(observableLock);
+    if (m_value == value)
+      return;
+    m_value = value;
+    this->changed();
+  }
+
+  observable &operator=(const T &value) {
+    set(value);
+    return *this;
+  }
+
+private:
+  T m_value;
+};
+
+/**
+\class computed
+\brief a value derived from other observable values by a function. The
+function is evaluated when the value is read after a dependency changed.
+*/
+template <typename T> class computed : public observableValue<T> {
+public:
+  computed(const std::function<T(void)> &fn,
+           std::initializer_list<std::reference_wrapper<observableBase>>
+               dependencies)
+      : m_fn(fn) {
+    std::lock_guard<std::recursive_mutex> lock(observableLock);
+    for (auto &d : dependencies)
+      this->dependsOn(d.get());
+  }
+
+  T get(void) override {
+    std::lock_guard<std::recursive_mutex> lock(observableLock);
+    if (!m_value) {
+      m_value = m_fn();
+    }
+    return *m_value;
+  }
+
+protected:
+  bool markStale(void) override {
+    if (!m_value)
+      return false;
+    m_value.reset();
+    return true;
+  }
+
+private:
+  std::function<T(void)> m_fn;
+  std::optional<T> m_value;
+};
+
 /**
 \def
 The object factory map provides a parser allocation map for base objects.
@@ -2066,6 +4296,129 @@ are added on top of the viewManager base library.
              -> Element & { return _createElement<OBJECT_TYPE>(attrs); }       \
   }
 
+/**
+\enum trimLevel
+\brief the caches of a Viewer in the order they are discarded. Trimming
+to a level discards that cache and those before it. The images are the mip
+levels and scaled copies of IMAGE bitmaps, the surfaces the pixel buffers
+of the platform made again for the next frame, the glyphs the FreeType
+cache and the metrics the measured words of the elements.
+
+Example
+-------
+\snippet examples.cpp memoryBudget
+*/
+enum class trimLevel : uint8_t { images, surfaces, glyphs, metrics };
+
+/**
+\brief the bytes held by each cache of a Viewer, or freed from each by
+Viewer::trim.
+*/
+struct memoryUsage {
+  std::size_t images;
+  std::size_t surfaces;
+  std::size_t glyphs;
+  std::size_t metrics;
+  std::size_t total(void) const { return images + surfaces + glyphs + metrics; }
+};
+
+#if defined(__linux__)
+/**
+\internal
+\class memoryPressureWatch
+\brief calls a function from its own thread each time the kernel reports
+that the memory stall time of the trigger was exceeded.
+*/
+class memoryPressureWatch {
+public:
+  memoryPressureWatch(const std::string &sTrigger,
+                      const std::function<void(void)> &fn);
+  ~memoryPressureWatch();
+
+private:
+  int m_fd;
+  int m_stop[2];
+  std::function<void(void)> m_fn;
+  std::thread m_thread;
+  void run(void);
+};
+#endif
+
+/**
+\class executor
+\brief a pool of worker threads for work that should not hold up the
+message loop, such as loading data, decoding images, parsing markup and
+warming the font cache.
+
+\details Each worker owns a queue per taskPriority. Tasks posted from
+outside the pool are dealt to the workers in turn, tasks posted by a task
+go to the queue of its worker. A worker takes the newest task of its own
+queue, and when that lane is empty steals the oldest of another worker's,
+before looking at a lower lane.
+
+The document is kept per thread, so tasks must not change elements. Their
+results are applied with Viewer::runOnUiThread. Tasks still queued when
+the executor is destroyed are dropped.
+
+Example
+-------
+\snippet examples.cpp executor
+*/
+class executor {
+public:
+  executor(const std::size_t nThreads = EXECUTOR_THREADS,
+           const std::vector<int> &cpus = {});
+  ~executor();
+  executor(const executor &) = delete;
+  executor &operator=(const executor &) = delete;
+
+  void post(std::function<void(void)> fn,
+            const taskPriority priority = taskPriority::background,
+            const cancellationToken &token = {});
+
+  /**
+  \brief posts fn and returns the future of its result. The exception
+  raised by fn is given by the future. When the task is dropped, the future
+  raises std::future_error.
+  */
+  template <typename FN>
+  auto submit(FN fn, const taskPriority priority = taskPriority::background,
+              const cancellationToken &token = {})
+      -> std::future<decltype(fn())> {
+    auto task =
+        std::make_shared<std::packaged_task<decltype(fn())(void)>>(
+            std::move(fn));
+    auto result = task->get_future();
+    post([task]() { (*task)(); }, priority, token);
+    return result;
+  }
+
+  std::size_t threads(void) const { return m_workers.size(); }
+
+private:
+  typedef struct {
+    std::function<void(void)> fn;
+    cancellationToken token;
+  } task;
+
+  // the lanes of one worker, the owner uses the back and thieves the front.
+  typedef struct {
+    std::mutex lock;
+    std::array<std::deque<task>, 3> lanes;
+  } workerQueue;
+
+  std::vector<std::unique_ptr<workerQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::atomic<std::size_t> m_next{0};
+  std::atomic<std::size_t> m_pending{0};
+  std::mutex m_sleepLock;
+  std::condition_variable m_sleep;
+  bool m_bStop = false;
+
+  void run(const std::size_t self);
+  bool take(const std::size_t self, task &t);
+};
+
 /**
 \brief The class is the main document viewer. Applications must create this as
 the top node of the tree. All subsequent operations are added or appended to
@@ -2080,16 +4433,123 @@ public:
   Viewer &operator=(Viewer &&other) noexcept {} // move assignment
   void render();
   void processEvents(void);
+  const std::vector<u_int8_t> &renderImage(void);
+  void saveImage(const std::string &sFilename);
+  void serveFrames(const std::string &sAddress);
+  void exportFrames(const std::string &sName);
   void dispatchEvent(const event &e);
 
+  void setMemoryBudget(
+      const std::size_t bytes,
+      const std::function<void(const memoryUsage &)> &fnExceeded = {});
+  std::size_t memoryBudget(void) const { return m_memoryBudget; }
+  memoryUsage cacheUsage(void) const;
+  memoryUsage trim(const trimLevel level);
+  void requestTrim(const trimLevel level);
+  void watchMemoryPressure(const trimLevel level,
+                           const std::string &sTrigger =
+                               MEMORY_PRESSURE_TRIGGER);
+
+  void configureExecutor(const std::size_t nThreads,
+                         const std::vector<int> &cpus = {});
+  executor &tasks(void);
+  void runOnUiThread(std::function<void(void)> fn,
+                     const cancellationToken &token = {});
+
+  bool layoutEstimated(void) {
+    return m_nextDeferred < m_deferredMetrics.size();
+  }
+
 private:
   void treeOrderComputeLayout(double &penx, double &penY, Element &e);
   void computeLayout(Element &e);
+  void initializeDisplayList(Element &e);
+  void beginLayout(void);
+  bool continueLayout(std::chrono::steady_clock::time_point deadline);
+  void layoutSlice(void);
+  void updateLayout(void);
+  void applyPendingWork(const bool bPaint);
+  void placeElement(Element &e, std::vector<std::size_t> &stack);
+  bool placeSubtree(Element &e);
+  void relayout(std::vector<std::size_t> keys);
+  void repaint(void);
+  void renderDisplayList(void);
+  void processDeferredMetrics(void);
+  void startPlatform(void);
+  void enforceMemoryBudget(void);
+  std::vector<std::size_t> takeFaceWaiters(void);
+  bool runUiTasks(void);
 
 private:
   std::unique_ptr<Visualizer::platform> m_device;
 
+  // the font and display start up tasks begun by the constructor.
+  std::future<void> m_textStartup;
+  std::future<void> m_displayStartup;
+
   std::vector<displayListItem *> m_displayList;
+
+  /**
+  \internal
+  \brief an element below the viewport whose size was estimated. The
+  element is referenced by its key within the elements map as it may be
+  removed before the idle slice measures it.
+  */
+  typedef struct {
+    std::size_t key;
+    double dWidth;
+    double dEstimatedHeight;
+  } deferredMetricsItem;
+
+  std::vector<deferredMetricsItem> m_deferredMetrics;
+  std::size_t m_nextDeferred = 0;
+  bool m_bRefinePaint = false;
+
+  /**
+  \internal
+  \brief the state of a time sliced layout. The initialize phase visits
+  the keys captured when the layout began, the walk phase visits the tree
+  using the stack of element keys. The generation is the treeGeneration
+  the layout and its display list were made from, changes the
+  layoutGeneration it has accounted for. bRedo notes changes made while
+  the layout was in progress, which are laid out once it completes.
+  */
+  enum class layoutPhase : uint8_t { initialize, walk, complete };
+  typedef struct {
+    layoutPhase phase;
+    std::vector<std::size_t> keys;
+    std::size_t next;
+    std::vector<std::size_t> stack;
+    std::size_t generation;
+    std::size_t changes;
+    bool bRedo;
+  } layoutState;
+
+  layoutState m_layout{layoutPhase::complete, {}, 0, {}, 0, 0, false};
+
+  std::size_t m_memoryBudget = MEMORY_BUDGET;
+  // called once when the caches the budget keeps exceed it.
+  std::function<void(const memoryUsage &)> m_fnBudgetExceeded;
+  bool m_bOverBudget = false;
+  // the deepest trimLevel requested from another thread, or -1.
+  std::atomic<int> m_requestedTrim{-1};
+
+  // functions posted by runOnUiThread, run by the next paint.
+  std::mutex m_uiTasksLock;
+  std::vector<std::pair<std::function<void(void)>, cancellationToken>>
+      m_uiTasks;
+
+  // the executor is started by its first use, after which it cannot be
+  // configured. Its workers stop before the members they may use.
+  std::mutex m_executorLock;
+  std::size_t m_executorThreads = EXECUTOR_THREADS;
+  std::vector<int> m_executorCpus;
+  std::unique_ptr<executor> m_executor;
+
+#if defined(__linux__)
+  // declared last so that its thread stops before the viewer is torn down.
+  std::unique_ptr<memoryPressureWatch> m_pressureWatch;
+#endif
 };
 }; // namespace viewManager
 